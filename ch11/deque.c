@@ -36,6 +36,27 @@
 
 #include "deque.h"
 
+void DequeInit(DEQUE *Deque, NODEPOOL *Pool)
+{
+  DEQUE Empty = {0};
+
+  assert(Deque != NULL);
+
+  *Deque = Empty;
+  Deque->Pool = Pool;
+}
+
+void DequeInitRing(DEQUE *Deque, size_t RecordSize)
+{
+  DEQUE Empty = {0};
+
+  assert(Deque != NULL);
+  assert(RecordSize > 0);
+
+  *Deque = Empty;
+  RingInit(&Deque->Ring, RecordSize);
+}
+
 int DequeAddAtFront(DEQUE *Deque,
                     int Tag,
                     void *Object,
@@ -46,24 +67,40 @@ int DequeAddAtFront(DEQUE *Deque,
   assert(Deque != NULL);
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
 
-  ListResult = DLAddBefore(&Deque->HeadPtr,
-                           Tag,
-                           Object,
-                           Size);
-
-  if(DL_SUCCESS == ListResult)
+  if(Deque->Ring.RecordSize > 0)
   {
-    if(0 == Deque->NumItems)
+    ListResult = RingAddAtFront(&Deque->Ring,
+                                Tag,
+                                Object,
+                                Size);
+    if(RING_SUCCESS == ListResult)
     {
-      Deque->TailPtr = Deque->HeadPtr;
+      Result = DEQUE_SUCCESS;
+      ++Deque->NumItems;
     }
-    else
+  }
+  else
+  {
+    ListResult = DLPoolAddBefore(Deque->Pool,
+                                 &Deque->HeadPtr,
+                                 Tag,
+                                 Object,
+                                 Size);
+
+    if(DL_SUCCESS == ListResult)
     {
-      Deque->HeadPtr = Deque->HeadPtr->Prev;
-    }
+      if(0 == Deque->NumItems)
+      {
+        Deque->TailPtr = Deque->HeadPtr;
+      }
+      else
+      {
+        Deque->HeadPtr = Deque->HeadPtr->Prev;
+      }
 
-    Result = DEQUE_SUCCESS;
-    ++Deque->NumItems;
+      Result = DEQUE_SUCCESS;
+      ++Deque->NumItems;
+    }
   }
 
   return Result;
@@ -79,24 +116,40 @@ int DequeAddAtBack(DEQUE *Deque,
   assert(Deque != NULL);
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
 
-  ListResult = DLAddAfter(&Deque->TailPtr,
-                          Tag,
-                          Object,
-                          Size);
-
-  if(DL_SUCCESS == ListResult)
+  if(Deque->Ring.RecordSize > 0)
   {
-    if(0 == Deque->NumItems)
+    ListResult = RingAddAtBack(&Deque->Ring,
+                               Tag,
+                               Object,
+                               Size);
+    if(RING_SUCCESS == ListResult)
     {
-      Deque->HeadPtr = Deque->TailPtr;
+      Result = DEQUE_SUCCESS;
+      ++Deque->NumItems;
     }
-    else
+  }
+  else
+  {
+    ListResult = DLPoolAddAfter(Deque->Pool,
+                                &Deque->TailPtr,
+                                Tag,
+                                Object,
+                                Size);
+
+    if(DL_SUCCESS == ListResult)
     {
-      Deque->TailPtr = Deque->TailPtr->Next;
-    }
+      if(0 == Deque->NumItems)
+      {
+        Deque->HeadPtr = Deque->TailPtr;
+      }
+      else
+      {
+        Deque->TailPtr = Deque->TailPtr->Next;
+      }
 
-    Result = DEQUE_SUCCESS;
-    ++Deque->NumItems;
+      Result = DEQUE_SUCCESS;
+      ++Deque->NumItems;
+    }
   }
 
   return Result;
@@ -112,7 +165,12 @@ int DequeRemoveFromFront(void *Object, DEQUE *Deque)
   assert(Deque != NULL);
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
 
-  if(Deque->NumItems > 0)
+  if(Deque->NumItems > 0 && Deque->Ring.RecordSize > 0)
+  {
+    RingRemoveFromFront(Object, &Deque->Ring);
+    --Deque->NumItems;
+  }
+  else if(Deque->NumItems > 0)
   {
     p = DLGetData(Deque->HeadPtr, NULL, &Size);
     if(p != NULL)
@@ -154,7 +212,12 @@ int DequeRemoveFromBack(void *Object, DEQUE *Deque)
   assert(Deque != NULL);
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
 
-  if(Deque->NumItems > 0)
+  if(Deque->NumItems > 0 && Deque->Ring.RecordSize > 0)
+  {
+    RingRemoveFromBack(Object, &Deque->Ring);
+    --Deque->NumItems;
+  }
+  else if(Deque->NumItems > 0)
   {
     p = DLGetData(Deque->TailPtr, NULL, &Size);
     if(p != NULL)
@@ -190,20 +253,42 @@ void *DequeGetDataFromFront(DEQUE *Deque,
                             int *Tag,
                             size_t *Size)
 {
+  void *p;
+
   assert(Deque != NULL);
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
 
-  return DLGetData(Deque->HeadPtr, Tag, Size);
+  if(Deque->Ring.RecordSize > 0)
+  {
+    p = RingGetDataFromFront(&Deque->Ring, Tag, Size);
+  }
+  else
+  {
+    p = DLGetData(Deque->HeadPtr, Tag, Size);
+  }
+
+  return p;
 }
 
 void *DequeGetDataFromBack(DEQUE *Deque,
                            int *Tag,
                            size_t *Size)
 {
+  void *p;
+
   assert(Deque != NULL);
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
 
-  return DLGetData(Deque->TailPtr, Tag, Size);
+  if(Deque->Ring.RecordSize > 0)
+  {
+    p = RingGetDataFromBack(&Deque->Ring, Tag, Size);
+  }
+  else
+  {
+    p = DLGetData(Deque->TailPtr, Tag, Size);
+  }
+
+  return p;
 }
 
 size_t DequeCount(DEQUE *Deque)
@@ -219,6 +304,8 @@ void DequeDestroy(DEQUE *Deque)
   assert(0 == Deque->CheckInit1 && 0 == Deque->CheckInit2);
   DLDestroy(&Deque->HeadPtr);
   Deque->TailPtr = NULL;
+  Deque->NumItems = 0;
+  RingDestroy(&Deque->Ring);
 }
 
 
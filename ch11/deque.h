@@ -34,6 +34,7 @@
 #define DEQUE_H__
 
 #include "dllist.h"
+#include "ring.h"
 
 #define DEQUE_SUCCESS       0
 #define DEQUE_ADD_FAILURE   1
@@ -49,12 +50,27 @@ typedef struct DEQUE
   DLLIST *HeadPtr;
   DLLIST *TailPtr;
   size_t NumItems;
+  NODEPOOL *Pool;
+  RING Ring;
 
 #ifndef NDEBUG
   int CheckInit2;
 #endif
 } DEQUE;
 
+/* Prepare an empty deque whose nodes come from
+ * Pool (see DLCreatePool). A deque initialised
+ * to {0} instead simply uses malloc.
+ */
+void DequeInit(DEQUE *Deque, NODEPOOL *Pool);
+
+/* Prepare an empty deque that keeps its items in a
+ * growable ring buffer rather than a linked list.
+ * Objects of up to RecordSize bytes are copied into
+ * the ring itself; larger ones are rejected.
+ */
+void DequeInitRing(DEQUE *Deque, size_t RecordSize);
+
 int DequeAddAtFront(DEQUE *Deque,
                     int Tag,
                     void *Object,
@@ -74,4 +90,6 @@ void *DequeGetDataFromBack(DEQUE *Deque,
                            size_t *Size);
 size_t DequeCount(DEQUE *Deque);
 
+void DequeDestroy(DEQUE *Deque);
+
 #endif
@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "deque.h"
@@ -49,6 +50,9 @@
 
 #define NUM_CITIES 12
 
+#define BENCH_ITEMS  1000000L
+#define BENCH_ROUNDS 10
+
 typedef struct CAR
 {
   char RegNumber[9];
@@ -114,7 +118,91 @@ int CompareCarsByDest(const void *p1, const void *p2)
   return Result;
 }
 
-int main(void)
+/* Load BENCH_ITEMS cars, alternately at the front and
+ * the back, then unload them from both ends, BENCH_ROUNDS
+ * times. Returns seconds taken.
+ */
+double TimeDeque(DEQUE *Deque)
+{
+  CAR Car = {"A123 BCD", 0};
+  clock_t Start;
+  long i;
+  int Round;
+  int Status;
+
+  Start = clock();
+  for(Round = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      Car.Destination = (int)(i % NUM_CITIES);
+      if(i % 2 == 0)
+      {
+        Status = DequeAddAtFront(Deque, 0, &Car, sizeof Car);
+      }
+      else
+      {
+        Status = DequeAddAtBack(Deque, 0, &Car, sizeof Car);
+      }
+      if(Status != DEQUE_SUCCESS)
+      {
+        puts("Car crash? Insufficient memory.");
+        exit(EXIT_FAILURE);
+      }
+    }
+    while(DequeCount(Deque) > 0)
+    {
+      DequeRemoveFromFront(&Car, Deque);
+      DequeRemoveFromBack(&Car, Deque);
+    }
+  }
+
+  return (double)(clock() - Start) / CLOCKS_PER_SEC;
+}
+
+void ReportDeque(const char *Name, double Seconds)
+{
+  double Ops = 2.0 * BENCH_ITEMS * BENCH_ROUNDS;
+
+  printf("%-20s %8.3f s", Name, Seconds);
+  if(Seconds > 0)
+  {
+    printf("  %12.0f ops/sec", Ops / Seconds);
+  }
+  printf("\n");
+}
+
+/* Compare the linked and ring-buffer deques */
+void Benchmark(void)
+{
+  DEQUE Deque;
+  NODEPOOL *Pool;
+
+  printf("Deque throughput, %ld items x %d rounds\n\n",
+         BENCH_ITEMS,
+         BENCH_ROUNDS);
+
+  DequeInit(&Deque, NULL);
+  ReportDeque("Linked (malloc)", TimeDeque(&Deque));
+  DequeDestroy(&Deque);
+
+  Pool = DLCreatePool(sizeof(CAR), 0);
+  if(NULL == Pool)
+  {
+    puts("Car crash? Insufficient memory.");
+    exit(EXIT_FAILURE);
+  }
+  DequeInit(&Deque, Pool);
+  ReportDeque("Linked (node pool)", TimeDeque(&Deque));
+  DequeDestroy(&Deque);
+  NPDestroy(Pool);
+
+  DequeInitRing(&Deque, sizeof(CAR));
+  ReportDeque("Ring buffer", TimeDeque(&Deque));
+  DequeDestroy(&Deque);
+}
+
+int main(int argc, char *argv[])
 {
   DEQUE Transporter = {0};
 
@@ -142,6 +230,12 @@ int main(void)
 
   int i;
 
+  if(argc > 1 && 0 == strcmp(argv[1], "-bench"))
+  {
+    Benchmark();
+    return 0;
+  }
+
   srand((unsigned)time(NULL));
 
   for(i = 0; i < LNUM_CARS; i++)
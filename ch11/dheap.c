@@ -0,0 +1,562 @@
+/*  dheap.c - source for d-ary heap library
+ *
+ *  DHEAP - d-ary Heap Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "dheap.h"
+
+/* Move the element at Pos towards the root until
+ * its parent's key is no greater.
+ */
+static void DHeapSiftUp(DHEAP *Heap, size_t Pos)
+{
+  DHEAP_ENTRY Moving = Heap->Heap[Pos];
+  size_t Parent;
+
+  while(Pos > 0)
+  {
+    Parent = (Pos - 1) / Heap->D;
+    if(Heap->Heap[Parent].Key <= Moving.Key)
+    {
+      break;
+    }
+    Heap->Heap[Pos] = Heap->Heap[Parent];
+    Heap->Item[Heap->Heap[Pos].Handle].Pos = Pos;
+    Pos = Parent;
+  }
+  Heap->Heap[Pos] = Moving;
+  Heap->Item[Moving.Handle].Pos = Pos;
+}
+
+/* Move the element at Pos towards the leaves until
+ * no child has a smaller key.
+ */
+static void DHeapSiftDown(DHEAP *Heap, size_t Pos)
+{
+  DHEAP_ENTRY Moving = Heap->Heap[Pos];
+  DHEAP_ENTRY *Child;
+  size_t First;
+  size_t Last;
+  size_t Best;
+  size_t i;
+
+  for(;;)
+  {
+    First = Pos * Heap->D + 1;
+    if(First >= Heap->Count)
+    {
+      break;
+    }
+    Last = First + Heap->D;
+    if(Last > Heap->Count)
+    {
+      Last = Heap->Count;
+    }
+
+    /* Find the smallest child */
+    Child = Heap->Heap;
+    Best = First;
+    for(i = First + 1; i < Last; i++)
+    {
+      if(Child[i].Key < Child[Best].Key)
+      {
+        Best = i;
+      }
+    }
+
+    if(Moving.Key <= Child[Best].Key)
+    {
+      break;
+    }
+    Heap->Heap[Pos] = Child[Best];
+    Heap->Item[Heap->Heap[Pos].Handle].Pos = Pos;
+    Pos = Best;
+  }
+  Heap->Heap[Pos] = Moving;
+  Heap->Item[Moving.Handle].Pos = Pos;
+}
+
+/* Make room for at least Extra more elements,
+ * growing geometrically.
+ */
+static int DHeapReserve(DHEAP *Heap, size_t Extra)
+{
+  DHEAP_ENTRY *NewHeap;
+  DHEAP_ITEM *NewItem;
+  size_t NewMax;
+  size_t i;
+  int Okay = 1;
+
+  if(Heap->Count + Extra > Heap->MaxCount)
+  {
+    NewMax = Heap->MaxCount > 0 ? Heap->MaxCount : 16;
+    while(NewMax < Heap->Count + Extra)
+    {
+      NewMax *= 2;
+    }
+
+    NewHeap = realloc(Heap->Heap, NewMax * sizeof *NewHeap);
+    if(NewHeap != NULL)
+    {
+      Heap->Heap = NewHeap;
+      NewItem = realloc(Heap->Item, NewMax * sizeof *NewItem);
+      if(NewItem != NULL)
+      {
+        Heap->Item = NewItem;
+
+        /* Put the new handles at the front of the free
+         * list, the last of them pointing at the old
+         * head. Old handles that are still free stay
+         * on the list behind the new ones.
+         */
+        for(i = Heap->MaxCount; i < NewMax; i++)
+        {
+          Heap->Item[i].Pos = i + 1 < NewMax ?
+                              i + 1 :
+                              Heap->FreeHandle;
+        }
+        Heap->FreeHandle = Heap->MaxCount;
+        Heap->MaxCount = NewMax;
+      }
+      else
+      {
+        Okay = 0;
+      }
+    }
+    else
+    {
+      Okay = 0;
+    }
+  }
+
+  return Okay;
+}
+
+DHEAP *DHeapCreate(size_t D, size_t MaxCount)
+{
+  DHEAP *Heap = malloc(sizeof *Heap);
+
+  if(Heap != NULL)
+  {
+    Heap->D = D > 1 ? D : (D == 0 ? DHEAP_DEFAULT_D : 2);
+    Heap->Count = 0;
+    Heap->MaxCount = 0;
+    Heap->Heap = NULL;
+    Heap->Item = NULL;
+    Heap->FreeHandle = DHEAP_NO_HANDLE;
+    if(!DHeapReserve(Heap, MaxCount > 0 ? MaxCount : 1))
+    {
+      DHeapDestroy(Heap);
+      Heap = NULL;
+    }
+  }
+
+  return Heap;
+}
+
+void DHeapDestroy(DHEAP *Heap)
+{
+  size_t i;
+
+  assert(Heap != NULL);
+
+  for(i = 0; i < Heap->Count; i++)
+  {
+    free(Heap->Item[Heap->Heap[i].Handle].Object);
+  }
+  free(Heap->Heap);
+  free(Heap->Item);
+  free(Heap);
+}
+
+/* Take a handle from the free list and fill it in.
+ * There must be room (see DHeapReserve).
+ */
+static size_t DHeapNewHandle(DHEAP *Heap,
+                             int Tag,
+                             size_t Size,
+                             void *Object)
+{
+  size_t Handle = Heap->FreeHandle;
+  DHEAP_ITEM *Item;
+
+  assert(Handle != DHEAP_NO_HANDLE);
+
+  Item = Heap->Item + Handle;
+  Heap->FreeHandle = Item->Pos;
+  Item->Tag = Tag;
+  Item->Size = Size;
+  Item->Object = Object;
+  Item->Pos = DHEAP_NO_HANDLE;
+
+  return Handle;
+}
+
+static void DHeapFreeHandle(DHEAP *Heap, size_t Handle)
+{
+  Heap->Item[Handle].Object = NULL;
+  Heap->Item[Handle].Pos = Heap->FreeHandle;
+  Heap->FreeHandle = Handle;
+}
+
+static int DHeapIsLive(DHEAP *Heap, size_t Handle)
+{
+  size_t Pos;
+
+  return Handle < Heap->MaxCount &&
+         (Pos = Heap->Item[Handle].Pos) < Heap->Count &&
+         Heap->Heap[Pos].Handle == Handle;
+}
+
+int DHeapInsert(DHEAP *Heap,
+                DHEAP_KEY Key,
+                int Tag,
+                size_t Size,
+                void *Object,
+                size_t *Handle)
+{
+  void *NewObject = NULL;
+  size_t NewHandle;
+  int Okay;
+
+  assert(Heap != NULL);
+
+  Okay = DHeapReserve(Heap, 1);
+  if(Okay && Size > 0)
+  {
+    NewObject = malloc(Size);
+    if(NULL == NewObject)
+    {
+      Okay = 0;
+    }
+    else
+    {
+      memcpy(NewObject, Object, Size);
+    }
+  }
+
+  if(Okay)
+  {
+    NewHandle = DHeapNewHandle(Heap, Tag, Size, NewObject);
+    Heap->Heap[Heap->Count].Key = Key;
+    Heap->Heap[Heap->Count].Handle = NewHandle;
+    DHeapSiftUp(Heap, Heap->Count++);
+    if(Handle != NULL)
+    {
+      *Handle = NewHandle;
+    }
+  }
+
+  return Okay;
+}
+
+int DHeapBuild(DHEAP *Heap,
+               size_t Count,
+               const DHEAP_KEY *Keys,
+               const int *Tags,
+               size_t Size,
+               const void *Objects,
+               size_t *Handles)
+{
+  const unsigned char *Src = Objects;
+  void *NewObject;
+  size_t NewHandle;
+  size_t Start = Heap->Count;
+  size_t i;
+  int Okay;
+
+  assert(Heap != NULL);
+  assert(Keys != NULL);
+
+  Okay = DHeapReserve(Heap, Count);
+  for(i = 0; Okay && i < Count; i++)
+  {
+    NewObject = NULL;
+    if(Src != NULL && Size > 0)
+    {
+      NewObject = malloc(Size);
+      if(NULL == NewObject)
+      {
+        Okay = 0;
+      }
+      else
+      {
+        memcpy(NewObject, Src + i * Size, Size);
+      }
+    }
+    if(Okay)
+    {
+      NewHandle = DHeapNewHandle(Heap,
+                                 Tags != NULL ? Tags[i] : 0,
+                                 NewObject != NULL ? Size : 0,
+                                 NewObject);
+      Heap->Heap[Start + i].Key = Keys[i];
+      Heap->Heap[Start + i].Handle = NewHandle;
+      Heap->Item[NewHandle].Pos = Start + i;
+      if(Handles != NULL)
+      {
+        Handles[i] = NewHandle;
+      }
+    }
+  }
+
+  if(Okay)
+  {
+    /* Floyd's method: sift down every internal
+     * node, last first. Most nodes are near the
+     * leaves and move very little, so this is O(n).
+     */
+    Heap->Count = Start + Count;
+    if(Heap->Count > 1)
+    {
+      i = (Heap->Count - 2) / Heap->D + 1;
+      while(i-- > 0)
+      {
+        DHeapSiftDown(Heap, i);
+      }
+    }
+  }
+  else if(i > 0)
+  {
+    /* Element i - 1 is the one that failed. Give
+     * back everything taken before it.
+     */
+    --i;
+    while(i-- > 0)
+    {
+      NewHandle = Heap->Heap[Start + i].Handle;
+      free(Heap->Item[NewHandle].Object);
+      DHeapFreeHandle(Heap, NewHandle);
+    }
+  }
+
+  return Okay;
+}
+
+/* Take the element at Pos out of the heap, copying
+ * out its data and freeing its handle.
+ */
+static void DHeapRemoveAt(DHEAP *Heap,
+                          size_t Pos,
+                          DHEAP_KEY *Key,
+                          int *Tag,
+                          size_t *Size,
+                          void *Object)
+{
+  DHEAP_ENTRY Removed = Heap->Heap[Pos];
+  DHEAP_ITEM *Item = Heap->Item + Removed.Handle;
+
+  if(Key != NULL)
+  {
+    *Key = Removed.Key;
+  }
+  if(Tag != NULL)
+  {
+    *Tag = Item->Tag;
+  }
+  if(Size != NULL)
+  {
+    *Size = Item->Size;
+  }
+  if(Object != NULL && Item->Object != NULL)
+  {
+    memcpy(Object, Item->Object, Item->Size);
+  }
+  free(Item->Object);
+  DHeapFreeHandle(Heap, Removed.Handle);
+
+  /* Fill the hole with the last element, which
+   * may then need to move either way.
+   */
+  if(Pos != --Heap->Count)
+  {
+    Heap->Heap[Pos] = Heap->Heap[Heap->Count];
+    if(Heap->Heap[Pos].Key < Removed.Key)
+    {
+      DHeapSiftUp(Heap, Pos);
+    }
+    else
+    {
+      DHeapSiftDown(Heap, Pos);
+    }
+  }
+}
+
+int DHeapDelete(DHEAP *Heap,
+                DHEAP_KEY *Key,
+                int *Tag,
+                size_t *Size,
+                void *Object)
+{
+  int Result = -1;
+
+  assert(Heap != NULL);
+
+  if(Heap->Count > 0)
+  {
+    DHeapRemoveAt(Heap, 0, Key, Tag, Size, Object);
+    Result = 0;
+  }
+
+  return Result;
+}
+
+void *DHeapPeek(DHEAP *Heap,
+                DHEAP_KEY *Key,
+                int *Tag,
+                size_t *Size)
+{
+  DHEAP_ITEM *Item;
+  void *p = NULL;
+
+  assert(Heap != NULL);
+
+  if(Heap->Count > 0)
+  {
+    Item = Heap->Item + Heap->Heap[0].Handle;
+    if(Key != NULL)
+    {
+      *Key = Heap->Heap[0].Key;
+    }
+    if(Tag != NULL)
+    {
+      *Tag = Item->Tag;
+    }
+    if(Size != NULL)
+    {
+      *Size = Item->Size;
+    }
+    p = Item->Object;
+  }
+
+  return p;
+}
+
+int DHeapDecreaseKey(DHEAP *Heap,
+                     size_t Handle,
+                     DHEAP_KEY NewKey)
+{
+  size_t Pos;
+  int Okay = 0;
+
+  assert(Heap != NULL);
+
+  if(DHeapIsLive(Heap, Handle))
+  {
+    Pos = Heap->Item[Handle].Pos;
+    if(NewKey <= Heap->Heap[Pos].Key)
+    {
+      Heap->Heap[Pos].Key = NewKey;
+      DHeapSiftUp(Heap, Pos);
+      Okay = 1;
+    }
+  }
+
+  return Okay;
+}
+
+int DHeapRemoveHandle(DHEAP *Heap,
+                      size_t Handle,
+                      DHEAP_KEY *Key,
+                      int *Tag,
+                      size_t *Size,
+                      void *Object)
+{
+  int Result = -1;
+
+  assert(Heap != NULL);
+
+  if(DHeapIsLive(Heap, Handle))
+  {
+    DHeapRemoveAt(Heap,
+                  Heap->Item[Handle].Pos,
+                  Key,
+                  Tag,
+                  Size,
+                  Object);
+    Result = 0;
+  }
+
+  return Result;
+}
+
+size_t DHeapGetSize(DHEAP *Heap)
+{
+  assert(Heap != NULL);
+
+  return Heap->Count;
+}
+
+/* Check heap order and the handle index. Returns
+ * the number of faults found.
+ */
+int DHeapVerify(DHEAP *Heap, FILE *fp)
+{
+  size_t j;
+  size_t Parent;
+  int BadCount = 0;
+
+  assert(Heap != NULL);
+
+  for(j = 0; j < Heap->Count; j++)
+  {
+    Parent = j > 0 ? (j - 1) / Heap->D : 0;
+    if(Heap->Heap[Parent].Key > Heap->Heap[j].Key)
+    {
+      ++BadCount;
+      if(fp != NULL)
+      {
+        fprintf(fp,
+                "bad ordering of keys %lu and %lu\n",
+                (unsigned long)Parent,
+                (unsigned long)j);
+      }
+    }
+    if(Heap->Item[Heap->Heap[j].Handle].Pos != j)
+    {
+      ++BadCount;
+      if(fp != NULL)
+      {
+        fprintf(fp,
+                "handle %lu doesn't know it's at %lu\n",
+                (unsigned long)Heap->Heap[j].Handle,
+                (unsigned long)j);
+      }
+    }
+  }
+
+  return BadCount;
+}
+
+/* end of dheap.c */
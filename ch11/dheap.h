@@ -0,0 +1,161 @@
+/*  dheap.h - header for d-ary heap library
+ *
+ *  DHEAP - d-ary Heap Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#ifndef DHEAP_H__
+#define DHEAP_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* A d-ary min-heap with addressable elements.
+ *
+ * Unlike HEAP, the priority is a plain key, held in
+ * the heap array itself beside a small integer handle,
+ * so sifting compares keys with '<' and touches one
+ * contiguous array; no comparison function is called.
+ * With d = 4 the tree is half as deep as a binary heap
+ * and the four children of a node usually share a
+ * cache line.
+ *
+ * Every element gets a handle when it is inserted.
+ * The handle stays valid until the element leaves the
+ * heap, and through it the element's key can be
+ * decreased, or the element removed, in O(log n).
+ */
+
+typedef long DHEAP_KEY;
+
+#define DHEAP_DEFAULT_D  4
+#define DHEAP_NO_HANDLE  ((size_t)-1)
+
+/* One slot of the heap proper */
+typedef struct DHEAP_ENTRY
+{
+  DHEAP_KEY Key;
+  size_t Handle;
+} DHEAP_ENTRY;
+
+/* What a handle refers to. Pos is the element's
+ * index in the heap array; for a free handle, it
+ * is the next free handle instead.
+ */
+typedef struct DHEAP_ITEM
+{
+  int Tag;
+  size_t Size;
+  void *Object;
+  size_t Pos;
+} DHEAP_ITEM;
+
+typedef struct DHEAP
+{
+  size_t D;               /* children per node */
+  size_t Count;           /* elements in heap */
+  size_t MaxCount;        /* elements allocated */
+  DHEAP_ENTRY *Heap;
+  DHEAP_ITEM *Item;       /* indexed by handle */
+  size_t FreeHandle;      /* head of free list */
+} DHEAP;
+
+/* D of 0 selects DHEAP_DEFAULT_D. Returns NULL on
+ * failure.
+ */
+DHEAP *DHeapCreate(size_t D, size_t MaxCount);
+void DHeapDestroy(DHEAP *Heap);
+
+/* Insert a copy of Object (which may be NULL if Size
+ * is 0). If Handle is non-NULL, the new element's
+ * handle is stored there. Returns nonzero only if
+ * successful.
+ */
+int DHeapInsert(DHEAP *Heap,
+                DHEAP_KEY Key,
+                int Tag,
+                size_t Size,
+                void *Object,
+                size_t *Handle);
+
+/* Bulk insert Count elements, then restore heap order
+ * in O(n) rather than O(n log n). Object i, if Objects
+ * is non-NULL, is Size bytes at Objects + i * Size;
+ * Tags and Handles may also be NULL. Returns nonzero
+ * only if successful; on failure the heap is unchanged.
+ */
+int DHeapBuild(DHEAP *Heap,
+               size_t Count,
+               const DHEAP_KEY *Keys,
+               const int *Tags,
+               size_t Size,
+               const void *Objects,
+               size_t *Handles);
+
+/* Remove the element with the smallest key, copying
+ * out whichever of its key, tag, size and object are
+ * asked for. Object must have room for the object.
+ * Returns 0 on success, -1 if the heap is empty.
+ */
+int DHeapDelete(DHEAP *Heap,
+                DHEAP_KEY *Key,
+                int *Tag,
+                size_t *Size,
+                void *Object);
+
+/* As DHeapDelete, but leave the element in place.
+ * Returns a pointer to the object, or NULL.
+ */
+void *DHeapPeek(DHEAP *Heap,
+                DHEAP_KEY *Key,
+                int *Tag,
+                size_t *Size);
+
+/* Lower the key of an element. Returns nonzero only
+ * if Handle is live and NewKey is no greater than
+ * its current key.
+ */
+int DHeapDecreaseKey(DHEAP *Heap,
+                     size_t Handle,
+                     DHEAP_KEY NewKey);
+
+/* Remove any element by handle. Returns 0 on
+ * success, -1 if the handle is not live.
+ */
+int DHeapRemoveHandle(DHEAP *Heap,
+                      size_t Handle,
+                      DHEAP_KEY *Key,
+                      int *Tag,
+                      size_t *Size,
+                      void *Object);
+
+size_t DHeapGetSize(DHEAP *Heap);
+
+int DHeapVerify(DHEAP *Heap, FILE *fp);
+
+#endif
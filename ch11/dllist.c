@@ -35,24 +35,72 @@
 #include "dllist.h"
 
 
+NODEPOOL *DLCreatePool(size_t InlineSize,
+                       size_t NodesPerSlab)
+{
+  return NPCreate(sizeof(DLLIST), InlineSize, NodesPerSlab);
+}
+
+/* Is this node's object stored inside the node? */
+static int DLIsInline(DLLIST *Item)
+{
+  return Item->Pool != NULL &&
+         Item->Object == NPInline(Item->Pool, Item);
+}
+
 DLLIST *DLCreate(int Tag, void *Object, size_t Size)
+{
+  return DLPoolCreate(NULL, Tag, Object, Size);
+}
+
+DLLIST *DLPoolCreate(NODEPOOL *Pool,
+                     int Tag,
+                     void *Object,
+                     size_t Size)
 {
   DLLIST *NewItem;
 
-  NewItem = malloc(sizeof *NewItem);
+  /* A pool made for smaller nodes (by SLCreatePool,
+   * say) would let the header overrun the payload.
+   */
+  assert(Pool == NULL || Pool->HeaderSize >= sizeof(DLLIST));
+
+  if(Pool != NULL)
+  {
+    NewItem = NPAlloc(Pool);
+  }
+  else
+  {
+    NewItem = malloc(sizeof *NewItem);
+  }
   if(NewItem != NULL)
   {
     NewItem->Prev = NewItem->Next = NULL;
     NewItem->Tag = Tag;
     NewItem->Size = Size;
-    NewItem->Object = malloc(Size);
+    NewItem->Pool = Pool;
+    if(Pool != NULL && Size <= Pool->InlineSize)
+    {
+      NewItem->Object = NPInline(Pool, NewItem);
+    }
+    else
+    {
+      NewItem->Object = malloc(Size);
+    }
     if(NULL != NewItem->Object)
     {
       memcpy(NewItem->Object, Object, Size);
     }
     else
     {
-      free(NewItem);
+      if(Pool != NULL)
+      {
+        NPFree(Pool, NewItem);
+      }
+      else
+      {
+        free(NewItem);
+      }
       NewItem = NULL;
     }
   }
@@ -108,6 +156,15 @@ int DLPrepend(DLLIST **Item,
               int Tag,
               void *Object,
               size_t Size)
+{
+  return DLPoolPrepend(NULL, Item, Tag, Object, Size);
+}
+
+int DLPoolPrepend(NODEPOOL *Pool,
+                  DLLIST **Item,
+                  int Tag,
+                  void *Object,
+                  size_t Size)
 {
   int Result = DL_SUCCESS;
 
@@ -116,7 +173,7 @@ int DLPrepend(DLLIST **Item,
 
   assert(Item != NULL);
 
-  p = DLCreate(Tag, Object, Size);
+  p = DLPoolCreate(Pool, Tag, Object, Size);
 
   if(p != NULL)
   {
@@ -142,6 +199,15 @@ int DLAppend(DLLIST **Item,
              int Tag,
              void *Object,
              size_t Size)
+{
+  return DLPoolAppend(NULL, Item, Tag, Object, Size);
+}
+
+int DLPoolAppend(NODEPOOL *Pool,
+                 DLLIST **Item,
+                 int Tag,
+                 void *Object,
+                 size_t Size)
 {
   int Result = DL_SUCCESS;
 
@@ -150,7 +216,7 @@ int DLAppend(DLLIST **Item,
 
   assert(Item != NULL);
 
-  p = DLCreate(Tag, Object, Size);
+  p = DLPoolCreate(Pool, Tag, Object, Size);
 
   if(p != NULL)
   {
@@ -178,13 +244,22 @@ int DLAddAfter(DLLIST **Item,
                int Tag,
                void *Object,
                size_t Size)
+{
+  return DLPoolAddAfter(NULL, Item, Tag, Object, Size);
+}
+
+int DLPoolAddAfter(NODEPOOL *Pool,
+                   DLLIST **Item,
+                   int Tag,
+                   void *Object,
+                   size_t Size)
 {
   int Result = DL_SUCCESS;
   DLLIST *p;
 
   assert(Item != NULL);
 
-  p = DLCreate(Tag, Object, Size);
+  p = DLPoolCreate(Pool, Tag, Object, Size);
 
   if(p != NULL)
   {
@@ -210,13 +285,22 @@ int DLAddBefore(DLLIST **Item,
                 int Tag,
                 void *Object,
                 size_t Size)
+{
+  return DLPoolAddBefore(NULL, Item, Tag, Object, Size);
+}
+
+int DLPoolAddBefore(NODEPOOL *Pool,
+                    DLLIST **Item,
+                    int Tag,
+                    void *Object,
+                    size_t Size)
 {
   int Result = DL_SUCCESS;
   DLLIST *p;
 
   assert(Item != NULL);
 
-  p = DLCreate(Tag, Object, Size);
+  p = DLPoolCreate(Pool, Tag, Object, Size);
 
   if(p != NULL)
   {
@@ -248,17 +332,42 @@ int DLUpdate(DLLIST *Item,
   
   if(NewSize > 0)
   {
-    p = realloc(Item->Object, NewSize);
-    if(NULL != p)
+    if(Item->Pool != NULL && NewSize <= Item->Pool->InlineSize)
     {
+      /* Move in before freeing, in case NewObject
+       * lies within the old out-of-line object.
+       */
+      p = NPInline(Item->Pool, Item);
+      memmove(p, NewObject, NewSize);
+      if(Item->Object != p)
+      {
+        free(Item->Object);
+      }
       Item->Object = p;
-      memmove(Item->Object, NewObject, NewSize);
       Item->Tag = NewTag;
       Item->Size = NewSize;
     }
     else
     {
-      Result = DL_NO_MEM;
+      if(DLIsInline(Item))
+      {
+        p = malloc(NewSize);
+      }
+      else
+      {
+        p = realloc(Item->Object, NewSize);
+      }
+      if(NULL != p)
+      {
+        Item->Object = p;
+        memmove(Item->Object, NewObject, NewSize);
+        Item->Tag = NewTag;
+        Item->Size = NewSize;
+      }
+      else
+      {
+        Result = DL_NO_MEM;
+      }
     }
   }
   else
@@ -314,11 +423,18 @@ void DLDelete(DLLIST *Item)
   {
     DLExtract(Item);
 
-    if(Item->Object != NULL)
+    if(Item->Object != NULL && !DLIsInline(Item))
     {
       free(Item->Object);
     }
-    free(Item);
+    if(Item->Pool != NULL)
+    {
+      NPFree(Item->Pool, Item);
+    }
+    else
+    {
+      free(Item);
+    }
   }
 }
 
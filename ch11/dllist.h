@@ -36,6 +36,8 @@
 #define DL_ZERO_SIZE    2
 #define DL_NULL_POINTER 3
 
+#include "nodepool.h"
+
 typedef struct DLLIST
 {
   int Tag;
@@ -43,10 +45,28 @@ typedef struct DLLIST
   struct DLLIST *Next;
   void *Object;
   size_t Size;
+  NODEPOOL *Pool; /* NULL if malloc'd */
 } DLLIST;
 
+/* Create a pool for DLLIST nodes. Objects of up to
+ * InlineSize bytes are stored inside the node. Free
+ * it with NPDestroy once all its lists are gone.
+ */
+NODEPOOL *DLCreatePool(size_t InlineSize,
+                       size_t NodesPerSlab);
+
 DLLIST *DLCreate(int Tag, void *Object, size_t Size);
 
+/* As DLCreate, but take the node from Pool, which
+ * must come from DLCreatePool. A NULL Pool means
+ * use malloc. The same goes for the other DLPool
+ * functions.
+ */
+DLLIST *DLPoolCreate(NODEPOOL *Pool,
+                     int Tag,
+                     void *Object,
+                     size_t Size);
+
 /* Insert existing item into list, just
  * before the item provided.
  */
@@ -63,24 +83,48 @@ int DLPrepend(DLLIST **Item,
               void *Object,
               size_t Size);
 
+int DLPoolPrepend(NODEPOOL *Pool,
+                  DLLIST **Item,
+                  int Tag,
+                  void *Object,
+                  size_t Size);
+
 /* Add item at end of list */
 int DLAppend(DLLIST **Item,
              int Tag,
              void *Object,
              size_t Size);
 
+int DLPoolAppend(NODEPOOL *Pool,
+                 DLLIST **Item,
+                 int Tag,
+                 void *Object,
+                 size_t Size);
+
 /* Add new item immediately after current item */
 int DLAddAfter(DLLIST **Item,
                int Tag,
                void *Object,
                size_t Size);
 
+int DLPoolAddAfter(NODEPOOL *Pool,
+                   DLLIST **Item,
+                   int Tag,
+                   void *Object,
+                   size_t Size);
+
 /* Add new item immediately before current item */
 int DLAddBefore(DLLIST **Item,
                 int Tag,
                 void *Object,
                 size_t Size);
 
+int DLPoolAddBefore(NODEPOOL *Pool,
+                    DLLIST **Item,
+                    int Tag,
+                    void *Object,
+                    size_t Size);
+
 /* Update one item */
 int DLUpdate(DLLIST *Item,
              int NewTag,
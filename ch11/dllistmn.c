@@ -37,9 +37,14 @@
 #include <assert.h>
 
 #include "dllist.h"
+#include "udllist.h"
 
 #define PI 3.14159265358979323846
 
+#define BENCH_ITEMS    1000000L
+#define BENCH_ROUNDS   10
+#define BENCH_INSERTS  100000L
+
 typedef struct CITY
 {
   char Nation[30];
@@ -161,7 +166,406 @@ int Random(int n)
   return (int)d;
 }
 
-/* The test file cityloc.txt may be passed as argv[1]. */
+int SumLatitude(int Tag, void *Object, void *Args)
+{
+  CITY *c = Object;
+
+  (void)Tag;
+  *(double *)Args += c->Latitude;
+
+  return 0;
+}
+
+void BenchFail(void)
+{
+  puts("Out of memory.");
+  exit(EXIT_FAILURE);
+}
+
+void ReportList(const char *Name,
+                clock_t Start,
+                clock_t Built,
+                clock_t Walked)
+{
+  clock_t Now = clock();
+
+  printf("%-20s %8.3f %8.3f %8.3f\n",
+         Name,
+         (double)(Built - Start) / CLOCKS_PER_SEC,
+         (double)(Walked - Built) / CLOCKS_PER_SEC,
+         (double)(Now - Walked) / CLOCKS_PER_SEC);
+}
+
+/* Append BENCH_ITEMS cities, walk the list BENCH_ROUNDS
+ * times, then insert BENCH_INSERTS more in the middle.
+ * Pool may be NULL.
+ */
+void TimeDLList(const char *Name, NODEPOOL *Pool)
+{
+  DLLIST *List = NULL;
+  DLLIST *Tail = NULL;
+  CITY City = {"Nowhere", "Nowhere", 0.0, 0.0};
+  clock_t Start;
+  clock_t Built;
+  clock_t Walked;
+  double Sum = 0.0;
+  long i;
+
+  Start = clock();
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    City.Latitude = (double)i;
+    if(DL_SUCCESS != DLPoolAddAfter(Pool,
+                                    &Tail,
+                                    0,
+                                    &City,
+                                    sizeof City))
+    {
+      BenchFail();
+    }
+    if(DLGetNext(Tail) != NULL)
+    {
+      Tail = DLGetNext(Tail);
+    }
+  }
+  List = DLGetFirst(Tail);
+  Built = clock();
+
+  for(i = 0; i < BENCH_ROUNDS; i++)
+  {
+    DLWalk(List, SumLatitude, &Sum);
+  }
+  Walked = clock();
+
+  for(i = 0; i < BENCH_ITEMS / 2; i++)
+  {
+    List = DLGetNext(List);
+  }
+  for(i = 0; i < BENCH_INSERTS; i++)
+  {
+    if(DL_SUCCESS != DLPoolAddAfter(Pool,
+                                    &List,
+                                    0,
+                                    &City,
+                                    sizeof City))
+    {
+      BenchFail();
+    }
+  }
+  ReportList(Name, Start, Built, Walked);
+
+  DLDestroy(&List);
+}
+
+void TimeUDLList(const char *Name, size_t ChunkCapacity)
+{
+  UDLLIST List;
+  UDL_POS Pos;
+  CITY City = {"Nowhere", "Nowhere", 0.0, 0.0};
+  clock_t Start;
+  clock_t Built;
+  clock_t Walked;
+  double Sum = 0.0;
+  long i;
+
+  UDLInit(&List, sizeof City, ChunkCapacity);
+
+  Start = clock();
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    City.Latitude = (double)i;
+    if(UDL_SUCCESS != UDLAppend(&List, 0, &City, sizeof City))
+    {
+      BenchFail();
+    }
+  }
+  Built = clock();
+
+  for(i = 0; i < BENCH_ROUNDS; i++)
+  {
+    UDLWalk(&List, SumLatitude, &Sum);
+  }
+  Walked = clock();
+
+  UDLGetFirst(&List, &Pos);
+  for(i = 0; i < BENCH_ITEMS / 2; i++)
+  {
+    UDLGetNext(&Pos);
+  }
+  for(i = 0; i < BENCH_INSERTS; i++)
+  {
+    if(UDL_SUCCESS != UDLInsertAfter(&List,
+                                     &Pos,
+                                     0,
+                                     &City,
+                                     sizeof City))
+    {
+      BenchFail();
+    }
+  }
+  ReportList(Name, Start, Built, Walked);
+
+  UDLDestroy(&List);
+}
+
+/* Compare DLLIST against the unrolled UDLLIST */
+void Benchmark(void)
+{
+  NODEPOOL *Pool;
+
+  printf("%ld cities appended, walked %d times,"
+         " then %ld inserted mid-list\n\n",
+         BENCH_ITEMS,
+         BENCH_ROUNDS,
+         BENCH_INSERTS);
+  printf("%-20s %8s %8s %8s\n", "", "append", "walk", "insert");
+
+  TimeDLList("DLLIST (malloc)", NULL);
+
+  Pool = DLCreatePool(sizeof(CITY), 0);
+  if(NULL == Pool)
+  {
+    BenchFail();
+  }
+  TimeDLList("DLLIST (node pool)", Pool);
+  NPDestroy(Pool);
+
+  TimeUDLList("UDLLIST (16)", 16);
+  TimeUDLList("UDLLIST (32)", 32);
+  TimeUDLList("UDLLIST (64)", 64);
+}
+
+#define CHECK_OPS      20000
+#define CHECK_MAX      300
+
+/* Do a DLLIST and a UDLLIST hold the same items, in
+ * the same order both ways? Objects are longs.
+ */
+int SameList(DLLIST *List, UDLLIST *UList)
+{
+  DLLIST *Item;
+  UDL_POS Pos;
+  int Tag;
+  int UTag;
+  long *Object;
+  long *UObject;
+  int More;
+
+  if((size_t)DLCount(List) != UDLCount(UList))
+  {
+    return 0;
+  }
+  Item = List;
+  More = UDLGetFirst(UList, &Pos);
+  while(Item != NULL && More)
+  {
+    Object = DLGetData(Item, &Tag, NULL);
+    UObject = UDLGetData(UList, &Pos, &UTag, NULL);
+    if(Tag != UTag || *Object != *UObject)
+    {
+      return 0;
+    }
+    Item = DLGetNext(Item);
+    More = UDLGetNext(&Pos);
+  }
+  if(Item != NULL || More)
+  {
+    return 0;
+  }
+  Item = DLGetLast(List);
+  More = UDLGetLast(UList, &Pos);
+  while(Item != NULL && More)
+  {
+    Object = DLGetData(Item, &Tag, NULL);
+    UObject = UDLGetData(UList, &Pos, &UTag, NULL);
+    if(Tag != UTag || *Object != *UObject)
+    {
+      return 0;
+    }
+    Item = DLGetPrev(Item);
+    More = UDLGetPrev(&Pos);
+  }
+  return Item == NULL && !More;
+}
+
+/* Does Pos hold the same item as Item? Both may
+ * be nowhere.
+ */
+int SameItem(DLLIST *Item, UDLLIST *UList, UDL_POS *Pos)
+{
+  int Tag;
+  int UTag;
+  long *UObject;
+
+  UObject = UDLGetData(UList, Pos, &UTag, NULL);
+  if(Item == NULL || UObject == NULL)
+  {
+    return Item == NULL && UObject == NULL;
+  }
+  return *(long *)DLGetData(Item, &Tag, NULL) == *UObject &&
+         Tag == UTag;
+}
+
+/* Item Index of a DLLIST, or NULL past the end */
+DLLIST *DLNth(DLLIST *List, int Index)
+{
+  while(List != NULL && Index-- > 0)
+  {
+    List = DLGetNext(List);
+  }
+  return List;
+}
+
+/* Put the same random inserts, extracts and joins
+ * through a DLLIST and a UDLLIST, checking that they
+ * still agree after each one. Small chunks make the
+ * UDLLIST split and merge them often. Returns the
+ * number of mismatches.
+ */
+int CheckUDLList(size_t ChunkCapacity)
+{
+  DLLIST *List = NULL;
+  DLLIST *Other;
+  DLLIST *Item;
+  UDLLIST UList;
+  UDLLIST UOther;
+  UDL_POS Pos;
+  long Next = 0;
+  long Object;
+  long UObject;
+  int Tag;
+  int UTag;
+  int Count = 0;
+  int Errors = 0;
+  int Op;
+  int Index;
+  int i;
+  int n;
+
+  UDLInit(&UList, sizeof(long), ChunkCapacity);
+
+  for(Op = 0; Op < CHECK_OPS && Errors < 10; Op++)
+  {
+    switch(Count >= CHECK_MAX ? 4 : Random(10))
+    {
+      case 0: case 1: case 2: case 3:
+        /* Insert before item Index, or append */
+        Index = Random(Count + 1);
+        Object = Next++;
+        Tag = (int)(Object % 7);
+        Item = DLNth(List, Index);
+        if(Item != NULL)
+        {
+          if(DL_SUCCESS != DLAddBefore(&Item, Tag, &Object, sizeof Object))
+          {
+            BenchFail();
+          }
+          List = DLGetFirst(Item);
+          Item = DLGetPrev(Item);
+        }
+        else
+        {
+          if(DL_SUCCESS != DLAppend(&List, Tag, &Object, sizeof Object))
+          {
+            BenchFail();
+          }
+          Item = DLGetLast(List);
+        }
+        UDLGetFirst(&UList, &Pos);
+        for(i = 0; i < Index; i++)
+        {
+          UDLGetNext(&Pos);
+        }
+        if(UDL_SUCCESS != UDLInsertBefore(&UList, &Pos, Tag, &Object, sizeof Object))
+        {
+          BenchFail();
+        }
+        if(!SameItem(Item, &UList, &Pos))
+        {
+          printf("UDLInsertBefore at %d did not leave Pos on the new item\n", Index);
+          ++Errors;
+        }
+        ++Count;
+        break;
+
+      case 4: case 5: case 6:
+        /* Extract item Index */
+        if(Count == 0)
+        {
+          break;
+        }
+        Index = Random(Count);
+        Item = DLNth(List, Index);
+        if(Item == List)
+        {
+          List = DLGetNext(List);
+        }
+        Other = DLGetNext(Item);
+        DLExtract(Item);
+        Object = *(long *)DLGetData(Item, &Tag, NULL);
+        DLDelete(Item);
+
+        UDLGetFirst(&UList, &Pos);
+        for(i = 0; i < Index; i++)
+        {
+          UDLGetNext(&Pos);
+        }
+        if(UDL_SUCCESS != UDLExtract(&UList, &Pos, &UTag, &UObject) ||
+           UTag != Tag || UObject != Object)
+        {
+          printf("UDLExtract at %d got the wrong item\n", Index);
+          ++Errors;
+        }
+        if(!SameItem(Other, &UList, &Pos))
+        {
+          printf("UDLExtract at %d did not leave Pos on the next item\n", Index);
+          ++Errors;
+        }
+        --Count;
+        break;
+
+      default:
+        /* Join a short list onto the end */
+        Other = NULL;
+        UDLInit(&UOther, sizeof(long), ChunkCapacity);
+        n = Random(2 * (int)ChunkCapacity + 2);
+        for(i = 0; i < n; i++)
+        {
+          Object = Next++;
+          Tag = (int)(Object % 7);
+          if(DL_SUCCESS != DLAppend(&Other, Tag, &Object, sizeof Object) ||
+             UDL_SUCCESS != UDLAppend(&UOther, Tag, &Object, sizeof Object))
+          {
+            BenchFail();
+          }
+        }
+        List = List != NULL ? DLJoin(List, Other) : Other;
+        if(UDL_SUCCESS != UDLJoin(&UList, &UOther) ||
+           UDLCount(&UOther) != 0)
+        {
+          puts("UDLJoin failed");
+          ++Errors;
+        }
+        UDLDestroy(&UOther);
+        Count += n;
+        break;
+    }
+    if(!SameList(List, &UList))
+    {
+      printf("Lists differ after operation %d\n", Op);
+      ++Errors;
+    }
+  }
+
+  DLDestroy(&List);
+  UDLDestroy(&UList);
+  return Errors;
+}
+
+/* The test file cityloc.txt may be passed as argv[1],
+ * -bench to time DLLIST against UDLLIST, or -check
+ * to check that UDLLIST does what DLLIST does.
+ */
 int main(int argc, char *argv[])
 {
   DLLIST *List = NULL;
@@ -186,7 +590,18 @@ int main(int argc, char *argv[])
   FILE *fp = NULL;
 
   srand((unsigned)time(NULL));
-  if(argc > 1)
+  if(argc > 1 && 0 == strcmp(argv[1], "-bench"))
+  {
+    Benchmark();
+    return EXIT_SUCCESS;
+  }
+  else if(argc > 1 && 0 == strcmp(argv[1], "-check"))
+  {
+    i = CheckUDLList(1) + CheckUDLList(3) + CheckUDLList(16);
+    printf("UDLLIST against DLLIST: %s\n", i ? "FAILED" : "passed");
+    return i ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+  else if(argc > 1)
   {
     fp = fopen(argv[1], "r");
 
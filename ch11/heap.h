@@ -33,12 +33,16 @@
  * smallest-out priority queue.
  */
 
-/* One element of a heap. */
+/* One element of a heap. Block is NULL if Object was
+ * allocated on its own, or the block that
+ * HeapInsertMany copied it into.
+ */
 typedef struct HEAP_ELEMENT
 {
   int Tag;
   size_t Size;
   void *Object;
+  void *Block;
 } HEAP_ELEMENT;
 
 /* An entire heap. */
@@ -72,6 +76,20 @@ int HeapDelete(HEAP *Heap,
                void *Object,
                HEAP_COMPARE Comp);
 
+int HeapInsertMany(HEAP *Heap,
+                   size_t Count,
+                   const int *Tags,
+                   size_t Size,
+                   const void *Objects,
+                   HEAP_COMPARE Comp);
+size_t HeapDeleteMany(HEAP *Heap,
+                      size_t MaxItems,
+                      int *Tags,
+                      size_t *Sizes,
+                      void *Objects,
+                      size_t Stride,
+                      HEAP_COMPARE Comp);
+
 int HeapGetSize(HEAP *Heap);
 
 int HeapVerify(HEAP *Heap, HEAP_COMPARE Comp, FILE *fp);
@@ -32,7 +32,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 #include "heap.h"
+#include "dheap.h"
+
+#define BENCH_ITEMS   1000000L
+#define BENCH_BATCH   1024
 
 typedef struct TASK
 {
@@ -77,7 +82,275 @@ int CompareTasks(const void *Left,
   return diff;
 }
 
-int main(void)
+/* Fill Keys with BENCH_ITEMS pseudo-random priorities,
+ * the same ones every time.
+ */
+void MakeKeys(DHEAP_KEY *Keys)
+{
+  long i;
+
+  srand(1);
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    Keys[i] = rand();
+  }
+}
+
+void BenchFail(void)
+{
+  printf("Memory loss.\n");
+  exit(EXIT_FAILURE);
+}
+
+/* Draining a heap frees a million small objects, and
+ * the C library may tidy those up during the next big
+ * malloc, charging it to whichever run comes next. So
+ * give it a big malloc of its own before each run.
+ * Block is volatile so that the compiler can't drop
+ * the malloc and free as a pair.
+ */
+void SettleHeap(void)
+{
+  void * volatile Block = malloc(BENCH_ITEMS * sizeof(TASK));
+
+  free(Block);
+}
+
+/* Loading and draining are reported separately,
+ * since bulk loading only speeds up the former.
+ */
+void ReportHeap(const char *Name, clock_t Start, clock_t Loaded)
+{
+  clock_t Now = clock();
+
+  printf("%-28s load %7.3f s  drain %7.3f s\n",
+         Name,
+         (double)(Loaded - Start) / CLOCKS_PER_SEC,
+         (double)(Now - Loaded) / CLOCKS_PER_SEC);
+}
+
+/* Insert every key, then delete them all, checking
+ * that they come out in order. If Many is set, load
+ * the heap with HeapInsertMany and drain it with
+ * HeapDeleteMany, BENCH_BATCH at a time.
+ */
+void TimeHeap(const DHEAP_KEY *Keys, int Many, TASK *Tasks)
+{
+  TASK Task = {"Benchmark", 0};
+  TASK Batch[BENCH_BATCH];
+  HEAP *Heap;
+  clock_t Start;
+  clock_t Loaded;
+  int Last = 0;
+  size_t Got;
+  size_t k;
+  long i;
+
+  Heap = HeapCreate(16);
+  if(NULL == Heap)
+  {
+    BenchFail();
+  }
+
+  SettleHeap();
+  Start = clock();
+  if(Many)
+  {
+    if(!HeapInsertMany(Heap,
+                       BENCH_ITEMS,
+                       NULL,
+                       sizeof *Tasks,
+                       Tasks,
+                       CompareTasks))
+    {
+      BenchFail();
+    }
+    Loaded = clock();
+    while((Got = HeapDeleteMany(Heap,
+                                BENCH_BATCH,
+                                NULL,
+                                NULL,
+                                Batch,
+                                sizeof Batch[0],
+                                CompareTasks)) > 0)
+    {
+      for(k = 0; k < Got; k++)
+      {
+        assert(Batch[k].Priority >= Last);
+        Last = Batch[k].Priority;
+      }
+    }
+  }
+  else
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      Task.Priority = (int)Keys[i];
+      if(!HeapInsert(Heap, 0, sizeof Task, &Task, CompareTasks))
+      {
+        BenchFail();
+      }
+    }
+    Loaded = clock();
+    while(HeapGetSize(Heap) > 0)
+    {
+      HeapDelete(Heap, NULL, NULL, &Task, CompareTasks);
+      assert(Task.Priority >= Last);
+      Last = Task.Priority;
+    }
+  }
+  ReportHeap(Many ? "HEAP (binary, many)" : "HEAP (binary)", Start, Loaded);
+
+  HeapDestroy(Heap);
+}
+
+/* As TimeHeap, using a DHEAP of the given arity. If
+ * Build is set, load it with DHeapBuild instead of
+ * one insertion at a time.
+ */
+void TimeDHeap(const DHEAP_KEY *Keys,
+               size_t D,
+               int Build,
+               TASK *Tasks)
+{
+  TASK Task = {"Benchmark", 0};
+  DHEAP *Heap;
+  DHEAP_KEY Key;
+  DHEAP_KEY Last = 0;
+  clock_t Start;
+  clock_t Loaded;
+  char Name[32];
+  long i;
+
+  Heap = DHeapCreate(D, 16);
+  if(NULL == Heap)
+  {
+    BenchFail();
+  }
+
+  SettleHeap();
+  Start = clock();
+  if(Build)
+  {
+    if(!DHeapBuild(Heap,
+                   BENCH_ITEMS,
+                   Keys,
+                   NULL,
+                   sizeof *Tasks,
+                   Tasks,
+                   NULL))
+    {
+      BenchFail();
+    }
+  }
+  else
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      Task.Priority = (int)Keys[i];
+      if(!DHeapInsert(Heap, Keys[i], 0, sizeof Task, &Task, NULL))
+      {
+        BenchFail();
+      }
+    }
+  }
+  Loaded = clock();
+  while(DHeapDelete(Heap, &Key, NULL, NULL, &Task) == 0)
+  {
+    assert(Key >= Last && Task.Priority == (int)Key);
+    Last = Key;
+  }
+  sprintf(Name,
+          "DHEAP d=%lu%s",
+          (unsigned long)D,
+          Build ? " (build)" : "");
+  ReportHeap(Name, Start, Loaded);
+
+  DHeapDestroy(Heap);
+}
+
+/* A Dijkstra-like load: insert everything, lower
+ * the key of every element once, then drain.
+ */
+void TimeDecreaseKey(const DHEAP_KEY *Keys, size_t *Handles)
+{
+  DHEAP *Heap;
+  DHEAP_KEY Key;
+  clock_t Start;
+  clock_t Loaded;
+  long i;
+
+  Heap = DHeapCreate(0, BENCH_ITEMS);
+  if(NULL == Heap)
+  {
+    BenchFail();
+  }
+
+  SettleHeap();
+  Start = clock();
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    if(!DHeapInsert(Heap, Keys[i], 0, 0, NULL, Handles + i))
+    {
+      BenchFail();
+    }
+  }
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    DHeapDecreaseKey(Heap, Handles[i], Keys[i] / 2);
+  }
+  Loaded = clock();
+  while(DHeapDelete(Heap, &Key, NULL, NULL, NULL) == 0)
+  {
+    continue;
+  }
+  ReportHeap("DHEAP d=4 decrease-key", Start, Loaded);
+
+  DHeapDestroy(Heap);
+}
+
+void Benchmark(void)
+{
+  static const size_t Arity[] = { 2, 4, 8 };
+  DHEAP_KEY *Keys;
+  size_t *Handles;
+  TASK *Tasks;
+  size_t j;
+  long i;
+
+  Keys = malloc(BENCH_ITEMS * sizeof *Keys);
+  Handles = malloc(BENCH_ITEMS * sizeof *Handles);
+  Tasks = malloc(BENCH_ITEMS * sizeof *Tasks);
+  if(NULL == Keys || NULL == Handles || NULL == Tasks)
+  {
+    BenchFail();
+  }
+
+  MakeKeys(Keys);
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    strcpy(Tasks[i].JobName, "Benchmark");
+    Tasks[i].Priority = (int)Keys[i];
+  }
+
+  printf("Priority queue, %ld items in and out\n\n",
+         BENCH_ITEMS);
+
+  TimeHeap(Keys, 0, Tasks);
+  TimeHeap(Keys, 1, Tasks);
+  for(j = 0; j < sizeof Arity / sizeof Arity[0]; j++)
+  {
+    TimeDHeap(Keys, Arity[j], 0, Tasks);
+  }
+  TimeDHeap(Keys, DHEAP_DEFAULT_D, 1, Tasks);
+  TimeDecreaseKey(Keys, Handles);
+
+  free(Tasks);
+  free(Handles);
+  free(Keys);
+}
+
+int main(int argc, char *argv[])
 {
   TASK TaskList[] =
   {
@@ -101,8 +374,16 @@ int main(void)
   size_t i;
 
   HEAP *Heap;
+  DHEAP *DHeap;
+  size_t Handle[sizeof TaskList / sizeof TaskList[0]];
   int BadCount;
 
+  if(argc > 1 && 0 == strcmp(argv[1], "-bench"))
+  {
+    Benchmark();
+    return EXIT_SUCCESS;
+  }
+
   Heap = HeapCreate(8);
 
   if(NULL != Heap)
@@ -145,6 +426,41 @@ int main(void)
 
     HeapDestroy(Heap);
   }
+
+  /* The same list again, in a d-ary heap. This time
+   * we hold on to the handles, so that priorities can
+   * be changed after the event.
+   */
+  DHeap = DHeapCreate(0, NumTasks);
+  if(NULL != DHeap)
+  {
+    for(i = 0; i < NumTasks; i++)
+    {
+      DHeapInsert(DHeap,
+                  TaskList[i].Priority,
+                  0,
+                  sizeof TaskList[0],
+                  TaskList + i,
+                  Handle + i);
+    }
+
+    puts("\nThe coffee's gone cold, and the dog needs a bath now.");
+    DHeapRemoveHandle(DHeap, Handle[11], NULL, NULL, NULL, NULL);
+    DHeapDecreaseKey(DHeap, Handle[1], 0);
+
+    BadCount = DHeapVerify(DHeap, stdout);
+    if(BadCount > 0)
+    {
+      printf("Number of errors: %d\n", BadCount);
+    }
+
+    while(DHeapDelete(DHeap, NULL, NULL, NULL, &ThisTask) == 0)
+    {
+      printf("Time to %s\n", ThisTask.JobName);
+    }
+
+    DHeapDestroy(DHeap);
+  }
   return 0;
 }
 
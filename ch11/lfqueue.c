@@ -0,0 +1,428 @@
+/*  lfqueue.c - source for lock-free queue library
+ *
+ *  LFQUEUE - Lock-Free Queue Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "lfqueue.h"
+
+typedef struct SPSC_SLOT
+{
+  int Tag;
+  size_t Size;
+} SPSC_SLOT;
+
+typedef struct MPMC_SLOT
+{
+  atomic_size_t Sequence;
+  int Tag;
+  size_t Size;
+} MPMC_SLOT;
+
+#define LFQ_ROUND(n) \
+  ((((n) + sizeof(max_align_t) - 1) / sizeof(max_align_t)) \
+    * sizeof(max_align_t))
+
+static size_t LFQCapacity(size_t Capacity)
+{
+  size_t Actual = 2;
+
+  while(Actual < Capacity && Actual * 2 > Actual)
+  {
+    Actual *= 2;
+  }
+
+  return Actual;
+}
+
+static void *LFQAllocSlots(size_t *SlotSize,
+                           size_t HeaderSize,
+                           size_t RecordSize,
+                           size_t Capacity)
+{
+  void *p = NULL;
+
+  *SlotSize = LFQ_ROUND(HeaderSize) + LFQ_ROUND(RecordSize);
+  if(Capacity <= (size_t)-1 / *SlotSize)
+  {
+    p = malloc(Capacity * *SlotSize);
+  }
+
+  return p;
+}
+
+/* ---- SPSCQUEUE ---- */
+
+#define SPSC_SLOT_AT(q, i) \
+  ((SPSC_SLOT *)((q)->Slots + ((i) & (q)->Mask) * (q)->SlotSize))
+
+#define SPSC_DATA(s) \
+  ((unsigned char *)(s) + LFQ_ROUND(sizeof(SPSC_SLOT)))
+
+int SPSCInit(SPSCQUEUE *Queue,
+             size_t Capacity,
+             size_t RecordSize)
+{
+  int Result = LFQ_SUCCESS;
+
+  assert(Queue != NULL);
+  assert(RecordSize > 0);
+
+  Capacity = LFQCapacity(Capacity);
+  Queue->RecordSize = RecordSize;
+  Queue->Mask = Capacity - 1;
+  Queue->Slots = LFQAllocSlots(&Queue->SlotSize,
+                               sizeof(SPSC_SLOT),
+                               RecordSize,
+                               Capacity);
+  if(NULL == Queue->Slots)
+  {
+    Result = LFQ_NO_MEM;
+  }
+  atomic_init(&Queue->Head, 0);
+  atomic_init(&Queue->Tail, 0);
+  Queue->CachedHead = 0;
+  Queue->CachedTail = 0;
+
+  return Result;
+}
+
+int SPSCAdd(SPSCQUEUE *Queue,
+            int Tag,
+            void *Object,
+            size_t Size)
+{
+  SPSC_SLOT *Slot;
+  size_t Tail;
+  int Result = LFQ_SUCCESS;
+
+  assert(Queue != NULL);
+
+  Tail = atomic_load_explicit(&Queue->Tail,
+                              memory_order_relaxed);
+  if(Size > Queue->RecordSize)
+  {
+    Result = LFQ_TOO_BIG;
+  }
+  else
+  {
+    /* Only re-read the consumer's index when our
+     * cached copy says the ring is full.
+     */
+    if(Tail - Queue->CachedHead > Queue->Mask)
+    {
+      Queue->CachedHead =
+        atomic_load_explicit(&Queue->Head,
+                             memory_order_acquire);
+    }
+    if(Tail - Queue->CachedHead > Queue->Mask)
+    {
+      Result = LFQ_FULL;
+    }
+    else
+    {
+      Slot = SPSC_SLOT_AT(Queue, Tail);
+      Slot->Tag = Tag;
+      Slot->Size = Size;
+      memcpy(SPSC_DATA(Slot), Object, Size);
+      atomic_store_explicit(&Queue->Tail,
+                            Tail + 1,
+                            memory_order_release);
+    }
+  }
+
+  return Result;
+}
+
+int SPSCRemove(void *Object,
+               int *Tag,
+               size_t *Size,
+               SPSCQUEUE *Queue)
+{
+  SPSC_SLOT *Slot;
+  size_t Head;
+  int Result = LFQ_SUCCESS;
+
+  assert(Queue != NULL);
+
+  Head = atomic_load_explicit(&Queue->Head,
+                              memory_order_relaxed);
+  if(Head == Queue->CachedTail)
+  {
+    Queue->CachedTail =
+      atomic_load_explicit(&Queue->Tail,
+                           memory_order_acquire);
+  }
+  if(Head == Queue->CachedTail)
+  {
+    Result = LFQ_EMPTY;
+  }
+  else
+  {
+    Slot = SPSC_SLOT_AT(Queue, Head);
+    if(Tag != NULL)
+    {
+      *Tag = Slot->Tag;
+    }
+    if(Size != NULL)
+    {
+      *Size = Slot->Size;
+    }
+    if(Object != NULL)
+    {
+      memcpy(Object, SPSC_DATA(Slot), Slot->Size);
+    }
+    atomic_store_explicit(&Queue->Head,
+                          Head + 1,
+                          memory_order_release);
+  }
+
+  return Result;
+}
+
+size_t SPSCCount(SPSCQUEUE *Queue)
+{
+  assert(Queue != NULL);
+
+  return atomic_load(&Queue->Tail) - atomic_load(&Queue->Head);
+}
+
+void SPSCDestroy(SPSCQUEUE *Queue)
+{
+  assert(Queue != NULL);
+
+  free(Queue->Slots);
+  Queue->Slots = NULL;
+}
+
+/* ---- MPMCQUEUE ---- */
+
+#define MPMC_SLOT_AT(q, i) \
+  ((MPMC_SLOT *)((q)->Slots + ((i) & (q)->Mask) * (q)->SlotSize))
+
+#define MPMC_DATA(s) \
+  ((unsigned char *)(s) + LFQ_ROUND(sizeof(MPMC_SLOT)))
+
+int MPMCInit(MPMCQUEUE *Queue,
+             size_t Capacity,
+             size_t RecordSize)
+{
+  int Result = LFQ_SUCCESS;
+  size_t i;
+
+  assert(Queue != NULL);
+  assert(RecordSize > 0);
+
+  Capacity = LFQCapacity(Capacity);
+  Queue->RecordSize = RecordSize;
+  Queue->Mask = Capacity - 1;
+  Queue->Slots = LFQAllocSlots(&Queue->SlotSize,
+                               sizeof(MPMC_SLOT),
+                               RecordSize,
+                               Capacity);
+  if(NULL == Queue->Slots)
+  {
+    Result = LFQ_NO_MEM;
+  }
+  else
+  {
+    /* Slot i is first writable when Tail == i */
+    for(i = 0; i < Capacity; i++)
+    {
+      atomic_init(&MPMC_SLOT_AT(Queue, i)->Sequence, i);
+    }
+  }
+  atomic_init(&Queue->Head, 0);
+  atomic_init(&Queue->Tail, 0);
+
+  return Result;
+}
+
+int MPMCAdd(MPMCQUEUE *Queue,
+            int Tag,
+            void *Object,
+            size_t Size)
+{
+  MPMC_SLOT *Slot = NULL;
+  size_t Tail;
+  size_t Sequence;
+  int Result = LFQ_SUCCESS;
+
+  assert(Queue != NULL);
+
+  if(Size > Queue->RecordSize)
+  {
+    Result = LFQ_TOO_BIG;
+  }
+  else
+  {
+    Tail = atomic_load_explicit(&Queue->Tail,
+                                memory_order_relaxed);
+    while(NULL == Slot && LFQ_SUCCESS == Result)
+    {
+      Slot = MPMC_SLOT_AT(Queue, Tail);
+      Sequence = atomic_load_explicit(&Slot->Sequence,
+                                      memory_order_acquire);
+      if(Sequence == Tail)
+      {
+        /* Slot is free on this lap; try to claim it.
+         * On failure, Tail is reloaded for us.
+         */
+        if(!atomic_compare_exchange_weak_explicit(
+              &Queue->Tail,
+              &Tail,
+              Tail + 1,
+              memory_order_relaxed,
+              memory_order_relaxed))
+        {
+          Slot = NULL;
+        }
+      }
+      else if((ptrdiff_t)(Sequence - Tail) < 0)
+      {
+        /* Still holds last lap's item: we're full */
+        Slot = NULL;
+        Result = LFQ_FULL;
+      }
+      else
+      {
+        /* Another producer got here first */
+        Slot = NULL;
+        Tail = atomic_load_explicit(&Queue->Tail,
+                                    memory_order_relaxed);
+      }
+    }
+
+    if(LFQ_SUCCESS == Result)
+    {
+      Slot->Tag = Tag;
+      Slot->Size = Size;
+      memcpy(MPMC_DATA(Slot), Object, Size);
+      atomic_store_explicit(&Slot->Sequence,
+                            Tail + 1,
+                            memory_order_release);
+    }
+  }
+
+  return Result;
+}
+
+int MPMCRemove(void *Object,
+               int *Tag,
+               size_t *Size,
+               MPMCQUEUE *Queue)
+{
+  MPMC_SLOT *Slot = NULL;
+  size_t Head;
+  size_t Sequence;
+  int Result = LFQ_SUCCESS;
+
+  assert(Queue != NULL);
+
+  Head = atomic_load_explicit(&Queue->Head,
+                              memory_order_relaxed);
+  while(NULL == Slot && LFQ_SUCCESS == Result)
+  {
+    Slot = MPMC_SLOT_AT(Queue, Head);
+    Sequence = atomic_load_explicit(&Slot->Sequence,
+                                    memory_order_acquire);
+    if(Sequence == Head + 1)
+    {
+      if(!atomic_compare_exchange_weak_explicit(
+            &Queue->Head,
+            &Head,
+            Head + 1,
+            memory_order_relaxed,
+            memory_order_relaxed))
+      {
+        Slot = NULL;
+      }
+    }
+    else if((ptrdiff_t)(Sequence - (Head + 1)) < 0)
+    {
+      /* Nothing written here yet on this lap */
+      Slot = NULL;
+      Result = LFQ_EMPTY;
+    }
+    else
+    {
+      Slot = NULL;
+      Head = atomic_load_explicit(&Queue->Head,
+                                  memory_order_relaxed);
+    }
+  }
+
+  if(LFQ_SUCCESS == Result)
+  {
+    if(Tag != NULL)
+    {
+      *Tag = Slot->Tag;
+    }
+    if(Size != NULL)
+    {
+      *Size = Slot->Size;
+    }
+    if(Object != NULL)
+    {
+      memcpy(Object, MPMC_DATA(Slot), Slot->Size);
+    }
+    /* Hand the slot back to producers, one lap on */
+    atomic_store_explicit(&Slot->Sequence,
+                          Head + Queue->Mask + 1,
+                          memory_order_release);
+  }
+
+  return Result;
+}
+
+size_t MPMCCount(MPMCQUEUE *Queue)
+{
+  size_t Head;
+  size_t Tail;
+
+  assert(Queue != NULL);
+
+  Head = atomic_load(&Queue->Head);
+  Tail = atomic_load(&Queue->Tail);
+
+  return Tail > Head ? Tail - Head : 0;
+}
+
+void MPMCDestroy(MPMCQUEUE *Queue)
+{
+  assert(Queue != NULL);
+
+  free(Queue->Slots);
+  Queue->Slots = NULL;
+}
+
+/* end of lfqueue.c */
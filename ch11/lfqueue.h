@@ -0,0 +1,142 @@
+/*  lfqueue.h - header for lock-free queue library
+ *
+ *  LFQUEUE - Lock-Free Queue Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#ifndef LFQUEUE_H__
+#define LFQUEUE_H__
+
+/* Unlike the rest of this library, these queues need
+ * a C11 compiler, since they rely on <stdatomic.h>.
+ */
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define LFQ_SUCCESS     0
+#define LFQ_NO_MEM      1
+#define LFQ_TOO_BIG     2
+#define LFQ_EMPTY       3
+#define LFQ_FULL        4
+
+/* Head and tail are kept on separate cache lines,
+ * so that producers and consumers don't keep
+ * stealing the line from one another.
+ */
+#define LFQ_CACHE_LINE  64
+
+/* SPSCQUEUE - single producer, single consumer.
+ *
+ * Exactly one thread may call SPSCAdd and exactly
+ * one (other) thread may call SPSCRemove. Both
+ * are wait-free: they never loop or block.
+ */
+typedef struct SPSCQUEUE
+{
+  unsigned char *Slots;
+  size_t SlotSize;
+  size_t RecordSize;
+  size_t Mask;             /* capacity - 1 */
+
+  char Pad0[LFQ_CACHE_LINE];
+  atomic_size_t Head;      /* next slot to read */
+  size_t CachedTail;       /* consumer's view of Tail */
+
+  char Pad1[LFQ_CACHE_LINE];
+  atomic_size_t Tail;      /* next slot to write */
+  size_t CachedHead;       /* producer's view of Head */
+
+  char Pad2[LFQ_CACHE_LINE];
+} SPSCQUEUE;
+
+/* Capacity is rounded up to a power of two.
+ * Objects of up to RecordSize bytes are copied
+ * into the queue's own slots.
+ */
+int SPSCInit(SPSCQUEUE *Queue,
+             size_t Capacity,
+             size_t RecordSize);
+int SPSCAdd(SPSCQUEUE *Queue,
+            int Tag,
+            void *Object,
+            size_t Size);
+
+/* Copy the first item to Object (if non-NULL) and
+ * return its tag and size through Tag and Size (if
+ * non-NULL). Returns LFQ_EMPTY if nothing is queued.
+ */
+int SPSCRemove(void *Object,
+               int *Tag,
+               size_t *Size,
+               SPSCQUEUE *Queue);
+
+/* Only a snapshot, if other threads are active */
+size_t SPSCCount(SPSCQUEUE *Queue);
+
+void SPSCDestroy(SPSCQUEUE *Queue);
+
+/* MPMCQUEUE - bounded multi-producer, multi-consumer.
+ *
+ * Any number of threads may add and remove at once.
+ * Each slot carries a sequence number which says
+ * whether it is ready to be written or read on the
+ * current lap, so a thread claims a slot with a
+ * single compare-and-swap on Head or Tail and never
+ * waits for a lock.
+ */
+typedef struct MPMCQUEUE
+{
+  unsigned char *Slots;
+  size_t SlotSize;
+  size_t RecordSize;
+  size_t Mask;
+
+  char Pad0[LFQ_CACHE_LINE];
+  atomic_size_t Head;
+
+  char Pad1[LFQ_CACHE_LINE];
+  atomic_size_t Tail;
+
+  char Pad2[LFQ_CACHE_LINE];
+} MPMCQUEUE;
+
+int MPMCInit(MPMCQUEUE *Queue,
+             size_t Capacity,
+             size_t RecordSize);
+int MPMCAdd(MPMCQUEUE *Queue,
+            int Tag,
+            void *Object,
+            size_t Size);
+int MPMCRemove(void *Object,
+               int *Tag,
+               size_t *Size,
+               MPMCQUEUE *Queue);
+size_t MPMCCount(MPMCQUEUE *Queue);
+void MPMCDestroy(MPMCQUEUE *Queue);
+
+#endif
@@ -0,0 +1,370 @@
+/*  lfqueuemn.c - lock-free queue stress test and benchmark
+ *
+ *  LFQUEUE - Lock-Free Queue Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <threads.h>
+#include <stdatomic.h>
+
+#include "lfqueue.h"
+#include "queue.h"
+
+/* This program hammers the lock-free queues from several
+ * threads at once, checking that nothing is lost,
+ * duplicated or reordered, and then times them against
+ * the obvious alternative: a ring-backed QUEUE guarded
+ * by a single mutex.
+ *
+ * Usage: lfqueuemn [items per producer]
+ */
+
+#define MAX_THREADS       8
+#define DEFAULT_ITEMS     200000L
+#define QUEUE_CAPACITY    1024
+
+typedef enum KIND
+{
+  KIND_SPSC,
+  KIND_MPMC,
+  KIND_MUTEX
+} KIND;
+
+typedef struct ITEM
+{
+  int Producer;
+  long Seq;
+} ITEM;
+
+typedef struct SHARED
+{
+  KIND Kind;
+  SPSCQUEUE Spsc;
+  MPMCQUEUE Mpmc;
+  QUEUE Locked;
+  mtx_t Lock;
+
+  long ItemsEach;
+  long Total;
+  atomic_long Consumed;
+  atomic_long SeqSum;
+  atomic_int Errors;
+} SHARED;
+
+typedef struct WORKER
+{
+  SHARED *Shared;
+  int Id;
+} WORKER;
+
+static int Add(SHARED *s, ITEM *Item)
+{
+  int Result;
+
+  switch(s->Kind)
+  {
+    case KIND_SPSC:
+      Result = SPSCAdd(&s->Spsc, Item->Producer, Item, sizeof *Item);
+      break;
+    case KIND_MPMC:
+      Result = MPMCAdd(&s->Mpmc, Item->Producer, Item, sizeof *Item);
+      break;
+    default:
+      mtx_lock(&s->Lock);
+      if(QueueCount(&s->Locked) >= QUEUE_CAPACITY)
+      {
+        Result = LFQ_FULL;
+      }
+      else
+      {
+        Result = QueueAdd(&s->Locked,
+                          Item->Producer,
+                          Item,
+                          sizeof *Item) == QUEUE_SUCCESS ?
+                 LFQ_SUCCESS : LFQ_NO_MEM;
+      }
+      mtx_unlock(&s->Lock);
+      break;
+  }
+
+  return Result;
+}
+
+static int Remove(SHARED *s, ITEM *Item, int *Tag)
+{
+  int Result;
+
+  switch(s->Kind)
+  {
+    case KIND_SPSC:
+      Result = SPSCRemove(Item, Tag, NULL, &s->Spsc);
+      break;
+    case KIND_MPMC:
+      Result = MPMCRemove(Item, Tag, NULL, &s->Mpmc);
+      break;
+    default:
+      mtx_lock(&s->Lock);
+      if(QueueGetData(&s->Locked, Tag, NULL) != NULL)
+      {
+        QueueRemove(Item, &s->Locked);
+        Result = LFQ_SUCCESS;
+      }
+      else
+      {
+        Result = LFQ_EMPTY;
+      }
+      mtx_unlock(&s->Lock);
+      break;
+  }
+
+  return Result;
+}
+
+static int Producer(void *Arg)
+{
+  WORKER *w = Arg;
+  ITEM Item;
+  int Status;
+
+  Item.Producer = w->Id;
+  for(Item.Seq = 0; Item.Seq < w->Shared->ItemsEach; Item.Seq++)
+  {
+    while((Status = Add(w->Shared, &Item)) == LFQ_FULL)
+    {
+      thrd_yield();
+    }
+    if(Status != LFQ_SUCCESS)
+    {
+      atomic_fetch_add(&w->Shared->Errors, 1);
+      break;
+    }
+  }
+
+  return 0;
+}
+
+/* Items from any one producer must reach any one
+ * consumer in the order they were added.
+ */
+static int Consumer(void *Arg)
+{
+  WORKER *w = Arg;
+  SHARED *s = w->Shared;
+  long LastSeq[MAX_THREADS];
+  long Sum = 0;
+  ITEM Item;
+  int Tag;
+  int i;
+
+  for(i = 0; i < MAX_THREADS; i++)
+  {
+    LastSeq[i] = -1;
+  }
+
+  while(atomic_load(&s->Consumed) < s->Total)
+  {
+    if(Remove(s, &Item, &Tag) == LFQ_SUCCESS)
+    {
+      atomic_fetch_add(&s->Consumed, 1);
+      if(Tag != Item.Producer ||
+         Item.Producer < 0 ||
+         Item.Producer >= MAX_THREADS ||
+         Item.Seq <= LastSeq[Item.Producer])
+      {
+        atomic_fetch_add(&s->Errors, 1);
+      }
+      else
+      {
+        LastSeq[Item.Producer] = Item.Seq;
+      }
+      Sum += Item.Seq;
+    }
+    else
+    {
+      thrd_yield();
+    }
+  }
+  atomic_fetch_add(&s->SeqSum, Sum);
+
+  return 0;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+
+  timespec_get(&ts, TIME_UTC);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Run Threads producers and Threads consumers.
+ * Returns elapsed seconds, or -1 on failure.
+ */
+static double Run(KIND Kind, int Threads, long ItemsEach)
+{
+  static SHARED s;
+  WORKER w[2 * MAX_THREADS];
+  thrd_t t[2 * MAX_THREADS];
+  double Start;
+  double Elapsed;
+  long Expected;
+  int i;
+  int Status;
+
+  s.Kind = Kind;
+  s.ItemsEach = ItemsEach;
+  s.Total = ItemsEach * Threads;
+  atomic_store(&s.Consumed, 0);
+  atomic_store(&s.SeqSum, 0);
+  atomic_store(&s.Errors, 0);
+
+  switch(Kind)
+  {
+    case KIND_SPSC:
+      Status = SPSCInit(&s.Spsc, QUEUE_CAPACITY, sizeof(ITEM));
+      break;
+    case KIND_MPMC:
+      Status = MPMCInit(&s.Mpmc, QUEUE_CAPACITY, sizeof(ITEM));
+      break;
+    default:
+      QueueInitRing(&s.Locked, sizeof(ITEM));
+      Status = mtx_init(&s.Lock, mtx_plain) == thrd_success ?
+               LFQ_SUCCESS : LFQ_NO_MEM;
+      break;
+  }
+  if(Status != LFQ_SUCCESS)
+  {
+    return -1;
+  }
+
+  Start = Now();
+  for(i = 0; i < 2 * Threads; i++)
+  {
+    w[i].Shared = &s;
+    w[i].Id = i < Threads ? i : i - Threads;
+    if(thrd_create(&t[i],
+                   i < Threads ? Producer : Consumer,
+                   &w[i]) != thrd_success)
+    {
+      printf("Can't start thread %d.\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+  for(i = 0; i < 2 * Threads; i++)
+  {
+    thrd_join(t[i], NULL);
+  }
+  Elapsed = Now() - Start;
+
+  switch(Kind)
+  {
+    case KIND_SPSC:
+      SPSCDestroy(&s.Spsc);
+      break;
+    case KIND_MPMC:
+      MPMCDestroy(&s.Mpmc);
+      break;
+    default:
+      QueueDestroy(&s.Locked);
+      mtx_destroy(&s.Lock);
+      break;
+  }
+
+  Expected = (ItemsEach - 1) * ItemsEach / 2 * Threads;
+  if(atomic_load(&s.Errors) != 0 ||
+     atomic_load(&s.SeqSum) != Expected)
+  {
+    printf("FAILED: %d ordering errors, checksum %ld, "
+           "expected %ld\n",
+           atomic_load(&s.Errors),
+           atomic_load(&s.SeqSum),
+           Expected);
+    Elapsed = -1;
+  }
+
+  return Elapsed;
+}
+
+static void Report(const char *Name,
+                   KIND Kind,
+                   int Threads,
+                   long ItemsEach)
+{
+  double Seconds = Run(Kind, Threads, ItemsEach);
+
+  printf("%-14s %2d + %-2d ", Name, Threads, Threads);
+  if(Seconds < 0)
+  {
+    printf("failed\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("%8.3f s", Seconds);
+  if(Seconds > 0)
+  {
+    printf("  %12.0f ops/sec",
+           2.0 * ItemsEach * Threads / Seconds);
+  }
+  printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+  long ItemsEach = DEFAULT_ITEMS;
+  int Threads;
+
+  if(argc > 1)
+  {
+    ItemsEach = strtol(argv[1], NULL, 10);
+    if(ItemsEach <= 0)
+    {
+      printf("Usage: lfqueuemn [items per producer]\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  printf("%ld items per producer, capacity %d\n\n",
+         ItemsEach,
+         QUEUE_CAPACITY);
+  printf("Queue          threads    time          throughput\n");
+
+  Report("SPSC", KIND_SPSC, 1, ItemsEach);
+  for(Threads = 1; Threads <= MAX_THREADS; Threads *= 2)
+  {
+    Report("MPMC", KIND_MPMC, Threads, ItemsEach);
+    Report("Mutex + QUEUE", KIND_MUTEX, Threads, ItemsEach);
+  }
+
+  printf("\nAll items accounted for, in order.\n");
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*  nodepool.c - source for list node pool allocator
+ *
+ *  NODEPOOL - Node Pool Allocator
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "nodepool.h"
+
+/* Anything we store inline must be correctly
+ * aligned, so every size is rounded up to a
+ * multiple of the most demanding basic type.
+ */
+typedef union NP_ALIGN
+{
+  long l;
+  double d;
+  long double ld;
+  void *p;
+  void (*f)(void);
+} NP_ALIGN;
+
+#define NP_ROUND(n) \
+  ((((n) + sizeof(NP_ALIGN) - 1) / sizeof(NP_ALIGN)) \
+    * sizeof(NP_ALIGN))
+
+NODEPOOL *NPCreate(size_t HeaderSize,
+                   size_t InlineSize,
+                   size_t NodesPerSlab)
+{
+  NODEPOOL *Pool;
+
+  assert(HeaderSize >= sizeof(NP_FREE));
+
+  Pool = malloc(sizeof *Pool);
+  if(Pool != NULL)
+  {
+    Pool->HeaderSize   = NP_ROUND(HeaderSize);
+    Pool->InlineSize   = InlineSize;
+    Pool->NodeSize     = Pool->HeaderSize +
+                         NP_ROUND(InlineSize);
+    Pool->NodesPerSlab = NodesPerSlab > 0 ?
+                         NodesPerSlab :
+                         NP_DEFAULT_SLAB;
+    Pool->Slabs        = NULL;
+    Pool->Bump         = NULL;
+    Pool->BumpLeft     = 0;
+    Pool->FreeList     = NULL;
+  }
+
+  return Pool;
+}
+
+void *NPAlloc(NODEPOOL *Pool)
+{
+  NP_SLAB *Slab;
+  void *Node = NULL;
+
+  assert(Pool != NULL);
+
+  if(Pool->FreeList != NULL)
+  {
+    Node = Pool->FreeList;
+    Pool->FreeList = Pool->FreeList->Next;
+  }
+  else
+  {
+    if(0 == Pool->BumpLeft)
+    {
+      Slab = malloc(NP_ROUND(sizeof *Slab) +
+                    Pool->NodeSize * Pool->NodesPerSlab);
+      if(Slab != NULL)
+      {
+        Slab->Next = Pool->Slabs;
+        Pool->Slabs = Slab;
+        Pool->Bump = (unsigned char *)Slab +
+                     NP_ROUND(sizeof *Slab);
+        Pool->BumpLeft = Pool->NodesPerSlab;
+      }
+    }
+    if(Pool->BumpLeft > 0)
+    {
+      Node = Pool->Bump;
+      Pool->Bump += Pool->NodeSize;
+      --Pool->BumpLeft;
+    }
+  }
+
+  return Node;
+}
+
+void NPFree(NODEPOOL *Pool, void *Node)
+{
+  NP_FREE *p = Node;
+
+  assert(Pool != NULL);
+
+  if(p != NULL)
+  {
+    p->Next = Pool->FreeList;
+    Pool->FreeList = p;
+  }
+}
+
+void *NPInline(NODEPOOL *Pool, void *Node)
+{
+  assert(Pool != NULL);
+  assert(Node != NULL);
+
+  return (unsigned char *)Node + Pool->HeaderSize;
+}
+
+void NPDestroy(NODEPOOL *Pool)
+{
+  NP_SLAB *Next;
+
+  if(Pool != NULL)
+  {
+    while(Pool->Slabs != NULL)
+    {
+      Next = Pool->Slabs->Next;
+      free(Pool->Slabs);
+      Pool->Slabs = Next;
+    }
+    free(Pool);
+  }
+}
+
+/* end of nodepool.c */
@@ -0,0 +1,93 @@
+/*  nodepool.h - header for list node pool allocator
+ *
+ *  NODEPOOL - Node Pool Allocator
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+#ifndef NODEPOOL_H__
+#define NODEPOOL_H__
+
+#include <stddef.h>
+
+/* A node pool hands out fixed-size blocks carved
+ * from large slabs. Each block is a list node header
+ * followed by InlineSize bytes of payload space, so
+ * a small object can live in the node itself and an
+ * insertion costs a single bump of a pointer (or a
+ * pop from the free list, once nodes are recycled).
+ *
+ * Blocks are only returned to the system when the
+ * whole pool is destroyed. Destroy every list that
+ * uses the pool before destroying the pool itself,
+ * or any out-of-line objects will leak.
+ */
+
+#define NP_DEFAULT_SLAB  256
+
+typedef struct NP_SLAB
+{
+  struct NP_SLAB *Next;
+} NP_SLAB;
+
+typedef struct NP_FREE
+{
+  struct NP_FREE *Next;
+} NP_FREE;
+
+typedef struct NODEPOOL
+{
+  size_t HeaderSize;   /* node header, rounded up */
+  size_t InlineSize;   /* payload bytes per node */
+  size_t NodeSize;     /* total bytes per node */
+  size_t NodesPerSlab;
+
+  NP_SLAB *Slabs;
+  unsigned char *Bump; /* next unused node in slab */
+  size_t BumpLeft;     /* unused nodes in slab */
+  NP_FREE *FreeList;   /* recycled nodes */
+} NODEPOOL;
+
+/* HeaderSize is the sizeof the node structure.
+ * NodesPerSlab of 0 selects NP_DEFAULT_SLAB.
+ */
+NODEPOOL *NPCreate(size_t HeaderSize,
+                   size_t InlineSize,
+                   size_t NodesPerSlab);
+
+/* Get one node. Returns NULL if out of memory. */
+void *NPAlloc(NODEPOOL *Pool);
+
+/* Give a node back to the pool for re-use */
+void NPFree(NODEPOOL *Pool, void *Node);
+
+/* Address of the node's inline payload area */
+void *NPInline(NODEPOOL *Pool, void *Node);
+
+/* Release every slab, and the pool itself */
+void NPDestroy(NODEPOOL *Pool);
+
+#endif
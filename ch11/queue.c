@@ -34,6 +34,27 @@
 
 #include "queue.h"
 
+void QueueInit(QUEUE *Queue, NODEPOOL *Pool)
+{
+  QUEUE Empty = {0};
+
+  assert(Queue != NULL);
+
+  *Queue = Empty;
+  Queue->Pool = Pool;
+}
+
+void QueueInitRing(QUEUE *Queue, size_t RecordSize)
+{
+  QUEUE Empty = {0};
+
+  assert(Queue != NULL);
+  assert(RecordSize > 0);
+
+  *Queue = Empty;
+  RingInit(&Queue->Ring, RecordSize);
+}
+
 int QueueAdd(QUEUE *Queue,
              int Tag,
              void *Object,
@@ -44,21 +65,39 @@ int QueueAdd(QUEUE *Queue,
   assert(Queue != NULL);
   assert(0 == Queue->CheckInit1 && 0 == Queue->CheckInit2);
 
-  ListResult = SLAdd(&Queue->TailPtr, Tag, Object, Size);
-
-  if(SL_SUCCESS == ListResult)
+  if(Queue->Ring.RecordSize > 0)
   {
-    if(0 == Queue->NumItems)
+    if(RING_SUCCESS == RingAddAtBack(&Queue->Ring,
+                                     Tag,
+                                     Object,
+                                     Size))
     {
-      Queue->HeadPtr = Queue->TailPtr;
+      Result = QUEUE_SUCCESS;
+      ++Queue->NumItems;
     }
-    else
+  }
+  else
+  {
+    ListResult = SLPoolAdd(Queue->Pool,
+                           &Queue->TailPtr,
+                           Tag,
+                           Object,
+                           Size);
+
+    if(SL_SUCCESS == ListResult)
     {
-      Queue->TailPtr = Queue->TailPtr->Next;
-    }
+      if(0 == Queue->NumItems)
+      {
+        Queue->HeadPtr = Queue->TailPtr;
+      }
+      else
+      {
+        Queue->TailPtr = Queue->TailPtr->Next;
+      }
 
-    Result = QUEUE_SUCCESS;
-    ++Queue->NumItems;
+      Result = QUEUE_SUCCESS;
+      ++Queue->NumItems;
+    }
   }
 
   return Result;
@@ -73,7 +112,12 @@ int QueueRemove(void *Object, QUEUE *Queue)
   assert(Queue != NULL);
   assert(0 == Queue->CheckInit1 && 0 == Queue->CheckInit2);
 
-  if(Queue->NumItems > 0)
+  if(Queue->NumItems > 0 && Queue->Ring.RecordSize > 0)
+  {
+    RingRemoveFromFront(Object, &Queue->Ring);
+    --Queue->NumItems;
+  }
+  else if(Queue->NumItems > 0)
   {
     p = SLGetData(Queue->HeadPtr, NULL, &Size);
     if(p != NULL)
@@ -104,10 +148,21 @@ int QueueRemove(void *Object, QUEUE *Queue)
 
 void *QueueGetData(QUEUE *Queue, int *Tag, size_t *Size)
 {
+  void *p;
+
   assert(Queue != NULL);
   assert(0 == Queue->CheckInit1 && 0 == Queue->CheckInit2);
 
-  return SLGetData(Queue->HeadPtr, Tag, Size);
+  if(Queue->Ring.RecordSize > 0)
+  {
+    p = RingGetDataFromFront(&Queue->Ring, Tag, Size);
+  }
+  else
+  {
+    p = SLGetData(Queue->HeadPtr, Tag, Size);
+  }
+
+  return p;
 }
 
 size_t QueueCount(QUEUE *Queue)
@@ -123,4 +178,5 @@ void QueueDestroy(QUEUE *Queue)
   {
     QueueRemove(NULL, Queue);
   }
+  RingDestroy(&Queue->Ring);
 }
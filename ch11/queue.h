@@ -32,6 +32,7 @@
 #define QUEUE_H__
 
 #include "sllist.h"
+#include "ring.h"
 
 #define QUEUE_SUCCESS       0
 #define QUEUE_ADD_FAILURE   1
@@ -47,12 +48,27 @@ typedef struct QUEUE
   SLLIST *HeadPtr;
   SLLIST *TailPtr;
   size_t NumItems;
+  NODEPOOL *Pool;
+  RING Ring;
 
 #ifndef NDEBUG
   int CheckInit2;
 #endif
 } QUEUE;
 
+/* Prepare an empty queue whose nodes come from
+ * Pool (see SLCreatePool). A queue initialised
+ * to {0} instead simply uses malloc.
+ */
+void QueueInit(QUEUE *Queue, NODEPOOL *Pool);
+
+/* Prepare an empty queue that keeps its items in a
+ * growable ring buffer rather than a linked list.
+ * Objects of up to RecordSize bytes are copied into
+ * the ring itself; larger ones are rejected.
+ */
+void QueueInitRing(QUEUE *Queue, size_t RecordSize);
+
 int QueueAdd(QUEUE *Queue,
              int Tag,
              void *Object,
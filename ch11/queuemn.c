@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <limits.h>
 #include <assert.h>
@@ -52,6 +53,9 @@
 #define OPENING_TIME 32400L /* 9am */
 #define CLOSING_TIME 61200L /* 5pm */
 
+#define BENCH_ITEMS  1000000L
+#define BENCH_ROUNDS 10
+
 typedef struct CUSTOMER
 {
   int Index;
@@ -112,7 +116,81 @@ char *GetTime(long Seconds)
   return TheTime;
 }
 
-int main(void)
+/* Fill the queue with BENCH_ITEMS customers and drain
+ * it again, BENCH_ROUNDS times. Returns seconds taken.
+ */
+double TimeQueue(QUEUE *Queue)
+{
+  CUSTOMER Customer = {0};
+  clock_t Start;
+  long i;
+  int Round;
+
+  Start = clock();
+  for(Round = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      Customer.Index = (int)i;
+      if(QUEUE_SUCCESS !=
+         QueueAdd(Queue, 0, &Customer, sizeof Customer))
+      {
+        printf("Insufficient memory.\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    while(QueueCount(Queue) > 0)
+    {
+      QueueRemove(&Customer, Queue);
+    }
+  }
+
+  return (double)(clock() - Start) / CLOCKS_PER_SEC;
+}
+
+void ReportQueue(const char *Name, double Seconds)
+{
+  double Ops = 2.0 * BENCH_ITEMS * BENCH_ROUNDS;
+
+  printf("%-20s %8.3f s", Name, Seconds);
+  if(Seconds > 0)
+  {
+    printf("  %12.0f ops/sec", Ops / Seconds);
+  }
+  printf("\n");
+}
+
+/* Compare the linked and ring-buffer queues */
+void Benchmark(void)
+{
+  QUEUE Queue;
+  NODEPOOL *Pool;
+
+  printf("Queue throughput, %ld items x %d rounds\n\n",
+         BENCH_ITEMS,
+         BENCH_ROUNDS);
+
+  QueueInit(&Queue, NULL);
+  ReportQueue("Linked (malloc)", TimeQueue(&Queue));
+  QueueDestroy(&Queue);
+
+  Pool = SLCreatePool(sizeof(CUSTOMER), 0);
+  if(NULL == Pool)
+  {
+    printf("Insufficient memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  QueueInit(&Queue, Pool);
+  ReportQueue("Linked (node pool)", TimeQueue(&Queue));
+  QueueDestroy(&Queue);
+  NPDestroy(Pool);
+
+  QueueInitRing(&Queue, sizeof(CUSTOMER));
+  ReportQueue("Ring buffer", TimeQueue(&Queue));
+  QueueDestroy(&Queue);
+}
+
+int main(int argc, char *argv[])
 {
   QUEUE Queue = {0};
 
@@ -140,6 +218,12 @@ int main(void)
 
   int NumCustomers = 0;
 
+  if(argc > 1 && 0 == strcmp(argv[1], "-bench"))
+  {
+    Benchmark();
+    return 0;
+  }
+
   srand((unsigned)time(NULL));
 
   /* get data from user */
@@ -0,0 +1,321 @@
+/*  ring.c - source for ring buffer library
+ *
+ *  RING - Ring Buffer Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ring.h"
+
+typedef struct RING_SLOT
+{
+  int Tag;
+  size_t Size;
+} RING_SLOT;
+
+typedef union RING_ALIGN
+{
+  long l;
+  double d;
+  long double ld;
+  void *p;
+  void (*f)(void);
+} RING_ALIGN;
+
+#define RING_ROUND(n) \
+  ((((n) + sizeof(RING_ALIGN) - 1) / sizeof(RING_ALIGN)) \
+    * sizeof(RING_ALIGN))
+
+#define RING_DATA_OFFSET RING_ROUND(sizeof(RING_SLOT))
+
+static RING_SLOT *RingSlot(RING *Ring, size_t Index)
+{
+  return (RING_SLOT *)(Ring->Slots +
+         ((Index & (Ring->Capacity - 1)) * Ring->SlotSize));
+}
+
+/* Double the capacity, unwrapping the items
+ * so that the first one lands in slot 0.
+ */
+static int RingGrow(RING *Ring)
+{
+  int Result = RING_SUCCESS;
+  size_t NewCapacity;
+  size_t FirstPart;
+  unsigned char *p;
+
+  NewCapacity = Ring->Capacity > 0 ?
+                Ring->Capacity * 2 :
+                RING_MIN_CAPACITY;
+
+  if(NewCapacity < Ring->Capacity ||
+     NewCapacity > (size_t)-1 / Ring->SlotSize)
+  {
+    Result = RING_NO_MEM;
+  }
+  else
+  {
+    p = malloc(NewCapacity * Ring->SlotSize);
+    if(p != NULL)
+    {
+      if(Ring->NumItems > 0)
+      {
+        FirstPart = Ring->Capacity - Ring->Head;
+        if(FirstPart > Ring->NumItems)
+        {
+          FirstPart = Ring->NumItems;
+        }
+        memcpy(p,
+               Ring->Slots + Ring->Head * Ring->SlotSize,
+               FirstPart * Ring->SlotSize);
+        memcpy(p + FirstPart * Ring->SlotSize,
+               Ring->Slots,
+               (Ring->NumItems - FirstPart) * Ring->SlotSize);
+      }
+      free(Ring->Slots);
+      Ring->Slots = p;
+      Ring->Capacity = NewCapacity;
+      Ring->Head = 0;
+    }
+    else
+    {
+      Result = RING_NO_MEM;
+    }
+  }
+
+  return Result;
+}
+
+static void RingStore(RING_SLOT *Slot,
+                      int Tag,
+                      void *Object,
+                      size_t Size)
+{
+  Slot->Tag = Tag;
+  Slot->Size = Size;
+  memcpy((unsigned char *)Slot + RING_DATA_OFFSET,
+         Object,
+         Size);
+}
+
+void RingInit(RING *Ring, size_t RecordSize)
+{
+  assert(Ring != NULL);
+
+  Ring->Slots = NULL;
+  Ring->RecordSize = RecordSize;
+  Ring->SlotSize = RING_DATA_OFFSET + RING_ROUND(RecordSize);
+  Ring->Capacity = 0;
+  Ring->Head = 0;
+  Ring->NumItems = 0;
+}
+
+int RingAddAtFront(RING *Ring,
+                   int Tag,
+                   void *Object,
+                   size_t Size)
+{
+  int Result = RING_SUCCESS;
+
+  assert(Ring != NULL);
+
+  if(Size > Ring->RecordSize)
+  {
+    Result = RING_TOO_BIG;
+  }
+  else if(Ring->NumItems == Ring->Capacity)
+  {
+    Result = RingGrow(Ring);
+  }
+
+  if(RING_SUCCESS == Result)
+  {
+    Ring->Head = (Ring->Head - 1) & (Ring->Capacity - 1);
+    RingStore(RingSlot(Ring, Ring->Head), Tag, Object, Size);
+    ++Ring->NumItems;
+  }
+
+  return Result;
+}
+
+int RingAddAtBack(RING *Ring,
+                  int Tag,
+                  void *Object,
+                  size_t Size)
+{
+  int Result = RING_SUCCESS;
+
+  assert(Ring != NULL);
+
+  if(Size > Ring->RecordSize)
+  {
+    Result = RING_TOO_BIG;
+  }
+  else if(Ring->NumItems == Ring->Capacity)
+  {
+    Result = RingGrow(Ring);
+  }
+
+  if(RING_SUCCESS == Result)
+  {
+    RingStore(RingSlot(Ring, Ring->Head + Ring->NumItems),
+              Tag,
+              Object,
+              Size);
+    ++Ring->NumItems;
+  }
+
+  return Result;
+}
+
+int RingRemoveFromFront(void *Object, RING *Ring)
+{
+  RING_SLOT *Slot;
+  int Result = RING_SUCCESS;
+
+  assert(Ring != NULL);
+
+  if(Ring->NumItems > 0)
+  {
+    Slot = RingSlot(Ring, Ring->Head);
+    if(Object != NULL)
+    {
+      memcpy(Object,
+             (unsigned char *)Slot + RING_DATA_OFFSET,
+             Slot->Size);
+    }
+    Ring->Head = (Ring->Head + 1) & (Ring->Capacity - 1);
+    --Ring->NumItems;
+  }
+  else
+  {
+    Result = RING_EMPTY;
+  }
+
+  return Result;
+}
+
+int RingRemoveFromBack(void *Object, RING *Ring)
+{
+  RING_SLOT *Slot;
+  int Result = RING_SUCCESS;
+
+  assert(Ring != NULL);
+
+  if(Ring->NumItems > 0)
+  {
+    Slot = RingSlot(Ring, Ring->Head + Ring->NumItems - 1);
+    if(Object != NULL)
+    {
+      memcpy(Object,
+             (unsigned char *)Slot + RING_DATA_OFFSET,
+             Slot->Size);
+    }
+    --Ring->NumItems;
+  }
+  else
+  {
+    Result = RING_EMPTY;
+  }
+
+  return Result;
+}
+
+static void *RingGetData(RING_SLOT *Slot,
+                         int *Tag,
+                         size_t *Size)
+{
+  if(Tag != NULL)
+  {
+    *Tag = Slot->Tag;
+  }
+  if(Size != NULL)
+  {
+    *Size = Slot->Size;
+  }
+
+  return (unsigned char *)Slot + RING_DATA_OFFSET;
+}
+
+void *RingGetDataFromFront(RING *Ring,
+                           int *Tag,
+                           size_t *Size)
+{
+  void *p = NULL;
+
+  assert(Ring != NULL);
+
+  if(Ring->NumItems > 0)
+  {
+    p = RingGetData(RingSlot(Ring, Ring->Head), Tag, Size);
+  }
+
+  return p;
+}
+
+void *RingGetDataFromBack(RING *Ring,
+                          int *Tag,
+                          size_t *Size)
+{
+  void *p = NULL;
+
+  assert(Ring != NULL);
+
+  if(Ring->NumItems > 0)
+  {
+    p = RingGetData(RingSlot(Ring,
+                             Ring->Head + Ring->NumItems - 1),
+                    Tag,
+                    Size);
+  }
+
+  return p;
+}
+
+size_t RingCount(RING *Ring)
+{
+  assert(Ring != NULL);
+
+  return Ring->NumItems;
+}
+
+void RingDestroy(RING *Ring)
+{
+  assert(Ring != NULL);
+
+  free(Ring->Slots);
+  Ring->Slots = NULL;
+  Ring->Capacity = 0;
+  Ring->Head = 0;
+  Ring->NumItems = 0;
+}
+
+/* end of ring.c */
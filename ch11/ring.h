@@ -0,0 +1,90 @@
+/*  ring.h - header for ring buffer library
+ *
+ *  RING - Ring Buffer Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#ifndef RING_H__
+#define RING_H__
+
+#include <stddef.h>
+
+#define RING_SUCCESS   0
+#define RING_NO_MEM    1
+#define RING_TOO_BIG   2
+#define RING_EMPTY     3
+
+#define RING_MIN_CAPACITY 16
+
+/* A ring is a growable circular array of fixed-size
+ * slots. Each slot holds a tag, a size and up to
+ * RecordSize bytes of object data, so adding an item
+ * never allocates unless the ring has to grow. The
+ * capacity is always a power of two, so wrapping an
+ * index is a simple mask.
+ */
+typedef struct RING
+{
+  unsigned char *Slots;
+  size_t SlotSize;     /* header + record, rounded */
+  size_t RecordSize;   /* largest object we accept */
+  size_t Capacity;     /* 0, or a power of two */
+  size_t Head;         /* slot holding first item */
+  size_t NumItems;
+} RING;
+
+/* A ring with a RecordSize of 0 is unused; this
+ * is how the containers tell a ring-backed object
+ * from a list-backed one.
+ */
+void RingInit(RING *Ring, size_t RecordSize);
+
+int RingAddAtFront(RING *Ring,
+                   int Tag,
+                   void *Object,
+                   size_t Size);
+int RingAddAtBack(RING *Ring,
+                  int Tag,
+                  void *Object,
+                  size_t Size);
+int RingRemoveFromFront(void *Object, RING *Ring);
+int RingRemoveFromBack(void *Object, RING *Ring);
+
+void *RingGetDataFromFront(RING *Ring,
+                           int *Tag,
+                           size_t *Size);
+void *RingGetDataFromBack(RING *Ring,
+                          int *Tag,
+                          size_t *Size);
+
+size_t RingCount(RING *Ring);
+
+/* Free the slot array. The ring may be re-used. */
+void RingDestroy(RING *Ring);
+
+#endif
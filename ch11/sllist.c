@@ -34,24 +34,63 @@
 
 #include "sllist.h"
 
+NODEPOOL *SLCreatePool(size_t InlineSize,
+                       size_t NodesPerSlab)
+{
+  return NPCreate(sizeof(SLLIST), InlineSize, NodesPerSlab);
+}
+
+/* Is this node's object stored inside the node? */
+static int SLIsInline(SLLIST *Item)
+{
+  return Item->Pool != NULL &&
+         Item->Object == NPInline(Item->Pool, Item);
+}
+
 int SLAdd(SLLIST **Item,
           int Tag,
           void *Object,
           size_t Size)
+{
+  return SLPoolAdd(NULL, Item, Tag, Object, Size);
+}
+
+int SLPoolAdd(NODEPOOL *Pool,
+              SLLIST **Item,
+              int Tag,
+              void *Object,
+              size_t Size)
 {
   SLLIST *NewItem;
   int Result = SL_SUCCESS;
 
   assert(Item != NULL);
+  /* The pool must have been made for SLLIST nodes */
+  assert(Pool == NULL || Pool->HeaderSize >= sizeof(SLLIST));
 
   if(Size > 0)
   {
-    NewItem = malloc(sizeof *NewItem);
+    if(Pool != NULL)
+    {
+      NewItem = NPAlloc(Pool);
+    }
+    else
+    {
+      NewItem = malloc(sizeof *NewItem);
+    }
     if(NewItem != NULL)
     {
       NewItem->Tag    = Tag;
       NewItem->Size   = Size;
-      NewItem->Object = malloc(Size);
+      NewItem->Pool   = Pool;
+      if(Pool != NULL && Size <= Pool->InlineSize)
+      {
+        NewItem->Object = NPInline(Pool, NewItem);
+      }
+      else
+      {
+        NewItem->Object = malloc(Size);
+      }
 
       if(NewItem->Object != NULL)
       {
@@ -70,7 +109,14 @@ int SLAdd(SLLIST **Item,
       }
       else
       {
-        free(NewItem);
+        if(Pool != NULL)
+        {
+          NPFree(Pool, NewItem);
+        }
+        else
+        {
+          free(NewItem);
+        }
         Result = SL_NO_MEM;
       }
     }
@@ -91,6 +137,15 @@ int SLFront(SLLIST **Item,
             int Tag,
             void *Object,
             size_t Size)
+{
+  return SLPoolFront(NULL, Item, Tag, Object, Size);
+}
+
+int SLPoolFront(NODEPOOL *Pool,
+                SLLIST **Item,
+                int Tag,
+                void *Object,
+                size_t Size)
 {
   int Result = SL_SUCCESS;
 
@@ -98,7 +153,7 @@ int SLFront(SLLIST **Item,
 
   assert(Item != NULL);
 
-  Result = SLAdd(&p, Tag, Object, Size);
+  Result = SLPoolAdd(Pool, &p, Tag, Object, Size);
   if(SL_SUCCESS == Result)
   {
     p->Next = *Item;
@@ -112,6 +167,15 @@ int SLAppend(SLLIST **Item,
              int Tag,
              void *Object,
              size_t Size)
+{
+  return SLPoolAppend(NULL, Item, Tag, Object, Size);
+}
+
+int SLPoolAppend(NODEPOOL *Pool,
+                 SLLIST **Item,
+                 int Tag,
+                 void *Object,
+                 size_t Size)
 {
   int Result = SL_SUCCESS;
   SLLIST *EndSeeker;
@@ -120,7 +184,7 @@ int SLAppend(SLLIST **Item,
 
   if(NULL == *Item)
   {
-    Result = SLAdd(Item, Tag, Object, Size);
+    Result = SLPoolAdd(Pool, Item, Tag, Object, Size);
   }
   else
   {
@@ -129,7 +193,7 @@ int SLAppend(SLLIST **Item,
     {
       EndSeeker = EndSeeker->Next;
     }
-    Result = SLAdd(&EndSeeker, Tag, Object, Size);
+    Result = SLPoolAdd(Pool, &EndSeeker, Tag, Object, Size);
   }
 
   return Result;
@@ -146,17 +210,42 @@ int SLUpdate(SLLIST *Item,
   
   if(NewSize > 0)
   {
-    p = realloc(Item->Object, NewSize);
-    if(NULL != p)
+    if(Item->Pool != NULL && NewSize <= Item->Pool->InlineSize)
     {
+      /* Move in before freeing, in case NewObject
+       * lies within the old out-of-line object.
+       */
+      p = NPInline(Item->Pool, Item);
+      memmove(p, NewObject, NewSize);
+      if(Item->Object != p)
+      {
+        free(Item->Object);
+      }
       Item->Object = p;
-      memmove(Item->Object, NewObject, NewSize);
       Item->Tag = NewTag;
       Item->Size = NewSize;
     }
     else
     {
-      Result = SL_NO_MEM;
+      if(SLIsInline(Item))
+      {
+        p = malloc(NewSize);
+      }
+      else
+      {
+        p = realloc(Item->Object, NewSize);
+      }
+      if(NULL != p)
+      {
+        Item->Object = p;
+        memmove(Item->Object, NewObject, NewSize);
+        Item->Tag = NewTag;
+        Item->Size = NewSize;
+      }
+      else
+      {
+        Result = SL_NO_MEM;
+      }
     }
   }
   else
@@ -197,11 +286,18 @@ SLLIST *SLDeleteThis(SLLIST *Item)
   {
     NextNode = Item->Next;
 
-    if(Item->Object != NULL)
+    if(Item->Object != NULL && !SLIsInline(Item))
     {
       free(Item->Object);
     }
-    free(Item);
+    if(Item->Pool != NULL)
+    {
+      NPFree(Item->Pool, Item);
+    }
+    else
+    {
+      free(Item);
+    }
   }
 
   return NextNode;
@@ -36,6 +36,7 @@
 #define SL_NO_MEM     1
 #define SL_ZERO_SIZE  2
 
+#include "nodepool.h"
 
 typedef struct SLLIST
 {
@@ -43,14 +44,33 @@ typedef struct SLLIST
   struct SLLIST *Next;
   void *Object;
   size_t Size;
+  NODEPOOL *Pool; /* NULL if malloc'd */
 } SLLIST;
 
+/* Create a pool for SLLIST nodes. Objects of up to
+ * InlineSize bytes are stored inside the node. Free
+ * it with NPDestroy once all its lists are gone.
+ */
+NODEPOOL *SLCreatePool(size_t InlineSize,
+                       size_t NodesPerSlab);
+
 /* Add new item immediately after current item */
 int SLAdd(SLLIST **Item,
           int Tag,
           void *Object,
           size_t Size);
 
+/* As SLAdd, but take the node from Pool, which
+ * must come from SLCreatePool (or DLCreatePool,
+ * whose nodes are bigger). A NULL Pool means use
+ * malloc, as SLAdd does.
+ */
+int SLPoolAdd(NODEPOOL *Pool,
+              SLLIST **Item,
+              int Tag,
+              void *Object,
+              size_t Size);
+
 /* Add item to front of list. Care: if you pass
  * this function any node other than the first,
  * you will get Y-branches in your list:
@@ -68,12 +88,24 @@ int SLFront(SLLIST **Item,
             void *Object,
             size_t Size);
 
+int SLPoolFront(NODEPOOL *Pool,
+                SLLIST **Item,
+                int Tag,
+                void *Object,
+                size_t Size);
+
 /* Add new item right at the end of the list */
 int SLAppend(SLLIST **Item,
              int Tag,
              void *Object,
              size_t Size);
 
+int SLPoolAppend(NODEPOOL *Pool,
+                 SLLIST **Item,
+                 int Tag,
+                 void *Object,
+                 size_t Size);
+
 /* Replace existing data */
 int SLUpdate(SLLIST *Item,
              int NewTag,
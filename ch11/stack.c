@@ -34,6 +34,27 @@
 
 #include "stack.h"
 
+void StackInit(STACK *Stack, NODEPOOL *Pool)
+{
+  STACK Empty = {0};
+
+  assert(Stack != NULL);
+
+  *Stack = Empty;
+  Stack->Pool = Pool;
+}
+
+void StackInitRing(STACK *Stack, size_t RecordSize)
+{
+  STACK Empty = {0};
+
+  assert(Stack != NULL);
+  assert(RecordSize > 0);
+
+  *Stack = Empty;
+  RingInit(&Stack->Ring, RecordSize);
+}
+
 int StackPush(STACK *Stack,
               int Tag,
               void *Object,
@@ -44,12 +65,31 @@ int StackPush(STACK *Stack,
   assert(Stack != NULL);
   assert(0 == Stack->CheckInit1 && 0 == Stack->CheckInit2);
 
-  ListResult = SLFront(&Stack->StackPtr, Tag, Object, Size);
-
-  if(SL_SUCCESS == ListResult)
+  if(Stack->Ring.RecordSize > 0)
+  {
+    ListResult = RingAddAtBack(&Stack->Ring,
+                               Tag,
+                               Object,
+                               Size);
+    if(RING_SUCCESS == ListResult)
+    {
+      Result = STACK_SUCCESS;
+      ++Stack->NumItems;
+    }
+  }
+  else
   {
-    Result = STACK_SUCCESS;
-    ++Stack->NumItems;
+    ListResult = SLPoolFront(Stack->Pool,
+                             &Stack->StackPtr,
+                             Tag,
+                             Object,
+                             Size);
+
+    if(SL_SUCCESS == ListResult)
+    {
+      Result = STACK_SUCCESS;
+      ++Stack->NumItems;
+    }
   }
 
   return Result;
@@ -64,7 +104,12 @@ int StackPop(void *Object, STACK *Stack)
   assert(Stack != NULL);
   assert(0 == Stack->CheckInit1 && 0 == Stack->CheckInit2);
 
-  if(Stack->NumItems > 0)
+  if(Stack->NumItems > 0 && Stack->Ring.RecordSize > 0)
+  {
+    RingRemoveFromBack(Object, &Stack->Ring);
+    --Stack->NumItems;
+  }
+  else if(Stack->NumItems > 0)
   {
     p = SLGetData(Stack->StackPtr, NULL, &Size);
     if(p != NULL)
@@ -91,10 +136,21 @@ int StackPop(void *Object, STACK *Stack)
 
 void *StackGetData(STACK *Stack, int *Tag, size_t *Size)
 {
+  void *p;
+
   assert(Stack != NULL);
   assert(0 == Stack->CheckInit1 && 0 == Stack->CheckInit2);
 
-  return SLGetData(Stack->StackPtr, Tag, Size);
+  if(Stack->Ring.RecordSize > 0)
+  {
+    p = RingGetDataFromBack(&Stack->Ring, Tag, Size);
+  }
+  else
+  {
+    p = SLGetData(Stack->StackPtr, Tag, Size);
+  }
+
+  return p;
 }
 
 size_t StackCount(STACK *Stack)
@@ -114,4 +170,5 @@ void StackDestroy(STACK *Stack)
     StackPop(NULL, Stack);
   }
   Stack->StackPtr = NULL;
+  RingDestroy(&Stack->Ring);
 }
@@ -32,6 +32,7 @@
 #define STACK_H__
 
 #include "sllist.h"
+#include "ring.h"
 
 #define STACK_SUCCESS       0
 #define STACK_PUSH_FAILURE  1
@@ -46,12 +47,27 @@ typedef struct STACK
 
   SLLIST *StackPtr;
   size_t NumItems;
+  NODEPOOL *Pool;
+  RING Ring;
 
 #ifndef NDEBUG
   int CheckInit2;
 #endif
 } STACK;
 
+/* Prepare an empty stack whose nodes come from
+ * Pool (see SLCreatePool). A stack initialised
+ * to {0} instead simply uses malloc.
+ */
+void StackInit(STACK *Stack, NODEPOOL *Pool);
+
+/* Prepare an empty stack that keeps its items in a
+ * growable array rather than a linked list. Objects
+ * of up to RecordSize bytes are copied into the
+ * array itself; larger ones are rejected.
+ */
+void StackInitRing(STACK *Stack, size_t RecordSize);
+
 int StackPush(STACK *Stack,
               int Tag,
               void *Object,
@@ -33,6 +33,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
 
 #include "stack.h"
 
@@ -45,6 +46,10 @@
 #define ERR_FILE_OPEN_FAILED    3
 #define ERR_ALLOC_FAILED        4
 
+#define BENCH_ITEMS             1000000L
+#define BENCH_ROUNDS            10
+#define BENCH_TAG_LEN           16
+
 int ReadFile(char *Filename,
              char ***Array,
              int *NumRows)
@@ -204,6 +209,78 @@ int Exempt(char *HTMLTag)
   return IsExempt;
 }
 
+/* Push BENCH_ITEMS tags onto the stack and pop them
+ * off again, BENCH_ROUNDS times. Returns seconds taken.
+ */
+double TimeStack(STACK *Stack)
+{
+  char Tag[BENCH_TAG_LEN] = "blockquote";
+  clock_t Start;
+  long i;
+  int Round;
+
+  Start = clock();
+  for(Round = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      if(STACK_SUCCESS !=
+         StackPush(Stack, 0, Tag, sizeof Tag))
+      {
+        printf("Memory loss.\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    while(StackCount(Stack) > 0)
+    {
+      StackPop(Tag, Stack);
+    }
+  }
+
+  return (double)(clock() - Start) / CLOCKS_PER_SEC;
+}
+
+void ReportStack(const char *Name, double Seconds)
+{
+  double Ops = 2.0 * BENCH_ITEMS * BENCH_ROUNDS;
+
+  printf("%-20s %8.3f s", Name, Seconds);
+  if(Seconds > 0)
+  {
+    printf("  %12.0f ops/sec", Ops / Seconds);
+  }
+  printf("\n");
+}
+
+/* Compare the linked and array-backed stacks */
+void Benchmark(void)
+{
+  STACK Stack;
+  NODEPOOL *Pool;
+
+  printf("Stack throughput, %ld items x %d rounds\n\n",
+         BENCH_ITEMS,
+         BENCH_ROUNDS);
+
+  StackInit(&Stack, NULL);
+  ReportStack("Linked (malloc)", TimeStack(&Stack));
+  StackDestroy(&Stack);
+
+  Pool = SLCreatePool(BENCH_TAG_LEN, 0);
+  if(NULL == Pool)
+  {
+    printf("Memory loss.\n");
+    exit(EXIT_FAILURE);
+  }
+  StackInit(&Stack, Pool);
+  ReportStack("Linked (node pool)", TimeStack(&Stack));
+  StackDestroy(&Stack);
+  NPDestroy(Pool);
+
+  StackInitRing(&Stack, BENCH_TAG_LEN);
+  ReportStack("Ring buffer", TimeStack(&Stack));
+  StackDestroy(&Stack);
+}
 
 int main(int argc, char *argv[])
 {
@@ -224,6 +301,12 @@ int main(int argc, char *argv[])
 
   int Status = EXIT_SUCCESS;
 
+  if(argc > 1 && 0 == strcmp(argv[1], "-bench"))
+  {
+    Benchmark();
+    return EXIT_SUCCESS;
+  }
+
   if(argc > 1)
   {
     strcpy(Filename, argv[1]);
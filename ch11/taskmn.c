@@ -0,0 +1,244 @@
+/*  taskmn.c - parallel recursion benchmarks for TASKPOOL
+ *
+ *  TASKPOOL - Work-Stealing Task Pool
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "taskpool.h"
+
+/* The recursive fib() and fact() of Chapter 10, run as
+ * trees of tasks on a work-stealing pool. Below a cutoff
+ * each task just calls the ordinary sequential version,
+ * since a task costs far more than a function call.
+ *
+ * A factorial large enough to be worth timing overflows
+ * any integer type, so fact() here works modulo
+ * ULONG_MAX + 1, which unsigned arithmetic gives us for
+ * free. n! itself has far more factors of two than that
+ * modulus has bits, so it would always come out as 0
+ * and prove nothing; fact() drops the twos and keeps
+ * the odd part of n!. Odd numbers are never 0 modulo a
+ * power of two, and a product of them changes if any
+ * factor is lost or repeated, so the tasks' answer is
+ * still worth checking against the sequential one.
+ *
+ * Usage: taskmn [fib n] [fact n]
+ */
+
+#define DEFAULT_FIB     36
+#define DEFAULT_FACT    200000000L
+#define FIB_CUTOFF      20
+#define FACT_CUTOFF     1000000L
+#define MAX_THREADS     8
+
+static TASKPOOL *Pool;
+
+long fib(int x)
+{
+  if(x == 1 || x == 2)
+  {
+    return 1;
+  }
+  return fib(x - 2) + fib(x - 1);
+}
+
+/* Odd part of the product of lo..hi */
+unsigned long fact(long lo, long hi)
+{
+  unsigned long Accumulator = 1;
+  unsigned long Factor;
+
+  while(hi >= lo && hi > 1)
+  {
+    Factor = (unsigned long)hi--;
+    Accumulator *= Factor / (Factor & -Factor);
+  }
+
+  return Accumulator;
+}
+
+typedef struct FIB_TASK
+{
+  int x;
+  long Result;
+} FIB_TASK;
+
+static void FibTask(void *Args)
+{
+  FIB_TASK *t = Args;
+  FIB_TASK Left;
+  FIB_TASK Right;
+  TASKGROUP Group;
+
+  if(t->x <= FIB_CUTOFF)
+  {
+    t->Result = fib(t->x);
+  }
+  else
+  {
+    /* Offer the bigger half to thieves,
+     * and do the smaller half ourselves.
+     */
+    TaskGroupInit(&Group);
+    Left.x = t->x - 1;
+    Right.x = t->x - 2;
+    TaskSpawn(Pool, &Group, FibTask, &Left);
+    FibTask(&Right);
+    TaskWait(Pool, &Group);
+    t->Result = Left.Result + Right.Result;
+  }
+}
+
+typedef struct FACT_TASK
+{
+  long lo;
+  long hi;
+  unsigned long Result;
+} FACT_TASK;
+
+static void FactTask(void *Args)
+{
+  FACT_TASK *t = Args;
+  FACT_TASK Left;
+  FACT_TASK Right;
+  TASKGROUP Group;
+
+  if(t->hi - t->lo < FACT_CUTOFF)
+  {
+    t->Result = fact(t->lo, t->hi);
+  }
+  else
+  {
+    TaskGroupInit(&Group);
+    Left.lo = t->lo;
+    Left.hi = t->lo + (t->hi - t->lo) / 2;
+    Right.lo = Left.hi + 1;
+    Right.hi = t->hi;
+    TaskSpawn(Pool, &Group, FactTask, &Left);
+    FactTask(&Right);
+    TaskWait(Pool, &Group);
+    t->Result = Left.Result * Right.Result;
+  }
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+
+  timespec_get(&ts, TIME_UTC);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+  FIB_TASK FibRoot;
+  FACT_TASK FactRoot;
+  int FibN = DEFAULT_FIB;
+  long FactN = DEFAULT_FACT;
+  long FibExpected;
+  unsigned long FactExpected;
+  double Start;
+  double FibBase;
+  double FactBase;
+  double FibTime;
+  double FactTime;
+  int Threads;
+  int Status = EXIT_SUCCESS;
+
+  if(argc > 1)
+  {
+    FibN = atoi(argv[1]);
+  }
+  if(argc > 2)
+  {
+    FactN = atol(argv[2]);
+  }
+  if(FibN < 1 || FibN > 46 || FactN < 1)
+  {
+    printf("Usage: taskmn [fib n (1-46)] [fact n]\n");
+    return EXIT_FAILURE;
+  }
+
+  Start = Now();
+  FibExpected = fib(FibN);
+  FibBase = Now() - Start;
+
+  Start = Now();
+  FactExpected = fact(1, FactN);
+  FactBase = Now() - Start;
+
+  printf("Sequential: fib(%d) %.3f s, fact(%ld) %.3f s\n\n",
+         FibN, FibBase, FactN, FactBase);
+  printf("Threads   fib time  speedup   fact time  speedup\n");
+
+  for(Threads = 1;
+      EXIT_SUCCESS == Status && Threads <= MAX_THREADS;
+      Threads *= 2)
+  {
+    Pool = TaskPoolCreate(Threads);
+    if(NULL == Pool)
+    {
+      printf("Couldn't create a pool of %d threads.\n", Threads);
+      return EXIT_FAILURE;
+    }
+
+    FibRoot.x = FibN;
+    Start = Now();
+    FibTask(&FibRoot);
+    FibTime = Now() - Start;
+
+    FactRoot.lo = 1;
+    FactRoot.hi = FactN;
+    Start = Now();
+    FactTask(&FactRoot);
+    FactTime = Now() - Start;
+
+    TaskPoolDestroy(Pool);
+
+    printf("%7d  %8.3f s  %6.2fx  %8.3f s  %6.2fx\n",
+           Threads,
+           FibTime,
+           FibTime > 0 ? FibBase / FibTime : 0.0,
+           FactTime,
+           FactTime > 0 ? FactBase / FactTime : 0.0);
+
+    if(FibRoot.Result != FibExpected ||
+       FactRoot.Result != FactExpected)
+    {
+      printf("Wrong answer!\n");
+      Status = EXIT_FAILURE;
+    }
+  }
+
+  return Status;
+}
@@ -0,0 +1,250 @@
+/*  taskpool.c - source for work-stealing task pool
+ *
+ *  TASKPOOL - Work-Stealing Task Pool
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "taskpool.h"
+
+/* The worker, if any, that this thread is */
+static _Thread_local TASKWORKER *Self;
+
+static void TaskRun(TASK *Task)
+{
+  (*Task->Func)(Task->Args);
+  atomic_fetch_sub_explicit(&Task->Group->Pending,
+                            1,
+                            memory_order_release);
+}
+
+/* Run one task, from our own deque if possible and
+ * otherwise stolen from a randomly chosen victim.
+ * Returns 0 if there was nothing to do.
+ */
+static int TaskRunOne(TASKWORKER *w)
+{
+  TASKPOOL *Pool = w->Pool;
+  TASK Task;
+  int Victim;
+  int Tries;
+  int Found = 0;
+
+  if(WSD_SUCCESS == WSDequeRemoveFromBack(&Task,
+                                          NULL,
+                                          &w->Deque))
+  {
+    Found = 1;
+  }
+  for(Tries = 0;
+      !Found && Tries < 2 * Pool->NumWorkers;
+      Tries++)
+  {
+    w->Seed = w->Seed * 1103515245UL + 12345UL;
+    Victim = (int)((w->Seed >> 16) %
+                   (unsigned long)Pool->NumWorkers);
+    if(Victim != w->Id &&
+       WSD_SUCCESS == WSDequeSteal(&Task,
+                                   NULL,
+                                   &Pool->Worker[Victim].Deque))
+    {
+      Found = 1;
+    }
+  }
+
+  if(Found)
+  {
+    TaskRun(&Task);
+  }
+
+  return Found;
+}
+
+static int TaskWorkerMain(void *Arg)
+{
+  TASKWORKER *w = Arg;
+
+  Self = w;
+  while(!atomic_load_explicit(&w->Pool->Shutdown,
+                              memory_order_acquire))
+  {
+    if(!TaskRunOne(w))
+    {
+      thrd_yield();
+    }
+  }
+
+  return 0;
+}
+
+TASKPOOL *TaskPoolCreate(int NumWorkers)
+{
+  TASKPOOL *Pool;
+  int Started;
+  int i;
+  int Ok = 1;
+
+  assert(NumWorkers > 0);
+
+  Pool = malloc(sizeof *Pool);
+  if(Pool != NULL)
+  {
+    Pool->NumWorkers = NumWorkers;
+    atomic_init(&Pool->Shutdown, 0);
+    Pool->Worker = malloc(NumWorkers * sizeof *Pool->Worker);
+    if(NULL == Pool->Worker)
+    {
+      free(Pool);
+      Pool = NULL;
+    }
+  }
+
+  if(Pool != NULL)
+  {
+    for(i = 0; Ok && i < NumWorkers; i++)
+    {
+      Pool->Worker[i].Pool = Pool;
+      Pool->Worker[i].Id = i;
+      Pool->Worker[i].Seed = 2UL * i + 1;
+      if(WSDequeInit(&Pool->Worker[i].Deque,
+                     sizeof(TASK)) != WSD_SUCCESS)
+      {
+        Ok = 0;
+      }
+    }
+
+    Self = &Pool->Worker[0];
+    for(Started = 1; Ok && Started < NumWorkers; Started++)
+    {
+      if(thrd_create(&Pool->Worker[Started].Thread,
+                     TaskWorkerMain,
+                     &Pool->Worker[Started]) != thrd_success)
+      {
+        Ok = 0;
+        --Started;
+      }
+    }
+
+    if(!Ok)
+    {
+      /* Stop any workers we did start, and undo */
+      atomic_store(&Pool->Shutdown, 1);
+      while(--Started > 0)
+      {
+        thrd_join(Pool->Worker[Started].Thread, NULL);
+      }
+      while(i-- > 0)
+      {
+        WSDequeDestroy(&Pool->Worker[i].Deque);
+      }
+      Self = NULL;
+      free(Pool->Worker);
+      free(Pool);
+      Pool = NULL;
+    }
+  }
+
+  return Pool;
+}
+
+void TaskGroupInit(TASKGROUP *Group)
+{
+  assert(Group != NULL);
+
+  atomic_init(&Group->Pending, 0);
+}
+
+void TaskSpawn(TASKPOOL *Pool,
+               TASKGROUP *Group,
+               TASKFUNC *Func,
+               void *Args)
+{
+  TASK Task;
+
+  assert(Pool != NULL);
+  assert(Self != NULL && Self->Pool == Pool);
+
+  Task.Func = Func;
+  Task.Args = Args;
+  Task.Group = Group;
+
+  atomic_fetch_add_explicit(&Group->Pending,
+                            1,
+                            memory_order_relaxed);
+  if(WSDequeAddAtBack(&Self->Deque,
+                      0,
+                      &Task,
+                      sizeof Task) != WSD_SUCCESS)
+  {
+    TaskRun(&Task);
+  }
+}
+
+void TaskWait(TASKPOOL *Pool, TASKGROUP *Group)
+{
+  assert(Pool != NULL);
+  assert(Self != NULL && Self->Pool == Pool);
+
+  while(atomic_load_explicit(&Group->Pending,
+                             memory_order_acquire) > 0)
+  {
+    if(!TaskRunOne(Self))
+    {
+      thrd_yield();
+    }
+  }
+}
+
+void TaskPoolDestroy(TASKPOOL *Pool)
+{
+  int i;
+
+  if(Pool != NULL)
+  {
+    assert(Self == &Pool->Worker[0]);
+
+    atomic_store_explicit(&Pool->Shutdown,
+                          1,
+                          memory_order_release);
+    for(i = 1; i < Pool->NumWorkers; i++)
+    {
+      thrd_join(Pool->Worker[i].Thread, NULL);
+    }
+    for(i = 0; i < Pool->NumWorkers; i++)
+    {
+      WSDequeDestroy(&Pool->Worker[i].Deque);
+    }
+    Self = NULL;
+    free(Pool->Worker);
+    free(Pool);
+  }
+}
+
+/* end of taskpool.c */
@@ -0,0 +1,111 @@
+/*  taskpool.h - header for work-stealing task pool
+ *
+ *  TASKPOOL - Work-Stealing Task Pool
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#ifndef TASKPOOL_H__
+#define TASKPOOL_H__
+
+/* Needs C11 <threads.h> and <stdatomic.h> */
+#include <threads.h>
+#include <stdatomic.h>
+
+#include "wsdeque.h"
+
+/* A fixed set of worker threads, each owning a WSDEQUE.
+ * A task spawns children onto its own worker's deque;
+ * idle workers steal from the front of other deques,
+ * which is where the oldest, and hence usually the
+ * largest, pieces of work are to be found.
+ *
+ * The thread that creates the pool becomes worker 0,
+ * and only worker threads (that is, the creator and
+ * code running inside tasks) may spawn or wait.
+ */
+
+typedef void TASKFUNC(void *Args);
+
+/* Tasks are spawned into a group, and TaskWait waits
+ * for the whole group. A group must not be reused
+ * until it has been waited for.
+ */
+typedef struct TASKGROUP
+{
+  atomic_long Pending;
+} TASKGROUP;
+
+typedef struct TASK
+{
+  TASKFUNC *Func;
+  void *Args;
+  TASKGROUP *Group;
+} TASK;
+
+typedef struct TASKWORKER
+{
+  struct TASKPOOL *Pool;
+  WSDEQUE Deque;
+  int Id;
+  unsigned long Seed;   /* for picking victims */
+  thrd_t Thread;
+} TASKWORKER;
+
+typedef struct TASKPOOL
+{
+  int NumWorkers;
+  TASKWORKER *Worker;
+  atomic_int Shutdown;
+} TASKPOOL;
+
+/* NumWorkers includes the calling thread.
+ * Returns NULL on failure.
+ */
+TASKPOOL *TaskPoolCreate(int NumWorkers);
+
+void TaskGroupInit(TASKGROUP *Group);
+
+/* Queue Func(Args) to run on some worker. If the task
+ * can't be queued, it is run immediately instead.
+ */
+void TaskSpawn(TASKPOOL *Pool,
+               TASKGROUP *Group,
+               TASKFUNC *Func,
+               void *Args);
+
+/* Run or steal other tasks until every task in
+ * Group has finished.
+ */
+void TaskWait(TASKPOOL *Pool, TASKGROUP *Group);
+
+/* Stop the workers and free the pool. Must be
+ * called by the thread that created it.
+ */
+void TaskPoolDestroy(TASKPOOL *Pool);
+
+#endif
@@ -0,0 +1,834 @@
+/*  tlist.h - typed list, queue and stack templates
+ *
+ *  TLIST - Typed List Templates
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+/* This is a "poor man's template" (compare ALLSORT.H
+ * in Chapter 13) for lists, queues and stacks that
+ * hold one particular type. Each element is stored by
+ * value inside its node, and nodes come from a
+ * NODEPOOL, so adding an element does not call malloc
+ * once the pool has warmed up. To generate a set of
+ * functions, define
+ *
+ *   TL_ETYPE   the element type
+ *   TL_SUFFIX  a suffix for the generated names
+ *
+ * and, optionally,
+ *
+ *   TL_WALK(Tag, Elem, Args)
+ *              an int expression to evaluate for each
+ *              element (Elem is a TL_ETYPE *); the walk
+ *              stops when it is nonzero. Without it,
+ *              no Walk functions are generated.
+ *   TL_PRELUDE storage class for the functions, e.g.
+ *              static. Empty by default, in which case
+ *              include this file in only one source
+ *              file per type.
+ *
+ * then include this file. For example,
+ *
+ *   #define TL_ETYPE   int
+ *   #define TL_SUFFIX  int
+ *   #include "tlist.h"
+ *
+ * gives SLLIST_int, SLAdd_int() and so on. The
+ * macros are undefined again at the end, so the file
+ * can be included once for each type.
+ *
+ * The functions mirror SLLIST, DLLIST, QUEUE and STACK,
+ * except that objects are passed by value, and that
+ * lists do not remember their pool: pass the same
+ * pool (or NULL, for malloc) to every call on a list.
+ */
+
+#ifndef TLIST_H__
+#define TLIST_H__
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "nodepool.h"
+#include "sllist.h"
+#include "dllist.h"
+#include "queue.h"
+#include "stack.h"
+
+#define TL_CAT_(a, b) a ## b
+#define TL_CAT(a, b)  TL_CAT_(a, b)
+#define TL_NAME(a)    TL_CAT(a, TL_CAT(_, TL_SUFFIX))
+
+#endif
+
+#if !defined(TL_ETYPE) || !defined(TL_SUFFIX)
+#error "Please define TL_ETYPE and TL_SUFFIX"
+#endif
+
+#ifndef TL_PRELUDE
+#define TL_PRELUDE
+#endif
+
+#define TL_SLLIST   TL_NAME(SLLIST)
+#define TL_DLLIST   TL_NAME(DLLIST)
+#define TL_QUEUE    TL_NAME(QUEUE)
+#define TL_STACK    TL_NAME(STACK)
+
+typedef struct TL_SLLIST
+{
+  struct TL_SLLIST *Next;
+  int Tag;
+  TL_ETYPE Object;
+} TL_SLLIST;
+
+typedef struct TL_DLLIST
+{
+  struct TL_DLLIST *Prev;
+  struct TL_DLLIST *Next;
+  int Tag;
+  TL_ETYPE Object;
+} TL_DLLIST;
+
+typedef struct TL_QUEUE
+{
+  TL_SLLIST *HeadPtr;
+  TL_SLLIST *TailPtr;
+  size_t NumItems;
+  NODEPOOL *Pool;
+} TL_QUEUE;
+
+typedef struct TL_STACK
+{
+  TL_SLLIST *StackPtr;
+  size_t NumItems;
+  NODEPOOL *Pool;
+} TL_STACK;
+
+/* Get a node from Pool, or from malloc if Pool is NULL.
+ * The pool must have been made for nodes this big.
+ */
+#define TL_NEW(Pool, p) \
+  (assert((Pool) == NULL || (Pool)->HeaderSize >= sizeof *(p)), \
+   (p) = (Pool) != NULL ? NPAlloc(Pool) : malloc(sizeof *(p)))
+
+#define TL_FREE(Pool, p) \
+  ((Pool) != NULL ? NPFree((Pool), (p)) : free(p))
+
+/* ---------------- singly linked list ---------------- */
+
+TL_PRELUDE
+NODEPOOL *TL_NAME(SLCreatePool)(size_t NodesPerSlab)
+{
+  return NPCreate(sizeof(TL_SLLIST), 0, NodesPerSlab);
+}
+
+/* Add new item immediately after current item */
+TL_PRELUDE
+int TL_NAME(SLAdd)(NODEPOOL *Pool,
+                   TL_SLLIST **Item,
+                   int Tag,
+                   TL_ETYPE Object)
+{
+  TL_SLLIST *NewItem;
+  int Result = SL_SUCCESS;
+
+  assert(Item != NULL);
+
+  if(TL_NEW(Pool, NewItem) != NULL)
+  {
+    NewItem->Tag = Tag;
+    NewItem->Object = Object;
+    if(NULL == *Item)
+    {
+      NewItem->Next = NULL;
+      *Item = NewItem;
+    }
+    else
+    {
+      NewItem->Next = (*Item)->Next;
+      (*Item)->Next = NewItem;
+    }
+  }
+  else
+  {
+    Result = SL_NO_MEM;
+  }
+
+  return Result;
+}
+
+/* Add item to front of list; see SLFront */
+TL_PRELUDE
+int TL_NAME(SLFront)(NODEPOOL *Pool,
+                     TL_SLLIST **Item,
+                     int Tag,
+                     TL_ETYPE Object)
+{
+  TL_SLLIST *p = NULL;
+  int Result;
+
+  assert(Item != NULL);
+
+  Result = TL_NAME(SLAdd)(Pool, &p, Tag, Object);
+  if(SL_SUCCESS == Result)
+  {
+    p->Next = *Item;
+    *Item = p;
+  }
+
+  return Result;
+}
+
+/* Add new item right at the end of the list */
+TL_PRELUDE
+int TL_NAME(SLAppend)(NODEPOOL *Pool,
+                      TL_SLLIST **Item,
+                      int Tag,
+                      TL_ETYPE Object)
+{
+  TL_SLLIST *EndSeeker;
+  int Result;
+
+  assert(Item != NULL);
+
+  if(NULL == *Item)
+  {
+    Result = TL_NAME(SLAdd)(Pool, Item, Tag, Object);
+  }
+  else
+  {
+    EndSeeker = *Item;
+    while(EndSeeker->Next != NULL)
+    {
+      EndSeeker = EndSeeker->Next;
+    }
+    Result = TL_NAME(SLAdd)(Pool, &EndSeeker, Tag, Object);
+  }
+
+  return Result;
+}
+
+TL_PRELUDE
+void TL_NAME(SLUpdate)(TL_SLLIST *Item,
+                       int NewTag,
+                       TL_ETYPE NewObject)
+{
+  assert(Item != NULL);
+
+  Item->Tag = NewTag;
+  Item->Object = NewObject;
+}
+
+TL_PRELUDE
+TL_ETYPE *TL_NAME(SLGetData)(TL_SLLIST *Item, int *Tag)
+{
+  TL_ETYPE *p = NULL;
+
+  if(Item != NULL)
+  {
+    if(Tag != NULL)
+    {
+      *Tag = Item->Tag;
+    }
+    p = &Item->Object;
+  }
+
+  return p;
+}
+
+/* Delete this item. Returns pointer to next item -
+ * caller's responsibility to maintain list integrity.
+ */
+TL_PRELUDE
+TL_SLLIST *TL_NAME(SLDeleteThis)(NODEPOOL *Pool, TL_SLLIST *Item)
+{
+  TL_SLLIST *NextNode = NULL;
+
+  if(Item != NULL)
+  {
+    NextNode = Item->Next;
+    TL_FREE(Pool, Item);
+  }
+
+  return NextNode;
+}
+
+TL_PRELUDE
+void TL_NAME(SLDeleteNext)(NODEPOOL *Pool, TL_SLLIST *Item)
+{
+  if(Item != NULL && Item->Next != NULL)
+  {
+    Item->Next = TL_NAME(SLDeleteThis)(Pool, Item->Next);
+  }
+}
+
+TL_PRELUDE
+void TL_NAME(SLDestroy)(NODEPOOL *Pool, TL_SLLIST **List)
+{
+  TL_SLLIST *Next;
+
+  assert(List != NULL);
+
+  Next = *List;
+  while(Next != NULL)
+  {
+    Next = TL_NAME(SLDeleteThis)(Pool, Next);
+  }
+  *List = NULL;
+}
+
+#ifdef TL_WALK
+/* Evaluate TL_WALK for each item */
+TL_PRELUDE
+int TL_NAME(SLWalk)(TL_SLLIST *List, void *Args)
+{
+  TL_SLLIST *ThisItem;
+  int Result = 0;
+
+  for(ThisItem = List;
+      0 == Result && ThisItem != NULL;
+      ThisItem = ThisItem->Next)
+  {
+    Result = TL_WALK(ThisItem->Tag, &ThisItem->Object, Args);
+  }
+
+  return Result;
+}
+#endif
+
+/* ---------------- doubly linked list ---------------- */
+
+TL_PRELUDE
+NODEPOOL *TL_NAME(DLCreatePool)(size_t NodesPerSlab)
+{
+  return NPCreate(sizeof(TL_DLLIST), 0, NodesPerSlab);
+}
+
+TL_PRELUDE
+TL_DLLIST *TL_NAME(DLCreate)(NODEPOOL *Pool,
+                             int Tag,
+                             TL_ETYPE Object)
+{
+  TL_DLLIST *NewItem;
+
+  if(TL_NEW(Pool, NewItem) != NULL)
+  {
+    NewItem->Prev = NewItem->Next = NULL;
+    NewItem->Tag = Tag;
+    NewItem->Object = Object;
+  }
+
+  return NewItem;
+}
+
+TL_PRELUDE
+int TL_NAME(DLInsertBefore)(TL_DLLIST *ExistingItem,
+                            TL_DLLIST *NewItem)
+{
+  int Result = DL_SUCCESS;
+
+  if(ExistingItem != NULL && NewItem != NULL)
+  {
+    NewItem->Next = ExistingItem;
+    NewItem->Prev = ExistingItem->Prev;
+    ExistingItem->Prev = NewItem;
+    if(NewItem->Prev != NULL)
+    {
+      NewItem->Prev->Next = NewItem;
+    }
+  }
+  else
+  {
+    Result = DL_NULL_POINTER;
+  }
+
+  return Result;
+}
+
+TL_PRELUDE
+int TL_NAME(DLInsertAfter)(TL_DLLIST *ExistingItem,
+                           TL_DLLIST *NewItem)
+{
+  int Result = DL_SUCCESS;
+
+  if(ExistingItem != NULL && NewItem != NULL)
+  {
+    NewItem->Prev = ExistingItem;
+    NewItem->Next = ExistingItem->Next;
+    ExistingItem->Next = NewItem;
+    if(NewItem->Next != NULL)
+    {
+      NewItem->Next->Prev = NewItem;
+    }
+  }
+  else
+  {
+    Result = DL_NULL_POINTER;
+  }
+
+  return Result;
+}
+
+TL_PRELUDE
+TL_DLLIST *TL_NAME(DLGetFirst)(TL_DLLIST *List)
+{
+  if(List != NULL)
+  {
+    while(List->Prev != NULL)
+    {
+      List = List->Prev;
+    }
+  }
+  return List;
+}
+
+TL_PRELUDE
+TL_DLLIST *TL_NAME(DLGetLast)(TL_DLLIST *List)
+{
+  if(List != NULL)
+  {
+    while(List->Next != NULL)
+    {
+      List = List->Next;
+    }
+  }
+  return List;
+}
+
+/* Add new item immediately after current item */
+TL_PRELUDE
+int TL_NAME(DLAddAfter)(NODEPOOL *Pool,
+                        TL_DLLIST **Item,
+                        int Tag,
+                        TL_ETYPE Object)
+{
+  TL_DLLIST *p;
+  int Result = DL_SUCCESS;
+
+  assert(Item != NULL);
+
+  p = TL_NAME(DLCreate)(Pool, Tag, Object);
+  if(p != NULL)
+  {
+    if(NULL == *Item)
+    {
+      *Item = p;
+    }
+    else
+    {
+      TL_NAME(DLInsertAfter)(*Item, p);
+    }
+  }
+  else
+  {
+    Result = DL_NO_MEM;
+  }
+
+  return Result;
+}
+
+/* Add new item immediately before current item */
+TL_PRELUDE
+int TL_NAME(DLAddBefore)(NODEPOOL *Pool,
+                         TL_DLLIST **Item,
+                         int Tag,
+                         TL_ETYPE Object)
+{
+  TL_DLLIST *p;
+  int Result = DL_SUCCESS;
+
+  assert(Item != NULL);
+
+  p = TL_NAME(DLCreate)(Pool, Tag, Object);
+  if(p != NULL)
+  {
+    if(NULL == *Item)
+    {
+      *Item = p;
+    }
+    else
+    {
+      TL_NAME(DLInsertBefore)(*Item, p);
+    }
+  }
+  else
+  {
+    Result = DL_NO_MEM;
+  }
+
+  return Result;
+}
+
+/* Add item at start of list */
+TL_PRELUDE
+int TL_NAME(DLPrepend)(NODEPOOL *Pool,
+                       TL_DLLIST **Item,
+                       int Tag,
+                       TL_ETYPE Object)
+{
+  TL_DLLIST *Start;
+
+  assert(Item != NULL);
+
+  Start = TL_NAME(DLGetFirst)(*Item);
+
+  return TL_NAME(DLAddBefore)(Pool,
+                              *Item != NULL ? &Start : Item,
+                              Tag,
+                              Object);
+}
+
+/* Add item at end of list */
+TL_PRELUDE
+int TL_NAME(DLAppend)(NODEPOOL *Pool,
+                      TL_DLLIST **Item,
+                      int Tag,
+                      TL_ETYPE Object)
+{
+  TL_DLLIST *End;
+
+  assert(Item != NULL);
+
+  End = TL_NAME(DLGetLast)(*Item);
+
+  return TL_NAME(DLAddAfter)(Pool,
+                             *Item != NULL ? &End : Item,
+                             Tag,
+                             Object);
+}
+
+TL_PRELUDE
+void TL_NAME(DLUpdate)(TL_DLLIST *Item,
+                       int NewTag,
+                       TL_ETYPE NewObject)
+{
+  assert(Item != NULL);
+
+  Item->Tag = NewTag;
+  Item->Object = NewObject;
+}
+
+TL_PRELUDE
+TL_ETYPE *TL_NAME(DLGetData)(TL_DLLIST *Item, int *Tag)
+{
+  TL_ETYPE *p = NULL;
+
+  if(Item != NULL)
+  {
+    if(Tag != NULL)
+    {
+      *Tag = Item->Tag;
+    }
+    p = &Item->Object;
+  }
+
+  return p;
+}
+
+/* Extract one item from the list, without destroying it */
+TL_PRELUDE
+TL_DLLIST *TL_NAME(DLExtract)(TL_DLLIST *Item)
+{
+  if(Item != NULL)
+  {
+    if(Item->Prev != NULL)
+    {
+      Item->Prev->Next = Item->Next;
+    }
+    if(Item->Next != NULL)
+    {
+      Item->Next->Prev = Item->Prev;
+    }
+    Item->Prev = Item->Next = NULL;
+  }
+  return Item;
+}
+
+TL_PRELUDE
+void TL_NAME(DLDelete)(NODEPOOL *Pool, TL_DLLIST *Item)
+{
+  if(Item != NULL)
+  {
+    TL_NAME(DLExtract)(Item);
+    TL_FREE(Pool, Item);
+  }
+}
+
+TL_PRELUDE
+void TL_NAME(DLDestroy)(NODEPOOL *Pool, TL_DLLIST **List)
+{
+  TL_DLLIST *Marker;
+  TL_DLLIST *Next;
+
+  assert(List != NULL);
+
+  Marker = TL_NAME(DLGetFirst)(*List);
+  while(Marker != NULL)
+  {
+    Next = Marker->Next;
+    TL_FREE(Pool, Marker);
+    Marker = Next;
+  }
+  *List = NULL;
+}
+
+TL_PRELUDE
+TL_DLLIST *TL_NAME(DLJoin)(TL_DLLIST *Left, TL_DLLIST *Right)
+{
+  if(Left != NULL && Right != NULL)
+  {
+    Left = TL_NAME(DLGetLast)(Left);
+    Right = TL_NAME(DLGetFirst)(Right);
+
+    Left->Next = Right;
+    Right->Prev = Left;
+  }
+
+  return TL_NAME(DLGetFirst)(Left != NULL ? Left : Right);
+}
+
+TL_PRELUDE
+int TL_NAME(DLCount)(TL_DLLIST *List)
+{
+  int Items = 0;
+
+  for(List = TL_NAME(DLGetFirst)(List);
+      List != NULL;
+      List = List->Next)
+  {
+    ++Items;
+  }
+
+  return Items;
+}
+
+#ifdef TL_WALK
+TL_PRELUDE
+int TL_NAME(DLWalk)(TL_DLLIST *List, void *Args)
+{
+  TL_DLLIST *ThisItem;
+  int Result = 0;
+
+  for(ThisItem = TL_NAME(DLGetFirst)(List);
+      0 == Result && ThisItem != NULL;
+      ThisItem = ThisItem->Next)
+  {
+    Result = TL_WALK(ThisItem->Tag, &ThisItem->Object, Args);
+  }
+
+  return Result;
+}
+#endif
+
+/* ---------------- queue ---------------- */
+
+TL_PRELUDE
+void TL_NAME(QueueInit)(TL_QUEUE *Queue, NODEPOOL *Pool)
+{
+  assert(Queue != NULL);
+
+  Queue->HeadPtr = Queue->TailPtr = NULL;
+  Queue->NumItems = 0;
+  Queue->Pool = Pool;
+}
+
+TL_PRELUDE
+int TL_NAME(QueueAdd)(TL_QUEUE *Queue, int Tag, TL_ETYPE Object)
+{
+  int Result = QUEUE_ADD_FAILURE;
+
+  assert(Queue != NULL);
+
+  if(SL_SUCCESS == TL_NAME(SLAdd)(Queue->Pool,
+                                  &Queue->TailPtr,
+                                  Tag,
+                                  Object))
+  {
+    if(0 == Queue->NumItems)
+    {
+      Queue->HeadPtr = Queue->TailPtr;
+    }
+    else
+    {
+      Queue->TailPtr = Queue->TailPtr->Next;
+    }
+
+    Result = QUEUE_SUCCESS;
+    ++Queue->NumItems;
+  }
+
+  return Result;
+}
+
+/* Copy the front item into *Object (if non-NULL)
+ * and remove it.
+ */
+TL_PRELUDE
+int TL_NAME(QueueRemove)(TL_ETYPE *Object, TL_QUEUE *Queue)
+{
+  int Result = QUEUE_EMPTY;
+
+  assert(Queue != NULL);
+
+  if(Queue->NumItems > 0)
+  {
+    if(Object != NULL)
+    {
+      *Object = Queue->HeadPtr->Object;
+    }
+    Queue->HeadPtr = TL_NAME(SLDeleteThis)(Queue->Pool,
+                                           Queue->HeadPtr);
+    if(0 == --Queue->NumItems)
+    {
+      Queue->TailPtr = NULL;
+    }
+    Result = QUEUE_SUCCESS;
+  }
+
+  return Result;
+}
+
+TL_PRELUDE
+TL_ETYPE *TL_NAME(QueueGetData)(TL_QUEUE *Queue, int *Tag)
+{
+  assert(Queue != NULL);
+
+  return TL_NAME(SLGetData)(Queue->HeadPtr, Tag);
+}
+
+TL_PRELUDE
+size_t TL_NAME(QueueCount)(TL_QUEUE *Queue)
+{
+  assert(Queue != NULL);
+
+  return Queue->NumItems;
+}
+
+TL_PRELUDE
+void TL_NAME(QueueDestroy)(TL_QUEUE *Queue)
+{
+  assert(Queue != NULL);
+
+  TL_NAME(SLDestroy)(Queue->Pool, &Queue->HeadPtr);
+  Queue->TailPtr = NULL;
+  Queue->NumItems = 0;
+}
+
+/* ---------------- stack ---------------- */
+
+TL_PRELUDE
+void TL_NAME(StackInit)(TL_STACK *Stack, NODEPOOL *Pool)
+{
+  assert(Stack != NULL);
+
+  Stack->StackPtr = NULL;
+  Stack->NumItems = 0;
+  Stack->Pool = Pool;
+}
+
+TL_PRELUDE
+int TL_NAME(StackPush)(TL_STACK *Stack, int Tag, TL_ETYPE Object)
+{
+  int Result = STACK_PUSH_FAILURE;
+
+  assert(Stack != NULL);
+
+  if(SL_SUCCESS == TL_NAME(SLFront)(Stack->Pool,
+                                    &Stack->StackPtr,
+                                    Tag,
+                                    Object))
+  {
+    Result = STACK_SUCCESS;
+    ++Stack->NumItems;
+  }
+
+  return Result;
+}
+
+/* Copy the top item into *Object (if non-NULL)
+ * and remove it.
+ */
+TL_PRELUDE
+int TL_NAME(StackPop)(TL_ETYPE *Object, TL_STACK *Stack)
+{
+  int Result = STACK_EMPTY;
+
+  assert(Stack != NULL);
+
+  if(Stack->NumItems > 0)
+  {
+    if(Object != NULL)
+    {
+      *Object = Stack->StackPtr->Object;
+    }
+    Stack->StackPtr = TL_NAME(SLDeleteThis)(Stack->Pool,
+                                            Stack->StackPtr);
+    --Stack->NumItems;
+    Result = STACK_SUCCESS;
+  }
+
+  return Result;
+}
+
+TL_PRELUDE
+TL_ETYPE *TL_NAME(StackGetData)(TL_STACK *Stack, int *Tag)
+{
+  assert(Stack != NULL);
+
+  return TL_NAME(SLGetData)(Stack->StackPtr, Tag);
+}
+
+TL_PRELUDE
+size_t TL_NAME(StackCount)(TL_STACK *Stack)
+{
+  assert(Stack != NULL);
+
+  return Stack->NumItems;
+}
+
+TL_PRELUDE
+void TL_NAME(StackDestroy)(TL_STACK *Stack)
+{
+  assert(Stack != NULL);
+
+  TL_NAME(SLDestroy)(Stack->Pool, &Stack->StackPtr);
+  Stack->NumItems = 0;
+}
+
+#undef TL_NEW
+#undef TL_FREE
+#undef TL_SLLIST
+#undef TL_DLLIST
+#undef TL_QUEUE
+#undef TL_STACK
+#undef TL_ETYPE
+#undef TL_SUFFIX
+#undef TL_WALK
+#undef TL_PRELUDE
+
+/* end of tlist.h */
@@ -0,0 +1,295 @@
+/*  tlistmn.c - test driver for typed list templates
+ *
+ *  TLIST - Typed List Templates
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sllist.h"
+#include "queue.h"
+
+/* Lists of int, whose walk adds up the elements */
+#define TL_ETYPE        int
+#define TL_SUFFIX       int
+#define TL_WALK(Tag, Elem, Args) \
+  (*(long *)(Args) += *(Elem), 0)
+#include "tlist.h"
+
+typedef struct POINT
+{
+  double x;
+  double y;
+} POINT;
+
+/* Lists of POINT, whose walk prints them */
+#define TL_ETYPE        POINT
+#define TL_SUFFIX       pt
+#define TL_WALK(Tag, Elem, Args) \
+  (printf("%s %d: (%g, %g)\n", \
+          (char *)(Args), (Tag), (Elem)->x, (Elem)->y) < 0)
+#include "tlist.h"
+
+#define BENCH_ITEMS   1000000L
+#define BENCH_ROUNDS  10
+
+int SumInt(int Tag, void *Object, void *Args)
+{
+  (void)Tag;
+  *(long *)Args += *(int *)Object;
+  return 0;
+}
+
+void BenchFail(void)
+{
+  printf("Memory loss.\n");
+  exit(EXIT_FAILURE);
+}
+
+void ReportList(const char *Name, clock_t Start)
+{
+  printf("%-36s %8.3f s\n",
+         Name,
+         (double)(clock() - Start) / CLOCKS_PER_SEC);
+}
+
+/* Compare the generic containers, at their best (with
+ * a node pool), against the int instantiations.
+ */
+void Benchmark(void)
+{
+  NODEPOOL *Pool;
+  SLLIST *List = NULL;
+  SLLIST *Tail = NULL;
+  SLLIST_int *IntList = NULL;
+  SLLIST_int *IntTail = NULL;
+  QUEUE Queue;
+  QUEUE_int IntQueue;
+  clock_t Start;
+  long Sum;
+  long Sum2;
+  long i;
+  int Round;
+  int n;
+
+  printf("%ld ints, %d rounds\n\n", BENCH_ITEMS, BENCH_ROUNDS);
+
+  Pool = SLCreatePool(sizeof(int), 0);
+  if(NULL == Pool)
+  {
+    BenchFail();
+  }
+  Start = clock();
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    n = (int)i;
+    if(SLPoolAdd(Pool, &Tail, 0, &n, sizeof n) != SL_SUCCESS)
+    {
+      BenchFail();
+    }
+    if(NULL == List)
+    {
+      List = Tail;
+    }
+    else
+    {
+      Tail = Tail->Next;
+    }
+  }
+  ReportList("SLLIST build (node pool)", Start);
+
+  Start = clock();
+  for(Round = 0, Sum = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    SLWalk(List, SumInt, &Sum);
+  }
+  ReportList("SLWalk", Start);
+  SLDestroy(&List);
+  NPDestroy(Pool);
+
+  Pool = SLCreatePool_int(0);
+  if(NULL == Pool)
+  {
+    BenchFail();
+  }
+  Start = clock();
+  for(i = 0; i < BENCH_ITEMS; i++)
+  {
+    if(SLAdd_int(Pool, &IntTail, 0, (int)i) != SL_SUCCESS)
+    {
+      BenchFail();
+    }
+    if(NULL == IntList)
+    {
+      IntList = IntTail;
+    }
+    else
+    {
+      IntTail = IntTail->Next;
+    }
+  }
+  ReportList("SLLIST_int build", Start);
+
+  Start = clock();
+  for(Round = 0, Sum2 = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    SLWalk_int(IntList, &Sum2);
+  }
+  ReportList("SLWalk_int", Start);
+  SLDestroy_int(Pool, &IntList);
+  NPDestroy(Pool);
+
+  if(Sum != Sum2)
+  {
+    printf("Sums differ: %ld and %ld\n", Sum, Sum2);
+  }
+
+  Pool = SLCreatePool(sizeof(int), 0);
+  if(NULL == Pool)
+  {
+    BenchFail();
+  }
+  QueueInit(&Queue, Pool);
+  Start = clock();
+  for(Round = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      n = (int)i;
+      if(QueueAdd(&Queue, 0, &n, sizeof n) != QUEUE_SUCCESS)
+      {
+        BenchFail();
+      }
+    }
+    while(QueueCount(&Queue) > 0)
+    {
+      QueueRemove(&n, &Queue);
+    }
+  }
+  ReportList("QUEUE add/remove (node pool)", Start);
+  QueueDestroy(&Queue);
+  NPDestroy(Pool);
+
+  Pool = SLCreatePool_int(0);
+  if(NULL == Pool)
+  {
+    BenchFail();
+  }
+  QueueInit_int(&IntQueue, Pool);
+  Start = clock();
+  for(Round = 0; Round < BENCH_ROUNDS; Round++)
+  {
+    for(i = 0; i < BENCH_ITEMS; i++)
+    {
+      if(QueueAdd_int(&IntQueue, 0, (int)i) != QUEUE_SUCCESS)
+      {
+        BenchFail();
+      }
+    }
+    while(QueueCount_int(&IntQueue) > 0)
+    {
+      QueueRemove_int(&n, &IntQueue);
+    }
+  }
+  ReportList("QUEUE_int add/remove", Start);
+  QueueDestroy_int(&IntQueue);
+  NPDestroy(Pool);
+}
+
+int main(int argc, char *argv[])
+{
+  POINT Corner[] =
+  {
+    { 0.0, 0.0 },
+    { 4.0, 0.0 },
+    { 4.0, 3.0 },
+    { 0.0, 3.0 }
+  };
+  size_t NumCorners = sizeof Corner / sizeof Corner[0];
+  NODEPOOL *Pool;
+  DLLIST_pt *Shape = NULL;
+  DLLIST_pt *Item;
+  STACK_int Stack;
+  size_t i;
+  int n;
+
+  if(argc > 1 && 0 == strcmp(argv[1], "-bench"))
+  {
+    Benchmark();
+    return EXIT_SUCCESS;
+  }
+
+  Pool = DLCreatePool_pt(0);
+  if(NULL == Pool)
+  {
+    BenchFail();
+  }
+
+  for(i = 0; i < NumCorners; i++)
+  {
+    if(DLAppend_pt(Pool, &Shape, (int)i, Corner[i]) != DL_SUCCESS)
+    {
+      BenchFail();
+    }
+  }
+  DLWalk_pt(Shape, "Corner");
+
+  /* Cut a corner off the rectangle */
+  Item = Shape->Next->Next;
+  Corner[0].x = 4.0;
+  Corner[0].y = 2.0;
+  Corner[1].x = 3.0;
+  Corner[1].y = 3.0;
+  DLAddBefore_pt(Pool, &Item, 4, Corner[0]);
+  DLAddAfter_pt(Pool, &Item, 5, Corner[1]);
+  DLDelete_pt(Pool, Item);
+  printf("\nNow %d corners:\n", DLCount_pt(Shape));
+  DLWalk_pt(Shape, "Corner");
+
+  DLDestroy_pt(Pool, &Shape);
+  NPDestroy(Pool);
+
+  /* A stack of int, using malloc for its nodes */
+  StackInit_int(&Stack, NULL);
+  for(n = 1; n <= 5; n++)
+  {
+    StackPush_int(&Stack, 0, n * n);
+  }
+  printf("\nSquares, largest first:");
+  while(StackPop_int(&n, &Stack) == STACK_SUCCESS)
+  {
+    printf(" %d", n);
+  }
+  printf("\n");
+  StackDestroy_int(&Stack);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,630 @@
+/*  udllist.c - source for unrolled double-linked list
+ *
+ *  UDLLIST - Unrolled Double-Linked List Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "udllist.h"
+
+typedef struct UDL_SLOT
+{
+  int Tag;
+  size_t Size;
+} UDL_SLOT;
+
+typedef union UDL_ALIGN
+{
+  long l;
+  double d;
+  long double ld;
+  void *p;
+  void (*f)(void);
+} UDL_ALIGN;
+
+#define UDL_ROUND(n) \
+  ((((n) + sizeof(UDL_ALIGN) - 1) / sizeof(UDL_ALIGN)) \
+    * sizeof(UDL_ALIGN))
+
+#define UDL_DATA_OFFSET  UDL_ROUND(sizeof(UDL_SLOT))
+#define UDL_SLOTS_OFFSET UDL_ROUND(sizeof(UDL_CHUNK))
+
+static UDL_SLOT *UDLSlot(UDLLIST *List,
+                         UDL_CHUNK *Chunk,
+                         size_t Index)
+{
+  return (UDL_SLOT *)((unsigned char *)Chunk +
+                      UDL_SLOTS_OFFSET +
+                      Index * List->SlotSize);
+}
+
+static void *UDLSlotData(UDL_SLOT *Slot)
+{
+  return (unsigned char *)Slot + UDL_DATA_OFFSET;
+}
+
+/* Open a gap of one slot at Index, or close the
+ * one there, by sliding the rest of the chunk.
+ */
+static void UDLShift(UDLLIST *List,
+                     UDL_CHUNK *Chunk,
+                     size_t Index,
+                     int Open)
+{
+  UDL_SLOT *At = UDLSlot(List, Chunk, Index);
+  UDL_SLOT *Beyond = UDLSlot(List, Chunk, Index + 1);
+  size_t Bytes = (Chunk->Count - Index - (Open ? 0 : 1)) *
+                 List->SlotSize;
+
+  if(Open)
+  {
+    memmove(Beyond, At, Bytes);
+  }
+  else
+  {
+    memmove(At, Beyond, Bytes);
+  }
+}
+
+/* Allocate an empty chunk and link it in after
+ * Prev (or at the front, if Prev is NULL).
+ */
+static UDL_CHUNK *UDLNewChunk(UDLLIST *List, UDL_CHUNK *Prev)
+{
+  UDL_CHUNK *Chunk;
+
+  Chunk = malloc(UDL_SLOTS_OFFSET +
+                 List->ChunkCapacity * List->SlotSize);
+  if(Chunk != NULL)
+  {
+    Chunk->Count = 0;
+    Chunk->Prev = Prev;
+    Chunk->Next = Prev != NULL ? Prev->Next : List->First;
+    if(Chunk->Prev != NULL)
+    {
+      Chunk->Prev->Next = Chunk;
+    }
+    else
+    {
+      List->First = Chunk;
+    }
+    if(Chunk->Next != NULL)
+    {
+      Chunk->Next->Prev = Chunk;
+    }
+    else
+    {
+      List->Last = Chunk;
+    }
+  }
+
+  return Chunk;
+}
+
+static void UDLFreeChunk(UDLLIST *List, UDL_CHUNK *Chunk)
+{
+  if(Chunk->Prev != NULL)
+  {
+    Chunk->Prev->Next = Chunk->Next;
+  }
+  else
+  {
+    List->First = Chunk->Next;
+  }
+  if(Chunk->Next != NULL)
+  {
+    Chunk->Next->Prev = Chunk->Prev;
+  }
+  else
+  {
+    List->Last = Chunk->Prev;
+  }
+  free(Chunk);
+}
+
+/* Store an item at Index within Chunk, which must
+ * have room for it.
+ */
+static void UDLStore(UDLLIST *List,
+                     UDL_CHUNK *Chunk,
+                     size_t Index,
+                     int Tag,
+                     void *Object,
+                     size_t Size)
+{
+  UDL_SLOT *Slot;
+
+  assert(Chunk->Count < List->ChunkCapacity);
+  assert(Index <= Chunk->Count);
+
+  if(Index < Chunk->Count)
+  {
+    UDLShift(List, Chunk, Index, 1);
+  }
+  Slot = UDLSlot(List, Chunk, Index);
+  Slot->Tag = Tag;
+  Slot->Size = Size;
+  memcpy(UDLSlotData(Slot), Object, Size);
+  ++Chunk->Count;
+  ++List->NumItems;
+}
+
+/* Insert an item so that it ends up at *Pos, which
+ * may be one past the last slot of its chunk. A full
+ * chunk is split in two first, and Pos adjusted.
+ */
+static int UDLInsertAt(UDLLIST *List,
+                       UDL_POS *Pos,
+                       int Tag,
+                       void *Object,
+                       size_t Size)
+{
+  UDL_CHUNK *Chunk = Pos->Chunk;
+  UDL_CHUNK *NewChunk;
+  size_t Keep;
+  int Result = UDL_SUCCESS;
+
+  if(Size > List->RecordSize)
+  {
+    Result = UDL_TOO_BIG;
+  }
+  else if(Chunk->Count == List->ChunkCapacity)
+  {
+    NewChunk = UDLNewChunk(List, Chunk);
+    if(NULL == NewChunk)
+    {
+      Result = UDL_NO_MEM;
+    }
+    else if(Pos->Index == Chunk->Count)
+    {
+      /* Adding at the very end: start afresh, so that
+       * a run of appends leaves the chunks full.
+       */
+      Pos->Chunk = NewChunk;
+      Pos->Index = 0;
+    }
+    else
+    {
+      Keep = Chunk->Count / 2;
+      NewChunk->Count = Chunk->Count - Keep;
+      memcpy(UDLSlot(List, NewChunk, 0),
+             UDLSlot(List, Chunk, Keep),
+             NewChunk->Count * List->SlotSize);
+      Chunk->Count = Keep;
+      if(Pos->Index > Keep)
+      {
+        Pos->Chunk = NewChunk;
+        Pos->Index -= Keep;
+      }
+    }
+  }
+
+  if(UDL_SUCCESS == Result)
+  {
+    UDLStore(List, Pos->Chunk, Pos->Index, Tag, Object, Size);
+  }
+
+  return Result;
+}
+
+void UDLInit(UDLLIST *List,
+             size_t RecordSize,
+             size_t ChunkCapacity)
+{
+  assert(List != NULL);
+
+  List->First = List->Last = NULL;
+  List->NumItems = 0;
+  List->RecordSize = RecordSize;
+  List->SlotSize = UDL_DATA_OFFSET + UDL_ROUND(RecordSize);
+  List->ChunkCapacity = ChunkCapacity > 0 ?
+                        ChunkCapacity :
+                        UDL_DEFAULT_CHUNK;
+}
+
+int UDLPrepend(UDLLIST *List,
+               int Tag,
+               void *Object,
+               size_t Size)
+{
+  UDL_POS Pos = {0};
+
+  return UDLInsertAfter(List, &Pos, Tag, Object, Size);
+}
+
+int UDLAppend(UDLLIST *List,
+              int Tag,
+              void *Object,
+              size_t Size)
+{
+  UDL_POS Pos = {0};
+
+  return UDLInsertBefore(List, &Pos, Tag, Object, Size);
+}
+
+int UDLInsertBefore(UDLLIST *List,
+                    UDL_POS *Pos,
+                    int Tag,
+                    void *Object,
+                    size_t Size)
+{
+  UDL_POS At;
+  int Result = UDL_SUCCESS;
+
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  At = *Pos;
+  if(NULL == At.Chunk)
+  {
+    /* Before "nowhere" is the end of the list */
+    At.Chunk = List->Last;
+    if(NULL == At.Chunk)
+    {
+      At.Chunk = UDLNewChunk(List, NULL);
+      if(NULL == At.Chunk)
+      {
+        Result = UDL_NO_MEM;
+      }
+    }
+    if(At.Chunk != NULL)
+    {
+      At.Index = At.Chunk->Count;
+    }
+  }
+
+  if(UDL_SUCCESS == Result)
+  {
+    Result = UDLInsertAt(List, &At, Tag, Object, Size);
+  }
+  if(UDL_SUCCESS == Result)
+  {
+    *Pos = At;
+  }
+  else if(List->First != NULL && 0 == List->First->Count)
+  {
+    UDLFreeChunk(List, List->First);
+  }
+
+  return Result;
+}
+
+int UDLInsertAfter(UDLLIST *List,
+                   UDL_POS *Pos,
+                   int Tag,
+                   void *Object,
+                   size_t Size)
+{
+  UDL_POS At;
+  int Result = UDL_SUCCESS;
+
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  At = *Pos;
+  if(At.Chunk != NULL)
+  {
+    ++At.Index;
+  }
+  else
+  {
+    /* After "nowhere" is the start of the list. A
+     * full first chunk gets a new one in front of it,
+     * rather than being split.
+     */
+    At.Chunk = List->First;
+    At.Index = 0;
+    if(NULL == At.Chunk ||
+       At.Chunk->Count == List->ChunkCapacity)
+    {
+      At.Chunk = UDLNewChunk(List, NULL);
+      if(NULL == At.Chunk)
+      {
+        Result = UDL_NO_MEM;
+      }
+    }
+  }
+
+  if(UDL_SUCCESS == Result)
+  {
+    Result = UDLInsertAt(List, &At, Tag, Object, Size);
+  }
+  if(UDL_SUCCESS == Result)
+  {
+    *Pos = At;
+  }
+  else if(List->First != NULL && 0 == List->First->Count)
+  {
+    UDLFreeChunk(List, List->First);
+  }
+
+  return Result;
+}
+
+int UDLUpdate(UDLLIST *List,
+              UDL_POS *Pos,
+              int NewTag,
+              void *NewObject,
+              size_t NewSize)
+{
+  UDL_SLOT *Slot;
+  int Result = UDL_SUCCESS;
+
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  if(NULL == Pos->Chunk)
+  {
+    Result = UDL_NULL_POINTER;
+  }
+  else if(NewSize > List->RecordSize)
+  {
+    Result = UDL_TOO_BIG;
+  }
+  else
+  {
+    Slot = UDLSlot(List, Pos->Chunk, Pos->Index);
+    Slot->Tag = NewTag;
+    Slot->Size = NewSize;
+    memmove(UDLSlotData(Slot), NewObject, NewSize);
+  }
+
+  return Result;
+}
+
+void *UDLGetData(UDLLIST *List,
+                 UDL_POS *Pos,
+                 int *Tag,
+                 size_t *Size)
+{
+  UDL_SLOT *Slot;
+  void *p = NULL;
+
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  if(Pos->Chunk != NULL)
+  {
+    Slot = UDLSlot(List, Pos->Chunk, Pos->Index);
+    if(Tag != NULL)
+    {
+      *Tag = Slot->Tag;
+    }
+    if(Size != NULL)
+    {
+      *Size = Slot->Size;
+    }
+    p = UDLSlotData(Slot);
+  }
+
+  return p;
+}
+
+int UDLExtract(UDLLIST *List,
+               UDL_POS *Pos,
+               int *Tag,
+               void *Object)
+{
+  UDL_CHUNK *Chunk;
+  UDL_CHUNK *Next;
+  UDL_SLOT *Slot;
+  int Result = UDL_SUCCESS;
+
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  Chunk = Pos->Chunk;
+  if(NULL == Chunk)
+  {
+    Result = UDL_NULL_POINTER;
+  }
+  else
+  {
+    Slot = UDLSlot(List, Chunk, Pos->Index);
+    if(Tag != NULL)
+    {
+      *Tag = Slot->Tag;
+    }
+    if(Object != NULL)
+    {
+      memcpy(Object, UDLSlotData(Slot), Slot->Size);
+    }
+    UDLShift(List, Chunk, Pos->Index, 0);
+    --Chunk->Count;
+    --List->NumItems;
+
+    /* Keep the chunks reasonably full: if this one
+     * and the next would fit in half a chunk, merge
+     * them.
+     */
+    Next = Chunk->Next;
+    if(Next != NULL &&
+       Chunk->Count + Next->Count <= List->ChunkCapacity / 2)
+    {
+      memcpy(UDLSlot(List, Chunk, Chunk->Count),
+             UDLSlot(List, Next, 0),
+             Next->Count * List->SlotSize);
+      Chunk->Count += Next->Count;
+      UDLFreeChunk(List, Next);
+    }
+
+    if(Pos->Index == Chunk->Count)
+    {
+      Pos->Chunk = Chunk->Next;
+      Pos->Index = 0;
+      if(0 == Chunk->Count)
+      {
+        UDLFreeChunk(List, Chunk);
+      }
+    }
+  }
+
+  return Result;
+}
+
+int UDLGetFirst(UDLLIST *List, UDL_POS *Pos)
+{
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  Pos->Chunk = List->First;
+  Pos->Index = 0;
+
+  return Pos->Chunk != NULL;
+}
+
+int UDLGetLast(UDLLIST *List, UDL_POS *Pos)
+{
+  assert(List != NULL);
+  assert(Pos != NULL);
+
+  Pos->Chunk = List->Last;
+  Pos->Index = Pos->Chunk != NULL ? Pos->Chunk->Count - 1 : 0;
+
+  return Pos->Chunk != NULL;
+}
+
+int UDLGetNext(UDL_POS *Pos)
+{
+  assert(Pos != NULL);
+
+  if(Pos->Chunk != NULL && ++Pos->Index == Pos->Chunk->Count)
+  {
+    Pos->Chunk = Pos->Chunk->Next;
+    Pos->Index = 0;
+  }
+
+  return Pos->Chunk != NULL;
+}
+
+int UDLGetPrev(UDL_POS *Pos)
+{
+  assert(Pos != NULL);
+
+  if(Pos->Chunk != NULL)
+  {
+    if(Pos->Index > 0)
+    {
+      --Pos->Index;
+    }
+    else
+    {
+      Pos->Chunk = Pos->Chunk->Prev;
+      Pos->Index = Pos->Chunk != NULL ? Pos->Chunk->Count - 1 : 0;
+    }
+  }
+
+  return Pos->Chunk != NULL;
+}
+
+int UDLJoin(UDLLIST *Left, UDLLIST *Right)
+{
+  int Result = UDL_SUCCESS;
+
+  assert(Left != NULL);
+  assert(Right != NULL);
+
+  if(Left->RecordSize != Right->RecordSize ||
+     Left->ChunkCapacity != Right->ChunkCapacity)
+  {
+    Result = UDL_MISMATCH;
+  }
+  else if(Right->First != NULL)
+  {
+    if(Left->Last != NULL)
+    {
+      Left->Last->Next = Right->First;
+      Right->First->Prev = Left->Last;
+    }
+    else
+    {
+      Left->First = Right->First;
+    }
+    Left->Last = Right->Last;
+    Left->NumItems += Right->NumItems;
+
+    Right->First = Right->Last = NULL;
+    Right->NumItems = 0;
+  }
+
+  return Result;
+}
+
+size_t UDLCount(UDLLIST *List)
+{
+  assert(List != NULL);
+
+  return List->NumItems;
+}
+
+int UDLWalk(UDLLIST *List,
+            int(*Func)(int, void *, void *),
+            void *Args)
+{
+  UDL_CHUNK *Chunk;
+  UDL_SLOT *Slot;
+  size_t i;
+  int Result = 0;
+
+  assert(List != NULL);
+
+  for(Chunk = List->First;
+      0 == Result && Chunk != NULL;
+      Chunk = Chunk->Next)
+  {
+    Slot = UDLSlot(List, Chunk, 0);
+    for(i = 0; 0 == Result && i < Chunk->Count; i++)
+    {
+      Result = (*Func)(Slot->Tag, UDLSlotData(Slot), Args);
+      Slot = (UDL_SLOT *)((unsigned char *)Slot + List->SlotSize);
+    }
+  }
+
+  return Result;
+}
+
+void UDLDestroy(UDLLIST *List)
+{
+  UDL_CHUNK *Next;
+
+  assert(List != NULL);
+
+  while(List->First != NULL)
+  {
+    Next = List->First->Next;
+    free(List->First);
+    List->First = Next;
+  }
+  List->Last = NULL;
+  List->NumItems = 0;
+}
+
+/* end of udllist.c */
@@ -0,0 +1,168 @@
+/*  udllist.h - header for unrolled double-linked list
+ *
+ *  UDLLIST - Unrolled Double-Linked List Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#ifndef UDLLIST_H__
+#define UDLLIST_H__
+
+#include <stddef.h>
+
+#define UDL_SUCCESS      0
+#define UDL_NO_MEM       1
+#define UDL_TOO_BIG      2
+#define UDL_NULL_POINTER 3
+#define UDL_MISMATCH     4
+
+#define UDL_DEFAULT_CHUNK 32
+
+/* An unrolled doubly linked list. Instead of one item
+ * per node, each node (a chunk) holds an array of up to
+ * ChunkCapacity fixed-size slots, each a tag, a size
+ * and up to RecordSize bytes of object data, as in a
+ * RING. Walking the list therefore reads memory more or
+ * less sequentially, and the Prev/Next overhead is
+ * shared between all the items in a chunk.
+ *
+ * Because items live inside chunks and move when a
+ * chunk is split or merged, an item is identified by a
+ * UDL_POS rather than by a node pointer. Any insertion
+ * or extraction may invalidate every position except
+ * the one passed to (and updated by) that call.
+ */
+typedef struct UDL_CHUNK
+{
+  struct UDL_CHUNK *Prev;
+  struct UDL_CHUNK *Next;
+  size_t Count;        /* slots in use */
+} UDL_CHUNK;
+
+typedef struct UDLLIST
+{
+  UDL_CHUNK *First;
+  UDL_CHUNK *Last;
+  size_t NumItems;
+  size_t RecordSize;     /* largest object we accept */
+  size_t SlotSize;       /* header + record, rounded */
+  size_t ChunkCapacity;  /* slots per chunk */
+} UDLLIST;
+
+/* Where an item is. A NULL Chunk means "nowhere",
+ * i.e. just past either end of the list.
+ */
+typedef struct UDL_POS
+{
+  UDL_CHUNK *Chunk;
+  size_t Index;
+} UDL_POS;
+
+/* Prepare an empty list. ChunkCapacity of 0
+ * selects UDL_DEFAULT_CHUNK.
+ */
+void UDLInit(UDLLIST *List,
+             size_t RecordSize,
+             size_t ChunkCapacity);
+
+/* Add item at start or end of list */
+int UDLPrepend(UDLLIST *List,
+               int Tag,
+               void *Object,
+               size_t Size);
+int UDLAppend(UDLLIST *List,
+              int Tag,
+              void *Object,
+              size_t Size);
+
+/* Add new item just before or after the item at Pos,
+ * leaving Pos on the new item. If Pos is nowhere,
+ * UDLInsertBefore appends and UDLInsertAfter
+ * prepends.
+ */
+int UDLInsertBefore(UDLLIST *List,
+                    UDL_POS *Pos,
+                    int Tag,
+                    void *Object,
+                    size_t Size);
+int UDLInsertAfter(UDLLIST *List,
+                   UDL_POS *Pos,
+                   int Tag,
+                   void *Object,
+                   size_t Size);
+
+/* Update one item */
+int UDLUpdate(UDLLIST *List,
+              UDL_POS *Pos,
+              int NewTag,
+              void *NewObject,
+              size_t NewSize);
+
+/* Get a pointer to the data, or NULL if Pos
+ * is nowhere.
+ */
+void *UDLGetData(UDLLIST *List,
+                 UDL_POS *Pos,
+                 int *Tag,
+                 size_t *Size);
+
+/* Remove the item at Pos from the list, copying its
+ * tag and object out first (if Tag and Object are
+ * non-NULL). Pos is left on the following item.
+ */
+int UDLExtract(UDLLIST *List,
+               UDL_POS *Pos,
+               int *Tag,
+               void *Object);
+
+/* List navigation functions. Each returns nonzero
+ * if Pos is left on an item, or 0 if it is nowhere.
+ */
+int UDLGetFirst(UDLLIST *List, UDL_POS *Pos);
+int UDLGetLast(UDLLIST *List, UDL_POS *Pos);
+int UDLGetNext(UDL_POS *Pos);
+int UDLGetPrev(UDL_POS *Pos);
+
+/* Move every item of Right onto the end of Left, in
+ * constant time. Right is left empty. Both lists must
+ * have the same RecordSize and ChunkCapacity.
+ */
+int UDLJoin(UDLLIST *Left, UDLLIST *Right);
+
+size_t UDLCount(UDLLIST *List);
+
+/* Call Func(Tag, Object, Args) for each item, until
+ * Func returns nonzero.
+ */
+int UDLWalk(UDLLIST *List,
+            int(*Func)(int, void *, void *),
+            void *Args);
+
+/* Free every chunk. The list may be re-used. */
+void UDLDestroy(UDLLIST *List);
+
+#endif
@@ -0,0 +1,362 @@
+/*  wsdeque.c - source for work-stealing deque library
+ *
+ *  WSDEQUE - Work-Stealing Deque Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "wsdeque.h"
+
+/* The indices only ever grow, and may wrap. All
+ * comparisons are therefore made on the signed
+ * difference between them.
+ */
+#define WSD_DIFF(a, b) ((ptrdiff_t)((a) - (b)))
+
+typedef struct WS_SLOT
+{
+  int Tag;
+  size_t Size;
+} WS_SLOT;
+
+#define WSD_ROUND(n) \
+  ((((n) + sizeof(max_align_t) - 1) / sizeof(max_align_t)) \
+    * sizeof(max_align_t))
+
+#define WSD_DATA(s) \
+  ((unsigned char *)(s) + WSD_ROUND(sizeof(WS_SLOT)))
+
+static WS_SLOT *WSSlot(WS_ARRAY *a, size_t Index)
+{
+  return (WS_SLOT *)(a->Slots + (Index & a->Mask) * a->SlotSize);
+}
+
+static WS_ARRAY *WSNewArray(size_t Capacity, size_t RecordSize)
+{
+  WS_ARRAY *a;
+  size_t SlotSize;
+
+  SlotSize = WSD_ROUND(sizeof(WS_SLOT)) + WSD_ROUND(RecordSize);
+
+  a = malloc(sizeof *a);
+  if(a != NULL)
+  {
+    a->Older = NULL;
+    a->Mask = Capacity - 1;
+    a->SlotSize = SlotSize;
+    a->Slots = NULL;
+    if(Capacity <= (size_t)-1 / SlotSize)
+    {
+      a->Slots = malloc(Capacity * SlotSize);
+    }
+    if(NULL == a->Slots)
+    {
+      free(a);
+      a = NULL;
+    }
+  }
+
+  return a;
+}
+
+/* Copy items Top..Bottom-1 into an array twice the
+ * size. Only the owner ever writes to slots, and it
+ * is busy here, so the copy is safe.
+ */
+static WS_ARRAY *WSGrow(WSDEQUE *Deque,
+                        WS_ARRAY *Old,
+                        size_t Top,
+                        size_t Bottom)
+{
+  WS_ARRAY *New = NULL;
+  size_t i;
+
+  if(Old->Mask + 1 <= (size_t)-1 / 2)
+  {
+    New = WSNewArray((Old->Mask + 1) * 2, Deque->RecordSize);
+  }
+  if(New != NULL)
+  {
+    for(i = Top; i != Bottom; i++)
+    {
+      memcpy(WSSlot(New, i), WSSlot(Old, i), Old->SlotSize);
+    }
+    New->Older = Old;
+    atomic_store_explicit(&Deque->Array,
+                          New,
+                          memory_order_release);
+  }
+
+  return New;
+}
+
+int WSDequeInit(WSDEQUE *Deque, size_t RecordSize)
+{
+  WS_ARRAY *a;
+  int Result = WSD_SUCCESS;
+
+  assert(Deque != NULL);
+  assert(RecordSize > 0);
+
+  Deque->RecordSize = RecordSize;
+  a = WSNewArray(WSD_MIN_CAPACITY, RecordSize);
+  if(NULL == a)
+  {
+    Result = WSD_NO_MEM;
+  }
+  atomic_init(&Deque->Array, a);
+  atomic_init(&Deque->Top, 1);
+  atomic_init(&Deque->Bottom, 1);
+
+  return Result;
+}
+
+int WSDequeAddAtBack(WSDEQUE *Deque,
+                     int Tag,
+                     void *Object,
+                     size_t Size)
+{
+  WS_ARRAY *a;
+  WS_SLOT *Slot;
+  size_t Top;
+  size_t Bottom;
+  int Result = WSD_SUCCESS;
+
+  assert(Deque != NULL);
+
+  if(Size > Deque->RecordSize)
+  {
+    Result = WSD_TOO_BIG;
+  }
+  else
+  {
+    Bottom = atomic_load_explicit(&Deque->Bottom,
+                                  memory_order_relaxed);
+    Top = atomic_load_explicit(&Deque->Top,
+                               memory_order_acquire);
+    a = atomic_load_explicit(&Deque->Array,
+                             memory_order_relaxed);
+
+    if(WSD_DIFF(Bottom, Top) > (ptrdiff_t)a->Mask)
+    {
+      a = WSGrow(Deque, a, Top, Bottom);
+    }
+
+    if(NULL == a)
+    {
+      Result = WSD_NO_MEM;
+    }
+    else
+    {
+      Slot = WSSlot(a, Bottom);
+      Slot->Tag = Tag;
+      Slot->Size = Size;
+      memcpy(WSD_DATA(Slot), Object, Size);
+      atomic_thread_fence(memory_order_release);
+      atomic_store_explicit(&Deque->Bottom,
+                            Bottom + 1,
+                            memory_order_relaxed);
+    }
+  }
+
+  return Result;
+}
+
+/* A thief may read a slot as it is being rewritten,
+ * so never trust Size beyond the record size.
+ */
+static void WSCopyOut(void *Object,
+                      int *Tag,
+                      WS_SLOT *Slot,
+                      size_t RecordSize)
+{
+  size_t Size = Slot->Size;
+
+  if(Tag != NULL)
+  {
+    *Tag = Slot->Tag;
+  }
+  if(Object != NULL)
+  {
+    memcpy(Object,
+           WSD_DATA(Slot),
+           Size < RecordSize ? Size : RecordSize);
+  }
+}
+
+int WSDequeRemoveFromBack(void *Object,
+                          int *Tag,
+                          WSDEQUE *Deque)
+{
+  WS_ARRAY *a;
+  size_t Top;
+  size_t Bottom;
+  int Result = WSD_SUCCESS;
+
+  assert(Deque != NULL);
+
+  /* Reserve the back item before looking at Top, so
+   * that a thief either sees the reservation or we
+   * see its steal. The seq_cst fence orders the two.
+   */
+  Bottom = atomic_load_explicit(&Deque->Bottom,
+                                memory_order_relaxed) - 1;
+  a = atomic_load_explicit(&Deque->Array,
+                           memory_order_relaxed);
+  atomic_store_explicit(&Deque->Bottom,
+                        Bottom,
+                        memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  Top = atomic_load_explicit(&Deque->Top,
+                             memory_order_relaxed);
+
+  if(WSD_DIFF(Bottom, Top) > 0)
+  {
+    /* More than one item: no thief can reach it */
+    WSCopyOut(Object,
+              Tag,
+              WSSlot(a, Bottom),
+              Deque->RecordSize);
+  }
+  else if(Bottom == Top)
+  {
+    /* The last item; race any thieves for it */
+    if(atomic_compare_exchange_strong_explicit(
+         &Deque->Top,
+         &Top,
+         Top + 1,
+         memory_order_seq_cst,
+         memory_order_relaxed))
+    {
+      WSCopyOut(Object,
+                Tag,
+                WSSlot(a, Bottom),
+                Deque->RecordSize);
+    }
+    else
+    {
+      Result = WSD_EMPTY;
+    }
+    atomic_store_explicit(&Deque->Bottom,
+                          Bottom + 1,
+                          memory_order_relaxed);
+  }
+  else
+  {
+    Result = WSD_EMPTY;
+    atomic_store_explicit(&Deque->Bottom,
+                          Bottom + 1,
+                          memory_order_relaxed);
+  }
+
+  return Result;
+}
+
+int WSDequeSteal(void *Object,
+                 int *Tag,
+                 WSDEQUE *Deque)
+{
+  WS_ARRAY *a;
+  size_t Top;
+  size_t Bottom;
+  int Result = WSD_SUCCESS;
+
+  assert(Deque != NULL);
+
+  Top = atomic_load_explicit(&Deque->Top,
+                             memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  Bottom = atomic_load_explicit(&Deque->Bottom,
+                                memory_order_acquire);
+
+  if(WSD_DIFF(Bottom, Top) > 0)
+  {
+    /* Copy first: once Top moves on, the owner is
+     * free to re-use the slot. If the CAS fails we
+     * may have copied a half-written record, but we
+     * then throw it away.
+     */
+    a = atomic_load_explicit(&Deque->Array,
+                             memory_order_acquire);
+    WSCopyOut(Object,
+              Tag,
+              WSSlot(a, Top),
+              Deque->RecordSize);
+    if(!atomic_compare_exchange_strong_explicit(
+          &Deque->Top,
+          &Top,
+          Top + 1,
+          memory_order_seq_cst,
+          memory_order_relaxed))
+    {
+      Result = WSD_ABORT;
+    }
+  }
+  else
+  {
+    Result = WSD_EMPTY;
+  }
+
+  return Result;
+}
+
+size_t WSDequeCount(WSDEQUE *Deque)
+{
+  size_t Top;
+  size_t Bottom;
+
+  assert(Deque != NULL);
+
+  Top = atomic_load(&Deque->Top);
+  Bottom = atomic_load(&Deque->Bottom);
+
+  return WSD_DIFF(Bottom, Top) > 0 ? Bottom - Top : 0;
+}
+
+void WSDequeDestroy(WSDEQUE *Deque)
+{
+  WS_ARRAY *a;
+  WS_ARRAY *Older;
+
+  assert(Deque != NULL);
+
+  a = atomic_load(&Deque->Array);
+  while(a != NULL)
+  {
+    Older = a->Older;
+    free(a->Slots);
+    free(a);
+    a = Older;
+  }
+  atomic_store(&Deque->Array, NULL);
+}
+
+/* end of wsdeque.c */
@@ -0,0 +1,109 @@
+/*  wsdeque.h - header for work-stealing deque library
+ *
+ *  WSDEQUE - Work-Stealing Deque Library
+ *
+ *  Copyright (C) 2000  Richard Heathfield
+ *                      Eton Computer Systems Ltd
+ *                      Macmillan Computer Publishing
+ *
+ *  This program is free software; you can redistribute it
+ *  and/or modify it under the terms of the GNU General
+ *  Public License as published by the Free Software
+ *  Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will
+ *  be useful, but WITHOUT ANY WARRANTY; without even the
+ *  implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *  PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General
+ *  Public License along with this program; if not, write
+ *  to the Free Software Foundation, Inc., 675 Mass Ave,
+ *  Cambridge, MA 02139, USA.
+ *
+ *  Richard Heathfield may be contacted by email at:
+ *     binary@eton.powernet.co.uk
+ *
+ */
+
+
+#ifndef WSDEQUE_H__
+#define WSDEQUE_H__
+
+/* Like LFQUEUE, this library needs a C11 compiler. */
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define WSD_SUCCESS     0
+#define WSD_NO_MEM      1
+#define WSD_TOO_BIG     2
+#define WSD_EMPTY       3
+#define WSD_ABORT       4  /* lost a race; try again */
+
+#define WSD_CACHE_LINE  64
+#define WSD_MIN_CAPACITY 64
+
+/* A Chase-Lev work-stealing deque.
+ *
+ * One thread, the owner, treats the back of the deque
+ * as a stack: WSDequeAddAtBack and WSDequeRemoveFromBack
+ * behave just like DequeAddAtBack and DequeRemoveFromBack,
+ * and cost no more than a few plain loads and stores.
+ * Any other thread may call WSDequeSteal, which takes
+ * the item at the front. Only when owner and thief race
+ * for the very last item does either side need a CAS.
+ *
+ * Records of up to RecordSize bytes live in a circular
+ * array which the owner doubles when it fills. Older
+ * arrays may still be in use by a thief, so they are
+ * kept until the deque is destroyed.
+ */
+typedef struct WS_ARRAY
+{
+  struct WS_ARRAY *Older;
+  size_t Mask;
+  size_t SlotSize;
+  unsigned char *Slots;
+} WS_ARRAY;
+
+typedef struct WSDEQUE
+{
+  _Atomic(WS_ARRAY *) Array;
+  size_t RecordSize;
+
+  char Pad0[WSD_CACHE_LINE];
+  atomic_size_t Top;       /* front; thieves take here */
+
+  char Pad1[WSD_CACHE_LINE];
+  atomic_size_t Bottom;    /* back; owner works here */
+
+  char Pad2[WSD_CACHE_LINE];
+} WSDEQUE;
+
+int WSDequeInit(WSDEQUE *Deque, size_t RecordSize);
+
+/* Owner only */
+int WSDequeAddAtBack(WSDEQUE *Deque,
+                     int Tag,
+                     void *Object,
+                     size_t Size);
+int WSDequeRemoveFromBack(void *Object,
+                          int *Tag,
+                          WSDEQUE *Deque);
+
+/* Any thread. On WSD_EMPTY or WSD_ABORT the contents
+ * of *Object are unspecified.
+ */
+int WSDequeSteal(void *Object,
+                 int *Tag,
+                 WSDEQUE *Deque);
+
+/* Only a snapshot, if other threads are active */
+size_t WSDequeCount(WSDEQUE *Deque);
+
+/* No other thread may be using the deque */
+void WSDequeDestroy(WSDEQUE *Deque);
+
+#endif
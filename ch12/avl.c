@@ -25,19 +25,56 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+/* Key and value types, and a comparison for keys that yields a
+   negative, zero or positive result as A is less than, equal to or
+   greater than B.  AVL_COMPARE is a macro so that it is compiled
+   inline.  Define all four before this point to index other kinds of
+   data; the test code at the bottom of this file assumes int keys. */
+#ifndef AVL_KEY
+#define AVL_KEY int
+#define AVL_VALUE int
+#define AVL_COMPARE(A, B) (((A) > (B)) - ((A) < (B)))
+#endif
+
+typedef AVL_KEY avl_key;
+typedef AVL_VALUE avl_value;
+
 /* An AVL tree node. */
 struct avl_node {
   struct avl_node *link[2];
-  int data;
+  avl_key data;
+  avl_value value;
   short bal;
 };
 
+/* Maximum height of an AVL tree, plus one.  An AVL tree of height H
+   has at least F(H + 2) - 1 nodes, where F is the Fibonacci
+   sequence, so 48 is enough for any tree whose node count fits in
+   a 32-bit int. */
+#define AVL_MAX_HEIGHT 48
+
+/* Number of nodes allocated at a time. */
+#define AVL_BLOCK_NODES 1024
+
+/* A block of nodes.  Nodes are carved out of blocks in order, and
+   deleted nodes go on a free list for reuse, so the tree never
+   calls malloc() per node and can be destroyed by freeing its
+   blocks, without visiting any nodes. */
+struct avl_block {
+  struct avl_block *next;
+  struct avl_node node[AVL_BLOCK_NODES];
+};
+
 /* An AVL tree. */
 struct avl_tree {
   struct avl_node *root;
   int count;
+  struct avl_block *blocks;	/* Most recent block first. */
+  int used;			/* Nodes handed out from first block. */
+  struct avl_node *free;	/* Free list, linked through link[0]. */
 };
 
 /* Creates and returns a new AVL tree.  Returns a null pointer if a
@@ -49,47 +86,85 @@ struct avl_tree *avl_create(void)
     return NULL;
   tree->root = NULL;
   tree->count = 0;
+  tree->blocks = NULL;
+  tree->used = AVL_BLOCK_NODES;
+  tree->free = NULL;
   return tree;
 }
 
-/* Searches TREE for matching ITEM.  Returns 1 if found, 0
-   otherwise. */
-int avl_search(const struct avl_tree *tree, int item)
+/* Searches TREE for matching ITEM.  Returns a pointer to its value
+   if found, a null pointer otherwise. */
+avl_value *avl_find(const struct avl_tree *tree, avl_key item)
 {
-  const struct avl_node *node;
+  struct avl_node *node;
   assert(tree != NULL);
   node = tree->root;
   for (;;) {
+    int cmp;
     if (node == NULL)
-      return 0;
-    else if (item == node->data)
-      return 1;
-    else if (item > node->data)
-      node = node->link[1];
-    else
-      node = node->link[0];
+      return NULL;
+    cmp = AVL_COMPARE(item, node->data);
+    if (cmp == 0)
+      return &node->value;
+    node = node->link[cmp > 0];
+  }
+}
+
+/* Searches TREE for matching ITEM.  Returns 1 if found, 0
+   otherwise. */
+int avl_search(const struct avl_tree *tree, avl_key item)
+{
+  return avl_find(tree, item) != NULL;
+}
+
+/* Takes a node from TREE's free list, or failing that from its
+   current block, starting a new block if necessary. */
+static struct avl_node *alloc_node(struct avl_tree *tree)
+{
+  struct avl_node *node = tree->free;
+  if (node != NULL) {
+    tree->free = node->link[0];
+    return node;
   }
+  if (tree->used == AVL_BLOCK_NODES) {
+    struct avl_block *block = malloc(sizeof *block);
+    if (block == NULL)
+      return NULL;
+    block->next = tree->blocks;
+    tree->blocks = block;
+    tree->used = 0;
+  }
+  return &tree->blocks->node[tree->used++];
+}
+
+/* Returns NODE to TREE's free list. */
+static void free_node(struct avl_tree *tree, struct avl_node *node)
+{
+  node->link[0] = tree->free;
+  tree->free = node;
 }
 
-/* Allocates a new node in TREE at *NODE.  Sets the node's parent to
-   PARENT and data to ITEM, and initializes the other fields
+/* Allocates a new node in TREE.  Sets the node's data to ITEM and
+   its value to VALUE, and initializes the other fields
    appropriately. */
-static struct avl_node *new_node(struct avl_tree *tree, int item)
+static struct avl_node *new_node(struct avl_tree *tree, avl_key item,
+				 avl_value value)
 {
-  struct avl_node *node = malloc(sizeof *node);
+  struct avl_node *node = alloc_node(tree);
   if (node == NULL)
     return NULL;
   node->data = item;
+  node->value = value;
   node->link[0] = node->link[1] = NULL;
   node->bal = 0;
   tree->count++;
   return node;
 }
 
-/* Inserts ITEM into TREE.  Returns 1 if the item was inserted, 2 if
-   an identical item already existed in TREE, or 0 if a memory
-   allocation error occurred. */
-int avl_insert(struct avl_tree *tree, int item)
+/* Inserts ITEM into TREE, with VALUE.  Returns 1 if the item was
+   inserted, 2 if an identical item already existed in TREE, or 0 if
+   a memory allocation error occurred. */
+int avl_insert(struct avl_tree *tree, avl_key item, avl_value value)
 {
   struct avl_node **v, *w, *x, *y, *z;
 
@@ -97,19 +172,20 @@ int avl_insert(struct avl_tree *tree, int item)
   v = &tree->root;
   x = z = tree->root;
   if (x == NULL) {
-    tree->root = new_node(tree, item);
+    tree->root = new_node(tree, item, value);
     return tree->root != NULL;
   }
 
   for (;;) {
     int dir;
-    if (item == z->data)
+    int cmp = AVL_COMPARE(item, z->data);
+    if (cmp == 0)
       return 2;
 
-    dir = item > z->data;
+    dir = cmp > 0;
     y = z->link[dir];
     if (y == NULL) {
-      y = z->link[dir] = new_node(tree, item);
+      y = z->link[dir] = new_node(tree, item, value);
       if (y == NULL)
 	return 0;
       break;
@@ -122,9 +198,9 @@ int avl_insert(struct avl_tree *tree, int item)
     z = y;
   }
 
-  w = z = x->link[item > x->data];
+  w = z = x->link[AVL_COMPARE(item, x->data) > 0];
   while (z != y)
-    if (item < z->data) {
+    if (AVL_COMPARE(item, z->data) < 0) {
       z->bal = -1;
       z = z->link[0];
     }
@@ -133,7 +209,7 @@ int avl_insert(struct avl_tree *tree, int item)
       z = z->link[1];
     }
 
-  if (item < x->data) {
+  if (AVL_COMPARE(item, x->data) < 0) {
     if (x->bal != -1)
       x->bal--;
     else if (w->bal == -1) {
@@ -198,28 +274,32 @@ int avl_insert(struct avl_tree *tree, int item)
 
 /* Deletes any item matching ITEM from TREE.  Returns 1 if such an
    item was deleted, 0 if none was found. */
-int avl_delete(struct avl_tree *tree, int item)
+int avl_delete(struct avl_tree *tree, avl_key item)
 {
-  struct avl_node *ap[32];
-  int ad[32];
+  struct avl_node *ap[AVL_MAX_HEIGHT];
+  int ad[AVL_MAX_HEIGHT];
   int k = 1;
 
+  struct avl_node head;		/* Stands in for the root's parent. */
   struct avl_node **y, *z;
 
   assert(tree != NULL);
 
+  head.link[0] = tree->root;
   ad[0] = 0;
-  ap[0] = (struct avl_node *) &tree->root;
+  ap[0] = &head;
 
   z = tree->root;
   for (;;) {
     int dir;
+    int cmp;
     if (z == NULL)
       return 0;
-    if (item == z->data)
+    cmp = AVL_COMPARE(item, z->data);
+    if (cmp == 0)
       break;
 
-    dir = item > z->data;
+    dir = cmp > 0;
     ap[k] = z;
     ad[k++] = dir;
     z = z->link[dir];
@@ -261,7 +341,7 @@ int avl_delete(struct avl_tree *tree, int item)
     }
   }
 
-  free(z);
+  free_node(tree, z);
   assert(k > 0);
   while (--k) {
     struct avl_node *w, *x;
@@ -365,6 +445,7 @@ int avl_delete(struct avl_tree *tree, int item)
     }
   }
 
+  tree->root = head.link[0];
   return 1;
 }
 
@@ -390,7 +471,7 @@ void avl_walk(const struct avl_tree *tree)
    algorithm. */
 void avl_traverse(const struct avl_tree *tree)
 {
-  struct avl_node *stack[32];
+  struct avl_node *stack[AVL_MAX_HEIGHT];
   int count;
   struct avl_node *node;
 
@@ -411,22 +492,94 @@ void avl_traverse(const struct avl_tree *tree)
   }
 }
 
-/* Destroys tree rooted at NODE. */
-static void destroy(struct avl_node *node)
+/* Destroys TREE.  Since all the nodes live in TREE's blocks, this
+   takes time proportional to the number of blocks, not nodes. */
+void avl_destroy(struct avl_tree *tree)
 {
-  if (node == NULL)
-    return;
-  destroy(node->link[0]);
-  destroy(node->link[1]);
-  free(node);
+  struct avl_block *block, *next;
+
+  assert(tree != NULL);
+  for (block = tree->blocks; block != NULL; block = next) {
+    next = block->next;
+    free(block);
+  }
+  free(tree);
 }
 
-/* Destroys TREE. */
-void avl_destroy(struct avl_tree *tree)
+/* Returns the number of bytes of memory used by TREE. */
+size_t avl_bytes(const struct avl_tree *tree)
 {
+  const struct avl_block *block;
+  size_t bytes = sizeof *tree;
+
   assert(tree != NULL);
-  destroy(tree->root);
-  free(tree);
+  for (block = tree->blocks; block != NULL; block = block->next)
+    bytes += sizeof *block;
+  return bytes;
+}
+
+/* Helper function for avl_build_sorted().  Builds a perfectly
+   balanced tree in TREE from the N items in KEYS[] and VALUES[],
+   storing its root into *ROOT and its height into *HEIGHT.  Nodes
+   are allocated in order, so that an in-order traversal reads
+   memory sequentially.  Returns 0 if a memory allocation error
+   occurred, 1 otherwise. */
+static int build(struct avl_tree *tree, const avl_key keys[],
+		 const avl_value values[], int n,
+		 struct avl_node **root, int *height)
+{
+  struct avl_node *left, *right;
+  int half = (n - 1) / 2;
+  int lh, rh;
+
+  if (n == 0) {
+    *root = NULL;
+    *height = 0;
+    return 1;
+  }
+
+  /* The left subtree is never larger than the right, so its
+     height is never greater, and the balance factor is 0 or +1. */
+  if (!build(tree, keys, values, half, &left, &lh))
+    return 0;
+  *root = new_node(tree, keys[half], values[half]);
+  if (*root == NULL)
+    return 0;
+  if (!build(tree, keys + half + 1, values + half + 1, n - half - 1,
+	     &right, &rh))
+    return 0;
+
+  (*root)->link[0] = left;
+  (*root)->link[1] = right;
+  (*root)->bal = rh - lh;
+  *height = 1 + rh;
+  return 1;
+}
+
+/* Creates and returns a new AVL tree holding the N items in KEYS[],
+   which must be in strictly ascending order, with the corresponding
+   values from VALUES[], in O(N) time.  Returns a null pointer if
+   KEYS[] is out of order or a memory allocation error occurs. */
+struct avl_tree *avl_build_sorted(const avl_key keys[],
+				  const avl_value values[], int n)
+{
+  struct avl_tree *tree;
+  int height;
+  int i;
+
+  assert(n >= 0);
+  for (i = 1; i < n; i++)
+    if (AVL_COMPARE(keys[i - 1], keys[i]) >= 0)
+      return NULL;
+
+  tree = avl_create();
+  if (tree == NULL)
+    return NULL;
+  if (!build(tree, keys, values, n, &tree->root, &height)) {
+    avl_destroy(tree);
+    return NULL;
+  }
+  return tree;
 }
 
 /* Returns the number of data items in TREE. */
@@ -576,6 +729,90 @@ void randomize(int argc, char **argv)
 /* Size of tree used for testing. */
 #define TREE_SIZE 16
 
+/* Default size of tree used for benchmarking. */
+#define BENCH_SIZE 10000000
+
+/* Returns the number of seconds since START. */
+static double elapsed(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Times the insertion of the integers from 0 up to N - 1 into a tree
+   in random order, searching for and deleting them in other random
+   orders, and building the same tree with avl_build_sorted().
+   Verifies the trees along the way and reports the memory used per
+   node. */
+void benchmark(int n)
+{
+  struct avl_tree *tree;
+  int *array;
+  clock_t start;
+  int i;
+
+  array = malloc(n * sizeof *array);
+  if (array == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  for (i = 0; i < n; i++)
+    array[i] = i;
+  shuffle(array, n);
+  printf("%d keys, %d-byte nodes\n", n, (int) sizeof(struct avl_node));
+
+  tree = avl_create();
+  if (tree == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (avl_insert(tree, array[i], i) != 1) {
+      printf("Error inserting element %d, %d, into tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("insert:  %8.3f s\n", elapsed(start));
+  verify_tree(tree, array);
+  printf("memory:  %8.1f bytes per node\n",
+	 (double) avl_bytes(tree) / n);
+
+  shuffle(array, n);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (avl_find(tree, array[i]) == NULL) {
+      printf("Tree does not contain expected value %d.\n", array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("search:  %8.3f s\n", elapsed(start));
+
+  shuffle(array, n);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (avl_delete(tree, array[i]) == 0) {
+      printf("Error removing element %d, %d, from tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("delete:  %8.3f s\n", elapsed(start));
+  avl_destroy(tree);
+
+  for (i = 0; i < n; i++)
+    array[i] = i;
+  start = clock();
+  tree = avl_build_sorted(array, array, n);
+  if (tree == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("build:   %8.3f s\n", elapsed(start));
+  verify_tree(tree, array);
+
+  start = clock();
+  avl_destroy(tree);
+  printf("destroy: %8.3f s\n", elapsed(start));
+
+  free(array);
+}
+
 /* Simple stress test procedure for the AVL tree routines.  Does
    the following:
 
@@ -596,13 +833,23 @@ void randomize(int argc, char **argv)
    This is pretty good test code if you write some of your own AVL
    tree routines.  If you do so you will probably want to modify the
    code below so that it increments the random seed and goes on to new
-   test cases automatically. */
+   test cases automatically.
+
+   Run as "avl -bench [SIZE [SEED]]" to time the same operations,
+   without the displays, on a much larger tree (by default,
+   BENCH_SIZE nodes). */
 int main(int argc, char **argv)
 {
   int array[TREE_SIZE];
   struct avl_tree *tree;
   int i;
 
+  if (argc > 1 && strcmp(argv[1], "-bench") == 0) {
+    randomize(argc - 2, argv + 2);
+    benchmark(argc > 2 ? atoi(argv[2]) : BENCH_SIZE);
+    return EXIT_SUCCESS;
+  }
+
   randomize(argc, argv);
 
   for (i = 0; i < TREE_SIZE; i++)
@@ -611,7 +858,7 @@ int main(int argc, char **argv)
   tree = avl_create();
 
   for (i = 0; i < TREE_SIZE; i++) {
-    int result = avl_insert(tree, array[i]);
+    int result = avl_insert(tree, array[i], i);
     if (result != 1) {
       printf("Error %d inserting element %d, %d, into tree.\n",
 	     result, i, array[i]);
@@ -0,0 +1,1041 @@
+/* bpt - manipulates B+ trees.
+   Derived from libavl for manipulation of binary trees.
+   Copyright (C) 1998-2000 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+   02111-1307, USA.
+
+   The author may be contacted at <pfaffben@msu.edu> on the Internet,
+   or as Ben Pfaff, 12167 Airport Rd, DeWitt MI 48820, USA through
+   more mundane means. */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Key and value types, and a comparison for keys that yields a
+   negative, zero or positive result as A is less than, equal to or
+   greater than B.  BPT_COMPARE is a macro so that it is compiled
+   inline.  Define all four before this point to index other kinds of
+   data; the test code at the bottom of this file assumes int keys. */
+#ifndef BPT_KEY
+#define BPT_KEY int
+#define BPT_VALUE int
+#define BPT_COMPARE(A, B) (((A) > (B)) - ((A) < (B)))
+#endif
+
+typedef BPT_KEY bpt_key;
+typedef BPT_VALUE bpt_value;
+
+/* A B+ tree node.  Every node holds up to ORDER keys in ascending
+   order, where ORDER is chosen when the tree is created.  The
+   arrays are allocated in the same block as the node itself.
+
+   A branch with COUNT keys has COUNT + 1 children; every key in
+   LINK[I] is at least KEY[I - 1] and less than KEY[I].  A branch
+   holds at most ORDER - 1 keys.
+
+   All the items are kept in the leaves, which are all at the same
+   depth.  VALUE[I] is the value for KEY[I], and each leaf is linked
+   to its neighbours, so that a range of keys can be read without
+   going back up the tree. */
+struct bpt_node {
+  int count;			/* Number of keys. */
+  bpt_key *key;			/* Keys. */
+  struct bpt_node **link;	/* Branches only: children. */
+  bpt_value *value;		/* Leaves only: values. */
+  struct bpt_node *prev;	/* Leaves only: leaf to the left. */
+  struct bpt_node *next;	/* Leaves only: leaf to the right. */
+};
+
+/* Default and minimum number of keys per node. */
+#define BPT_ORDER 64
+#define BPT_MIN_ORDER 3
+
+/* Maximum height of a B+ tree.  Every branch but the root has at
+   least two children, so this is enough for any tree whose node
+   count fits in a 32-bit int. */
+#define BPT_MAX_HEIGHT 32
+
+/* A B+ tree. */
+struct bpt_tree {
+  struct bpt_node *root;
+  int count;			/* Number of items. */
+  int height;			/* Number of levels, including leaves. */
+  int order;			/* Maximum keys per node. */
+  int min_leaf;			/* Minimum keys per leaf but the root. */
+  int min_branch;		/* Minimum keys per branch but the root. */
+  size_t bytes;			/* Memory allocated for nodes. */
+};
+
+/* Union of types with strict alignment requirements, so that the
+   arrays that follow a node are suitably aligned. */
+union bpt_align {
+  long l;
+  double d;
+  void *p;
+  bpt_key k;
+  bpt_value v;
+};
+
+/* Rounds N up to a multiple of the size of union bpt_align. */
+#define BPT_ROUND(N) \
+  (((N) + sizeof (union bpt_align) - 1) / sizeof (union bpt_align) \
+   * sizeof (union bpt_align))
+
+/* Creates and returns a new B+ tree whose nodes hold up to ORDER
+   keys, or BPT_ORDER keys if ORDER is 0.  Returns a null pointer if
+   a memory allocation error occurs. */
+struct bpt_tree *bpt_create(int order)
+{
+  struct bpt_tree *tree;
+
+  if (order == 0)
+    order = BPT_ORDER;
+  assert(order >= BPT_MIN_ORDER);
+  tree = malloc(sizeof *tree);
+  if (tree == NULL)
+    return NULL;
+  tree->root = NULL;
+  tree->count = 0;
+  tree->height = 0;
+  tree->order = order;
+  tree->min_leaf = order / 2;
+  tree->min_branch = (order - 1) / 2;
+  tree->bytes = 0;
+  return tree;
+}
+
+/* Allocates a new, empty leaf (if LEAF is nonzero) or branch for
+   TREE.  Returns a null pointer if a memory allocation error
+   occurs. */
+static struct bpt_node *new_node(struct bpt_tree *tree, int leaf)
+{
+  size_t keys = BPT_ROUND(tree->order * sizeof (bpt_key));
+  size_t rest = leaf ? tree->order * sizeof (bpt_value)
+		     : (tree->order + 1) * sizeof (struct bpt_node *);
+  size_t size = BPT_ROUND(sizeof (struct bpt_node)) + keys + rest;
+  struct bpt_node *node = malloc(size);
+  unsigned char *p;
+
+  if (node == NULL)
+    return NULL;
+  p = (unsigned char *) node + BPT_ROUND(sizeof *node);
+  node->count = 0;
+  node->key = (bpt_key *) p;
+  if (leaf) {
+    node->link = NULL;
+    node->value = (bpt_value *) (p + keys);
+  }
+  else {
+    node->link = (struct bpt_node **) (p + keys);
+    node->value = NULL;
+  }
+  node->prev = node->next = NULL;
+  tree->bytes += size;
+  return node;
+}
+
+/* Frees NODE, which belongs to TREE. */
+static void free_node(struct bpt_tree *tree, struct bpt_node *node)
+{
+  size_t keys = BPT_ROUND(tree->order * sizeof (bpt_key));
+  size_t rest = node->link == NULL
+		? tree->order * sizeof (bpt_value)
+		: (tree->order + 1) * sizeof (struct bpt_node *);
+  tree->bytes -= BPT_ROUND(sizeof (struct bpt_node)) + keys + rest;
+  free(node);
+}
+
+/* Returns the index of the first key in NODE that is not less than
+   ITEM, or NODE->count if there is none. */
+static int lower_bound(const struct bpt_node *node, bpt_key item)
+{
+  int lo = 0, hi = node->count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (BPT_COMPARE(node->key[mid], item) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/* Returns the index of the child of branch NODE whose subtree would
+   contain ITEM. */
+static int child_index(const struct bpt_node *node, bpt_key item)
+{
+  int lo = 0, hi = node->count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (BPT_COMPARE(node->key[mid], item) <= 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/* Returns the leaf of TREE that would contain ITEM, or a null pointer
+   if TREE is empty. */
+static struct bpt_node *find_leaf(const struct bpt_tree *tree,
+				  bpt_key item)
+{
+  struct bpt_node *node = tree->root;
+  int level;
+
+  for (level = 1; level < tree->height; level++)
+    node = node->link[child_index(node, item)];
+  return node;
+}
+
+/* Searches TREE for matching ITEM.  Returns a pointer to its value
+   if found, a null pointer otherwise. */
+bpt_value *bpt_find(const struct bpt_tree *tree, bpt_key item)
+{
+  struct bpt_node *leaf;
+  int i;
+
+  assert(tree != NULL);
+  leaf = find_leaf(tree, item);
+  if (leaf == NULL)
+    return NULL;
+  i = lower_bound(leaf, item);
+  if (i < leaf->count && BPT_COMPARE(leaf->key[i], item) == 0)
+    return &leaf->value[i];
+  return NULL;
+}
+
+/* Searches TREE for matching ITEM.  Returns 1 if found, 0
+   otherwise. */
+int bpt_search(const struct bpt_tree *tree, bpt_key item)
+{
+  return bpt_find(tree, item) != NULL;
+}
+
+/* Inserts ITEM into TREE, with VALUE.  Returns 1 if the item was
+   inserted, 2 if an identical item already existed in TREE, or 0 if
+   a memory allocation error occurred. */
+int bpt_insert(struct bpt_tree *tree, bpt_key item, bpt_value value)
+{
+  /* Stack of branches passed through on the way down, and the child
+     taken from each. */
+  struct bpt_node *pa[BPT_MAX_HEIGHT];
+  int pi[BPT_MAX_HEIGHT];
+  int k;
+
+  /* New nodes for splitting. */
+  struct bpt_node *spare[BPT_MAX_HEIGHT + 1];
+  int ns;
+
+  struct bpt_node *node, *right;
+  bpt_key up;
+  int i, j, n;
+
+  assert(tree != NULL);
+  if (tree->root == NULL) {
+    node = new_node(tree, 1);
+    if (node == NULL)
+      return 0;
+    node->key[0] = item;
+    node->value[0] = value;
+    node->count = 1;
+    tree->root = node;
+    tree->height = 1;
+    tree->count++;
+    return 1;
+  }
+
+  node = tree->root;
+  for (k = 0; k < tree->height - 1; k++) {
+    pa[k] = node;
+    pi[k] = child_index(node, item);
+    node = node->link[pi[k]];
+  }
+
+  i = lower_bound(node, item);
+  if (i < node->count && BPT_COMPARE(node->key[i], item) == 0)
+    return 2;
+
+  /* Insert into the leaf if there is room. */
+  if (node->count < tree->order) {
+    memmove(&node->key[i + 1], &node->key[i],
+	    (node->count - i) * sizeof *node->key);
+    memmove(&node->value[i + 1], &node->value[i],
+	    (node->count - i) * sizeof *node->value);
+    node->key[i] = item;
+    node->value[i] = value;
+    node->count++;
+    tree->count++;
+    return 1;
+  }
+
+  /* Otherwise the leaf must be split, and so must each full branch
+     above it.  Allocate all the new nodes first, so that running out
+     of memory leaves the tree untouched. */
+  for (j = k; j > 0 && pa[j - 1]->count == tree->order - 1; j--)
+    ;
+  n = 1 + (k - j) + (j == 0);
+  for (ns = 0; ns < n; ns++) {
+    spare[ns] = new_node(tree, ns == 0);
+    if (spare[ns] == NULL) {
+      while (ns > 0)
+	free_node(tree, spare[--ns]);
+      return 0;
+    }
+  }
+
+  /* Of the ORDER + 1 items, the first N stay in NODE and the rest
+     move to a new leaf, RIGHT, whose first key is copied up into the
+     parent. */
+  right = spare[0];
+  n = (tree->order + 1) / 2;
+  if (i < n) {
+    right->count = tree->order - (n - 1);
+    memcpy(right->key, &node->key[n - 1], right->count * sizeof *node->key);
+    memcpy(right->value, &node->value[n - 1],
+	   right->count * sizeof *node->value);
+    memmove(&node->key[i + 1], &node->key[i],
+	    (n - 1 - i) * sizeof *node->key);
+    memmove(&node->value[i + 1], &node->value[i],
+	    (n - 1 - i) * sizeof *node->value);
+    node->key[i] = item;
+    node->value[i] = value;
+  }
+  else {
+    right->count = tree->order + 1 - n;
+    memcpy(right->key, &node->key[n], (i - n) * sizeof *node->key);
+    memcpy(right->value, &node->value[n], (i - n) * sizeof *node->value);
+    right->key[i - n] = item;
+    right->value[i - n] = value;
+    memcpy(&right->key[i - n + 1], &node->key[i],
+	   (tree->order - i) * sizeof *node->key);
+    memcpy(&right->value[i - n + 1], &node->value[i],
+	   (tree->order - i) * sizeof *node->value);
+  }
+  node->count = n;
+  right->prev = node;
+  right->next = node->next;
+  if (node->next != NULL)
+    node->next->prev = right;
+  node->next = right;
+  tree->count++;
+  up = right->key[0];
+
+  /* Insert UP and RIGHT into each parent in turn, splitting full
+     branches, until one has room. */
+  while (k > 0) {
+    struct bpt_node *split;
+
+    k--;
+    node = pa[k];
+    i = pi[k];
+    if (node->count < tree->order - 1) {
+      memmove(&node->key[i + 1], &node->key[i],
+	      (node->count - i) * sizeof *node->key);
+      memmove(&node->link[i + 2], &node->link[i + 1],
+	      (node->count - i) * sizeof *node->link);
+      node->key[i] = up;
+      node->link[i + 1] = right;
+      node->count++;
+      return 1;
+    }
+
+    /* Of the ORDER keys, the first N stay in NODE, the next moves
+       up, and the rest move to SPLIT.  Work out which is which
+       without building the combined node. */
+    split = spare[--ns];
+    n = tree->order / 2;
+    split->count = tree->order - 1 - n;
+    if (i < n) {
+      bpt_key mid = node->key[n - 1];
+      memcpy(split->key, &node->key[n], split->count * sizeof *node->key);
+      memcpy(split->link, &node->link[n], (split->count + 1)
+	     * sizeof *node->link);
+      memmove(&node->key[i + 1], &node->key[i],
+	      (n - 1 - i) * sizeof *node->key);
+      memmove(&node->link[i + 2], &node->link[i + 1],
+	      (n - 1 - i) * sizeof *node->link);
+      node->key[i] = up;
+      node->link[i + 1] = right;
+      up = mid;
+    }
+    else if (i == n) {
+      memcpy(split->key, &node->key[n], split->count * sizeof *node->key);
+      memcpy(&split->link[1], &node->link[n + 1],
+	     split->count * sizeof *node->link);
+      split->link[0] = right;
+    }
+    else {
+      bpt_key mid = node->key[n];
+      int j = i - n - 1;
+      memcpy(split->key, &node->key[n + 1], j * sizeof *node->key);
+      memcpy(split->link, &node->link[n + 1], (j + 1) * sizeof *node->link);
+      split->key[j] = up;
+      split->link[j + 1] = right;
+      memcpy(&split->key[j + 1], &node->key[i],
+	     (tree->order - 1 - i) * sizeof *node->key);
+      memcpy(&split->link[j + 2], &node->link[i + 1],
+	     (tree->order - 1 - i) * sizeof *node->link);
+      up = mid;
+    }
+    node->count = n;
+    right = split;
+  }
+
+  /* The root was split, so the tree grows a new root. */
+  node = spare[--ns];
+  node->count = 1;
+  node->key[0] = up;
+  node->link[0] = tree->root;
+  node->link[1] = right;
+  tree->root = node;
+  tree->height++;
+  return 1;
+}
+
+/* Deletes any item matching ITEM from TREE.  Returns 1 if such an
+   item was deleted, 0 if none was found. */
+int bpt_delete(struct bpt_tree *tree, bpt_key item)
+{
+  /* Stack of branches passed through on the way down, and the child
+     taken from each. */
+  struct bpt_node *pa[BPT_MAX_HEIGHT];
+  int pi[BPT_MAX_HEIGHT];
+  int k;
+
+  struct bpt_node *node;
+  int i;
+
+  assert(tree != NULL);
+  node = tree->root;
+  if (node == NULL)
+    return 0;
+  for (k = 0; k < tree->height - 1; k++) {
+    pa[k] = node;
+    pi[k] = child_index(node, item);
+    node = node->link[pi[k]];
+  }
+
+  i = lower_bound(node, item);
+  if (i >= node->count || BPT_COMPARE(node->key[i], item) != 0)
+    return 0;
+  memmove(&node->key[i], &node->key[i + 1],
+	  (node->count - i - 1) * sizeof *node->key);
+  memmove(&node->value[i], &node->value[i + 1],
+	  (node->count - i - 1) * sizeof *node->value);
+  node->count--;
+  tree->count--;
+
+  /* A separator in a branch may still equal the deleted key.  That
+     does no harm, because it still divides the keys correctly. */
+  if (k == 0) {
+    if (node->count == 0) {
+      free_node(tree, node);
+      tree->root = NULL;
+      tree->height = 0;
+    }
+    return 1;
+  }
+  if (node->count >= tree->min_leaf)
+    return 1;
+
+  /* The leaf is too small.  Borrow an item from a neighbour with the
+     same parent if it can spare one, otherwise merge with it. */
+  {
+    struct bpt_node *parent = pa[k - 1];
+    int c = pi[k - 1];
+    struct bpt_node *left, *right;
+
+    if (c > 0 && parent->link[c - 1]->count > tree->min_leaf) {
+      left = parent->link[c - 1];
+      memmove(&node->key[1], &node->key[0], node->count * sizeof *node->key);
+      memmove(&node->value[1], &node->value[0],
+	      node->count * sizeof *node->value);
+      left->count--;
+      node->key[0] = left->key[left->count];
+      node->value[0] = left->value[left->count];
+      node->count++;
+      parent->key[c - 1] = node->key[0];
+      return 1;
+    }
+    if (c < parent->count && parent->link[c + 1]->count > tree->min_leaf) {
+      right = parent->link[c + 1];
+      node->key[node->count] = right->key[0];
+      node->value[node->count] = right->value[0];
+      node->count++;
+      right->count--;
+      memmove(&right->key[0], &right->key[1],
+	      right->count * sizeof *right->key);
+      memmove(&right->value[0], &right->value[1],
+	      right->count * sizeof *right->value);
+      parent->key[c] = right->key[0];
+      return 1;
+    }
+
+    if (c > 0)
+      c--;
+    left = parent->link[c];
+    right = parent->link[c + 1];
+    memcpy(&left->key[left->count], right->key,
+	   right->count * sizeof *right->key);
+    memcpy(&left->value[left->count], right->value,
+	   right->count * sizeof *right->value);
+    left->count += right->count;
+    left->next = right->next;
+    if (right->next != NULL)
+      right->next->prev = left;
+    free_node(tree, right);
+    pi[k - 1] = c;
+  }
+
+  /* Two children of PA[K - 1] were merged, so remove the separator
+     between them, KEY[PI[K - 1]], and the link to the right-hand one.
+     Repeat for each branch that becomes too small in turn. */
+  for (;;) {
+    struct bpt_node *parent, *left, *right;
+    int c;
+
+    k--;
+    node = pa[k];
+    i = pi[k];
+    memmove(&node->key[i], &node->key[i + 1],
+	    (node->count - i - 1) * sizeof *node->key);
+    memmove(&node->link[i + 1], &node->link[i + 2],
+	    (node->count - i - 1) * sizeof *node->link);
+    node->count--;
+
+    if (k == 0) {
+      if (node->count == 0) {
+	tree->root = node->link[0];
+	tree->height--;
+	free_node(tree, node);
+      }
+      return 1;
+    }
+    if (node->count >= tree->min_branch)
+      return 1;
+
+    parent = pa[k - 1];
+    c = pi[k - 1];
+    if (c > 0 && parent->link[c - 1]->count > tree->min_branch) {
+      left = parent->link[c - 1];
+      memmove(&node->key[1], &node->key[0], node->count * sizeof *node->key);
+      memmove(&node->link[1], &node->link[0],
+	      (node->count + 1) * sizeof *node->link);
+      node->key[0] = parent->key[c - 1];
+      node->link[0] = left->link[left->count];
+      node->count++;
+      parent->key[c - 1] = left->key[left->count - 1];
+      left->count--;
+      return 1;
+    }
+    if (c < parent->count && parent->link[c + 1]->count > tree->min_branch) {
+      right = parent->link[c + 1];
+      node->key[node->count] = parent->key[c];
+      node->link[node->count + 1] = right->link[0];
+      node->count++;
+      parent->key[c] = right->key[0];
+      memmove(&right->key[0], &right->key[1],
+	      (right->count - 1) * sizeof *right->key);
+      memmove(&right->link[0], &right->link[1],
+	      right->count * sizeof *right->link);
+      right->count--;
+      return 1;
+    }
+
+    if (c > 0)
+      c--;
+    left = parent->link[c];
+    right = parent->link[c + 1];
+    left->key[left->count] = parent->key[c];
+    memcpy(&left->key[left->count + 1], right->key,
+	   right->count * sizeof *right->key);
+    memcpy(&left->link[left->count + 1], right->link,
+	   (right->count + 1) * sizeof *right->link);
+    left->count += right->count + 1;
+    free_node(tree, right);
+    pi[k - 1] = c;
+  }
+}
+
+/* Function called by bpt_range() for each item in the range, with
+   the item's key, a pointer to its value, and PARAM.  Should return
+   zero to go on to the next item, nonzero to stop. */
+typedef int bpt_range_func(bpt_key key, bpt_value *value, void *param);
+
+/* Calls FUNC for each item in TREE from LO to HI inclusive, in
+   ascending order, following the links between leaves.  Returns the
+   number of items for which FUNC was called. */
+int bpt_range(const struct bpt_tree *tree, bpt_key lo, bpt_key hi,
+	      bpt_range_func *func, void *param)
+{
+  struct bpt_node *leaf;
+  int count = 0;
+  int i;
+
+  assert(tree != NULL && func != NULL);
+  leaf = find_leaf(tree, lo);
+  if (leaf == NULL)
+    return 0;
+  for (i = lower_bound(leaf, lo); ; i++) {
+    if (i == leaf->count) {
+      leaf = leaf->next;
+      if (leaf == NULL)
+	return count;
+      i = 0;
+    }
+    if (BPT_COMPARE(leaf->key[i], hi) > 0)
+      return count;
+    count++;
+    if (func(leaf->key[i], &leaf->value[i], param))
+      return count;
+  }
+}
+
+/* Helper function for bpt_walk().  Recursively prints data from each
+   node in the subtree rooted at NODE, HEIGHT levels high, in
+   in-order. */
+static void walk(const struct bpt_node *node, int height)
+{
+  int i;
+
+  if (height == 1)
+    for (i = 0; i < node->count; i++)
+      printf("%d ", node->key[i]);
+  else
+    for (i = 0; i <= node->count; i++)
+      walk(node->link[i], height - 1);
+}
+
+/* Prints all the data items in TREE in in-order. */
+void bpt_walk(const struct bpt_tree *tree)
+{
+  assert(tree != NULL);
+  if (tree->root != NULL)
+    walk(tree->root, tree->height);
+}
+
+/* Prints all the data items in TREE in in-order, using an iterative
+   algorithm that follows the links between leaves. */
+void bpt_traverse(const struct bpt_tree *tree)
+{
+  const struct bpt_node *node;
+  int level;
+  int i;
+
+  assert(tree != NULL);
+  node = tree->root;
+  if (node == NULL)
+    return;
+  for (level = 1; level < tree->height; level++)
+    node = node->link[0];
+  for (; node != NULL; node = node->next)
+    for (i = 0; i < node->count; i++)
+      printf("%d ", node->key[i]);
+}
+
+/* Helper function for bpt_destroy().  Frees the subtree rooted at
+   NODE, HEIGHT levels high. */
+static void destroy(struct bpt_node *node, int height)
+{
+  int i;
+
+  if (height > 1)
+    for (i = 0; i <= node->count; i++)
+      destroy(node->link[i], height - 1);
+  free(node);
+}
+
+/* Destroys TREE. */
+void bpt_destroy(struct bpt_tree *tree)
+{
+  assert(tree != NULL);
+  if (tree->root != NULL)
+    destroy(tree->root, tree->height);
+  free(tree);
+}
+
+/* Returns the number of bytes of memory used by TREE. */
+size_t bpt_bytes(const struct bpt_tree *tree)
+{
+  assert(tree != NULL);
+  return sizeof *tree + tree->bytes;
+}
+
+/* Returns the number of data items in TREE. */
+int bpt_count(const struct bpt_tree *tree)
+{
+  assert(tree != NULL);
+  return tree->count;
+}
+
+/* Print the structure of node NODE of a B+ tree, which is LEVEL
+   levels from the top of a tree HEIGHT levels high.  Uses different
+   delimiters to visually distinguish levels. */
+void print_structure(struct bpt_node *node, int level, int height)
+{
+  int i;
+
+  assert(level <= 100);
+  if (node == NULL) {
+    printf(" nil");
+    return;
+  }
+
+  printf(" %c", "([{`/"[level % 5]);
+  for (i = 0; i < node->count; i++)
+    printf("%s%d", i ? "," : "", node->key[i]);
+  if (level < height - 1)
+    for (i = 0; i <= node->count; i++)
+      print_structure(node->link[i], level + 1, height);
+  printf("%c", ")]}'\\"[level % 5]);
+}
+
+/* Examine NODE in TREE, which is LEVEL levels from the top.  *COUNT
+   is increased by the number of items in the subtree rooted at NODE.
+   If LO is not a null pointer, every key in the subtree must be at
+   least *LO, and if HI is not a null pointer, every key must be less
+   than *HI.  *LEAF is the last leaf visited so far, in in-order, and
+   is updated as leaves are visited.  Sets *OKAY to 0 if an error is
+   found. */
+void
+recurse_tree(struct bpt_tree *tree, struct bpt_node *node, int level,
+	     int *count, const int *lo, const int *hi,
+	     struct bpt_node **leaf, int *okay)
+{
+  int min;
+  int i;
+
+  if (level == tree->height - 1) {
+    if (node->link != NULL) {
+      printf(" Branch %d is at the leaf level.\n", node->key[0]);
+      *okay = 0;
+      return;
+    }
+    if (node->prev != *leaf || (*leaf != NULL && (*leaf)->next != node)) {
+      printf(" Leaf starting %d is not linked to its neighbour.\n",
+	     node->key[0]);
+      *okay = 0;
+    }
+    *leaf = node;
+    *count += node->count;
+    min = tree->min_leaf;
+  }
+  else {
+    if (node->link == NULL) {
+      printf(" Leaf %d is above the leaf level.\n", node->key[0]);
+      *okay = 0;
+      return;
+    }
+    min = tree->min_branch;
+  }
+
+  if (node->count > tree->order - (node->link != NULL)
+      || node->count < (level == 0 ? 1 : min)) {
+    printf(" Node starting %d has %d keys.\n", node->key[0], node->count);
+    *okay = 0;
+  }
+  for (i = 0; i < node->count; i++) {
+    if (i > 0 && node->key[i] <= node->key[i - 1]) {
+      printf(" Key %d follows key %d.\n", node->key[i], node->key[i - 1]);
+      *okay = 0;
+    }
+    if ((lo != NULL && node->key[i] < *lo)
+	|| (hi != NULL && node->key[i] >= *hi)) {
+      printf(" Key %d is out of range for its parent.\n", node->key[i]);
+      *okay = 0;
+    }
+  }
+
+  if (node->link != NULL)
+    for (i = 0; i <= node->count; i++)
+      recurse_tree(tree, node->link[i], level + 1, count,
+		   i > 0 ? &node->key[i - 1] : lo,
+		   i < node->count ? &node->key[i] : hi, leaf, okay);
+}
+
+/* Called by bpt_range() from verify_tree().  Counts the items
+   visited in *PARAM. */
+static int count_item(int key, int *value, void *param)
+{
+  (void) key;
+  (void) value;
+  ++*(int *) param;
+  return 0;
+}
+
+/* Checks that TREE's structure is kosher and verifies that the values
+   in ARRAY are actually in the tree.  There must be as many elements
+   in ARRAY as there are items in the tree.  Also checks a range scan
+   over a random range.  Exits the program if an error was
+   encountered. */
+void verify_tree(struct bpt_tree *tree, int array[])
+{
+  struct bpt_node *leaf = NULL;
+  int count = 0;
+  int okay = 1;
+
+  if (tree->root != NULL) {
+    recurse_tree(tree, tree->root, 0, &count, NULL, NULL, &leaf, &okay);
+    if (leaf->next != NULL) {
+      printf(" Last leaf has a successor.\n");
+      okay = 0;
+    }
+  }
+  if (count != tree->count) {
+    printf(" Tree has %d items, but tree count is %d.\n",
+	   count, tree->count);
+    okay = 0;
+  }
+
+  if (okay) {
+    int lo = tree->count > 0 ? rand() % tree->count : 0;
+    int hi = lo + rand() % 64;
+    int expect = 0, found = 0, visited;
+    int i;
+
+    for (i = 0; i < tree->count; i++) {
+      if (!bpt_search(tree, array[i])) {
+	printf("Tree does not contain expected value %d.\n", array[i]);
+	okay = 0;
+      }
+      if (array[i] >= lo && array[i] <= hi)
+	expect++;
+    }
+    visited = bpt_range(tree, lo, hi, count_item, &found);
+    if (visited != expect || found != expect) {
+      printf("Range %d...%d has %d items, but %d were visited.\n",
+	     lo, hi, expect, found);
+      okay = 0;
+    }
+  }
+
+  if (!okay) {
+    printf("Error(s) encountered, aborting execution.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Arrange the N elements of ARRAY in random order. */
+void shuffle(int *array, int n)
+{
+  int i;
+  for (i = 0; i < n; i++) {
+    int j = i + rand() % (n - i);
+    int t = array[j];
+    array[j] = array[i];
+    array[i] = t;
+  }
+}
+
+/* Choose and display an initial random seed.
+   Based on code by Lawrence Kirby <fred@genesis.demon.co.uk>. */
+void randomize(int argc, char **argv)
+{
+  unsigned seed;
+
+  /* Obtain a seed value from the command line if provided, otherwise
+     from the computer's realtime clock. */
+  if (argc < 2) {
+    time_t timeval = time(NULL);
+    unsigned char *ptr = (unsigned char *) &timeval;
+    size_t i;
+
+    seed = 0;
+    for (i = 0; i < sizeof timeval; i++)
+      seed = seed * (UCHAR_MAX + 2U) + ptr[i];
+  }
+  else
+    seed = strtoul(argv[1], NULL, 0);
+
+  /* It is more convenient to deal with small seed values when
+     debugging by hand. */
+  seed %= 32768;
+
+  printf("Seed value = %d\n", seed);
+  srand(seed);
+}
+
+/* Size of tree used for testing, and the order of its nodes, which
+   is kept small so that the test exercises splitting and merging. */
+#define TREE_SIZE 16
+#define TREE_ORDER 3
+
+/* Default size of tree used for benchmarking. */
+#define BENCH_SIZE 10000000
+
+/* Returns the number of seconds since START. */
+static double elapsed(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Called by bpt_range() from benchmark().  Adds each value into
+   *PARAM. */
+static int sum_item(int key, int *value, void *param)
+{
+  (void) key;
+  *(long *) param += *value;
+  return 0;
+}
+
+/* Times the insertion of the integers from 0 up to N - 1 into a tree
+   of the given ORDER in random order, searching for and deleting
+   them in other random orders, and scanning the whole tree.
+   Verifies the tree along the way and reports the memory used per
+   item. */
+void benchmark(int n, int order)
+{
+  struct bpt_tree *tree;
+  int *array;
+  clock_t start;
+  long sum = 0;
+  int i;
+
+  array = malloc(n * sizeof *array);
+  if (array == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  for (i = 0; i < n; i++)
+    array[i] = i;
+  shuffle(array, n);
+
+  tree = bpt_create(order);
+  if (tree == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("%d keys, order %d\n", n, tree->order);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (bpt_insert(tree, array[i], i) != 1) {
+      printf("Error inserting element %d, %d, into tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("insert:  %8.3f s\n", elapsed(start));
+  verify_tree(tree, array);
+  printf("memory:  %8.1f bytes per item, height %d\n",
+	 (double) bpt_bytes(tree) / n, tree->height);
+
+  shuffle(array, n);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (bpt_find(tree, array[i]) == NULL) {
+      printf("Tree does not contain expected value %d.\n", array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("search:  %8.3f s\n", elapsed(start));
+
+  start = clock();
+  if (bpt_range(tree, 0, n - 1, sum_item, &sum) != n) {
+    printf("Range scan did not visit every item.\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("scan:    %8.3f s\n", elapsed(start));
+
+  shuffle(array, n);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (bpt_delete(tree, array[i]) == 0) {
+      printf("Error removing element %d, %d, from tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("delete:  %8.3f s\n", elapsed(start));
+  verify_tree(tree, array);
+  bpt_destroy(tree);
+
+  free(array);
+}
+
+/* Simple stress test procedure for the B+ tree routines.  Does the
+   following:
+
+   * Generate a random number seed.  By default this is generated from
+   the current time.  You can also pass an integer seed value on the
+   command line if you want to test the same case.  The seed value is
+   displayed.
+
+   * Create a tree of order TREE_ORDER and insert the integers from 0
+   up to TREE_SIZE - 1 into it, in random order.  Verifies and
+   displays the tree structure after each insertion.
+
+   * Removes each integer from the tree, in a different random order.
+   Verifies and displays the tree structure after each deletion.
+
+   * Destroys the tree.
+
+   Run as "bpt -bench [SIZE [SEED [ORDER]]]" to time the same
+   operations, without the displays, on a much larger tree (by
+   default, BENCH_SIZE items in nodes of BPT_ORDER keys).  The output
+   can be compared directly with "avl -bench" and "rb -bench" for the
+   same SIZE and SEED. */
+int main(int argc, char **argv)
+{
+  int array[TREE_SIZE];
+  struct bpt_tree *tree;
+  int i;
+
+  if (argc > 1 && strcmp(argv[1], "-bench") == 0) {
+    randomize(argc - 2, argv + 2);
+    benchmark(argc > 2 ? atoi(argv[2]) : BENCH_SIZE,
+	      argc > 4 ? atoi(argv[4]) : 0);
+    return EXIT_SUCCESS;
+  }
+
+  randomize(argc, argv);
+
+  for (i = 0; i < TREE_SIZE; i++)
+    array[i] = i;
+  shuffle(array, TREE_SIZE);
+  tree = bpt_create(TREE_ORDER);
+
+  for (i = 0; i < TREE_SIZE; i++) {
+    int result = bpt_insert(tree, array[i], i);
+    if (result != 1) {
+      printf("Error %d inserting element %d, %d, into tree.\n",
+	     result, i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+    printf("Inserted %d: ", array[i]);
+
+    /* print_structure(tree->root, 0, tree->height); */
+    bpt_walk(tree);
+    putchar('\n');
+    verify_tree(tree, array);
+  }
+
+  shuffle(array, TREE_SIZE);
+  for (i = 0; i < TREE_SIZE; i++) {
+    if (bpt_delete(tree, array[i]) == 0) {
+      printf("Error removing element %d, %d, from tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+    printf("Removed %d: ", array[i]);
+
+    /* print_structure(tree->root, 0, tree->height); */
+    bpt_traverse(tree);
+    putchar('\n');
+    verify_tree(tree, array + i + 1);
+  }
+  bpt_destroy(tree);
+  printf("Success!\n");
+  return EXIT_SUCCESS;
+}
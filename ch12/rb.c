@@ -25,8 +25,23 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+/* Key and value types, and a comparison for keys that yields a
+   negative, zero or positive result as A is less than, equal to or
+   greater than B.  RB_COMPARE is a macro so that it is compiled
+   inline.  Define all four before this point to index other kinds of
+   data; the test code at the bottom of this file assumes int keys. */
+#ifndef RB_KEY
+#define RB_KEY int
+#define RB_VALUE int
+#define RB_COMPARE(A, B) (((A) > (B)) - ((A) < (B)))
+#endif
+
+typedef RB_KEY rb_key;
+typedef RB_VALUE rb_value;
+
 /* A node color. */
 enum color {
   RB_RED,
@@ -36,14 +51,36 @@ enum color {
 /* A red-black tree node. */
 struct rb_node {
   struct rb_node *link[2];
-  int data;
+  rb_key data;
+  rb_value value;
   enum color color;
 };
 
+/* Maximum height of a red-black tree, plus room for the extra
+   entries that deletion pushes while rebalancing.  A red-black tree
+   with N nodes is at most 2 * log2(N + 1) high, so this is enough
+   for any tree whose node count fits in a 32-bit int. */
+#define RB_MAX_HEIGHT 72
+
+/* Number of nodes allocated at a time. */
+#define RB_BLOCK_NODES 1024
+
+/* A block of nodes.  Nodes are carved out of blocks in order, and
+   deleted nodes go on a free list for reuse, so the tree never
+   calls malloc() per node and can be destroyed by freeing its
+   blocks, without visiting any nodes. */
+struct rb_block {
+  struct rb_block *next;
+  struct rb_node node[RB_BLOCK_NODES];
+};
+
 /* A red-black tree. */
 struct rb_tree {
   struct rb_node *root;
   int count;
+  struct rb_block *blocks;	/* Most recent block first. */
+  int used;			/* Nodes handed out from first block. */
+  struct rb_node *free;		/* Free list, linked through link[0]. */
 };
 
 /* Creates and returns a new red-black tree.  Returns a null pointer
@@ -55,79 +92,122 @@ struct rb_tree *rb_create(void)
     return NULL;
   tree->root = NULL;
   tree->count = 0;
+  tree->blocks = NULL;
+  tree->used = RB_BLOCK_NODES;
+  tree->free = NULL;
   return tree;
 }
 
-/* Searches TREE for matching ITEM.  Returns 1 if found, 0
-   otherwise. */
-int rb_search(const struct rb_tree *tree, int item)
+/* Searches TREE for matching ITEM.  Returns a pointer to its value
+   if found, a null pointer otherwise. */
+rb_value *rb_find(const struct rb_tree *tree, rb_key item)
 {
-  const struct rb_node *node;
+  struct rb_node *node;
 
   assert(tree != NULL);
   node = tree->root;
   for (;;) {
+    int cmp;
+
     if (node == NULL)
-      return 0;
-    else if (item == node->data)
-      return 1;
-    else if (item > node->data)
-      node = node->link[1];
-    else
-      node = node->link[0];
+      return NULL;
+    cmp = RB_COMPARE(item, node->data);
+    if (cmp == 0)
+      return &node->value;
+    node = node->link[cmp > 0];
+  }
+}
+
+/* Searches TREE for matching ITEM.  Returns 1 if found, 0
+   otherwise. */
+int rb_search(const struct rb_tree *tree, rb_key item)
+{
+  return rb_find(tree, item) != NULL;
+}
+
+/* Takes a node from TREE's free list, or failing that from its
+   current block, starting a new block if necessary. */
+static struct rb_node *alloc_node(struct rb_tree *tree)
+{
+  struct rb_node *node = tree->free;
+
+  if (node != NULL) {
+    tree->free = node->link[0];
+    return node;
+  }
+  if (tree->used == RB_BLOCK_NODES) {
+    struct rb_block *block = malloc(sizeof *block);
+
+    if (block == NULL)
+      return NULL;
+    block->next = tree->blocks;
+    tree->blocks = block;
+    tree->used = 0;
   }
+  return &tree->blocks->node[tree->used++];
+}
+
+/* Returns NODE to TREE's free list. */
+static void free_node(struct rb_tree *tree, struct rb_node *node)
+{
+  node->link[0] = tree->free;
+  tree->free = node;
 }
 
-/* Allocates a new node in TREE at *NODE.  Sets the node's parent to
-   PARENT and data to ITEM, and initializes the other fields
-   appropriately. */
-static struct rb_node *new_node(struct rb_tree *tree,
-				int item, enum color color)
+/* Allocates a new node in TREE.  Sets the node's data to ITEM, its
+   value to VALUE and its color to COLOR, and initializes the other
+   fields appropriately. */
+static struct rb_node *new_node(struct rb_tree *tree, rb_key item,
+				rb_value value, enum color color)
 {
-  struct rb_node *node = malloc(sizeof *node);
+  struct rb_node *node = alloc_node(tree);
   if (node == NULL)
     return NULL;
   node->data = item;
+  node->value = value;
   node->link[0] = node->link[1] = NULL;
   node->color = color;
   tree->count++;
   return node;
 }
 
-/* Inserts ITEM into TREE.  Returns 1 if the item was inserted, 2 if
-   an identical item already existed in TREE, or 0 if a memory
-   allocation error occurred. */
-int rb_insert(struct rb_tree *tree, int item)
+/* Inserts ITEM into TREE, with VALUE.  Returns 1 if the item was
+   inserted, 2 if an identical item already existed in TREE, or 0 if
+   a memory allocation error occurred. */
+int rb_insert(struct rb_tree *tree, rb_key item, rb_value value)
 {
-  struct rb_node *ap[48];
-  int ad[48];
+  struct rb_node *ap[RB_MAX_HEIGHT];
+  int ad[RB_MAX_HEIGHT];
   int ak;
 
+  struct rb_node head;		/* Stands in for the root's parent. */
   struct rb_node *x, *y;
 
   assert(tree != NULL);
   if (tree->root == NULL) {
-    tree->root = new_node(tree, item, RB_BLACK);
+    tree->root = new_node(tree, item, value, RB_BLACK);
     return tree->root != NULL;
   }
 
+  head.link[0] = tree->root;
   ad[0] = 0;
-  ap[0] = (struct rb_node *) &tree->root;
+  ap[0] = &head;
   ak = 1;
 
   x = tree->root;
   for (;;) {
     int dir;
+    int cmp = RB_COMPARE(item, x->data);
 
-    if (item == x->data)
+    if (cmp == 0)
       return 2;
-    dir = item > x->data;
+    dir = cmp > 0;
 
     ap[ak] = x;
     ad[ak++] = dir;
     y = x->link[dir];
     if (y == NULL) {
-      x = x->link[dir] = new_node(tree, item, RB_RED);
+      x = x->link[dir] = new_node(tree, item, value, RB_RED);
       if (x == NULL)
 	return 0;
       break;
@@ -135,7 +215,10 @@ int rb_insert(struct rb_tree *tree, int item)
     x = y;
   }
 
-  while (ap[ak - 1]->color == RB_RED)
+  /* Stop when the parent is the fake node ap[0], which happens after
+     recoloring makes the root red; reading its color would read
+     past the end of TREE. */
+  while (ak >= 3 && ap[ak - 1]->color == RB_RED)
     if (ad[ak - 2] == 0) {
       y = ap[ak - 2]->link[1];
       if (y != NULL && y->color == RB_RED) {
@@ -192,6 +275,7 @@ int rb_insert(struct rb_tree *tree, int item)
       }
     }
 
+  tree->root = head.link[0];
   tree->root->color = RB_BLACK;
 
   return 1;
@@ -199,30 +283,34 @@ int rb_insert(struct rb_tree *tree, int item)
 
 /* Deletes any item matching ITEM from TREE.  Returns 1 if such an
    item was deleted, 0 if none was found. */
-int rb_delete(struct rb_tree *tree, int item)
+int rb_delete(struct rb_tree *tree, rb_key item)
 {
-  struct rb_node *ap[48];
-  int ad[48];
+  struct rb_node *ap[RB_MAX_HEIGHT];
+  int ad[RB_MAX_HEIGHT];
   int k;
 
+  struct rb_node head;		/* Stands in for the root's parent. */
   struct rb_node *w, *x, *y, *z;
 
   assert(tree != NULL);
 
+  head.link[0] = tree->root;
   ad[0] = 0;
-  ap[0] = (struct rb_node *) &tree->root;
+  ap[0] = &head;
   k = 1;
 
   z = tree->root;
   for (;;) {
     int dir;
+    int cmp;
 
     if (z == NULL)
       return 0;
 
-    if (item == z->data)
+    cmp = RB_COMPARE(item, z->data);
+    if (cmp == 0)
       break;
-    dir = item > z->data;
+    dir = cmp > 0;
 
     ap[k] = z;
     ad[k++] = dir;
@@ -250,15 +338,17 @@ int rb_delete(struct rb_tree *tree, int item)
 
     x = y->link[1];
     z->data = y->data;
+    z->value = y->value;
   }
   ap[k - 1]->link[ad[k - 1]] = x;
 
   if (y->color == RB_RED) {
-    free(y);
+    free_node(tree, y);
+    tree->root = head.link[0];
     return 1;
   }
 
-  free(y);
+  free_node(tree, y);
 
   while (k > 1 && (x == NULL || x->color == RB_BLACK))
     if (ad[k - 1] == 0) {
@@ -306,7 +396,7 @@ int rb_delete(struct rb_tree *tree, int item)
 	w->link[0] = ap[k - 1];
 	ap[k - 2]->link[ad[k - 2]] = w;
 
-	x = tree->root;
+	x = head.link[0];
 	break;
       }
     }
@@ -354,7 +444,7 @@ int rb_delete(struct rb_tree *tree, int item)
 	w->link[1] = ap[k - 1];
 	ap[k - 2]->link[ad[k - 2]] = w;
 
-	x = tree->root;
+	x = head.link[0];
 	break;
       }
     }
@@ -362,6 +452,7 @@ int rb_delete(struct rb_tree *tree, int item)
   if (x != NULL)
     x->color = RB_BLACK;
 
+  tree->root = head.link[0];
   return 1;
 }
 
@@ -387,7 +478,7 @@ void rb_walk(const struct rb_tree *tree)
    algorithm. */
 void rb_traverse(const struct rb_tree *tree)
 {
-  struct rb_node *stack[32];
+  struct rb_node *stack[RB_MAX_HEIGHT];
   int count;
 
   struct rb_node *node;
@@ -408,22 +499,96 @@ void rb_traverse(const struct rb_tree *tree)
   }
 }
 
-/* Destroys tree rooted at NODE. */
-static void destroy(struct rb_node *node)
+/* Destroys TREE.  Since all the nodes live in TREE's blocks, this
+   takes time proportional to the number of blocks, not nodes. */
+void rb_destroy(struct rb_tree *tree)
 {
-  if (node == NULL)
-    return;
-  destroy(node->link[0]);
-  destroy(node->link[1]);
-  free(node);
+  struct rb_block *block, *next;
+
+  assert(tree != NULL);
+  for (block = tree->blocks; block != NULL; block = next) {
+    next = block->next;
+    free(block);
+  }
+  free(tree);
 }
 
-/* Destroys TREE. */
-void rb_destroy(struct rb_tree *tree)
+/* Returns the number of bytes of memory used by TREE. */
+size_t rb_bytes(const struct rb_tree *tree)
 {
+  const struct rb_block *block;
+  size_t bytes = sizeof *tree;
+
   assert(tree != NULL);
-  destroy(tree->root);
-  free(tree);
+  for (block = tree->blocks; block != NULL; block = block->next)
+    bytes += sizeof *block;
+  return bytes;
+}
+
+/* Helper function for rb_build_sorted().  Builds a perfectly
+   balanced tree in TREE from the N items in KEYS[] and VALUES[],
+   storing its root into *ROOT.  The node is at DEPTH, counting the
+   root as 0.  All the null links of such a tree are at depth RED or
+   RED + 1, so coloring the nodes at depth RED red and all the others
+   black gives every path the same black-height.  Nodes are allocated
+   in order, so that an in-order traversal reads memory sequentially.
+   Returns 0 if a memory allocation error occurred, 1 otherwise. */
+static int build(struct rb_tree *tree, const rb_key keys[],
+		 const rb_value values[], int n, int depth, int red,
+		 struct rb_node **root)
+{
+  struct rb_node *left, *right;
+  int half = (n - 1) / 2;
+
+  if (n == 0) {
+    *root = NULL;
+    return 1;
+  }
+
+  if (!build(tree, keys, values, half, depth + 1, red, &left))
+    return 0;
+  *root = new_node(tree, keys[half], values[half],
+		   depth == red ? RB_RED : RB_BLACK);
+  if (*root == NULL)
+    return 0;
+  if (!build(tree, keys + half + 1, values + half + 1, n - half - 1,
+	     depth + 1, red, &right))
+    return 0;
+
+  (*root)->link[0] = left;
+  (*root)->link[1] = right;
+  return 1;
+}
+
+/* Creates and returns a new red-black tree holding the N items in
+   KEYS[], which must be in strictly ascending order, with the
+   corresponding values from VALUES[], in O(N) time.  Returns a null
+   pointer if KEYS[] is out of order or a memory allocation error
+   occurs. */
+struct rb_tree *rb_build_sorted(const rb_key keys[],
+				const rb_value values[], int n)
+{
+  struct rb_tree *tree;
+  int red;
+  int i;
+
+  assert(n >= 0);
+  for (i = 1; i < n; i++)
+    if (RB_COMPARE(keys[i - 1], keys[i]) >= 0)
+      return NULL;
+
+  /* Levels 0 through RED - 1 are full; RED is floor(log2(N + 1)). */
+  for (red = 0; (2L << red) - 1 <= n; red++)
+    continue;
+
+  tree = rb_create();
+  if (tree == NULL)
+    return NULL;
+  if (!build(tree, keys, values, n, 0, red, &tree->root)) {
+    rb_destroy(tree);
+    return NULL;
+  }
+  return tree;
 }
 
 /* Returns the number of data items in TREE. */
@@ -594,6 +759,90 @@ void randomize(int argc, char **argv)
 /* Size of tree used for testing. */
 #define TREE_SIZE 16
 
+/* Default size of tree used for benchmarking. */
+#define BENCH_SIZE 10000000
+
+/* Returns the number of seconds since START. */
+static double elapsed(clock_t start)
+{
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* Times the insertion of the integers from 0 up to N - 1 into a tree
+   in random order, searching for and deleting them in other random
+   orders, and building the same tree with rb_build_sorted().
+   Verifies the trees along the way and reports the memory used per
+   node. */
+void benchmark(int n)
+{
+  struct rb_tree *tree;
+  int *array;
+  clock_t start;
+  int i;
+
+  array = malloc(n * sizeof *array);
+  if (array == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  for (i = 0; i < n; i++)
+    array[i] = i;
+  shuffle(array, n);
+  printf("%d keys, %d-byte nodes\n", n, (int) sizeof(struct rb_node));
+
+  tree = rb_create();
+  if (tree == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (rb_insert(tree, array[i], i) != 1) {
+      printf("Error inserting element %d, %d, into tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("insert:  %8.3f s\n", elapsed(start));
+  verify_tree(tree, array);
+  printf("memory:  %8.1f bytes per node\n",
+	 (double) rb_bytes(tree) / n);
+
+  shuffle(array, n);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (rb_find(tree, array[i]) == NULL) {
+      printf("Tree does not contain expected value %d.\n", array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("search:  %8.3f s\n", elapsed(start));
+
+  shuffle(array, n);
+  start = clock();
+  for (i = 0; i < n; i++)
+    if (rb_delete(tree, array[i]) == 0) {
+      printf("Error removing element %d, %d, from tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  printf("delete:  %8.3f s\n", elapsed(start));
+  rb_destroy(tree);
+
+  for (i = 0; i < n; i++)
+    array[i] = i;
+  start = clock();
+  tree = rb_build_sorted(array, array, n);
+  if (tree == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  printf("build:   %8.3f s\n", elapsed(start));
+  verify_tree(tree, array);
+
+  start = clock();
+  rb_destroy(tree);
+  printf("destroy: %8.3f s\n", elapsed(start));
+
+  free(array);
+}
+
 /* Simple stress test procedure for the red-black tree routines.  Does
    the following:
 
@@ -614,13 +863,23 @@ void randomize(int argc, char **argv)
    This is pretty good test code if you write some of your own red-black
    tree routines.  If you do so you will probably want to modify the
    code below so that it increments the random seed and goes on to new
-   test cases automatically. */
+   test cases automatically.
+
+   Run as "rb -bench [SIZE [SEED]]" to time the same operations,
+   without the displays, on a much larger tree (by default,
+   BENCH_SIZE nodes). */
 int main(int argc, char **argv)
 {
   int array[TREE_SIZE];
   struct rb_tree *tree;
   int i;
 
+  if (argc > 1 && strcmp(argv[1], "-bench") == 0) {
+    randomize(argc - 2, argv + 2);
+    benchmark(argc > 2 ? atoi(argv[2]) : BENCH_SIZE);
+    return EXIT_SUCCESS;
+  }
+
   randomize(argc, argv);
 
   for (i = 0; i < TREE_SIZE; i++)
@@ -630,7 +889,7 @@ int main(int argc, char **argv)
   tree = rb_create();
 
   for (i = 0; i < TREE_SIZE; i++) {
-    int result = rb_insert(tree, array[i]);
+    int result = rb_insert(tree, array[i], i);
     if (result != 1) {
       printf("Error %d inserting element %d, %d, into tree.\n",
 	     result, i, array[i]);
@@ -0,0 +1,1293 @@
+/* tbinrcu - threaded binary trees with lock-free readers.
+   Derived from libavl for manipulation of binary trees.
+   Copyright (C) 1998-2000 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+   02111-1307, USA.
+
+   The author may be contacted at <pfaffben@msu.edu> on the Internet,
+   or as Ben Pfaff, 12167 Airport Rd, DeWitt MI 48820, USA through
+   more mundane means. */
+
+/* This is the threaded binary tree of tbin.c, changed so that any
+   number of threads can read the tree while one thread changes it.
+   Readers take no locks, never wait for the writer, and never start
+   over.  Unlike the rest of this chapter, it needs a C11 compiler with
+   <stdatomic.h> and <threads.h>:
+
+   gcc -Wall -std=c11 -pedantic -O2 -o tbinrcu tbinrcu.c -pthread
+
+   Four things make this work.
+
+   Each link is a single word holding both the pointer and the flag
+   that says whether it is a thread, so one store changes both, and a
+   reader can never see a new pointer with an old flag.
+
+   Insertion only ever adds a leaf, and does so by replacing a single
+   thread with a link to the new node, after the new node has been
+   filled in.  A reader sees either the old thread or the new node,
+   and both lead to the right place.
+
+   Deletion never changes a node's data, and never moves a node
+   further from the root.  A node with at most a left child is
+   unlinked with a single store.  A node with a right child is
+   replaced by a copy of its successor, and the nodes on the path down
+   to the successor are copied too, with the successor left out; the
+   copies go in with a single store.  A search that was already on its
+   way down goes on through the old nodes, which are not changed, and
+   one that starts afterward sees only the new ones.
+
+   Deleted nodes are not freed at once, because a reader may still be
+   looking at them.  Instead, each reader records the current epoch
+   while it reads, and the writer keeps deleted nodes until every
+   reader has moved on to a later epoch.
+
+   Searches go down from the root, and so are always right.  Cursors
+   step along the threads, which is quicker, but threads are changed
+   one by one during a deletion, so the writer makes the tree's
+   sequence number odd while it deletes, and even again afterward.  A
+   cursor that finds it odd, or changed since the cursor last moved,
+   seeks its next item from the root instead of waiting. */
+
+#include <assert.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+/* A threaded binary tree node.  Readers may be looking at a node while
+   the writer changes its links, so the links are atomic.  The data
+   never changes once the node is in the tree. */
+struct tbin_node {
+  int data;
+  atomic_uintptr_t left;	/* Link to the left (see below). */
+  atomic_uintptr_t right;	/* Link to the right. */
+  struct tbin_node *retired;	/* Next node awaiting reclamation. */
+};
+
+/* A link is the address of a node, with THREAD added if it is a
+   thread rather than a child.  A thread to nowhere is just THREAD. */
+#define THREAD ((uintptr_t) 1)
+#define IS_THREAD(LINK) (((LINK) & THREAD) != 0)
+#define NODE(LINK) ((struct tbin_node *) ((LINK) & ~THREAD))
+#define CHILD_LINK(NODE) ((uintptr_t) (NODE))
+#define THREAD_LINK(NODE) ((uintptr_t) (NODE) | THREAD)
+
+/* Maximum number of readers at once, and the size of a cache line. */
+#define TBIN_MAX_READERS 64
+#define TBIN_CACHE_LINE 64
+
+/* A reader's slot in a tree.  Each is on its own cache line, so that
+   readers do not slow each other down by writing to them. */
+struct tbin_reader {
+  atomic_uint epoch;		/* Epoch while reading, 0 otherwise. */
+  atomic_int used;		/* Nonzero if the slot is taken. */
+  char pad[TBIN_CACHE_LINE - sizeof (atomic_uint) - sizeof (atomic_int)];
+};
+
+/* A binary tree. */
+struct tbin_tree {
+  atomic_uintptr_t root;	/* Link to the root, a thread if empty. */
+  atomic_int count;
+  atomic_uint seq;		/* Odd while a deletion is under way. */
+  atomic_uint epoch;		/* Current epoch, never 0. */
+  struct tbin_node *limbo[3];	/* Nodes retired in recent epochs. */
+  int readers;			/* Number of reader slots ever used. */
+  struct tbin_reader reader[TBIN_MAX_READERS];
+};
+
+/* Loads and stores of fields shared with readers. */
+#define LOAD(FIELD) atomic_load_explicit(&(FIELD), memory_order_acquire)
+#define STORE(FIELD, VALUE) \
+  atomic_store_explicit(&(FIELD), (VALUE), memory_order_release)
+
+/* Creates and returns a new threaded binary tree.  Returns a null
+   pointer if a memory allocation error occurs. */
+struct tbin_tree *tbin_create(void)
+{
+  struct tbin_tree *tree = malloc(sizeof *tree);
+  int i;
+
+  if (tree == NULL)
+    return NULL;
+  atomic_init(&tree->root, THREAD);
+  atomic_init(&tree->count, 0);
+  atomic_init(&tree->seq, 0);
+  atomic_init(&tree->epoch, 1);
+  tree->limbo[0] = tree->limbo[1] = tree->limbo[2] = NULL;
+  tree->readers = 0;
+  for (i = 0; i < TBIN_MAX_READERS; i++) {
+    atomic_init(&tree->reader[i].epoch, 0);
+    atomic_init(&tree->reader[i].used, 0);
+  }
+  return tree;
+}
+
+/* Registers the calling thread as a reader of TREE, and returns its
+   slot, which must be passed to the reading functions.  Returns a
+   null pointer if there are already TBIN_MAX_READERS readers.  May be
+   called by any thread, but the writer reads TREE->readers, so the
+   slots must be registered before the writer starts deleting. */
+struct tbin_reader *tbin_register(struct tbin_tree *tree)
+{
+  int i;
+
+  for (i = 0; i < TBIN_MAX_READERS; i++) {
+    int expect = 0;
+    if (atomic_compare_exchange_strong(&tree->reader[i].used, &expect, 1)) {
+      if (i >= tree->readers)
+	tree->readers = i + 1;
+      return &tree->reader[i];
+    }
+  }
+  return NULL;
+}
+
+/* Gives up READER's slot. */
+void tbin_unregister(struct tbin_reader *reader)
+{
+  assert(reader != NULL && atomic_load(&reader->epoch) == 0);
+  atomic_store(&reader->used, 0);
+}
+
+/* Marks READER as reading TREE.  Nodes deleted from now on will not be
+   freed until the reader calls leave(). */
+static void enter(struct tbin_tree *tree, struct tbin_reader *reader)
+{
+  atomic_store_explicit(&reader->epoch,
+			atomic_load_explicit(&tree->epoch,
+					     memory_order_relaxed),
+			memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+/* Marks READER as no longer reading. */
+static void leave(struct tbin_reader *reader)
+{
+  atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+/* Frees the nodes on LIST. */
+static void free_list(struct tbin_node *list)
+{
+  while (list != NULL) {
+    struct tbin_node *next = list->retired;
+    free(list);
+    list = next;
+  }
+}
+
+/* Moves TREE on to the next epoch if every reader that is reading has
+   seen the current one.  Nodes retired two epochs ago can then no
+   longer be in use, so frees them. */
+static void reclaim(struct tbin_tree *tree)
+{
+  unsigned epoch = atomic_load_explicit(&tree->epoch, memory_order_relaxed);
+  int i;
+
+  atomic_thread_fence(memory_order_seq_cst);
+  for (i = 0; i < tree->readers; i++) {
+    unsigned e = atomic_load_explicit(&tree->reader[i].epoch,
+				      memory_order_acquire);
+    if (e != 0 && e != epoch)
+      return;
+  }
+
+  /* UINT_MAX is a multiple of 3, so skipping 0 keeps the cycle. */
+  if (++epoch == 0)
+    epoch = 1;
+  atomic_store_explicit(&tree->epoch, epoch, memory_order_release);
+  free_list(tree->limbo[epoch % 3]);
+  tree->limbo[epoch % 3] = NULL;
+}
+
+/* Adds NODE, just deleted from TREE, to the nodes to be freed once no
+   reader can still be looking at it. */
+static void retire(struct tbin_tree *tree, struct tbin_node *node)
+{
+  unsigned epoch = atomic_load_explicit(&tree->epoch, memory_order_relaxed);
+
+  node->retired = tree->limbo[epoch % 3];
+  tree->limbo[epoch % 3] = node;
+  reclaim(tree);
+}
+
+/* Returns TREE's sequence number, for a reader about to look at the
+   links.  It is odd if a deletion is under way. */
+static unsigned read_begin(struct tbin_tree *tree)
+{
+  return LOAD(tree->seq);
+}
+
+/* Returns nonzero if no deletion has started in TREE since
+   read_begin() returned SEQ, so that the links read since were all
+   part of one tree. */
+static int read_valid(struct tbin_tree *tree, unsigned seq)
+{
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&tree->seq, memory_order_relaxed) == seq;
+}
+
+/* Starts a deletion in TREE. */
+static void write_begin(struct tbin_tree *tree)
+{
+  unsigned seq = atomic_load_explicit(&tree->seq, memory_order_relaxed);
+  atomic_store_explicit(&tree->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+}
+
+/* Finishes a deletion in TREE. */
+static void write_end(struct tbin_tree *tree)
+{
+  unsigned seq = atomic_load_explicit(&tree->seq, memory_order_relaxed);
+  atomic_store_explicit(&tree->seq, seq + 1, memory_order_release);
+}
+
+/* Ways of seeking an item. */
+enum tbin_seek {
+  TBIN_GE,			/* Least item >= ITEM. */
+  TBIN_GT,			/* Least item > ITEM. */
+  TBIN_LE,			/* Greatest item <= ITEM. */
+  TBIN_LT			/* Greatest item < ITEM. */
+};
+
+/* Returns the node in TREE found by seeking ITEM in the way given by
+   HOW, or a null pointer if there is none.  A deletion going on at the
+   same time may or may not be seen, but every other item is. */
+static struct tbin_node *seek(struct tbin_tree *tree, int item,
+			      enum tbin_seek how)
+{
+  struct tbin_node *best = NULL;
+  uintptr_t link = LOAD(tree->root);
+
+  while (!IS_THREAD(link)) {
+    struct tbin_node *node = NODE(link);
+    int right;
+
+    switch (how) {
+    case TBIN_GE:
+      right = node->data < item;
+      break;
+    case TBIN_GT:
+      right = node->data <= item;
+      break;
+    case TBIN_LE:
+      right = node->data <= item;
+      break;
+    default:
+      right = node->data < item;
+      break;
+    }
+    if (right == (how == TBIN_LE || how == TBIN_LT))
+      best = node;
+
+    link = right ? LOAD(node->right) : LOAD(node->left);
+  }
+  return best;
+}
+
+/* Returns the next node in in-order after X, or NULL if X is the
+   greatest node in its tree.  Only right if no deletion was under way
+   meanwhile. */
+static struct tbin_node *successor(struct tbin_node *x)
+{
+  uintptr_t link = LOAD(x->right);
+  struct tbin_node *y;
+
+  if (IS_THREAD(link))
+    return NODE(link);
+  do {
+    y = NODE(link);
+    link = LOAD(y->left);
+  } while (!IS_THREAD(link));
+  return y;
+}
+
+/* Returns the previous node in in-order before X, or NULL if X is the
+   least node in its tree.  Only right if no deletion was under way
+   meanwhile. */
+static struct tbin_node *predecessor(struct tbin_node *x)
+{
+  uintptr_t link = LOAD(x->left);
+  struct tbin_node *y;
+
+  if (IS_THREAD(link))
+    return NODE(link);
+  do {
+    y = NODE(link);
+    link = LOAD(y->right);
+  } while (!IS_THREAD(link));
+  return y;
+}
+
+/* Searches TREE for matching ITEM, as READER.  Returns 1 if found, 0
+   otherwise. */
+int tbin_search(struct tbin_tree *tree, struct tbin_reader *reader, int item)
+{
+  struct tbin_node *node;
+  int found;
+
+  assert(tree != NULL && reader != NULL);
+  enter(tree, reader);
+  node = seek(tree, item, TBIN_GE);
+  found = node != NULL && node->data == item;
+  leave(reader);
+  return found;
+}
+
+/* A cursor, for reading the items in a tree in order.  Its position
+   is kept both as a node and as an item, so that if a deletion
+   removes the node the cursor can find its place again by item. */
+struct tbin_cursor {
+  struct tbin_tree *tree;
+  struct tbin_reader *reader;
+  struct tbin_node *node;	/* Current node, or NULL. */
+  int data;			/* Current item, if NODE is not NULL. */
+  unsigned seq;			/* TREE's sequence number when found. */
+};
+
+/* Initializes CURSOR for reading TREE as READER.  The cursor is not
+   positioned on any item. */
+void tbin_cursor_init(struct tbin_cursor *cursor, struct tbin_tree *tree,
+		      struct tbin_reader *reader)
+{
+  assert(cursor != NULL && tree != NULL && reader != NULL);
+  cursor->tree = tree;
+  cursor->reader = reader;
+  cursor->node = NULL;
+  cursor->data = 0;
+  cursor->seq = 0;
+}
+
+/* Moves CURSOR by seeking ITEM in the way given by HOW, when already
+   reading.  Returns 1 if the cursor is now on an item, 0 otherwise. */
+static int cursor_seek(struct tbin_cursor *cursor, int item,
+		       enum tbin_seek how)
+{
+  unsigned seq = read_begin(cursor->tree);
+  struct tbin_node *node = seek(cursor->tree, item, how);
+
+  cursor->node = node;
+  cursor->data = node != NULL ? node->data : 0;
+  cursor->seq = seq;
+  return node != NULL;
+}
+
+/* Moves CURSOR to the item after (if DIR is +1) or before (if DIR is
+   -1) the current one, when already reading.  If a deletion has
+   started since the cursor's node was found, the node may be gone, or
+   its threads out of date, so finds the next item by seeking instead.
+   Returns 1 if the cursor is now on an item, 0 otherwise. */
+static int cursor_step(struct tbin_cursor *cursor, int dir)
+{
+  struct tbin_node *node;
+  unsigned seq;
+
+  if (cursor->node == NULL)
+    return 0;
+  seq = read_begin(cursor->tree);
+  if (seq == cursor->seq && !(seq & 1)) {
+    node = dir > 0 ? successor(cursor->node) : predecessor(cursor->node);
+    if (read_valid(cursor->tree, seq)) {
+      cursor->node = node;
+      cursor->data = node != NULL ? node->data : 0;
+      return node != NULL;
+    }
+  }
+  return cursor_seek(cursor, cursor->data, dir > 0 ? TBIN_GT : TBIN_LT);
+}
+
+/* Moves CURSOR to the least item in its tree that is at least ITEM.
+   Returns 1 if there is one, 0 otherwise. */
+int tbin_seek(struct tbin_cursor *cursor, int item)
+{
+  int result;
+
+  assert(cursor != NULL);
+  enter(cursor->tree, cursor->reader);
+  result = cursor_seek(cursor, item, TBIN_GE);
+  leave(cursor->reader);
+  return result;
+}
+
+/* Moves CURSOR to the least item in its tree.  Returns 1 if there is
+   one, 0 if the tree is empty. */
+int tbin_first(struct tbin_cursor *cursor)
+{
+  return tbin_seek(cursor, INT_MIN);
+}
+
+/* Moves CURSOR to the greatest item in its tree.  Returns 1 if there
+   is one, 0 if the tree is empty. */
+int tbin_last(struct tbin_cursor *cursor)
+{
+  int result;
+
+  assert(cursor != NULL);
+  enter(cursor->tree, cursor->reader);
+  result = cursor_seek(cursor, INT_MAX, TBIN_LE);
+  leave(cursor->reader);
+  return result;
+}
+
+/* Moves CURSOR to the next item in its tree.  Returns 1 if there is
+   one, 0 if the cursor was on the greatest item or on none. */
+int tbin_next(struct tbin_cursor *cursor)
+{
+  int result;
+
+  assert(cursor != NULL);
+  enter(cursor->tree, cursor->reader);
+  result = cursor_step(cursor, +1);
+  leave(cursor->reader);
+  return result;
+}
+
+/* Moves CURSOR to the previous item in its tree.  Returns 1 if there
+   is one, 0 if the cursor was on the least item or on none. */
+int tbin_prev(struct tbin_cursor *cursor)
+{
+  int result;
+
+  assert(cursor != NULL);
+  enter(cursor->tree, cursor->reader);
+  result = cursor_step(cursor, -1);
+  leave(cursor->reader);
+  return result;
+}
+
+/* Returns the item CURSOR is on.  The cursor must be on an item. */
+int tbin_item(const struct tbin_cursor *cursor)
+{
+  assert(cursor != NULL && cursor->node != NULL);
+  return cursor->data;
+}
+
+/* Function called by tbin_range() for each item in the range, with
+   the item and PARAM.  Should return zero to go on to the next item,
+   nonzero to stop. */
+typedef int tbin_range_func(int item, void *param);
+
+/* Calls FUNC for each item in TREE that is at least LO and less than
+   HI, in ascending order, as READER.  FUNC must not change the tree.
+   Items inserted or deleted during the call may or may not be
+   visited, but every other item in the range is visited exactly once.
+   Returns the number of items for which FUNC was called. */
+int tbin_range(struct tbin_tree *tree, struct tbin_reader *reader,
+	       int lo, int hi, tbin_range_func *func, void *param)
+{
+  struct tbin_cursor cursor;
+  int count = 0;
+  int more;
+
+  assert(func != NULL);
+  tbin_cursor_init(&cursor, tree, reader);
+  enter(tree, reader);
+  for (more = cursor_seek(&cursor, lo, TBIN_GE);
+       more && cursor.data < hi; more = cursor_step(&cursor, +1)) {
+    count++;
+    if (func(cursor.data, param))
+      break;
+  }
+  leave(reader);
+  return count;
+}
+
+/* Allocates a new node in TREE.  Sets the node's data to ITEM, and
+   makes it a leaf whose threads point to LEFT and RIGHT. */
+static struct tbin_node *new_node(struct tbin_tree *tree, int item,
+				  struct tbin_node *left,
+				  struct tbin_node *right)
+{
+  struct tbin_node *node = malloc(sizeof *node);
+  if (node == NULL)
+    return NULL;
+
+  node->data = item;
+  atomic_init(&node->left, THREAD_LINK(left));
+  atomic_init(&node->right, THREAD_LINK(right));
+  node->retired = NULL;
+  atomic_fetch_add_explicit(&tree->count, 1, memory_order_relaxed);
+  return node;
+}
+
+/* Inserts ITEM into TREE.  Returns 1 if the item was inserted, 2 if
+   an identical item already existed in TREE, or 0 if a memory
+   allocation error occurred.  Only one thread at a time may insert
+   into or delete from a tree. */
+int tbin_insert(struct tbin_tree *tree, int item)
+{
+  atomic_uintptr_t *q = &tree->root;
+  uintptr_t link = LOAD(tree->root);
+  struct tbin_node *z = NULL, *y;
+
+  assert(tree != NULL);
+
+  while (!IS_THREAD(link)) {
+    z = NODE(link);
+    if (item == z->data)
+      return 2;
+    q = item > z->data ? &z->right : &z->left;
+    link = LOAD(*q);
+  }
+
+  if (z == NULL)
+    y = new_node(tree, item, NULL, NULL);
+  else if (item > z->data)
+    y = new_node(tree, item, z, NODE(link));
+  else
+    y = new_node(tree, item, NODE(link), z);
+  if (y == NULL)
+    return 0;
+
+  STORE(*q, CHILD_LINK(y));
+  return 1;
+}
+
+/* Returns the rightmost node in the subtree with root X. */
+static struct tbin_node *rightmost(struct tbin_node *x)
+{
+  uintptr_t link;
+
+  while (!IS_THREAD(link = LOAD(x->right)))
+    x = NODE(link);
+  return x;
+}
+
+/* Returns the leftmost node in the subtree with root X. */
+static struct tbin_node *leftmost(struct tbin_node *x)
+{
+  uintptr_t link;
+
+  while (!IS_THREAD(link = LOAD(x->left)))
+    x = NODE(link);
+  return x;
+}
+
+/* Returns the link to put in the right of a copy of node O, which is
+   on the path down to a successor being copied.  If O's right is a
+   thread, it points to the node above O, so it must point to ABOVE,
+   the copy of that node, instead; but the first node on the path
+   threads past the deleted node, so for that ABOVE is null and the
+   thread is kept. */
+static uintptr_t copy_right(struct tbin_node *o, struct tbin_node *above)
+{
+  uintptr_t r = LOAD(o->right);
+
+  return IS_THREAD(r) && above != NULL ? THREAD_LINK(above) : r;
+}
+
+/* O has been copied as C, and the copy shares O's right subtree.  Makes
+   the threads from that subtree point to C instead of O, and to ABOVE
+   instead of the node above O, if ABOVE is not null. */
+static void retarget(struct tbin_node *o, struct tbin_node *c,
+		     struct tbin_node *above)
+{
+  uintptr_t r = LOAD(o->right);
+
+  if (!IS_THREAD(r)) {
+    STORE(leftmost(NODE(r))->left, THREAD_LINK(c));
+    if (above != NULL)
+      STORE(rightmost(NODE(r))->right, THREAD_LINK(above));
+  }
+}
+
+/* Replaces T, a node of TREE with a right child, by a copy N of its
+   successor P.  Q is the link to T.  The nodes on the path from T's
+   right child down to P are copied, with P left out, and the copies
+   share every subtree off that path with the old nodes.  Then the
+   threads from the shared subtrees are pointed at the copies, and N
+   goes in with a single store, so a reader sees either all the old
+   nodes or all the new ones.  Returns 0 if memory runs out, with the
+   tree unchanged, and 1 otherwise. */
+static int replace(struct tbin_tree *tree, atomic_uintptr_t *q,
+		   struct tbin_node *t)
+{
+  struct tbin_node *n, *o, *c, *above, *made;
+  atomic_uintptr_t *link;
+  uintptr_t l, pr;
+
+  n = malloc(sizeof *n);
+  if (n == NULL)
+    return 0;
+  n->retired = NULL;
+  made = n;
+
+  link = &n->right;
+  above = NULL;
+  for (o = NODE(LOAD(t->right)); !IS_THREAD(l = LOAD(o->left));
+       o = NODE(l)) {
+    c = malloc(sizeof *c);
+    if (c == NULL) {
+      free_list(made);
+      return 0;
+    }
+    c->retired = made;
+    made = c;
+    c->data = o->data;
+    atomic_init(&c->right, copy_right(o, above));
+    atomic_init(link, CHILD_LINK(c));
+    link = &c->left;
+    above = c;
+  }
+
+  /* O is now P.  Its right subtree, or its thread, takes its place;
+     the node above it, if any, now comes just after N. */
+  n->data = o->data;
+  atomic_init(&n->left, LOAD(t->left));
+  pr = LOAD(o->right);
+  atomic_init(link, IS_THREAD(pr) && above != NULL ? THREAD_LINK(n) : pr);
+
+  write_begin(tree);
+  l = LOAD(t->left);
+  if (!IS_THREAD(l))
+    STORE(rightmost(NODE(l))->right, THREAD_LINK(n));
+  above = NULL;
+  link = &n->right;
+  for (o = NODE(LOAD(t->right)); !IS_THREAD(l = LOAD(o->left));
+       o = NODE(l)) {
+    c = NODE(LOAD(*link));
+    retarget(o, c, above);
+    link = &c->left;
+    above = c;
+  }
+  retarget(o, n, above);
+  STORE(*q, CHILD_LINK(n));
+  write_end(tree);
+
+  for (o = NODE(LOAD(t->right)); !IS_THREAD(l = LOAD(o->left));
+       o = NODE(l))
+    retire(tree, o);
+  retire(tree, o);
+  retire(tree, t);
+  return 1;
+}
+
+/* Deletes any item matching ITEM from TREE.  Returns 1 if such an
+   item was deleted, 0 if none was found, or -1 if a memory allocation
+   error occurred, in which case the tree is unchanged.  Only one
+   thread at a time may insert into or delete from a tree. */
+int tbin_delete(struct tbin_tree *tree, int item)
+{
+  atomic_uintptr_t *q = &tree->root;
+  uintptr_t link = LOAD(tree->root);
+  uintptr_t l, r;
+  struct tbin_node *t;
+  int dir = 0;			/* 1 if T is a right child. */
+
+  assert(tree != NULL);
+
+  for (;;) {
+    if (IS_THREAD(link))
+      return 0;
+    t = NODE(link);
+    if (item == t->data)
+      break;
+    dir = item > t->data;
+    q = dir ? &t->right : &t->left;
+    link = LOAD(*q);
+  }
+
+  l = LOAD(t->left);
+  r = LOAD(t->right);
+  if (!IS_THREAD(r)) {
+    if (!replace(tree, q, t))
+      return -1;
+  }
+  else {
+    write_begin(tree);
+    if (IS_THREAD(l))
+      /* A leaf: its parent's link becomes the thread T had on that
+	 side. */
+      STORE(*q, dir ? r : l);
+    else {
+      /* Only a left child, which takes T's place, once the greatest
+	 node under it threads past T. */
+      STORE(rightmost(NODE(l))->right, r);
+      STORE(*q, l);
+    }
+    write_end(tree);
+    retire(tree, t);
+  }
+
+  atomic_fetch_sub_explicit(&tree->count, 1, memory_order_relaxed);
+  return 1;
+}
+
+/* Destroys tree rooted at NODE. */
+static void destroy(struct tbin_node *node)
+{
+  if (!IS_THREAD(node->left))
+    destroy(NODE(node->left));
+  if (!IS_THREAD(node->right))
+    destroy(NODE(node->right));
+  free(node);
+}
+
+/* Destroys TREE.  No thread may be reading it. */
+void tbin_destroy(struct tbin_tree *tree)
+{
+  int i;
+
+  assert(tree != NULL);
+  if (!IS_THREAD(tree->root))
+    destroy(NODE(tree->root));
+  for (i = 0; i < 3; i++)
+    free_list(tree->limbo[i]);
+  free(tree);
+}
+
+/* Returns the number of data items in TREE. */
+int tbin_count(const struct tbin_tree *tree)
+{
+  assert(tree != NULL);
+  return atomic_load_explicit(&tree->count, memory_order_relaxed);
+}
+
+/* Prints all the data items in TREE in in-order, as READER, using a
+   cursor. */
+void tbin_traverse(struct tbin_tree *tree, struct tbin_reader *reader)
+{
+  struct tbin_cursor cursor;
+  int more;
+
+  tbin_cursor_init(&cursor, tree, reader);
+  for (more = tbin_first(&cursor); more; more = tbin_next(&cursor))
+    printf("%d ", tbin_item(&cursor));
+}
+
+/* Examine NODE in a binary tree.  *COUNT is increased by the number
+   of nodes in the tree, including the current one.  If the node is
+   the root of the tree, PARENT should be INT_MIN, otherwise it should
+   be the parent node value.  If this node is a left child of its
+   parent node, DIR should be -1.  Otherwise, if it is not the root,
+   it is a right child and DIR must be +1.  Sets *OKAY to 0 if an
+   error is found. */
+static void
+recurse_tree(struct tbin_node *node, int *count,
+	     int parent, int dir, int *okay)
+{
+  assert(count != NULL);
+  (*count)++;
+
+  if (!IS_THREAD(node->left))
+    recurse_tree(NODE(node->left), count, node->data, -1, okay);
+  if (!IS_THREAD(node->right))
+    recurse_tree(NODE(node->right), count, node->data, +1, okay);
+
+  if (parent != INT_MIN) {
+    assert(dir == -1 || dir == +1);
+    if (dir == -1 && node->data > parent) {
+      printf(" Node %d is smaller than its left child %d.\n",
+	     parent, node->data);
+      *okay = 0;
+    }
+    else if (dir == +1 && node->data < parent) {
+      printf(" Node %d is larger than its right child %d.\n",
+	     parent, node->data);
+      *okay = 0;
+    }
+  }
+}
+
+/* Verifies that ITEM exists in the array ARRAY having LENGTH
+   elements. */
+static int array_contains(int array[], int length, int item)
+{
+  while (length-- > 0)
+    if (array[length] == item)
+      return 1;
+
+  return 0;
+}
+
+/* Called by tbin_range() from verify_tree().  Checks that ITEM is in
+   the range given by PARAM[0] and PARAM[1] and greater than the last
+   item, PARAM[2], and counts it in PARAM[3]. */
+static int check_range(int item, void *param)
+{
+  int *p = param;
+
+  if (item < p[0] || item >= p[1] || (p[3] > 0 && item <= p[2]))
+    p[4] = 0;
+  p[2] = item;
+  p[3]++;
+  return 0;
+}
+
+/* Checks that TREE's structure is kosher and verifies that the values
+   in ARRAY are actually in the tree, reading as READER.  There must
+   be as many elements in ARRAY as there are nodes in the tree.  Also
+   reads the tree with a cursor in both directions, seeks each item
+   and its neighbours, and reads a range.  Exits the program if an
+   error was encountered. */
+static void verify_tree(struct tbin_tree *tree, struct tbin_reader *reader,
+			int array[])
+{
+  struct tbin_cursor cursor;
+  int n = tbin_count(tree);
+  int count = 0;
+  int okay = 1;
+  int i;
+
+  if (!IS_THREAD(tree->root))
+    recurse_tree(NODE(tree->root), &count, INT_MIN, 0, &okay);
+  if (count != n) {
+    printf(" Tree has %d nodes, but tree count is %d.\n", count, n);
+    okay = 0;
+  }
+
+  if (okay)
+    for (i = 0; i < n; i++)
+      if (!tbin_search(tree, reader, array[i])) {
+	printf("Tree does not contain expected value %d.\n", array[i]);
+	okay = 0;
+      }
+
+  tbin_cursor_init(&cursor, tree, reader);
+  if (okay) {
+    int last = INT_MIN;
+    int more;
+
+    count = 0;
+    for (more = tbin_first(&cursor); more; more = tbin_next(&cursor)) {
+      if (count > 0 && tbin_item(&cursor) <= last) {
+	printf(" Misordered right threads: %d after %d.\n",
+	       tbin_item(&cursor), last);
+	okay = 0;
+	break;
+      }
+      last = tbin_item(&cursor);
+      if (count++ >= n)
+	break;
+      if (!array_contains(array, n, last)) {
+	printf(" Wrong data in tree by right threads.\n");
+	okay = 0;
+	break;
+      }
+    }
+
+    if (okay && count != n) {
+      printf(" Tree has %d nodes, but count by right threads is %d.\n",
+	     count, n);
+      okay = 0;
+    }
+  }
+
+  if (okay) {
+    int last = INT_MAX;
+    int more;
+
+    count = 0;
+    for (more = tbin_last(&cursor); more; more = tbin_prev(&cursor)) {
+      if (count > 0 && tbin_item(&cursor) >= last) {
+	printf(" Misordered left threads: %d after %d.\n",
+	       tbin_item(&cursor), last);
+	okay = 0;
+	break;
+      }
+      last = tbin_item(&cursor);
+      if (count++ >= n)
+	break;
+      if (!array_contains(array, n, last)) {
+	printf(" Wrong data in tree by left threads.\n");
+	okay = 0;
+	break;
+      }
+    }
+
+    if (okay && count != n) {
+      printf(" Tree has %d nodes, but count by left threads is %d.\n",
+	     count, n);
+      okay = 0;
+    }
+  }
+
+  /* Seek each item, and check that the item after it is the least
+     item in ARRAY that is greater. */
+  for (i = 0; okay && i < n; i++) {
+    int next = 0, found = 0;
+    int j;
+
+    for (j = 0; j < n; j++)
+      if (array[j] > array[i] && (!found || array[j] < next)) {
+	next = array[j];
+	found = 1;
+      }
+    if (!tbin_seek(&cursor, array[i]) || tbin_item(&cursor) != array[i]) {
+      printf(" Seeking %d did not find it.\n", array[i]);
+      okay = 0;
+    }
+    else if (tbin_next(&cursor) != found
+	     || (found && tbin_item(&cursor) != next)) {
+      printf(" Item after %d is not %d.\n", array[i], next);
+      okay = 0;
+    }
+  }
+
+  if (okay) {
+    int p[5];
+    int visited;
+
+    p[0] = n > 0 ? array[rand() % n] : 0;
+    p[1] = p[0] + rand() % 8;
+    p[3] = 0;
+    p[4] = 1;
+    for (count = i = 0; i < n; i++)
+      count += array[i] >= p[0] && array[i] < p[1];
+    visited = tbin_range(tree, reader, p[0], p[1], check_range, p);
+    if (!p[4] || visited != count || p[3] != count) {
+      printf(" Range %d...%d has %d items, but %d were visited.\n",
+	     p[0], p[1], count, visited);
+      okay = 0;
+    }
+  }
+
+  if (!okay) {
+    printf("Error(s) encountered, aborting execution.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Arrange the N elements of ARRAY in random order. */
+void shuffle(int *array, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    int j = i + rand() % (n - i);
+    int t = array[j];
+    array[j] = array[i];
+    array[i] = t;
+  }
+}
+
+/* Choose and display an initial random seed.
+   Based on code by Lawrence Kirby <fred@genesis.demon.co.uk>. */
+void randomize(int argc, char **argv)
+{
+  unsigned seed;
+
+  /* Obtain a seed value from the command line if provided, otherwise
+     from the computer's realtime clock. */
+  if (argc < 2) {
+    time_t timeval = time(NULL);
+    unsigned char *ptr = (unsigned char *) &timeval;
+    size_t i;
+
+    seed = 0;
+    for (i = 0; i < sizeof timeval; i++)
+      seed = seed * (UCHAR_MAX + 2U) + ptr[i];
+  }
+  else
+    seed = strtoul(argv[1], NULL, 0);
+
+  /* It is more convenient to deal with small seed values when
+     debugging by hand. */
+  seed %= 32768;
+
+  printf("Seed value = %d\n", seed);
+  srand(seed);
+}
+
+/* Size of tree used for testing. */
+#define TREE_SIZE 16
+
+/* Defaults for benchmarking: the number of items in the tree, the
+   number of items in each range scanned, and how long to run for
+   each number of readers, in seconds. */
+#define BENCH_SIZE 1000000
+#define BENCH_SCAN 100
+#define BENCH_SECONDS 2
+
+/* Greatest number of reader threads benchmarked. */
+#define BENCH_READERS 8
+
+/* State shared by the benchmark threads. */
+struct bench {
+  struct tbin_tree *tree;
+  mtx_t lock;			/* Taken by all threads if LOCKED. */
+  int locked;
+  int size;			/* Items are 0...SIZE - 1. */
+  atomic_int stop;		/* Set to make the threads finish. */
+  atomic_int failed;		/* Set if a reader saw a bad scan. */
+};
+
+/* One benchmark thread's own state. */
+struct bench_thread {
+  struct bench *bench;
+  struct tbin_reader *reader;	/* Null for the writer. */
+  unsigned random;		/* State of random number generator. */
+  long ops;			/* Scans or updates done. */
+};
+
+/* Returns a pseudo-random number from 0 to N - 1, using and updating
+   *STATE. */
+static int next_random(unsigned *state, int n)
+{
+  *state = *state * 1103515245u + 12345u;
+  return (int) ((*state >> 8) % (unsigned) n);
+}
+
+/* Called by tbin_range() from bench_reader().  PARAM points to the
+   item expected next; every even item is always in the tree, so the
+   scan must not skip one, and items must be in ascending order. */
+static int check_scan(int item, void *param)
+{
+  int *expect = param;
+
+  if (item < *expect || item > ((*expect + 1) & ~1))
+    return 1;
+  *expect = item + 1;
+  return 0;
+}
+
+/* Benchmark reader thread.  Repeatedly scans a random range of
+   BENCH_SCAN items, checking that the scan is ordered and complete,
+   and searches for a random even item, which must be found. */
+static int bench_reader(void *arg)
+{
+  struct bench_thread *t = arg;
+  struct bench *b = t->bench;
+
+  while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+    int lo = next_random(&t->random, b->size - BENCH_SCAN) & ~1;
+    int even = next_random(&t->random, b->size) & ~1;
+    int expect = lo;
+    int visited, found;
+
+    if (b->locked)
+      mtx_lock(&b->lock);
+    visited = tbin_range(b->tree, t->reader, lo, lo + BENCH_SCAN,
+			 check_scan, &expect);
+    found = tbin_search(b->tree, t->reader, even);
+    if (b->locked)
+      mtx_unlock(&b->lock);
+    if (visited < BENCH_SCAN / 2 || expect < lo + BENCH_SCAN - 1 || !found)
+      atomic_store(&b->failed, 1);
+    t->ops++;
+  }
+  return 0;
+}
+
+/* Benchmark writer thread.  Repeatedly deletes a random odd item and
+   puts it back. */
+static int bench_writer(void *arg)
+{
+  struct bench_thread *t = arg;
+  struct bench *b = t->bench;
+
+  while (!atomic_load_explicit(&b->stop, memory_order_relaxed)) {
+    int item = next_random(&t->random, b->size) | 1;
+    int okay;
+
+    if (b->locked)
+      mtx_lock(&b->lock);
+    okay = (tbin_delete(b->tree, item) == 1
+	    && tbin_insert(b->tree, item) == 1);
+    if (b->locked)
+      mtx_unlock(&b->lock);
+    if (!okay)
+      atomic_store(&b->failed, 1);
+    t->ops += 2;
+  }
+  return 0;
+}
+
+/* Returns the current time in seconds. */
+static double now(void)
+{
+  struct timespec ts;
+
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Runs NREADERS reader threads and a writer against B's tree for
+   SECONDS seconds, and reports the throughput of each. */
+static void bench_run(struct bench *b, int nreaders, int seconds)
+{
+  struct bench_thread t[BENCH_READERS + 1];
+  thrd_t id[BENCH_READERS + 1];
+  double start, end;
+  long scans = 0;
+  int i;
+
+  atomic_store(&b->stop, 0);
+  for (i = 0; i <= nreaders; i++) {
+    t[i].bench = b;
+    t[i].reader = NULL;
+    t[i].random = 12345u * (i + 1) + rand();
+    t[i].ops = 0;
+    if (i > 0) {
+      t[i].reader = tbin_register(b->tree);
+      assert(t[i].reader != NULL);
+    }
+  }
+
+  start = now();
+  for (i = 0; i <= nreaders; i++)
+    if (thrd_create(&id[i], i == 0 ? bench_writer : bench_reader, &t[i])
+	!= thrd_success) {
+      printf("Can't create thread.\n");
+      exit(EXIT_FAILURE);
+    }
+  while (now() - start < seconds)
+    thrd_yield();
+  atomic_store(&b->stop, 1);
+  for (i = 0; i <= nreaders; i++)
+    thrd_join(id[i], NULL);
+  end = now();
+
+  for (i = 1; i <= nreaders; i++) {
+    scans += t[i].ops;
+    tbin_unregister(t[i].reader);
+  }
+  printf("%-10s %7d %12.0f %12.0f\n", b->locked ? "mutex" : "lock-free",
+	 nreaders, scans / (end - start), t[0].ops / (end - start));
+}
+
+/* Builds a tree of N items, then for 1, 2, 4 and 8 readers, runs the
+   readers scanning ranges while a writer deletes and reinserts items,
+   for SECONDS seconds, first with readers that take no locks and then
+   with every thread taking a mutex.  Exits the program if a reader
+   sees a scan that is out of order or misses an item. */
+void benchmark(int n, int seconds)
+{
+  struct bench b;
+  int *array;
+  int i, r;
+
+  array = malloc(n * sizeof *array);
+  b.tree = tbin_create();
+  if (array == NULL || b.tree == NULL) {
+    printf("Out of memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  for (i = 0; i < n; i++)
+    array[i] = i;
+  shuffle(array, n);
+  for (i = 0; i < n; i++)
+    if (tbin_insert(b.tree, array[i]) != 1) {
+      printf("Error inserting element %d, %d, into tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+  free(array);
+
+  if (mtx_init(&b.lock, mtx_plain) != thrd_success) {
+    printf("Can't create mutex.\n");
+    exit(EXIT_FAILURE);
+  }
+  b.size = n;
+  atomic_init(&b.stop, 0);
+  atomic_init(&b.failed, 0);
+
+  printf("%d items, scans of %d, %d s per run\n\n",
+	 n, BENCH_SCAN, seconds);
+  printf("%-10s %7s %12s %12s\n", "", "readers", "scans/s", "updates/s");
+  for (b.locked = 0; b.locked <= 1; b.locked++)
+    for (r = 1; r <= BENCH_READERS; r *= 2)
+      bench_run(&b, r, seconds);
+
+  mtx_destroy(&b.lock);
+  tbin_destroy(b.tree);
+  if (atomic_load(&b.failed)) {
+    printf("A reader saw a bad scan.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Simple stress test procedure for the binary tree routines.  Does
+   the following:
+
+   * Generate a random number seed.  By default this is generated from
+   the current time.  You can also pass an integer seed value on the
+   command line if you want to test the same case.  The seed value is
+   displayed.
+
+   * Create a tree and insert the integers from 0 up to TREE_SIZE - 1
+   into it, in random order.  Verifies and displays the tree structure
+   after each insertion.
+
+   * Removes each integer from the tree, in a different random order.
+   Verifies and displays the tree structure after each deletion.
+
+   * Destroys the tree.
+
+   Run as "tbinrcu -bench [SIZE [SEED [SECONDS]]]" to time readers
+   scanning a tree of SIZE items (by default, BENCH_SIZE) while a
+   writer changes it. */
+int main(int argc, char **argv)
+{
+  int array[TREE_SIZE];
+  struct tbin_tree *tree;
+  struct tbin_reader *reader;
+  int i;
+
+  if (argc > 1 && strcmp(argv[1], "-bench") == 0) {
+    randomize(argc - 2, argv + 2);
+    benchmark(argc > 2 ? atoi(argv[2]) : BENCH_SIZE,
+	      argc > 4 ? atoi(argv[4]) : BENCH_SECONDS);
+    return EXIT_SUCCESS;
+  }
+
+  randomize(argc, argv);
+
+  for (i = 0; i < TREE_SIZE; i++)
+    array[i] = i;
+  shuffle(array, TREE_SIZE);
+
+  tree = tbin_create();
+  reader = tbin_register(tree);
+
+  for (i = 0; i < TREE_SIZE; i++) {
+    int result = tbin_insert(tree, array[i]);
+    if (result != 1) {
+      printf("Error %d inserting element %d, %d, into tree.\n",
+	     result, i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+
+    printf("Inserted %d: ", array[i]);
+    tbin_traverse(tree, reader);
+    putchar('\n');
+
+    verify_tree(tree, reader, array);
+  }
+
+  shuffle(array, TREE_SIZE);
+  for (i = 0; i < TREE_SIZE; i++) {
+    if (tbin_delete(tree, array[i]) != 1) {
+      printf("Error removing element %d, %d, from tree.\n", i, array[i]);
+      exit(EXIT_FAILURE);
+    }
+
+    printf("Removed %d: ", array[i]);
+    tbin_traverse(tree, reader);
+    putchar('\n');
+
+    verify_tree(tree, reader, array + i + 1);
+  }
+
+  tbin_unregister(reader);
+  tbin_destroy(tree);
+  printf("Success!\n");
+
+  return EXIT_SUCCESS;
+}
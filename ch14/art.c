@@ -0,0 +1,1127 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <stddef.h>
+#include "art_internal.h"
+
+/*
+ * This is the adaptive radix tree version of the trie module.  It has
+ * exactly the same interface as trie.c (see trie.h), and the layout is
+ * described in art_internal.h
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ART_SSE2 1
+#endif
+
+/*
+ * trie_create -- create a new trie
+ *
+ * inputs: none
+ *
+ * outputs: a pointer to the new trie, or NULL on error
+ *
+ * This attempts to dynamically allocate a new trie, initializes it to
+ * empty, and returns a pointer to it.
+ */
+struct trie *trie_create(void)
+{
+  struct trie *trie = malloc( sizeof(*trie ) );
+
+  if (trie) {
+    trie->root = 0;
+  }
+  return trie;
+}
+
+/*
+ * new_leaf -- allocate a leaf
+ *
+ * inputs: the key and its length, and the result for that key
+ *
+ * outputs: a pointer to the new leaf, or NULL on malloc failure
+ */
+static struct art_leaf *new_leaf( const unsigned char *key, size_t len_key,
+                                                  trie_result result )
+{
+  struct art_leaf *leaf = malloc( offsetof( struct art_leaf, key ) +
+                                          (len_key > 0 ? len_key : 1) );
+  if (leaf) {
+    leaf->type = TRIE_LEAF;
+    leaf->result = result;
+    leaf->len_key = len_key;
+    memcpy( leaf->key, key, len_key );
+  }
+  return leaf;
+}
+
+/*
+ * new_node -- allocate an empty inner node
+ *
+ * inputs: the type of node to allocate
+ *
+ * outputs: a pointer to the new node, or NULL on malloc failure
+ *
+ * All the children of the new node are NULL, and it has no prefix and no
+ * exact_match
+ */
+static struct art_node *new_node( enum trie_node_type type )
+{
+  struct art_node *node;
+  size_t size;
+
+  switch (type) {
+    case TRIE_NODE4:   size = sizeof( struct art_node4 ); break;
+    case TRIE_NODE16:  size = sizeof( struct art_node16 ); break;
+    case TRIE_NODE48:  size = sizeof( struct art_node48 ); break;
+    case TRIE_NODE256: size = sizeof( struct art_node256 ); break;
+    default: assert(0); return 0;
+  }
+  node = calloc( 1, size );
+  if (node) {
+    node->type = type;
+  }
+  return node;
+}
+
+/*
+ * copy_header -- copy the common part of an inner node into another one,
+ *                when a node changes size
+ */
+static void copy_header( struct art_node *to, const struct art_node *from )
+{
+  to->num_children = from->num_children;
+  to->count = from->count;
+  to->prefix_len = from->prefix_len;
+  memcpy( to->prefix, from->prefix, sizeof to->prefix );
+  to->exact_match = from->exact_match;
+}
+
+/*
+ * destroy_node -- deallocate a node of any type
+ *
+ * inputs: a pointer to the node to free
+ *
+ * outputs: none
+ *
+ * This frees up all memory associated with the node, and all the nodes
+ * beneath it.  Calling it with NULL is legitimite
+ */
+static void destroy_node(trie_pointer node)
+{
+  int i;
+
+  if (node == 0)
+    return;
+
+  switch (*node) {
+    case TRIE_LEAF:
+      free(node);
+      return;
+    case TRIE_NODE4: {
+      struct art_node4 *p = (struct art_node4*)node;
+      for (i=0; i<p->n.num_children; i++)
+        destroy_node(p->children[i]);
+      break;
+    }
+    case TRIE_NODE16: {
+      struct art_node16 *p = (struct art_node16*)node;
+      for (i=0; i<p->n.num_children; i++)
+        destroy_node(p->children[i]);
+      break;
+    }
+    case TRIE_NODE48: {
+      struct art_node48 *p = (struct art_node48*)node;
+      for (i=0; i<48; i++)
+        destroy_node(p->children[i]);
+      break;
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *p = (struct art_node256*)node;
+      for (i=0; i<256; i++)
+        destroy_node(p->children[i]);
+      break;
+    }
+    default: assert(0); return;
+  }
+  free( ((struct art_node*)node)->exact_match );
+  free(node);
+}
+
+/*
+ * trie_destroy -- destroy a trie
+ *
+ * inputs: a pointer to the trie to free
+ *
+ * outputs: none
+ *
+ * This frees up all memory associated with the trie.  If any keys were
+ * inserted into the trie, any memory associated with those are freed as
+ * well.
+ * Once this returns, it is no longer legitimite to refer to the trie
+ */
+void trie_destroy(struct trie *trie)
+{
+  if (trie) {
+    destroy_node(trie->root);
+    free(trie);
+  }
+}
+
+/*
+ * find_child -- find the child of an inner node for a key byte
+ *
+ * inputs: node -- the inner node to look in
+ *         c -- the next byte of the key
+ *
+ * outputs: a pointer to the slot that holds the child, or NULL if there
+ *          is no child for that byte
+ *
+ * This is the inner loop of every search, so the 16-way node compares all
+ * of its key bytes at once where it can
+ */
+static trie_pointer *find_child( struct art_node *node, unsigned char c )
+{
+  int i;
+
+  switch (node->type) {
+    case TRIE_NODE4: {
+      struct art_node4 *p = (struct art_node4*)node;
+      for (i=0; i<p->n.num_children; i++)
+        if (p->keys[i] == c)
+          return &p->children[i];
+      return 0;
+    }
+    case TRIE_NODE16: {
+      struct art_node16 *p = (struct art_node16*)node;
+#if defined(ART_SSE2)
+      __m128i cmp = _mm_cmpeq_epi8( _mm_set1_epi8( (char)c ),
+                            _mm_loadu_si128( (const __m128i*)p->keys ) );
+      unsigned bits = (unsigned)_mm_movemask_epi8( cmp ) &
+                            ((1U << p->n.num_children) - 1);
+      if (bits == 0)
+        return 0;
+#if defined(__GNUC__)
+      return &p->children[ __builtin_ctz( bits ) ];
+#else
+      for (i=0; !(bits & 1); i++)
+        bits >>= 1;
+      return &p->children[i];
+#endif
+#else
+      for (i=0; i<p->n.num_children; i++)
+        if (p->keys[i] == c)
+          return &p->children[i];
+      return 0;
+#endif
+    }
+    case TRIE_NODE48: {
+      struct art_node48 *p = (struct art_node48*)node;
+      i = p->child_index[c];
+      return i ? &p->children[i-1] : 0;
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *p = (struct art_node256*)node;
+      return p->children[c] ? &p->children[c] : 0;
+    }
+    default:
+      assert(0);
+      return 0;
+  }
+}
+
+/*
+ * any_leaf -- find a leaf beneath an inner node
+ *
+ * inputs: the node to look under
+ *
+ * outputs: one of the leaves beneath it
+ *
+ * Every key beneath a node shares the whole prefix of the node, so any
+ * leaf will do to recover the prefix bytes that the node did not store
+ */
+static const struct art_leaf *any_leaf( trie_pointer node )
+{
+  while (*node != TRIE_LEAF) {
+    struct art_node *p = (struct art_node*)node;
+    int i;
+
+    if (p->exact_match)
+      return p->exact_match;
+    switch (p->type) {
+      case TRIE_NODE4:  node = ((struct art_node4*)p)->children[0]; break;
+      case TRIE_NODE16: node = ((struct art_node16*)p)->children[0]; break;
+      case TRIE_NODE48: {
+        struct art_node48 *q = (struct art_node48*)p;
+        for (i=0; !q->children[i]; i++)
+          ;
+        node = q->children[i];
+        break;
+      }
+      case TRIE_NODE256: {
+        struct art_node256 *q = (struct art_node256*)p;
+        for (i=0; !q->children[i]; i++)
+          ;
+        node = q->children[i];
+        break;
+      }
+      default: assert(0); return 0;
+    }
+  }
+  return (const struct art_leaf*)node;
+}
+
+/*
+ * compare_leaf -- check a leaf to see if it matches the key we are
+ *                 searching for
+ *
+ * inputs: a pointer to the leaf to compare
+ *         the key and its length we are searching for
+ *
+ * outputs: the result of the search
+ *
+ * This does the final check for a search on this key.  Since the search
+ * does not look at the prefix bytes that an inner node did not store, this
+ * compares the entire key
+ */
+static trie_result compare_leaf( const struct art_leaf *leaf,
+                                  const unsigned char *key, size_t len_key )
+{
+  if (!leaf || len_key != leaf->len_key ||
+      0 != memcmp( key, leaf->key, len_key)) {
+    return 0;
+  } else
+    return leaf->result;
+}
+
+/*
+ * trie_search -- search the trie for an entry
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         key -- a pointer to the key to look for
+ *         len_key -- the length (in bytes) of the key to look for
+ *
+ * outputs: the result of the key, or NULL if the key was not found
+ *
+ * This searches for the given key through the trie.  If that key has been
+ * successfully inserted, and has not been removed since, this will return
+ * the trie_result that was specified during the insert.
+ */
+trie_result trie_search(const struct trie *trie, const unsigned char *key, size_t len_key)
+{
+  trie_pointer node;
+  size_t depth = 0;
+
+  if (trie == 0)
+    return 0;
+
+  /*
+   * Walk down a byte at a time, stepping over the prefix of each inner
+   * node, until we reach a leaf, a NULL, or the end of the key
+   */
+  node = trie->root;
+  while (node) {
+    struct art_node *p;
+    trie_pointer *child;
+
+    if (*node == TRIE_LEAF)
+      return compare_leaf( (const struct art_leaf*)node, key, len_key );
+
+    p = (struct art_node*)node;
+    if (p->prefix_len) {
+      size_t stored = p->prefix_len < ART_MAX_PREFIX ?
+                                          p->prefix_len : ART_MAX_PREFIX;
+      /* Every key beneath here is at least this long */
+      if (len_key - depth < p->prefix_len)
+        return 0;
+      if (0 != memcmp( key + depth, p->prefix, stored ))
+        return 0;
+      depth += p->prefix_len;
+    }
+    if (depth == len_key)
+      return compare_leaf( p->exact_match, key, len_key );
+
+    child = find_child( p, key[depth] );
+    if (!child)
+      return 0;
+    node = *child;
+    depth += 1;
+  }
+  return 0;
+}
+
+/*
+ * add_child -- add a child to an inner node, growing it if it is full
+ *
+ * inputs: ref -- a pointer to the pointer to the node
+ *         c -- the key byte for the new child
+ *         child -- the new child
+ *
+ * outputs: nonzero on success, zero on malloc failure
+ *          updates *ref if the node had to grow
+ *
+ * There must not already be a child for c.  On failure, the node is
+ * unchanged
+ */
+static int add_child( trie_pointer *ref, unsigned char c, trie_pointer child )
+{
+  struct art_node *node = (struct art_node*)*ref;
+  int i;
+
+  switch (node->type) {
+    case TRIE_NODE4: {
+      struct art_node4 *p = (struct art_node4*)node;
+      if (p->n.num_children < 4) {
+        /* Keep the keys in order, so that an ordered walk is easy */
+        for (i=p->n.num_children; i>0 && p->keys[i-1] > c; i--) {
+          p->keys[i] = p->keys[i-1];
+          p->children[i] = p->children[i-1];
+        }
+        p->keys[i] = c;
+        p->children[i] = child;
+        p->n.num_children += 1;
+        return 1;
+      } else {
+        struct art_node16 *q = (struct art_node16*)new_node( TRIE_NODE16 );
+        if (!q) return 0;
+        copy_header( &q->n, &p->n );
+        memcpy( q->keys, p->keys, sizeof p->keys );
+        memcpy( q->children, p->children, sizeof p->children );
+        free(p);
+        *ref = (trie_pointer)q;
+        return add_child( ref, c, child );
+      }
+    }
+    case TRIE_NODE16: {
+      struct art_node16 *p = (struct art_node16*)node;
+      if (p->n.num_children < 16) {
+        for (i=p->n.num_children; i>0 && p->keys[i-1] > c; i--) {
+          p->keys[i] = p->keys[i-1];
+          p->children[i] = p->children[i-1];
+        }
+        p->keys[i] = c;
+        p->children[i] = child;
+        p->n.num_children += 1;
+        return 1;
+      } else {
+        struct art_node48 *q = (struct art_node48*)new_node( TRIE_NODE48 );
+        if (!q) return 0;
+        copy_header( &q->n, &p->n );
+        for (i=0; i<16; i++) {
+          q->children[i] = p->children[i];
+          q->child_index[ p->keys[i] ] = i+1;
+        }
+        free(p);
+        *ref = (trie_pointer)q;
+        return add_child( ref, c, child );
+      }
+    }
+    case TRIE_NODE48: {
+      struct art_node48 *p = (struct art_node48*)node;
+      if (p->n.num_children < 48) {
+        for (i=0; p->children[i]; i++)
+          ;
+        p->children[i] = child;
+        p->child_index[c] = i+1;
+        p->n.num_children += 1;
+        return 1;
+      } else {
+        struct art_node256 *q = (struct art_node256*)new_node( TRIE_NODE256 );
+        if (!q) return 0;
+        copy_header( &q->n, &p->n );
+        for (i=0; i<256; i++)
+          if (p->child_index[i])
+            q->children[i] = p->children[ p->child_index[i]-1 ];
+        free(p);
+        *ref = (trie_pointer)q;
+        return add_child( ref, c, child );
+      }
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *p = (struct art_node256*)node;
+      p->children[c] = child;
+      p->n.num_children += 1;
+      return 1;
+    }
+    default:
+      assert(0);
+      return 0;
+  }
+}
+
+/*
+ * prefix_mismatch -- see how much of a node's prefix a key matches
+ *
+ * inputs: node -- the inner node
+ *         key, len_key -- the key
+ *         depth -- where the prefix starts in the key
+ *
+ * outputs: the number of prefix bytes that match (node->prefix_len if they
+ *          all do)
+ *
+ * Bytes past the stored part of the prefix are taken from a leaf
+ */
+static size_t prefix_mismatch( struct art_node *node, const unsigned char *key,
+                               size_t len_key, size_t depth )
+{
+  size_t max = node->prefix_len, i;
+  const unsigned char *prefix = node->prefix;
+
+  if (max > len_key - depth)
+    max = len_key - depth;
+  for (i=0; i<max; i++) {
+    if (i == ART_MAX_PREFIX) {
+      /* We need the bytes that weren't stored */
+      prefix = any_leaf( (trie_pointer)node )->key + depth;
+    }
+    if (prefix[i] != key[depth+i])
+      break;
+  }
+  return i;
+}
+
+/*
+ * insert_node -- insert a leaf beneath a node
+ *
+ * inputs: ref -- a pointer to the pointer to the node we are inserting into
+ *         depth -- the number of key bytes that led to this node
+ *         leaf -- pointer to the leaf to insert
+ *
+ * outputs: nonzero if leaf successfully inserted, zero on error
+ *          updates *ref on success, if appropriate
+ *
+ * There are two error conditions: malloc failure, and if the key already
+ * exists within the trie.  On error, the node is unchanged
+ *
+ * Having *ref be NULL is supported, and is interpreted to mean that you
+ * are inserting the leaf into a node that does not correspond to any keys
+ */
+static int insert_node( trie_pointer *ref, size_t depth, struct art_leaf *leaf )
+{
+  const unsigned char *key = leaf->key;
+  size_t len_key = leaf->len_key;
+  struct art_node *node;
+  trie_pointer *child;
+
+  /* An empty slot -- the leaf goes right here */
+  if (!*ref) {
+    *ref = (trie_pointer)leaf;
+    return 1;
+  }
+
+  /*
+   * Inserting a new leaf onto an existing leaf.  The two keys are the same
+   * up to some point; we make a new node with that common part as its
+   * prefix, and hang the two leaves beneath it
+   */
+  if (**ref == TRIE_LEAF) {
+    struct art_leaf *previous_leaf = (struct art_leaf*)*ref;
+    struct art_node *new;
+    size_t max, i;
+
+    max = len_key < previous_leaf->len_key ? len_key : previous_leaf->len_key;
+    for (i=depth; i<max && key[i] == previous_leaf->key[i]; i++)
+      ;
+    if (i == len_key && i == previous_leaf->len_key)
+      return 0;   /* The key is already in the trie */
+
+    new = new_node( TRIE_NODE4 );
+    if (!new) return 0;
+    new->prefix_len = i - depth;
+    memcpy( new->prefix, key + depth,
+            new->prefix_len < ART_MAX_PREFIX ? new->prefix_len : ART_MAX_PREFIX );
+    new->count = 2;
+    *ref = (trie_pointer)new;
+
+    /* At most one of the two keys can end here.  Neither add can fail */
+    if (i == previous_leaf->len_key)
+      new->exact_match = previous_leaf;
+    else
+      add_child( ref, previous_leaf->key[i], (trie_pointer)previous_leaf );
+    if (i == len_key)
+      new->exact_match = leaf;
+    else
+      add_child( ref, key[i], (trie_pointer)leaf );
+    return 1;
+  }
+
+  node = (struct art_node*)*ref;
+  if (node->prefix_len) {
+    size_t match = prefix_mismatch( node, key, len_key, depth );
+
+    if (match < node->prefix_len) {
+      /*
+       * The new key leaves the prefix partway along.  Put a new node in
+       * front of this one, with the part of the prefix that matched, and
+       * hang this node and the new leaf beneath it
+       */
+      struct art_node *new = new_node( TRIE_NODE4 );
+      unsigned char c;
+      size_t rest;
+
+      if (!new) return 0;
+      new->prefix_len = match;
+      memcpy( new->prefix, node->prefix,
+                            match < ART_MAX_PREFIX ? match : ART_MAX_PREFIX );
+      new->count = node->count + 1;
+
+      /* The old node keeps what is left of the prefix after byte c */
+      rest = node->prefix_len - (match + 1);
+      if (node->prefix_len <= ART_MAX_PREFIX) {
+        c = node->prefix[match];
+        memmove( node->prefix, node->prefix + match + 1, rest );
+      } else {
+        const struct art_leaf *any = any_leaf( (trie_pointer)node );
+        c = any->key[depth + match];
+        memcpy( node->prefix, any->key + depth + match + 1,
+                                rest < ART_MAX_PREFIX ? rest : ART_MAX_PREFIX );
+      }
+      node->prefix_len = rest;
+
+      *ref = (trie_pointer)new;
+      add_child( ref, c, (trie_pointer)node );
+      if (depth + match == len_key)
+        new->exact_match = leaf;
+      else
+        add_child( ref, key[depth + match], (trie_pointer)leaf );
+      return 1;
+    }
+    depth += node->prefix_len;
+  }
+
+  if (depth == len_key) {
+    /*
+     * If we ran out of key, then install this as an exact match, unless
+     * there's already one there
+     */
+    if (node->exact_match)
+      return 0;
+    node->exact_match = leaf;
+  } else {
+    child = find_child( node, key[depth] );
+    if (child) {
+      if (!insert_node( child, depth+1, leaf ))
+        return 0;
+    } else {
+      if (!add_child( ref, key[depth], (trie_pointer)leaf ))
+        return 0;
+      node = (struct art_node*)*ref;  /* It may have grown */
+    }
+  }
+  node->count += 1;
+  return 1;
+}
+
+/*
+ * trie_insert -- insert an entry into a trie
+ *
+ * inputs: trie -- a pointer to the trie to insert into
+ *         key -- a pointer to the key to insert
+ *         len_key -- the length (in bytes) of the key to insert
+ *         result -- the value that trie_search should return when it finds
+ *                   this entry
+ *
+ * outputs: nonzero on success, zero on error
+ *
+ * This attempts to insert the given key into the trie, so that if you
+ * search for that specific key, you will find it.
+ * There are two error conditions: malloc failure, and if the key already
+ * exists within the trie.  On error, the trie is unchanged.
+ * The trie makes a copy of the key.  When trie_insert returns, you are
+ * free to reuse the memory that you used to specify the key
+ */
+int trie_insert(struct trie *trie, const unsigned char *key, size_t len_key,
+            trie_result result) {
+  if (trie) {
+    struct art_leaf *leaf = new_leaf( key, len_key, result );
+
+    if (!leaf)
+      return 0;
+    if (insert_node( &trie->root, 0, leaf ))
+      return 1;
+
+    /* We failed for some reason, free up the now worthless leaf */
+    free( leaf );
+  }
+  return 0;
+}
+
+/*
+ * remove_child -- take the child for a key byte out of an inner node,
+ *                 shrinking the node if it has got small enough
+ *
+ * inputs: ref -- a pointer to the pointer to the node
+ *         slot -- the slot of the child, from find_child
+ *         c -- the key byte for the child
+ *
+ * outputs: none
+ *          updates *ref if the node shrank
+ *
+ * Shrinking only happens if the malloc for the smaller node works; if it
+ * doesn't, we just keep the bigger node
+ */
+static void remove_child( trie_pointer *ref, trie_pointer *slot, unsigned char c )
+{
+  struct art_node *node = (struct art_node*)*ref;
+  int i, j;
+
+  switch (node->type) {
+    case TRIE_NODE4: {
+      struct art_node4 *p = (struct art_node4*)node;
+      i = (int)(slot - p->children);
+      p->n.num_children -= 1;
+      memmove( p->keys + i, p->keys + i + 1, p->n.num_children - i );
+      memmove( p->children + i, p->children + i + 1,
+                        (p->n.num_children - i) * sizeof p->children[0] );
+      return;
+    }
+    case TRIE_NODE16: {
+      struct art_node16 *p = (struct art_node16*)node;
+      struct art_node4 *q;
+      i = (int)(slot - p->children);
+      p->n.num_children -= 1;
+      memmove( p->keys + i, p->keys + i + 1, p->n.num_children - i );
+      memmove( p->children + i, p->children + i + 1,
+                        (p->n.num_children - i) * sizeof p->children[0] );
+      if (p->n.num_children <= 3 &&
+                      (q = (struct art_node4*)new_node( TRIE_NODE4 )) != 0) {
+        copy_header( &q->n, &p->n );
+        memcpy( q->keys, p->keys, p->n.num_children );
+        memcpy( q->children, p->children,
+                        p->n.num_children * sizeof p->children[0] );
+        free(p);
+        *ref = (trie_pointer)q;
+      }
+      return;
+    }
+    case TRIE_NODE48: {
+      struct art_node48 *p = (struct art_node48*)node;
+      struct art_node16 *q;
+      *slot = 0;
+      p->child_index[c] = 0;
+      p->n.num_children -= 1;
+      if (p->n.num_children <= 12 &&
+                      (q = (struct art_node16*)new_node( TRIE_NODE16 )) != 0) {
+        copy_header( &q->n, &p->n );
+        for (i=0, j=0; i<256; i++)
+          if (p->child_index[i]) {
+            q->keys[j] = (unsigned char)i;
+            q->children[j++] = p->children[ p->child_index[i]-1 ];
+          }
+        free(p);
+        *ref = (trie_pointer)q;
+      }
+      return;
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *p = (struct art_node256*)node;
+      struct art_node48 *q;
+      *slot = 0;
+      p->n.num_children -= 1;
+      if (p->n.num_children <= 37 &&
+                      (q = (struct art_node48*)new_node( TRIE_NODE48 )) != 0) {
+        copy_header( &q->n, &p->n );
+        for (i=0, j=0; i<256; i++)
+          if (p->children[i]) {
+            q->children[j] = p->children[i];
+            q->child_index[i] = ++j;
+          }
+        free(p);
+        *ref = (trie_pointer)q;
+      }
+      return;
+    }
+    default:
+      assert(0);
+  }
+}
+
+/*
+ * only_child -- the single child of an inner node with one child
+ *
+ * inputs: node -- the node
+ *         c -- where to put the key byte of the child
+ *
+ * outputs: the child
+ */
+static trie_pointer only_child( struct art_node *node, unsigned char *c )
+{
+  int i;
+
+  switch (node->type) {
+    case TRIE_NODE4:
+      *c = ((struct art_node4*)node)->keys[0];
+      return ((struct art_node4*)node)->children[0];
+    case TRIE_NODE16:
+      *c = ((struct art_node16*)node)->keys[0];
+      return ((struct art_node16*)node)->children[0];
+    case TRIE_NODE48: {
+      struct art_node48 *p = (struct art_node48*)node;
+      for (i=0; !p->child_index[i]; i++)
+        ;
+      *c = (unsigned char)i;
+      return p->children[ p->child_index[i]-1 ];
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *p = (struct art_node256*)node;
+      for (i=0; !p->children[i]; i++)
+        ;
+      *c = (unsigned char)i;
+      return p->children[i];
+    }
+    default:
+      assert(0);
+      return 0;
+  }
+}
+
+/*
+ * collapse_node -- undo a node that no longer branches
+ *
+ * inputs: ref -- a pointer to the pointer to the node
+ *
+ * outputs: none
+ *          updates *ref if the node went away
+ *
+ * A node with only one leaf beneath it is replaced by that leaf.  A node
+ * with a single child (and no exact_match) is merged into the child: the
+ * child's prefix becomes our prefix, then the child's key byte, then its
+ * own prefix
+ */
+static void collapse_node( trie_pointer *ref )
+{
+  struct art_node *node = (struct art_node*)*ref;
+  trie_pointer child;
+  unsigned char c;
+
+  if (node->exact_match) {
+    if (node->num_children > 0)
+      return;
+    *ref = (trie_pointer)node->exact_match;
+    free(node);
+    return;
+  }
+  if (node->num_children != 1)
+    return;
+  child = only_child( node, &c );
+  if (*child != TRIE_LEAF) {
+    struct art_node *q = (struct art_node*)child;
+    unsigned char prefix[ART_MAX_PREFIX];
+    size_t len = 0, n;
+
+    /* Build the new stored prefix: our prefix, c, then the child's */
+    n = node->prefix_len < ART_MAX_PREFIX ? node->prefix_len : ART_MAX_PREFIX;
+    memcpy( prefix, node->prefix, n );
+    len = n;
+    if (len < ART_MAX_PREFIX)
+      prefix[len++] = c;
+    if (len < ART_MAX_PREFIX) {
+      n = q->prefix_len < ART_MAX_PREFIX - len ? q->prefix_len :
+                                                      ART_MAX_PREFIX - len;
+      memcpy( prefix + len, q->prefix, n );
+    }
+    memcpy( q->prefix, prefix, sizeof prefix );
+    q->prefix_len += node->prefix_len + 1;
+  }
+  *ref = child;
+  free(node);
+}
+
+/*
+ * delete_node -- remove an entry from a node
+ *
+ * inputs: ref -- a pointer to the pointer to the node we are modifying
+ *         depth -- the number of key bytes that led to this node
+ *         key -- a pointer to the key to delete
+ *         len_key -- the length (in bytes) of the key to delete
+ *
+ * outputs: nonzero on success, zero on error
+ *          updates *ref on success, if appropriate
+ *
+ * This attempts to remove the given key from the node, returning the node
+ * to the state as if the key had never been inserted
+ * There is only one error condition: if the key was not found within the
+ * node.  On error, the node is unchanged.
+ */
+static int delete_node( trie_pointer *ref, size_t depth,
+             const unsigned char *key, size_t len_key )
+{
+  struct art_node *node;
+
+  /* If the pointer is NULL, then obviously the key was not a member of */
+  /* this node */
+  if (!*ref)
+    return 0;
+
+  if (**ref == TRIE_LEAF) {
+    struct art_leaf *p = (struct art_leaf*)*ref;
+    if (len_key != p->len_key || 0 != memcmp( key, p->key, len_key ))
+      return 0;
+    free( p );
+    *ref = 0;
+    return 1;
+  }
+
+  node = (struct art_node*)*ref;
+  if (node->prefix_len) {
+    if (len_key - depth < node->prefix_len ||
+        prefix_mismatch( node, key, len_key, depth ) < node->prefix_len)
+      return 0;
+    depth += node->prefix_len;
+  }
+
+  if (depth == len_key) {
+    /* If we run out of key, then we need to delete the exact match */
+    struct art_leaf *leaf = node->exact_match;
+    if (!leaf || leaf->len_key != len_key ||
+                 0 != memcmp( key, leaf->key, len_key ))
+      return 0;
+    free( leaf );
+    node->exact_match = 0;
+  } else {
+    trie_pointer *child = find_child( node, key[depth] );
+    if (!child || !delete_node( child, depth+1, key, len_key ))
+      return 0;
+    if (!*child) {
+      remove_child( ref, child, key[depth] );
+      node = (struct art_node*)*ref;  /* It may have shrunk */
+    }
+  }
+
+  node->count -= 1;
+  assert( node->count > 0 );
+  collapse_node( ref );
+  return 1;
+}
+
+/*
+ * trie_delete -- remove an entry from a trie
+ *
+ * inputs: trie -- a pointer to the trie to remove from
+ *         key -- a pointer to the key to delete
+ *         len_key -- the length (in bytes) of the key to delete
+ *
+ * outputs: nonzero on success, zero on error
+ *
+ * This attempts to remove the given key from the trie, so that if you
+ * search for that specific key, it will not be found.
+ * There is only one error condition: if the key was not found within the
+ * trie.  On error, the trie is unchanged.
+ */
+int trie_delete( struct trie *trie, const unsigned char *key, size_t len_key )
+{
+  if (trie) {
+    return delete_node( &trie->root, 0, key, len_key );
+  }
+  return 0;
+}
+
+/*
+ * trie_longest_prefix -- find the longest entry that a key starts with
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         key -- a pointer to the key to look for
+ *         len_key -- the length (in bytes) of the key to look for
+ *         len_match -- if not NULL, where to put the length of the entry
+ *                      that was found
+ *
+ * outputs: the result of the entry, or NULL if no entry is a prefix of
+ *          the key
+ *
+ * The walk down the trie doesn't look at the prefix bytes a node didn't
+ * store, so it can't tell by itself which of the exact_match leaves it
+ * passes really are prefixes of the key.  So we go down twice.  The first
+ * time finds the deepest node the key can reach, and from a leaf beneath
+ * it, how many bytes of the key really match.  The second time stops at
+ * that many bytes, and every exact_match on the way is a true prefix
+ */
+trie_result trie_longest_prefix(const struct trie *trie,
+                                  const unsigned char *key, size_t len_key,
+                                  size_t *len_match)
+{
+  trie_pointer node, *child;
+  const struct art_leaf *leaf, *best = 0;
+  size_t depth = 0, match;
+
+  if (trie == 0 || trie->root == 0)
+    return 0;
+
+  /* First, find a leaf that shares as much of the key as any leaf does */
+  node = trie->root;
+  while (*node != TRIE_LEAF) {
+    struct art_node *p = (struct art_node*)node;
+    depth += p->prefix_len;
+    if (depth >= len_key || !(child = find_child( p, key[depth] )))
+      break;
+    node = *child;
+    depth += 1;
+  }
+  leaf = any_leaf( node );
+  for (match=0; match<len_key && match<leaf->len_key &&
+                            key[match] == leaf->key[match]; match++)
+    ;
+
+  /* Then go down again, no further than that */
+  node = trie->root;
+  depth = 0;
+  while (*node != TRIE_LEAF) {
+    struct art_node *p = (struct art_node*)node;
+    depth += p->prefix_len;
+    if (depth > match)
+      break;
+    if (p->exact_match)
+      best = p->exact_match;
+    if (depth == match || !(child = find_child( p, key[depth] )))
+      break;
+    node = *child;
+    depth += 1;
+  }
+  if (*node == TRIE_LEAF && ((const struct art_leaf*)node)->len_key <= match)
+    best = (const struct art_leaf*)node;
+
+  if (!best)
+    return 0;
+  if (len_match)
+    *len_match = best->len_key;
+  return best->result;
+}
+
+/*
+ * find_prefix -- find the node that holds every key with a given prefix
+ *
+ * inputs: trie -- the trie
+ *         prefix, len_prefix -- the prefix
+ *
+ * outputs: a node, all of whose keys start with the prefix; or NULL if
+ *          no key does
+ *
+ * We go down until the prefix runs out, which may be partway along the
+ * prefix of a node.  Every key beneath that node has the same first
+ * len_prefix bytes, so checking one leaf checks them all, including the
+ * bytes the walk skipped
+ */
+static trie_pointer find_prefix( const struct trie *trie,
+                                 const unsigned char *prefix, size_t len_prefix )
+{
+  trie_pointer node, *child;
+  const struct art_leaf *leaf;
+  size_t depth = 0;
+
+  if (trie == 0 || trie->root == 0)
+    return 0;
+  node = trie->root;
+  while (*node != TRIE_LEAF) {
+    struct art_node *p = (struct art_node*)node;
+    depth += p->prefix_len;
+    if (depth >= len_prefix)
+      break;
+    if (!(child = find_child( p, prefix[depth] )))
+      return 0;
+    node = *child;
+    depth += 1;
+  }
+  leaf = any_leaf( node );
+  if (leaf->len_key < len_prefix || 0 != memcmp( leaf->key, prefix, len_prefix ))
+    return 0;
+  return node;
+}
+
+/*
+ * iterate_node -- visit every key under a node in order
+ *
+ * inputs: node -- the node
+ *         visit, arg -- as for trie_prefix_iterate
+ *
+ * outputs: zero, or what visit returned to stop
+ *
+ * The exact_match comes first, then the children in order of their key
+ * bytes.  The 4 and 16 way nodes keep their keys sorted, so this is easy
+ */
+static int iterate_node( trie_pointer node, trie_visit visit, void *arg )
+{
+  struct art_node *p;
+  int i, stop = 0;
+
+  if (*node == TRIE_LEAF) {
+    const struct art_leaf *leaf = (const struct art_leaf*)node;
+    return visit( leaf->key, leaf->len_key, leaf->result, arg );
+  }
+  p = (struct art_node*)node;
+  if (p->exact_match &&
+      0 != (stop = iterate_node( (trie_pointer)p->exact_match, visit, arg )))
+    return stop;
+  switch (p->type) {
+    case TRIE_NODE4: {
+      struct art_node4 *q = (struct art_node4*)p;
+      for (i=0; i<q->n.num_children && !stop; i++)
+        stop = iterate_node( q->children[i], visit, arg );
+      break;
+    }
+    case TRIE_NODE16: {
+      struct art_node16 *q = (struct art_node16*)p;
+      for (i=0; i<q->n.num_children && !stop; i++)
+        stop = iterate_node( q->children[i], visit, arg );
+      break;
+    }
+    case TRIE_NODE48: {
+      struct art_node48 *q = (struct art_node48*)p;
+      for (i=0; i<256 && !stop; i++)
+        if (q->child_index[i])
+          stop = iterate_node( q->children[ q->child_index[i]-1 ], visit, arg );
+      break;
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *q = (struct art_node256*)p;
+      for (i=0; i<256 && !stop; i++)
+        if (q->children[i])
+          stop = iterate_node( q->children[i], visit, arg );
+      break;
+    }
+    default:
+      assert(0);
+  }
+  return stop;
+}
+
+/*
+ * trie_prefix_iterate -- visit every entry that starts with a prefix
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         prefix -- a pointer to the prefix
+ *         len_prefix -- the length (in bytes) of the prefix
+ *         visit -- the function to call for each entry
+ *         arg -- passed to visit
+ *
+ * outputs: zero if every entry was visited, or the nonzero value that
+ *          visit returned to stop the iteration
+ */
+int trie_prefix_iterate(const struct trie *trie,
+                        const unsigned char *prefix, size_t len_prefix,
+                        trie_visit visit, void *arg)
+{
+  trie_pointer node = find_prefix( trie, prefix, len_prefix );
+
+  return node ? iterate_node( node, visit, arg ) : 0;
+}
+
+/*
+ * trie_count_prefix -- count the entries that start with a prefix
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         prefix -- a pointer to the prefix
+ *         len_prefix -- the length (in bytes) of the prefix
+ *
+ * outputs: the number of entries whose keys start with prefix
+ */
+size_t trie_count_prefix(const struct trie *trie,
+                         const unsigned char *prefix, size_t len_prefix)
+{
+  trie_pointer node = find_prefix( trie, prefix, len_prefix );
+
+  if (!node)
+    return 0;
+  if (*node == TRIE_LEAF)
+    return 1;
+  return ((const struct art_node*)node)->count;
+}
@@ -0,0 +1,214 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include "art_internal.h"
+#include <stdio.h>
+
+/*
+ * Debugging aids for art.c, the same as trie_extra.c is for trie.c
+ */
+
+/*
+ * The children of an inner node, in key order, as (byte, child) pairs.
+ * Returns the number of them
+ */
+static int children( trie_pointer node, unsigned char keys[256],
+                                        trie_pointer child[256] )
+{
+  int i, n = 0;
+
+  switch (*node) {
+    case TRIE_NODE4: {
+      struct art_node4 *p = (struct art_node4*)node;
+      for (n=0; n<p->n.num_children; n++) {
+        keys[n] = p->keys[n];
+        child[n] = p->children[n];
+      }
+      break;
+    }
+    case TRIE_NODE16: {
+      struct art_node16 *p = (struct art_node16*)node;
+      for (n=0; n<p->n.num_children; n++) {
+        keys[n] = p->keys[n];
+        child[n] = p->children[n];
+      }
+      break;
+    }
+    case TRIE_NODE48: {
+      struct art_node48 *p = (struct art_node48*)node;
+      for (i=0; i<256; i++)
+        if (p->child_index[i]) {
+          keys[n] = (unsigned char)i;
+          child[n++] = p->children[ p->child_index[i]-1 ];
+        }
+      break;
+    }
+    case TRIE_NODE256: {
+      struct art_node256 *p = (struct art_node256*)node;
+      for (i=0; i<256; i++)
+        if (p->children[i]) {
+          keys[n] = (unsigned char)i;
+          child[n++] = p->children[i];
+        }
+      break;
+    }
+    default:
+      assert(0);
+  }
+  return n;
+}
+
+static const struct art_leaf *first_leaf( trie_pointer node )
+{
+  unsigned char keys[256];
+  trie_pointer child[256];
+
+  while (*node != TRIE_LEAF) {
+    if (((struct art_node*)node)->exact_match)
+      return ((struct art_node*)node)->exact_match;
+    children( node, keys, child );
+    node = child[0];
+  }
+  return (const struct art_leaf*)node;
+}
+
+int
+print_node( trie_pointer node, char *prefix ) {
+  if (!node) return 0;
+  if (*node == TRIE_LEAF) {
+    struct art_leaf *p = (struct art_leaf*)node;
+    printf( "%s: %*.*s -> %s\n", prefix, (int)p->len_key, (int)p->len_key,
+                                          p->key, (char*)p->result );
+    return 0;
+  } else {
+    struct art_node *p = (struct art_node*)node;
+    unsigned char keys[256];
+    trie_pointer child[256];
+    char new_prefix[ 200 ];
+    int i, n;
+
+    sprintf( new_prefix, "%s [%u+%lu]", prefix,
+            p->type == TRIE_NODE4 ? 4 : p->type == TRIE_NODE16 ? 16 :
+            p->type == TRIE_NODE48 ? 48 : 256, (unsigned long)p->prefix_len );
+    print_node( (trie_pointer)p->exact_match, new_prefix );
+    n = children( node, keys, child );
+    for (i=0; i<n; i++) {
+      char child_prefix[ 210 ];
+      sprintf( child_prefix, "%s %02x", new_prefix, keys[i] );
+      print_node( child[i], child_prefix );
+    }
+    return 0;
+  }
+}
+
+void print_trie( struct trie *trie )
+{
+   print_node( trie->root, "" );
+}
+
+/*
+ * validate_node -- check a node and everything beneath it
+ *
+ * inputs: node -- the node to check
+ *         path -- a key that all keys beneath node must start with
+ *         depth -- how many bytes of path
+ *
+ * outputs: the number of leaves beneath the node, or 0 if it is bad
+ */
+static int validate_node( trie_pointer node, const unsigned char *path,
+                                                            size_t depth )
+{
+  if (*node == TRIE_LEAF) {
+    struct art_leaf *p = (struct art_leaf*)node;
+    if (p->len_key < depth || 0 != memcmp( p->key, path, depth ))
+      return 0;
+    return 1;
+  } else {
+    struct art_node *p = (struct art_node*)node;
+    const struct art_leaf *any = first_leaf( node );
+    unsigned char keys[256];
+    trie_pointer child[256];
+    size_t end = depth + p->prefix_len, stored;
+    int i, n, count = 0, min_children;
+
+    /* The prefix must be what the keys beneath us have */
+    stored = p->prefix_len < ART_MAX_PREFIX ? p->prefix_len : ART_MAX_PREFIX;
+    if (any->len_key < end || 0 != memcmp( any->key, path, depth ) ||
+        0 != memcmp( any->key + depth, p->prefix, stored ))
+      return 0;
+
+    if (p->exact_match) {
+      if (p->exact_match->len_key != end ||
+          !validate_node( (trie_pointer)p->exact_match, any->key, end ))
+        return 0;
+      count += 1;
+    }
+    n = children( node, keys, child );
+    if (n != p->num_children)
+      return 0;
+    switch (p->type) {
+      case TRIE_NODE4: min_children = 0; break;
+      case TRIE_NODE16: min_children = 4; break;
+      case TRIE_NODE48: min_children = 13; break;
+      default: min_children = 38; break;
+    }
+    if (n < min_children)
+      return 0;
+    for (i=0; i<n; i++) {
+      const struct art_leaf *first = first_leaf( child[i] );
+      int m;
+      if (i > 0 && keys[i] <= keys[i-1])
+        return 0;
+      if (first->len_key <= end || first->key[end] != keys[i] ||
+          0 != memcmp( first->key, any->key, end ))
+        return 0;
+      m = validate_node( child[i], first->key, end+1 );
+      if (!m) return 0;
+      count += m;
+    }
+    /* No node that doesn't branch */
+    if (count < 2 || count != p->count || (n == 1 && !p->exact_match))
+      return 0;
+    return count;
+  }
+}
+
+int validate_trie( struct trie *trie )
+{
+   if (trie->root)
+      return 0 != validate_node( trie->root, (const unsigned char *)"", 0 );
+   else
+      return 1;
+}
+
+/*
+ * The number of bytes of memory that the trie takes up (not counting
+ * malloc's own overhead)
+ */
+static size_t node_memory( trie_pointer node )
+{
+  unsigned char keys[256];
+  trie_pointer child[256];
+  size_t total;
+  int i, n;
+
+  if (*node == TRIE_LEAF)
+    return sizeof( struct art_leaf ) - 1 + ((struct art_leaf*)node)->len_key;
+  switch (*node) {
+    case TRIE_NODE4: total = sizeof( struct art_node4 ); break;
+    case TRIE_NODE16: total = sizeof( struct art_node16 ); break;
+    case TRIE_NODE48: total = sizeof( struct art_node48 ); break;
+    default: total = sizeof( struct art_node256 ); break;
+  }
+  if (((struct art_node*)node)->exact_match)
+    total += node_memory( (trie_pointer)((struct art_node*)node)->exact_match );
+  n = children( node, keys, child );
+  for (i=0; i<n; i++)
+    total += node_memory( child[i] );
+  return total;
+}
+
+size_t trie_memory( struct trie *trie )
+{
+  return sizeof( *trie ) + (trie->root ? node_memory( trie->root ) : 0);
+}
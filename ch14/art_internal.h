@@ -0,0 +1,97 @@
+#if !defined( ART_INTERNAL_H_ )
+#define ART_INTERNAL_H_
+
+/*
+ * This file defines the private internals for the adaptive radix tree
+ * version of the trie management module (art.c)
+ * No file outside the trie code itself should include this
+ *
+ * An adaptive radix tree takes one whole byte of key per level, but does
+ * not give every inner node a 256 entry array.  Instead, there are four
+ * sizes of inner node, and a node is grown or shrunk to the smallest one
+ * that holds its children:
+ *
+ *   TRIE_NODE4    up to 4 children, the key bytes in a sorted array
+ *   TRIE_NODE16   up to 16 children, the key bytes in a sorted array that
+ *                 is searched 16 at a time with SSE2, where we have it
+ *   TRIE_NODE48   up to 48 children, with a 256 entry byte index into them
+ *   TRIE_NODE256  a child pointer for every byte value
+ *
+ * In addition, a chain of inner nodes with one child each is collapsed
+ * into a single node that carries the bytes of the chain as its prefix
+ * (path compression).  Only the first ART_MAX_PREFIX bytes of the prefix
+ * are stored in the node.  A search skips the rest, and relies on the
+ * final compare against the leaf to catch a mismatch there.  An insert
+ * that needs those bytes gets them from any leaf beneath the node, since
+ * all of them share the prefix.
+ *
+ * Every inner node has at least two leaves beneath it.
+ */
+
+#include "trie.h"
+
+/*
+ * This is the number of prefix bytes kept in an inner node.  Making it
+ * larger makes inserts into long shared prefixes (URLs) a bit cheaper,
+ * and makes every inner node bigger
+ */
+#define ART_MAX_PREFIX 10
+
+/*
+ * This is the internal representation of a leaf, which corresponds to
+ * a single key.  The key is kept in the same allocation, right after the
+ * leaf
+ */
+struct art_leaf {
+  enum trie_node_type type; /* TRIE_LEAF.  This is the type field to */
+                         /* identify the node type, and must be the first */
+                         /* element of this structure */
+  trie_result result;    /* The value that trie_search should return when */
+                         /* we find this key */
+  size_t len_key;        /* The length of the key, in bytes */
+  unsigned char key[1];  /* The key itself (len_key bytes are allocated) */
+};
+
+/*
+ * This is the part that every inner node starts with
+ */
+struct art_node {
+  enum trie_node_type type; /* TRIE_NODE4, 16, 48 or 256.  This is the */
+                         /* type field to identify the node type, and */
+                         /* must be the first element of this structure */
+  int num_children;      /* The number of non-NULL children */
+  int count;             /* The number of leaves beneath this node, */
+                         /* including exact_match */
+  size_t prefix_len;     /* The number of key bytes that every key beneath */
+                         /* this node has in common, after the byte that */
+                         /* led to this node */
+  unsigned char prefix[ART_MAX_PREFIX]; /* The first of those bytes */
+  struct art_leaf *exact_match; /* The leaf for the key that ends right */
+                         /* after the prefix, or NULL */
+};
+
+struct art_node4 {
+  struct art_node n;
+  unsigned char keys[4]; /* Sorted.  keys[i] leads to children[i] */
+  trie_pointer children[4];
+};
+
+struct art_node16 {
+  struct art_node n;
+  unsigned char keys[16]; /* Sorted.  keys[i] leads to children[i] */
+  trie_pointer children[16];
+};
+
+struct art_node48 {
+  struct art_node n;
+  unsigned char child_index[256]; /* Byte N leads to children[ */
+                         /* child_index[N]-1 ], or nowhere if it is 0 */
+  trie_pointer children[48];
+};
+
+struct art_node256 {
+  struct art_node n;
+  trie_pointer children[256]; /* Byte N leads to children[N] */
+};
+
+#endif /* ART_INTERNAL_H_ */
@@ -1,10 +1,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
 #include "trie.h"
 
 extern int validate_trie( struct trie *trie );
 extern void print_trie( struct trie *trie );
+extern size_t trie_memory( struct trie *trie );
 
 void error( const char *s ) {
   printf( "%s\n", s );
@@ -32,12 +35,64 @@ void check( struct trie *trie, char *s, char *t ) {
     error( "found wrong " );
 }
 
+struct order {
+  char last[11];
+  int count;
+};
+
+static int check_order( const unsigned char *key, size_t len_key,
+                        trie_result result, void *arg ) {
+  struct order *o = arg;
+  char s[11];
+
+  memcpy( s, key, len_key );
+  s[len_key] = 0;
+  if (o->count > 0 && strcmp( o->last, s ) >= 0) error( "prefix order" );
+  strcpy( o->last, s );
+  o->count += 1;
+  (void)result;
+  return 0;
+}
+
+/*
+ * Check the prefix queries against a search through all the strings
+ */
+void check_prefixes( struct trie *p, char *strings[][2], int num_strings ) {
+  char q[8], *expect = 0;
+  size_t len_q = rand() % 7, len_prefix = rand() % 3, len_match;
+  struct order o;
+  int i, count = 0;
+
+  for (i=0; i<(int)len_q; i++)
+    q[i] = '0' + (rand() % 10);
+  q[len_q] = 0;
+  if (len_prefix > len_q) len_prefix = len_q;
+  for (i=0; i<num_strings; i++) {
+    size_t len = strlen( strings[i][0] );
+    if (len <= len_q && 0 == memcmp( strings[i][0], q, len ) &&
+        (!expect || len > strlen( expect )))
+      expect = strings[i][0];
+    if (0 == strncmp( strings[i][0], q, len_prefix ))
+      count += 1;
+  }
+  if (trie_longest_prefix( p, (unsigned char*)q, len_q, &len_match ) !=
+      (expect ? trie_search( p, (unsigned char*)expect, strlen(expect) ) : 0))
+    error( "longest prefix" );
+  if (expect && len_match != strlen( expect )) error( "longest prefix length" );
+  if (trie_count_prefix( p, (unsigned char*)q, len_prefix ) != (size_t)count)
+    error( "count prefix" );
+  o.count = 0;
+  trie_prefix_iterate( p, (unsigned char*)q, len_prefix, check_order, &o );
+  if (o.count != count) error( "prefix iterate" );
+}
+
 void check_strings( struct trie *p, char *strings[][2], int num_strings ) {
   int i;
 
   if (!validate_trie( p )) error( "validate" );
   for (i=0; i<num_strings; i++)
     check( p, strings[i][0], strings[i][1] );
+  check_prefixes( p, strings, num_strings );
 }
 
 void add_string( struct trie *p, char *strings[][2], int num_strings, int i ) {
@@ -71,17 +126,426 @@ void remove_string( struct trie *p, char *s ) {
       error( "second delete failed" );
 }
 
-int main() {
+/*
+ * The keys above are short and made of digits, so no node ever has more
+ * than 11 children or a long prefix.  These keys have long runs in common,
+ * longer than art.c keeps in a node, and then one of 200 bytes, so the
+ * nodes grow to the biggest kind and, as the keys are deleted again, shrink
+ * back.  Everything is checked against a search through all the keys
+ */
+#define WIDE_KEYS 800
+#define WIDE_LEN 64
+
+static unsigned char wide_key[WIDE_KEYS][WIDE_LEN];
+static size_t wide_len[WIDE_KEYS];
+static char wide_value[WIDE_KEYS][8];
+static int wide_in[WIDE_KEYS];
+
+struct wide_order {
+  unsigned char last[WIDE_LEN];
+  size_t len_last;
+  int count;
+};
+
+static int check_wide_order( const unsigned char *key, size_t len_key,
+                             trie_result result, void *arg ) {
+  struct wide_order *o = arg;
+  size_t len = len_key < o->len_last ? len_key : o->len_last;
+  int c = memcmp( o->last, key, len );
+
+  if (o->count > 0 && (c > 0 || (c == 0 && o->len_last >= len_key)))
+    error( "wide prefix order" );
+  memcpy( o->last, key, len_key );
+  o->len_last = len_key;
+  o->count += 1;
+  (void)result;
+  return 0;
+}
+
+static void make_wide_keys( void ) {
+  static const char common[] = "/usr/share/a/long/common/path/";
+  size_t len_common = sizeof common - 1;
+  int k, j;
+
+  for (k=0; k<WIDE_KEYS; k++) {
+    do {
+      unsigned char *key = wide_key[k];
+      size_t len = 0, cut;
+      switch (k % 4) {
+        case 0:         /* the common part, then each wide byte once */
+          memcpy( key, common, len_common );
+          len = len_common;
+          key[len++] = (unsigned char)(1 + k / 4);
+          break;
+        case 1:         /* the common part, then two wide bytes */
+          memcpy( key, common, len_common );
+          len = len_common;
+          key[len++] = (unsigned char)(1 + rand() % 200);
+          key[len++] = (unsigned char)(1 + rand() % 200);
+          break;
+        case 2:         /* some of the common part, maybe a byte that
+                           the others don't use */
+          len = rand() % (len_common + 1);
+          memcpy( key, common, len );
+          if (rand() % 2)
+            key[len++] = (unsigned char)(201 + rand() % 55);
+          break;
+        default:        /* a wide byte between two long common runs */
+          cut = len_common / 2;
+          memcpy( key, common, cut );
+          len = cut;
+          key[len++] = (unsigned char)(1 + rand() % 200);
+          memcpy( key + len, common, len_common );
+          len += len_common;
+          key[len++] = (unsigned char)(1 + rand() % 200);
+          break;
+      }
+      wide_len[k] = len;
+      for (j=0; j<k; j++)
+        if (wide_len[j] == len && 0 == memcmp( wide_key[j], key, len ))
+          break;
+    } while (j < k);
+    sprintf( wide_value[k], "w%d", k );
+    wide_in[k] = 0;
+  }
+}
+
+static void check_wide_queries( struct trie *p ) {
+  struct wide_order o;
+  int i, j, k, count, expect;
+  size_t len_q, len_match;
+
+  if (!validate_trie( p )) error( "wide validate" );
+  for (k=0; k<WIDE_KEYS; k++)
+    if (trie_search( p, wide_key[k], wide_len[k] ) !=
+        (wide_in[k] ? wide_value[k] : 0))
+      error( "wide search" );
+
+  for (i=0; i<20; i++) {
+    k = rand() % WIDE_KEYS;
+    len_q = rand() % (wide_len[k] + 1);
+    expect = -1;
+    count = 0;
+    for (j=0; j<WIDE_KEYS; j++) {
+      if (!wide_in[j]) continue;
+      if (wide_len[j] <= len_q && 0 == memcmp( wide_key[j], wide_key[k], wide_len[j] ) &&
+          (expect < 0 || wide_len[j] > wide_len[expect]))
+        expect = j;
+      if (wide_len[j] >= len_q && 0 == memcmp( wide_key[j], wide_key[k], len_q ))
+        count += 1;
+    }
+    if (trie_longest_prefix( p, wide_key[k], len_q, &len_match ) !=
+        (expect < 0 ? 0 : wide_value[expect]))
+      error( "wide longest prefix" );
+    if (expect >= 0 && len_match != wide_len[expect])
+      error( "wide longest prefix length" );
+    if (trie_count_prefix( p, wide_key[k], len_q ) != (size_t)count)
+      error( "wide count prefix" );
+    o.count = 0;
+    o.len_last = 0;
+    trie_prefix_iterate( p, wide_key[k], len_q, check_wide_order, &o );
+    if (o.count != count) error( "wide prefix iterate" );
+  }
+}
+
+void check_wide( void ) {
+  struct trie *p = trie_create();
+  int step, k, deleting, present = 0;
+
+  if (!p) error( "trie_create" );
+  make_wide_keys();
+  for (step=0; step<40000; step++) {
+    /* Fill the trie up to about 90%, then empty it to about 5% */
+    deleting = (step / 4000) % 2 ? rand() % 100 < 95 : rand() % 100 < 10;
+    k = rand() % WIDE_KEYS;
+    if (wide_in[k] && deleting) {
+      if (0 == trie_delete( p, wide_key[k], wide_len[k] ))
+        error( "wide delete" );
+      wide_in[k] = 0;
+      present -= 1;
+    } else if (!wide_in[k] && !deleting) {
+      if (0 == trie_insert( p, wide_key[k], wide_len[k], wide_value[k] ))
+        error( "wide insert" );
+      wide_in[k] = 1;
+      present += 1;
+    }
+    if (step % 200 == 0)
+      check_wide_queries( p );
+  }
+  check_wide_queries( p );
+  trie_destroy( p );
+  printf( "Wide keys: %d left of %d\n", present, WIDE_KEYS );
+}
+
+/*
+ * Overwrite some words of a saved trie after its header with random ones,
+ * map it, and search it.  The answers may be wrong, but the searches must
+ * not read outside the mapping (run it under a memory checker to see)
+ */
+void check_damaged_map( const char *filename, char *strings[][2],
+                        int num_strings ) {
+  struct trie_map *map;
+  FILE *f;
+  uint32_t *words;
+  long size;
+  int i, j;
+
+  if (!(f = fopen( filename, "r+b" ))) error( "open map" );
+  fseek( f, 0L, SEEK_END );
+  size = ftell( f );
+  if (size < 64) {
+    fclose( f );
+    return;
+  }
+  if (!(words = malloc( (size_t)size ))) error( "malloc" );
+  fseek( f, 0L, SEEK_SET );
+  if (fread( words, 1, (size_t)size, f ) != (size_t)size) error( "read map" );
+  for (j=0; j<4; j++) {
+    i = 8 + rand() % (int)(size / 4 - 8);
+    words[i] = rand() % 2 ? (uint32_t)rand() * 65599u : (uint32_t)rand() % 64;
+  }
+  fseek( f, 0L, SEEK_SET );
+  if (fwrite( words, 1, (size_t)size, f ) != (size_t)size) error( "write map" );
+  fclose( f );
+  free( words );
+
+  if (!(map = trie_map_open( filename ))) error( "trie_map_open damaged" );
+  for (i=0; i<num_strings; i++)
+    trie_search_mapped( map, (unsigned char*)strings[i][0],
+                        strlen( strings[i][0] ), 0 );
+  trie_map_close( map );
+}
+
+/*
+ * Save the trie, map it, and check that the mapped trie has the same
+ * strings in it, and no others
+ */
+void check_mapped( struct trie *p, char *strings[][2], int num_strings ) {
+  struct trie *empty;
+  struct trie_map *map;
+  size_t len;
+  int i;
+
+  if (!trie_save( p, "test_trie.map", 0, 0 )) error( "trie_save" );
+  if (!(map = trie_map_open( "test_trie.map" ))) error( "trie_map_open" );
+  for (i=0; i<num_strings; i++) {
+    const char *r = trie_search_mapped( map, (unsigned char*)strings[i][0],
+                                        strlen( strings[i][0] ), &len );
+    if (!r || 0 != strcmp( r, strings[i][1] ) || len != strlen( r ) + 1)
+      error( "mapped search" );
+  }
+  for (i=0; i<1000; i++) {
+    char s[8];
+    int j, k, len_s = rand() % 7;
+    for (j=0; j<len_s; j++)
+      s[j] = '0' + (rand() % 10);
+    s[len_s] = 0;
+    for (k=0; k<num_strings; k++)
+      if (0 == strcmp( s, strings[k][0] ))
+        break;
+    if ((k == num_strings) !=
+        (0 == trie_search_mapped( map, (unsigned char*)s, len_s, 0 )))
+      error( "mapped search miss" );
+  }
+
+  /* saving over the file must leave the old mapping as it was */
+  if (!(empty = trie_create())) error( "trie_create" );
+  if (!trie_save( empty, "test_trie.map", 0, 0 )) error( "trie_save empty" );
+  trie_destroy( empty );
+  for (i=0; i<num_strings; i++)
+    if (!trie_search_mapped( map, (unsigned char*)strings[i][0],
+                             strlen( strings[i][0] ), 0 ))
+      error( "mapped search after save" );
+  trie_map_close( map );
+  if (!(map = trie_map_open( "test_trie.map" ))) error( "trie_map_open empty" );
+  for (i=0; i<num_strings; i++)
+    if (trie_search_mapped( map, (unsigned char*)strings[i][0],
+                            strlen( strings[i][0] ), 0 ))
+      error( "mapped search empty" );
+  trie_map_close( map );
+
+  if (!trie_save( p, "test_trie.map", 0, 0 )) error( "trie_save" );
+  check_damaged_map( "test_trie.map", strings, num_strings );
+  remove( "test_trie.map" );
+}
+
+/*
+ * The benchmark: test_trie -bench [n]
+ *
+ * This makes n keys that look like URLs (a host name, then a path), and
+ * times inserting them, searching for all of them in a different order,
+ * searching for n keys that aren't there, and deleting them all.  It also
+ * reports how much memory the trie takes, and times saving the trie,
+ * mapping it and searching the mapped trie.  Link with trie.c and
+ * trie_extra.c, or with art.c and art_extra.c, to compare the two (and
+ * with trie_map.c either way)
+ */
+static const char *syllable[] = { "ex", "am", "ple", "new", "s", "shop",
+  "mail", "cloud", "data", "net", "web", "st", "or", "age", "tech", "on",
+  "line", "my", "go", "get", "hub", "app", "box", "zen" };
+static const char *tld[] = { ".com", ".org", ".net", ".de", ".co.uk", ".io" };
+#define NUM( a ) (sizeof(a) / sizeof(a[0]))
+
+static char *make_word( char *s, int min, int max ) {
+  int i, n = min + rand() % (max - min + 1);
+  for (i=0; i<n; i++) {
+    strcpy( s, syllable[ rand() % NUM(syllable) ] );
+    s += strlen( s );
+  }
+  return s;
+}
+
+static void make_url( char *s ) {
+  int i, segments = rand() % 4;
+  s += sprintf( s, "%s", rand() % 2 ? "https://" : "http://" );
+  if (rand() % 3) s += sprintf( s, "www." );
+  s = make_word( s, 1, 3 );
+  s += sprintf( s, "%s/", tld[ rand() % NUM(tld) ] );
+  for (i=0; i<segments; i++) {
+    s = make_word( s, 1, 2 );
+    *s++ = '/';
+  }
+  if (rand() % 2)
+    s += sprintf( s, "item?id=%d", rand() % 100000 );
+  *s = 0;
+}
+
+static double seconds_since( clock_t start ) {
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static int bench( long n ) {
+  struct trie *p;
+  struct trie_map *map;
+  FILE *f;
+  char **keys, **misses;
+  long i, inserted = 0, found = 0, total_len = 0;
+  long *order;
+  clock_t start;
+  double t;
+
+  keys = malloc( n * sizeof *keys );
+  misses = malloc( n * sizeof *misses );
+  order = malloc( n * sizeof *order );
+  p = trie_create();
+  if (!keys || !misses || !order || !p) error( "out of memory" );
+  srand( 1 );
+  for (i=0; i<n; i++) {
+    char buf[ 200 ];
+    make_url( buf );
+    keys[i] = malloc( strlen( buf ) + 1 );
+    strcpy( keys[i], buf );
+    total_len += strlen( buf );
+    /* A key that isn't there: the same URL with a byte changed */
+    buf[ strlen(buf) / 2 ] ^= 0x80;
+    misses[i] = malloc( strlen( buf ) + 1 );
+    strcpy( misses[i], buf );
+    order[i] = i;
+  }
+  for (i=n-1; i>0; i--) {
+    long j = ((long)rand() * (RAND_MAX + 1L) + rand()) % (i + 1);
+    long tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+  }
+
+  printf( "%ld URLs, %.1f bytes each on average\n", n, (double)total_len / n );
+  start = clock();
+  for (i=0; i<n; i++)
+    inserted += trie_insert( p, (unsigned char*)keys[i], strlen(keys[i]), keys[i] );
+  t = seconds_since( start );
+  printf( "insert:        %8.1f ns/key (%ld distinct)\n", t * 1e9 / n, inserted );
+  printf( "memory:        %8.1f bytes/key\n", (double)trie_memory( p ) / inserted );
+
+  start = clock();
+  for (i=0; i<n; i++) {
+    char *k = keys[ order[i] ];
+    found += 0 != trie_search( p, (unsigned char*)k, strlen(k) );
+  }
+  t = seconds_since( start );
+  printf( "search (hit):  %8.1f ns/key\n", t * 1e9 / n );
+  if (found != n) error( "search hit" );
+
+  found = 0;
+  start = clock();
+  for (i=0; i<n; i++)
+    found += 0 != trie_search( p, (unsigned char*)misses[i], strlen(misses[i]) );
+  t = seconds_since( start );
+  printf( "search (miss): %8.1f ns/key\n", t * 1e9 / n );
+  if (found != 0) error( "search miss" );
+
+  if (!validate_trie( p )) error( "validate" );
+
+  start = clock();
+  if (!trie_save( p, "test_trie.map", 0, 0 )) error( "trie_save" );
+  t = seconds_since( start );
+  printf( "save:          %8.1f ns/key\n", t * 1e9 / n );
+  start = clock();
+  map = trie_map_open( "test_trie.map" );
+  t = seconds_since( start );
+  if (!map) error( "trie_map_open" );
+  printf( "map open:      %8.1f us\n", t * 1e6 );
+  if ((f = fopen( "test_trie.map", "rb" )) != 0) {
+    fseek( f, 0L, SEEK_END );
+    printf( "map file:      %8.1f bytes/key\n", (double)ftell( f ) / inserted );
+    fclose( f );
+  }
+
+  found = 0;
+  start = clock();
+  for (i=0; i<n; i++) {
+    char *k = keys[ order[i] ];
+    const char *r = trie_search_mapped( map, (unsigned char*)k, strlen(k), 0 );
+    found += r != 0 && 0 == strcmp( r, k );
+  }
+  t = seconds_since( start );
+  printf( "mapped (hit):  %8.1f ns/key\n", t * 1e9 / n );
+  if (found != n) error( "mapped search hit" );
+
+  found = 0;
+  start = clock();
+  for (i=0; i<n; i++)
+    found += 0 != trie_search_mapped( map, (unsigned char*)misses[i], strlen(misses[i]), 0 );
+  t = seconds_since( start );
+  printf( "mapped (miss): %8.1f ns/key\n", t * 1e9 / n );
+  if (found != 0) error( "mapped search miss" );
+  trie_map_close( map );
+  remove( "test_trie.map" );
+
+  start = clock();
+  for (i=0; i<n; i++) {
+    char *k = keys[ order[i] ];
+    trie_delete( p, (unsigned char*)k, strlen(k) );
+  }
+  t = seconds_since( start );
+  printf( "delete:        %8.1f ns/key\n", t * 1e9 / n );
+  if (p->root) error( "delete" );
+
+  trie_destroy( p );
+  for (i=0; i<n; i++) {
+    free( keys[i] );
+    free( misses[i] );
+  }
+  free( keys );
+  free( misses );
+  free( order );
+  return 0;
+}
+
+int main( int argc, char **argv ) {
   struct trie *p;
   int i;
   char *strings[200][2];
   int num_strings = 0;
 
+  if (argc > 1 && 0 == strcmp( argv[1], "-bench" ))
+    return bench( argc > 2 ? atol( argv[2] ) : 1000000L );
+
   p = trie_create();
   if (!p) error( "trie_create" );
 
   for (i=0; i<100000; i++) {
     check_strings( p, strings, num_strings );
+    if (i % 1000 == 0)
+      check_mapped( p, strings, num_strings );
 
     if (num_strings < rand() % 200) {
       add_string( p, strings, num_strings, i );
@@ -98,6 +562,8 @@ int main() {
   }
   print_trie( p );
   if (!validate_trie( p )) error( "validate" );
+  check_mapped( p, strings, num_strings );
+  check_wide();
 
   printf( "Success!\n" );
 
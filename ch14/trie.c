@@ -528,3 +528,209 @@ int trie_delete( struct trie *trie, const unsigned char *key, size_t len_key )
   }  
   return 0;
 }
+
+/*
+ * has_prefix -- check whether a leaf's key starts with a prefix
+ */
+static int has_prefix( const struct trie_leaf *leaf,
+                       const unsigned char *prefix, size_t len_prefix )
+{
+  return leaf->len_key >= len_prefix &&
+         0 == memcmp( leaf->key, prefix, len_prefix );
+}
+
+/*
+ * trie_longest_prefix -- find the longest entry that a key starts with
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         key -- a pointer to the key to look for
+ *         len_key -- the length (in bytes) of the key to look for
+ *         len_match -- if not NULL, where to put the length of the entry
+ *                      that was found
+ *
+ * outputs: the result of the entry, or NULL if no entry is a prefix of
+ *          the key
+ *
+ * This walks the key down the trie just as trie_search does.  The
+ * exact_match of every subtrie on the way is a prefix of the key (the
+ * position of a subtrie gives its prefix), so the last one we pass is the
+ * best so far.  If the walk ends on a leaf, that leaf may be better still
+ */
+trie_result trie_longest_prefix(const struct trie *trie,
+                                  const unsigned char *key, size_t len_key,
+                                  size_t *len_match)
+{
+  trie_pointer node;
+  key_walker walker;
+  const struct trie_leaf *best = 0;
+
+  if (trie == 0)
+    return 0;
+
+  initialize_walker(walker, key, len_key);
+  node = trie->root;
+  while (node) {
+    const struct trie_subtrie *q;
+    int n;
+
+    if (*node == TRIE_LEAF) {
+      const struct trie_leaf *leaf = (const struct trie_leaf*)node;
+      if (leaf->len_key <= len_key && has_prefix( leaf, key, leaf->len_key ))
+        best = leaf;
+      break;
+    }
+    q = (const struct trie_subtrie*)node;
+    if (q->exact_match)
+      best = q->exact_match;
+    n = extract_next(walker);
+    if (n < 0)
+      break;
+    assert( n < TRIE_BRANCH_FACTOR );
+    node = q->next_level[n];
+  }
+
+  if (!best)
+    return 0;
+  if (len_match)
+    *len_match = best->len_key;
+  return best->result;
+}
+
+/*
+ * find_prefix -- find the node that holds every key with a given prefix
+ *
+ * inputs: trie -- the trie
+ *         prefix, len_prefix -- the prefix
+ *
+ * outputs: a subtrie, all of whose keys start with the prefix; a leaf,
+ *          whose key starts with the prefix; or NULL if no key does
+ */
+static trie_pointer find_prefix( const struct trie *trie,
+                                 const unsigned char *key, size_t len_key )
+{
+  trie_pointer node;
+  key_walker walker;
+  int n;
+
+  if (trie == 0)
+    return 0;
+  initialize_walker(walker, key, len_key);
+  node = trie->root;
+  while (node && *node == TRIE_SUBTRIE && (n = extract_next(walker)) >= 0)
+    node = ((const struct trie_subtrie*)node)->next_level[n];
+  if (node && *node == TRIE_LEAF &&
+      !has_prefix( (const struct trie_leaf*)node, key, len_key ))
+    return 0;
+  return node;
+}
+
+/*
+ * byte_child -- the node for the keys that go on with byte v
+ *
+ * inputs: node -- a subtrie that sits on a byte boundary
+ *         v -- the next byte
+ *         depth -- the number of bytes that led to node
+ *
+ * outputs: the subtrie or leaf that holds the keys that have byte v next,
+ *          or NULL if there are none
+ *
+ * When TRIE_BRANCH_FACTOR is less than a byte, the byte is spread over
+ * LEVEL_PER_UCHAR levels, low bits first.  A leaf may turn up partway
+ * through; it only belongs to v if its key has v at this depth
+ */
+static trie_pointer byte_child( trie_pointer node, int v, size_t depth )
+{
+#if TRIE_BRANCH_FACTOR > UCHAR_MAX
+  return ((const struct trie_subtrie*)node)->next_level[v];
+#else
+  int i;
+
+  for (i=0; i<LEVEL_PER_UCHAR && node; i++) {
+    if (*node == TRIE_LEAF) {
+      const struct trie_leaf *leaf = (const struct trie_leaf*)node;
+      return leaf->key[depth] == v ? node : 0;
+    }
+    node = ((const struct trie_subtrie*)node)->next_level[
+              (v >> (i*TRIE_LOG_BRANCH_FACTOR)) & (TRIE_BRANCH_FACTOR-1) ];
+  }
+  return node;
+#endif
+}
+
+/*
+ * iterate_node -- visit every key under a node in order
+ *
+ * inputs: node -- a subtrie that sits on a byte boundary, or a leaf
+ *         depth -- the number of bytes that led to node
+ *         visit, arg -- as for trie_prefix_iterate
+ *
+ * outputs: zero, or what visit returned to stop
+ *
+ * The exact_match comes first, then the keys that go on, byte by byte.
+ * Each subtrie looks at up to 256 byte values, but it has at least two
+ * keys beneath it, so this is still proportional to the number visited
+ */
+static int iterate_node( trie_pointer node, size_t depth,
+                         trie_visit visit, void *arg )
+{
+  const struct trie_subtrie *q;
+  int v, stop;
+
+  if (!node)
+    return 0;
+  if (*node == TRIE_LEAF) {
+    const struct trie_leaf *leaf = (const struct trie_leaf*)node;
+    return visit( leaf->key, leaf->len_key, leaf->result, arg );
+  }
+  q = (const struct trie_subtrie*)node;
+  if (q->exact_match &&
+      0 != (stop = iterate_node( (trie_pointer)q->exact_match, depth, visit, arg )))
+    return stop;
+  for (v=0; v<=UCHAR_MAX; v++) {
+    if (0 != (stop = iterate_node( byte_child( node, v, depth ), depth+1,
+                                                          visit, arg )))
+      return stop;
+  }
+  return 0;
+}
+
+/*
+ * trie_prefix_iterate -- visit every entry that starts with a prefix
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         prefix -- a pointer to the prefix
+ *         len_prefix -- the length (in bytes) of the prefix
+ *         visit -- the function to call for each entry
+ *         arg -- passed to visit
+ *
+ * outputs: zero if every entry was visited, or the nonzero value that
+ *          visit returned to stop the iteration
+ */
+int trie_prefix_iterate(const struct trie *trie,
+                        const unsigned char *prefix, size_t len_prefix,
+                        trie_visit visit, void *arg)
+{
+  return iterate_node( find_prefix( trie, prefix, len_prefix ), len_prefix,
+                                                               visit, arg );
+}
+
+/*
+ * trie_count_prefix -- count the entries that start with a prefix
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         prefix -- a pointer to the prefix
+ *         len_prefix -- the length (in bytes) of the prefix
+ *
+ * outputs: the number of entries whose keys start with prefix
+ */
+size_t trie_count_prefix(const struct trie *trie,
+                         const unsigned char *prefix, size_t len_prefix)
+{
+  trie_pointer node = find_prefix( trie, prefix, len_prefix );
+
+  if (!node)
+    return 0;
+  if (*node == TRIE_LEAF)
+    return 1;
+  return ((const struct trie_subtrie*)node)->count;
+}
@@ -20,8 +20,15 @@ typedef void *trie_result;
  * because all nodes that can appear within a trie are structures that
  * have a enum trie_node_type as its first element, and a pointer to a
  * structure can be portably converted into a point to the first element
+ *
+ * There are two implementations of this interface.  trie.c is a trie that
+ * takes TRIE_LOG_BRANCH_FACTOR bits of key per level, and uses TRIE_LEAF
+ * and TRIE_SUBTRIE nodes.  art.c is an adaptive radix tree, which takes a
+ * byte per level, and uses TRIE_LEAF and the TRIE_NODE* nodes.  Link with
+ * one or the other
  */
-enum trie_node_type { TRIE_LEAF, TRIE_SUBTRIE };
+enum trie_node_type { TRIE_LEAF, TRIE_SUBTRIE,
+                      TRIE_NODE4, TRIE_NODE16, TRIE_NODE48, TRIE_NODE256 };
 typedef enum trie_node_type *trie_pointer;
 
 /*
@@ -112,4 +119,160 @@ int trie_delete(struct trie *trie, const unsigned char *key, size_t len_key);
 trie_result trie_search(const struct trie *trie,
                                   const unsigned char *key, size_t len_key);
 
+/*
+ * trie_longest_prefix -- find the longest entry that a key starts with
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         key -- a pointer to the key to look for
+ *         len_key -- the length (in bytes) of the key to look for
+ *         len_match -- if not NULL, where to put the length of the entry
+ *                      that was found
+ *
+ * outputs: the result of the entry, or NULL if no entry is a prefix of
+ *          the key
+ *
+ * This is the lookup for a routing table: of all the entries that are a
+ * prefix of key (including key itself, and the empty key), it finds the
+ * longest one.  It takes time proportional to len_key.
+ */
+trie_result trie_longest_prefix(const struct trie *trie,
+                                  const unsigned char *key, size_t len_key,
+                                  size_t *len_match);
+
+/*
+ * This is the type of the function that trie_prefix_iterate calls for
+ * each entry.  It gets the key of the entry (which belongs to the trie,
+ * and must not be changed), its length and its result, and the arg that
+ * was given to trie_prefix_iterate.  If it returns nonzero, the iteration
+ * stops there
+ */
+typedef int (*trie_visit)(const unsigned char *key, size_t len_key,
+                          trie_result result, void *arg);
+
+/*
+ * trie_prefix_iterate -- visit every entry that starts with a prefix
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         prefix -- a pointer to the prefix
+ *         len_prefix -- the length (in bytes) of the prefix
+ *         visit -- the function to call for each entry
+ *         arg -- passed to visit
+ *
+ * outputs: zero if every entry was visited, or the nonzero value that
+ *          visit returned to stop the iteration
+ *
+ * The entries are visited in lexicographic order of their keys (bytes
+ * compared as unsigned char, and a key comes before all longer keys
+ * that start with it).  Nothing is allocated, and the time taken is
+ * proportional to len_prefix plus the number of entries visited.  The
+ * trie must not be changed while this is going on.
+ */
+int trie_prefix_iterate(const struct trie *trie,
+                        const unsigned char *prefix, size_t len_prefix,
+                        trie_visit visit, void *arg);
+
+/*
+ * trie_count_prefix -- count the entries that start with a prefix
+ *
+ * inputs: trie -- a pointer to the trie to search
+ *         prefix -- a pointer to the prefix
+ *         len_prefix -- the length (in bytes) of the prefix
+ *
+ * outputs: the number of entries whose keys start with prefix
+ *
+ * This uses the count that each node keeps of the entries beneath it, so
+ * it takes time proportional to len_prefix, however many entries there are
+ */
+size_t trie_count_prefix(const struct trie *trie,
+                         const unsigned char *prefix, size_t len_prefix);
+
+/*
+ * The mapped trie.  trie_save writes a trie to a file that has no pointers
+ * in it, only offsets from the start of the file, so the file can be used
+ * just as it is.  trie_map_open maps that file into memory read-only,
+ * which takes the same short time however big the file is.  The pages
+ * come from the file as they are touched, and are shared by every process
+ * that maps the same file.  A mapped trie can't be changed; to change
+ * it, build a new struct trie and save it again.  This is in trie_map.c,
+ * which works with either trie.c or art.c
+ *
+ * A trie_result is a pointer, which means nothing once the process that
+ * made it has gone, so trie_save calls a trie_encode function to get the
+ * bytes to store for each result.  It gets the result and the arg given
+ * to trie_save, puts the number of bytes in *len_result, and returns a
+ * pointer to them.  trie_search_mapped returns a pointer to the stored
+ * copy of those bytes, within the mapping
+ */
+typedef const void *(*trie_encode)(trie_result result, size_t *len_result,
+                                   void *arg);
+
+struct trie_map;
+
+/*
+ * trie_save -- write a trie to a file that trie_map_open can map
+ *
+ * inputs: trie -- a pointer to the trie to write
+ *         filename -- the file to write it to
+ *         encode -- gives the bytes to store for each result; if NULL,
+ *                   each result is taken to be a null terminated string
+ *         arg -- passed to encode
+ *
+ * outputs: nonzero on success, zero on error (out of memory, a write
+ *          error, or a trie too big for the 32 bit offsets, which count
+ *          in 4 byte words, so the file can be up to 16GB)
+ *
+ * The file is written under a temporary name (filename with ".tmp" added)
+ * and then renamed over filename, so a process that already has the old
+ * file mapped keeps seeing the old trie until it calls trie_map_open
+ * again.  On error, filename is left as it was and the temporary file is
+ * removed.  The trie is unchanged.
+ */
+int trie_save(const struct trie *trie, const char *filename,
+              trie_encode encode, void *arg);
+
+/*
+ * trie_map_open -- map a file that trie_save wrote
+ *
+ * inputs: filename -- the file
+ *
+ * outputs: a pointer to the mapped trie, or NULL on error (the file can't
+ *          be opened or mapped, or it isn't one that trie_save wrote on
+ *          a machine with the same byte order)
+ *
+ * Only the header of the file is checked here.  trie_search_mapped checks
+ * each node and result it reads against the size of the file, so a damaged
+ * file gives wrong answers, but no reads outside the mapping
+ */
+struct trie_map *trie_map_open(const char *filename);
+
+/*
+ * trie_map_close -- unmap a mapped trie
+ *
+ * inputs: map -- a pointer to the mapped trie
+ *
+ * outputs: none
+ *
+ * Once this returns, the pointers that trie_search_mapped returned are
+ * no longer valid
+ */
+void trie_map_close(struct trie_map *map);
+
+/*
+ * trie_search_mapped -- search a mapped trie for an entry
+ *
+ * inputs: map -- a pointer to the mapped trie to search
+ *         key -- a pointer to the key to look for
+ *         len_key -- the length (in bytes) of the key to look for
+ *         len_result -- if not NULL, where to put the length of the result
+ *
+ * outputs: a pointer to the bytes stored for the result of the key, or
+ *          NULL if the key was not found
+ *
+ * This touches one node per byte that the keys branch on, and allocates
+ * nothing
+ */
+const void *trie_search_mapped(const struct trie_map *map,
+                               const unsigned char *key, size_t len_key,
+                               size_t *len_result);
+
 #endif /* TRIE_H_ */
@@ -69,3 +69,32 @@ int validate_trie( struct trie *trie )
    else
       return 1;
 }
+
+/*
+ * The number of bytes of memory that the trie takes up (not counting
+ * malloc's own overhead)
+ */
+static size_t node_memory( trie_pointer node )
+{
+  if (!node) return 0;
+  switch (*node) {
+    case TRIE_LEAF: {
+      struct trie_leaf *p = (struct trie_leaf*)node;
+      return sizeof( *p ) + (p->len_key > 0 ? p->len_key : 1);
+    }
+    case TRIE_SUBTRIE: {
+      struct trie_subtrie *p = (struct trie_subtrie*)node;
+      size_t total = sizeof( *p ) + node_memory( (trie_pointer)p->exact_match );
+      int i;
+      for (i=0; i<TRIE_BRANCH_FACTOR; i++)
+        total += node_memory( p->next_level[i] );
+      return total;
+    }
+    default: assert( 0 ); return 0;
+  }
+}
+
+size_t trie_memory( struct trie *trie )
+{
+  return sizeof( *trie ) + node_memory( trie->root );
+}
@@ -0,0 +1,564 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "trie.h"
+
+/*
+ * This is the mapped trie (see trie.h).  It uses only the public interface
+ * of the trie module, so it works with either trie.c or art.c.
+ *
+ * The file is an array of 32 bit words, and every offset in it is a word
+ * index from the start of the file.  It starts with a struct map_header.
+ * Each node is
+ *
+ *   word 0:         the offset of the result of the key that ends here,
+ *                   or 0 if there is none
+ *   word 1:         prefix_len, the number of bytes of key this node takes
+ *   word 2:         num_children
+ *   num_children words: the offsets of the children
+ *   num_children bytes: the key byte for each child, in increasing order
+ *   prefix_len bytes:   the bytes of key this node takes
+ *
+ * padded out to a whole word.  A leaf is just a node with no children, and
+ * its prefix is the rest of the key.  Unlike art.c, the whole prefix is
+ * stored, so a search never has to go back and check the key.  A result is
+ * a word holding its length, then its bytes, padded to a whole word.
+ *
+ * The nodes are written children first, so the root comes last.  The
+ * numbers are in the byte order of the machine that wrote the file, and
+ * map_header.byte_order lets a machine with the other order notice
+ */
+
+#if defined(__unix__) || defined(__unix) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define TRIE_MMAP 1
+#endif
+
+#define MAP_MAGIC "TRIEMAP"
+#define MAP_BYTE_ORDER 0x01020304UL
+
+struct map_header {
+  char magic[8];
+  uint32_t byte_order;   /* MAP_BYTE_ORDER, as the writer stored it */
+  uint32_t root;         /* the offset of the root node; 0 if empty */
+  uint64_t size;         /* the size of the whole file, in bytes */
+  uint64_t count;        /* the number of entries */
+};
+
+struct trie_map {
+  const uint32_t *base;  /* the start of the file */
+  size_t size;           /* its size in bytes */
+  int mapped;            /* nonzero if base was mmap'ed, not malloc'ed */
+};
+
+/*
+ * While the trie is being saved, the entries come in order, and the nodes
+ * on the path to the last one are still open: more children may yet be
+ * added to them.  When the next key leaves that path, the nodes it leaves
+ * are written, so the memory needed depends on the length of the keys,
+ * not on how many there are
+ */
+struct map_open {
+  size_t start, end;     /* the bytes of the key that this node takes */
+  uint32_t value;        /* the offset of its result, or 0 if none */
+  size_t first_child;    /* where its children start in map_writer.child */
+};
+
+struct map_writer {
+  FILE *f;
+  uint64_t pos;          /* bytes written so far */
+  uint64_t count;        /* entries written so far */
+  trie_encode encode;
+  void *arg;
+  const unsigned char *key;  /* the last key written */
+  size_t len_key;
+  struct map_open *open; /* the open nodes, root first */
+  size_t num_open, max_open;
+  uint32_t *child;       /* the children the open nodes have so far */
+  unsigned char *byte;   /* and the key byte for each */
+  size_t num_child, max_child;
+};
+
+/*
+ * put -- append bytes to the file
+ *
+ * inputs: w -- the writer
+ *         p, len -- the bytes
+ *
+ * outputs: nonzero on success, zero on a write error
+ */
+static int put( struct map_writer *w, const void *p, size_t len )
+{
+  if (len && fwrite( p, 1, len, w->f ) != len)
+    return 0;
+  w->pos += len;
+  return 1;
+}
+
+/*
+ * pad -- pad the file out to a whole word
+ *
+ * outputs: the word offset of the end of the file, or 0 on error
+ */
+static uint32_t pad( struct map_writer *w )
+{
+  static const unsigned char zero[4];
+
+  if (!put( w, zero, (size_t)(-w->pos & 3) ))
+    return 0;
+  if (w->pos / 4 > UINT32_MAX)
+    return 0;
+  return (uint32_t)(w->pos / 4);
+}
+
+/*
+ * push_open -- open a node on the path to the last key
+ *
+ * outputs: nonzero on success, zero if out of memory
+ */
+static int push_open( struct map_writer *w, size_t start, size_t end,
+                      uint32_t value, size_t first_child )
+{
+  struct map_open *o;
+
+  if (w->num_open == w->max_open) {
+    size_t max = w->max_open ? 2 * w->max_open : 64;
+    struct map_open *p = realloc( w->open, max * sizeof *p );
+    if (!p) return 0;
+    w->open = p;
+    w->max_open = max;
+  }
+  o = &w->open[ w->num_open++ ];
+  o->start = start;
+  o->end = end;
+  o->value = value;
+  o->first_child = first_child;
+  return 1;
+}
+
+/*
+ * add_child -- give the innermost open node another child
+ *
+ * outputs: nonzero on success, zero if out of memory
+ */
+static int add_child( struct map_writer *w, unsigned char c, uint32_t node )
+{
+  if (w->num_child == w->max_child) {
+    size_t max = w->max_child ? 2 * w->max_child : 1024;
+    uint32_t *p = realloc( w->child, max * sizeof *p );
+    unsigned char *q;
+    if (!p) return 0;
+    w->child = p;
+    if (!(q = realloc( w->byte, max ))) return 0;
+    w->byte = q;
+    w->max_child = max;
+  }
+  w->child[ w->num_child ] = node;
+  w->byte[ w->num_child++ ] = c;
+  return 1;
+}
+
+/*
+ * write_node -- write a node that has been closed
+ *
+ * inputs: w -- the writer
+ *         node -- the node; its children are the ones from
+ *                 node->first_child to the end of w->child, and its
+ *                 prefix is taken from the last key
+ *
+ * outputs: the word offset of the node, or 0 on error
+ */
+static uint32_t write_node( struct map_writer *w,
+                            const struct map_open *node )
+{
+  size_t num_children = w->num_child - node->first_child;
+  uint32_t header[3], offset;
+
+  if (node->end - node->start > UINT32_MAX || !(offset = pad( w )))
+    return 0;
+  header[0] = node->value;
+  header[1] = (uint32_t)(node->end - node->start);
+  header[2] = (uint32_t)num_children;
+  if (!put( w, header, sizeof header ) ||
+      !put( w, w->child + node->first_child,
+            num_children * sizeof w->child[0] ) ||
+      !put( w, w->byte + node->first_child, num_children ) ||
+      !put( w, w->key + node->start, node->end - node->start ))
+    return 0;
+  return offset;
+}
+
+/*
+ * close_nodes -- write the open nodes that the next key leaves
+ *
+ * inputs: w -- the writer
+ *         len -- the number of bytes the next key has in common with
+ *                the last one
+ *
+ * outputs: nonzero on success, zero on error
+ *
+ * Each open node that takes bytes beyond len is written and becomes a
+ * child of the node below it.  If the next key branches off in the
+ * middle of a node's prefix, a new node that stops there takes its place
+ * first, so that the next key can be its child
+ */
+static int close_nodes( struct map_writer *w, size_t len )
+{
+  while (w->num_open > 0 && w->open[ w->num_open - 1 ].end > len) {
+    struct map_open node = w->open[ --w->num_open ];
+    uint32_t offset;
+
+    if (w->num_open == 0 || w->open[ w->num_open - 1 ].end < len) {
+      if (!push_open( w, node.start, len, 0, node.first_child ))
+        return 0;
+      node.start = len + 1;
+    }
+    if (!(offset = write_node( w, &node )))
+      return 0;
+    w->num_child = node.first_child;
+    if (!add_child( w, w->key[ node.start - 1 ], offset ))
+      return 0;
+  }
+  return 1;
+}
+
+/*
+ * close_all -- write all the open nodes, once there are no more keys
+ *
+ * outputs: the word offset of the root, or 0 on error
+ */
+static uint32_t close_all( struct map_writer *w )
+{
+  uint32_t offset = 0;
+
+  while (w->num_open > 0) {
+    struct map_open node = w->open[ --w->num_open ];
+
+    if (!(offset = write_node( w, &node )))
+      return 0;
+    w->num_child = node.first_child;
+    if (w->num_open > 0 && !add_child( w, w->key[ node.start - 1 ], offset ))
+      return 0;
+  }
+  return offset;
+}
+
+/*
+ * save_entry -- the trie_visit function that writes the entries
+ *
+ * The result is written straight away.  The entry's node is left open
+ * until a later key leaves it, since keys that start with this one may
+ * still come
+ */
+static int save_entry( const unsigned char *key, size_t len_key,
+                       trie_result result, void *arg )
+{
+  struct map_writer *w = arg;
+  size_t start = 0;
+  const void *p;
+  size_t len;
+  uint32_t value, len32;
+
+  if (w->num_open > 0) {
+    size_t common = 0;
+    while (common < w->len_key && common < len_key &&
+           w->key[common] == key[common])
+      common++;
+    if (!close_nodes( w, common ))
+      return 1;
+    start = common + 1;
+  }
+
+  if (w->encode)
+    p = w->encode( result, &len, w->arg );
+  else {
+    p = result;
+    len = strlen( p ) + 1;
+  }
+  if (len > UINT32_MAX || !(value = pad( w )))
+    return 1;
+  len32 = (uint32_t)len;
+  if (!put( w, &len32, sizeof len32 ) || !put( w, p, len ) ||
+      !push_open( w, start, len_key, value, w->num_child ))
+    return 1;
+
+  w->key = key;
+  w->len_key = len_key;
+  w->count++;
+  return 0;
+}
+
+/*
+ * trie_save -- write a trie to a file that trie_map_open can map
+ *
+ * inputs: trie -- a pointer to the trie to write
+ *         filename -- the file to write it to
+ *         encode -- gives the bytes to store for each result; if NULL,
+ *                   each result is taken to be a null terminated string
+ *         arg -- passed to encode
+ *
+ * outputs: nonzero on success, zero on error
+ *
+ * The entries come out of trie_prefix_iterate in order, which is the
+ * order save_entry wants them in.  The header is written last, once the
+ * root and the size are known.  All of this goes to a file with ".tmp"
+ * added to its name, which is only renamed over filename once it is
+ * complete and on the disk: rewriting filename in place would pull the
+ * pages out from under anyone who has it mapped
+ */
+int trie_save(const struct trie *trie, const char *filename,
+              trie_encode encode, void *arg)
+{
+  struct map_writer w;
+  struct map_header h;
+  char *temp;
+  int ok;
+
+  if (!trie || !filename)
+    return 0;
+  memset( &w, 0, sizeof w );
+  memset( &h, 0, sizeof h );
+  w.encode = encode;
+  w.arg = arg;
+  if (!(temp = malloc( strlen( filename ) + sizeof ".tmp" )))
+    return 0;
+  strcpy( temp, filename );
+  strcat( temp, ".tmp" );
+  if (!(w.f = fopen( temp, "wb" ))) {
+    free( temp );
+    return 0;
+  }
+
+  ok = put( &w, &h, sizeof h ) &&
+       0 == trie_prefix_iterate( trie, (const unsigned char*)"", 0,
+                                 save_entry, &w );
+  if (ok && w.num_open > 0)
+    ok = 0 != (h.root = close_all( &w ));
+  if (ok) {
+    memcpy( h.magic, MAP_MAGIC, sizeof MAP_MAGIC );
+    h.byte_order = MAP_BYTE_ORDER;
+    h.size = w.pos;
+    h.count = w.count;
+    ok = 0 == fseek( w.f, 0L, SEEK_SET ) &&
+         fwrite( &h, sizeof h, 1, w.f ) == 1 &&
+         0 == fflush( w.f );
+  }
+#ifdef TRIE_MMAP
+  if (ok)
+    ok = 0 == fsync( fileno( w.f ) );
+#endif
+  if (fclose( w.f ) != 0)
+    ok = 0;
+#ifndef TRIE_MMAP
+  /* rename will not replace a file everywhere */
+  if (ok)
+    remove( filename );
+#endif
+  if (ok)
+    ok = 0 == rename( temp, filename );
+  if (!ok)
+    remove( temp );
+  free( w.open );
+  free( w.child );
+  free( w.byte );
+  free( temp );
+  return ok;
+}
+
+/*
+ * trie_map_open -- map a file that trie_save wrote
+ *
+ * inputs: filename -- the file
+ *
+ * outputs: a pointer to the mapped trie, or NULL on error
+ *
+ * Where there is no mmap, this reads the whole file into memory instead,
+ * which works the same but isn't quick and isn't shared
+ */
+struct trie_map *trie_map_open(const char *filename)
+{
+  struct trie_map *map;
+  const struct map_header *h;
+  void *base;
+  size_t size;
+
+  if (!filename || !(map = malloc( sizeof *map )))
+    return 0;
+#if defined(TRIE_MMAP)
+  {
+    struct stat st;
+    int fd = open( filename, O_RDONLY );
+    if (fd < 0) {
+      free( map );
+      return 0;
+    }
+    if (fstat( fd, &st ) != 0 || st.st_size < (off_t)sizeof *h ||
+        (uint64_t)st.st_size > (size_t)-1) {
+      close( fd );
+      free( map );
+      return 0;
+    }
+    size = (size_t)st.st_size;
+    base = mmap( 0, size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (base == MAP_FAILED) {
+      free( map );
+      return 0;
+    }
+    map->mapped = 1;
+  }
+#else
+  {
+    FILE *f = fopen( filename, "rb" );
+    long len = -1;
+    base = 0;
+    if (f && fseek( f, 0L, SEEK_END ) == 0 && (len = ftell( f )) >= (long)sizeof *h &&
+        fseek( f, 0L, SEEK_SET ) == 0 && (base = malloc( (size_t)len )) != 0 &&
+        fread( base, 1, (size_t)len, f ) != (size_t)len) {
+      free( base );
+      base = 0;
+    }
+    if (f)
+      fclose( f );
+    if (!base) {
+      free( map );
+      return 0;
+    }
+    size = (size_t)len;
+    map->mapped = 0;
+  }
+#endif
+  map->base = base;
+  map->size = size;
+
+  h = base;
+  if (0 != memcmp( h->magic, MAP_MAGIC, sizeof MAP_MAGIC ) ||
+      h->byte_order != MAP_BYTE_ORDER || h->size != size ||
+      (uint64_t)h->root * 4 >= size) {
+    trie_map_close( map );
+    return 0;
+  }
+  return map;
+}
+
+/*
+ * trie_map_close -- unmap a mapped trie
+ *
+ * inputs: map -- a pointer to the mapped trie
+ *
+ * outputs: none
+ */
+void trie_map_close(struct trie_map *map)
+{
+  if (!map)
+    return;
+#if defined(TRIE_MMAP)
+  if (map->mapped)
+    munmap( (void*)map->base, map->size );
+  else
+#endif
+    free( (void*)map->base );
+  free( map );
+}
+
+/*
+ * map_words -- find bytes in a mapped trie
+ *
+ * inputs: map -- the mapped trie
+ *         offset -- the word offset of the bytes
+ *         len -- how many bytes there must be
+ *
+ * outputs: a pointer to them, or NULL if they don't lie wholly between the
+ *          header and the end of the file
+ *
+ * Only the header is checked at open, so that opening stays quick however
+ * big the file is.  Every offset and length read from the rest of the file
+ * goes through here before it is used, so a damaged file makes searches
+ * miss rather than read outside the mapping
+ */
+static const uint32_t *map_words( const struct trie_map *map,
+                                  uint32_t offset, uint64_t len )
+{
+  uint64_t start = (uint64_t)offset * 4;
+
+  if (start < sizeof (struct map_header) || start > map->size ||
+      len > map->size - start)
+    return 0;
+  return map->base + offset;
+}
+
+/*
+ * trie_search_mapped -- search a mapped trie for an entry
+ *
+ * inputs: map -- a pointer to the mapped trie to search
+ *         key -- a pointer to the key to look for
+ *         len_key -- the length (in bytes) of the key to look for
+ *         len_result -- if not NULL, where to put the length of the result
+ *
+ * outputs: a pointer to the bytes stored for the result of the key, or
+ *          NULL if the key was not found
+ *
+ * At each node, we match its prefix, and then either the key ends here,
+ * or we look for the next byte of the key among the bytes of the children.
+ * Those are sorted, so a binary search finds it.  Each node is checked to
+ * lie within the file before it is read
+ */
+const void *trie_search_mapped(const struct trie_map *map,
+                               const unsigned char *key, size_t len_key,
+                               size_t *len_result)
+{
+  const uint32_t *node;
+  size_t depth = 0;
+  uint32_t root, offset;
+
+  if (!map || !(root = ((const struct map_header*)map->base)->root))
+    return 0;
+  offset = root;
+  for (;;) {
+    uint32_t num_children, prefix_len, lo, hi;
+    const unsigned char *byte;
+    unsigned char c;
+
+    if (!(node = map_words( map, offset, 12 )))
+      return 0;
+    num_children = node[2];
+    prefix_len = node[1];
+    if (num_children > 256 ||
+        !map_words( map, offset, 12 + 5 * (uint64_t)num_children + prefix_len ))
+      return 0;
+    byte = (const unsigned char*)(node + 3 + num_children);
+    lo = 0;
+    hi = num_children;
+
+    if (len_key - depth < prefix_len ||
+        0 != memcmp( key + depth, byte + num_children, prefix_len ))
+      return 0;
+    depth += prefix_len;
+    if (depth == len_key) {
+      const uint32_t *result;
+      if (!node[0] || !(result = map_words( map, node[0], 4 )) ||
+          !map_words( map, node[0], 4 + (uint64_t)result[0] ))
+        return 0;
+      if (len_result)
+        *len_result = result[0];
+      return result + 1;
+    }
+    c = key[depth];
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (byte[mid] < c)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo == num_children || byte[lo] != c)
+      return 0;
+    offset = node[3 + lo];
+    depth += 1;
+  }
+}
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sparse.h"
+#include "sp_index.h"
 
 SPARSE_MATRIX *sp_add_header_dimension(SPARSE_MATRIX *sp, 
                                        int           dim, 
@@ -133,6 +134,18 @@ SPARSE_MATRIX *sp_add_header_dimension(SPARSE_MATRIX *sp,
     free(sp->hdr_stack);
     sp->hdr_ranges = new_rng_stack;
     sp->hdr_stack = new_hdr_stack;
+
+    /* The index holds whole tuples, so it is made again for the new number
+       of dimensions.  The matrix is empty, so this is quick */
+    if (sp->index != (SP_INDEX *)NULL)
+    {
+      sp_del_index(sp);
+      if ((sp_create_index(sp) == (SPARSE_MATRIX *)NULL) ||
+          (sp->error_no != SP_NOERR))
+      {
+        return(sp);
+      }
+    }
   }
 
   /* Insert the information for the added dimension */
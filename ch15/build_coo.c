@@ -0,0 +1,365 @@
+/**************************************************************************
+**  SP_BUILD_COO                                                         **
+**                                                                       **
+**    Fills an empty sparse matrix from a list of coordinates (COO).     **
+**                                                                       **
+**  INPUT:                                                               **
+**    sp -- The sparse matrix to be filled.  Its dimensions and their    **
+**          ranges must already have been set up with                    **
+**          sp_add_header_dimension, and it must not have any nodes.     **
+**    count -- The number of values.                                     **
+**    seq -- The tuples of the values, one after the other, so the       **
+**           sequence number of value i in dimension d (counting from 1) **
+**           is seq[i * sp->dimensions + d - 1].  They can be in any     **
+**           order.                                                      **
+**    value -- The values.                                               **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    SPARSE_MATRIX * -- A pointer to the modified sparse matrix         **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    The error_no field of the sparse matrix can be set to an error if  **
+**  an error is encountered.  If it is, the matrix has no nodes, though  **
+**  some header list elements may have been added.                       **
+**    Header list elements are inserted as needed, as by sp_ins_node.    **
+**  If the matrix has a hash index, the nodes are put in it.             **
+**                                                                       **
+**  NOTES:                                                               **
+**    If the same tuple is given more than once, the last value wins,    **
+**  just as if each had been given to sp_ins_node in turn, and the       **
+**  matrix has the same nodes and values that those calls would give.    **
+**  Each node list is in order of the other dimensions, left to right.   **
+**    Calling sp_ins_node for each value searches a header list and a    **
+**  node list in every dimension, which gets slower as the matrix fills. **
+**  Instead, this sorts the values once by their whole tuple, and then   **
+**  once more by each dimension in turn.  In the order for dimension d,  **
+**  the nodes for each header element of dimension d come together, and  **
+**  in the order that its node list needs, so the headers and the lists  **
+**  can all be made in one pass.  That is O(dimensions * count * log     **
+**  count) in all.                                                       **
+**    The nodes are allocated one by one, just as sp_ins_node allocates  **
+**  them, so that sp_del_node can still free them.                       **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sparse.h"
+#include "sp_index.h"
+#include "sp_coo.h"
+
+/* Compare the tuples of entries a and b, in dimension key_dim (counting
+   from 0), or in every dimension from left to right if key_dim is -1 */
+static int sp_coo_compare(int *seq, int dimensions, int key_dim, int a, int b)
+{
+  int *seq_a = seq + a * dimensions, *seq_b = seq + b * dimensions;
+  int curr_dim;
+
+  if (key_dim >= 0)
+  {
+    return((seq_a[key_dim] > seq_b[key_dim]) -
+           (seq_a[key_dim] < seq_b[key_dim]));
+  }
+  for (curr_dim = 0; curr_dim < dimensions; curr_dim++)
+  {
+    if (seq_a[curr_dim] != seq_b[curr_dim])
+    {
+      return((seq_a[curr_dim] > seq_b[curr_dim]) ? 1 : -1);
+    }
+  }
+  return(0);
+}
+
+/* Sort the entry numbers in order[] by their tuples.  This is a bottom up
+   merge sort, so entries that compare equal stay in the order they were */
+static void sp_coo_sort(int *order, int *temp, int count, int *seq,
+                        int dimensions, int key_dim)
+{
+  int *from = order, *to = temp, *swap;
+  int width, lo, mid, hi, i, j, k;
+
+  for (width = 1; width < count; width *= 2)
+  {
+    for (lo = 0; lo < count; lo += 2 * width)
+    {
+      mid = (lo + width < count) ? lo + width : count;
+      hi = (lo + 2 * width < count) ? lo + 2 * width : count;
+      i = lo;
+      j = mid;
+      k = lo;
+      while ((i < mid) && (j < hi))
+      {
+        if (sp_coo_compare(seq, dimensions, key_dim, from[j], from[i]) < 0)
+        {
+          to[k++] = from[j++];
+        }
+        else
+        {
+          to[k++] = from[i++];
+        }
+      }
+      while (i < mid)
+      {
+        to[k++] = from[i++];
+      }
+      while (j < hi)
+      {
+        to[k++] = from[j++];
+      }
+    }
+    swap = from;
+    from = to;
+    to = swap;
+  }
+  if (from != order)
+  {
+    memcpy((void *)order, (void *)from, sizeof(int) * count);
+  }
+}
+
+SPARSE_MATRIX *sp_build_coo(SPARSE_MATRIX *sp, int count, int *seq,
+                            int *value)
+/* SPARSE_MATRIX *sp  The sparse matrix to be filled */
+/* int count          The number of values */
+/* int *seq           The tuples, sp->dimensions sequence numbers each */
+/* int *value         The values */
+{
+  SP_HDR_ELEMENT *hdr_list, *hdr_pos, *new_header;
+  SP_NODE **node = (SP_NODE **)NULL, *new_node;
+  int *order, *temp, *node_seq, *perm;
+  int dimensions, curr_dim, num_nodes, made, i, j, k;
+
+  /* If the sparse matrix is empty, then nothing can be added to it */
+  if (sp == (SPARSE_MATRIX *)NULL)
+  {
+    return((SPARSE_MATRIX *)NULL);
+  }
+
+  sp->error_no = SP_NOERR;
+  dimensions = sp->dimensions;
+
+  if ((count < 0) || ((count > 0) && ((seq == (int *)NULL) ||
+                                      (value == (int *)NULL))))
+  {
+    sp->error_no = SP_BADDIM;
+    return(sp);
+  }
+
+  /* The matrix must not have any nodes yet.  Every node is in the node
+     list of a header list element of the first dimension */
+  hdr_list = sp_get_header_list(sp, 1);
+  if ((hdr_list == (SP_HDR_ELEMENT *)NULL) || (sp->error_no != SP_NOERR))
+  {
+    return(sp);
+  }
+  hdr_pos = hdr_list;
+  do
+  {
+    if (hdr_pos->first != (SP_NODE *)NULL)
+    {
+      sp->error_no = SP_INSFAIL;
+      return(sp);
+    }
+    hdr_pos = hdr_pos->next;
+  }
+  while (hdr_pos != hdr_list);
+
+  /* Make sure that every tuple is legal */
+  for (i = 0; i < count; i++)
+  {
+    for (curr_dim = 0; curr_dim < dimensions; curr_dim++)
+    {
+      j = seq[i * dimensions + curr_dim];
+      if (j < *(sp->hdr_ranges + (2 * curr_dim)))
+      {
+        sp->error_no = SP_DLOW;
+        return(sp);
+      }
+      if (j > *(sp->hdr_ranges + (2 * curr_dim) + 1))
+      {
+        sp->error_no = SP_DHIGH;
+        return(sp);
+      }
+    }
+  }
+  if (count == 0)
+  {
+    return(sp);
+  }
+
+  order = (int *)malloc(sizeof(int) * count);
+  temp = (int *)malloc(sizeof(int) * count);
+  node_seq = (int *)malloc(sizeof(int) * count * dimensions);
+  perm = (int *)malloc(sizeof(int) * count * dimensions);
+  node = (SP_NODE **)malloc(sizeof(SP_NODE *) * count);
+  if ((order == (int *)NULL) || (temp == (int *)NULL) ||
+      (node_seq == (int *)NULL) || (perm == (int *)NULL) ||
+      (node == (SP_NODE **)NULL))
+  {
+    sp->error_no = SP_MEMLOW;
+    num_nodes = 0;
+    made = 0;
+    goto cleanup;
+  }
+
+  /* Sort the entries by their whole tuples, and keep only the last of
+     each run of equal tuples.  Node k will be for entry order[k] */
+  for (i = 0; i < count; i++)
+  {
+    order[i] = i;
+  }
+  sp_coo_sort(order, temp, count, seq, dimensions, -1);
+  num_nodes = 0;
+  for (i = 0; i < count; i++)
+  {
+    if ((i + 1 < count) &&
+        (sp_coo_compare(seq, dimensions, -1, order[i], order[i + 1]) == 0))
+    {
+      continue;
+    }
+    memcpy((void *)(node_seq + num_nodes * dimensions),
+           (void *)(seq + order[i] * dimensions), sizeof(int) * dimensions);
+    order[num_nodes++] = order[i];
+  }
+
+  /* Make the nodes */
+  for (made = 0; made < num_nodes; made++)
+  {
+    new_node = (SP_NODE *)malloc(sizeof(SP_NODE));
+    if (new_node == (SP_NODE *)NULL)
+    {
+      sp->error_no = SP_MEMLOW;
+      goto cleanup;
+    }
+    new_node->hdr_stack = (SP_HDR_ELEMENT **)malloc(sizeof(SP_HDR_ELEMENT *) *
+                                                    dimensions);
+    new_node->dimension_stack = (SP_NODE **)malloc(sizeof(SP_NODE *) *
+                                                   dimensions * 2);
+    if ((new_node->hdr_stack == (SP_HDR_ELEMENT **)NULL) ||
+        (new_node->dimension_stack == (SP_NODE **)NULL))
+    {
+      free(new_node->hdr_stack);
+      free(new_node->dimension_stack);
+      free(new_node);
+      sp->error_no = SP_MEMLOW;
+      goto cleanup;
+    }
+    new_node->value = value[order[made]];
+    node[made] = new_node;
+  }
+
+  /* For each dimension, put the nodes in order of their sequence number in
+     that dimension.  The sort is stable and they start in order of their
+     whole tuples, so each run of equal sequence numbers is in the order
+     that the node list of its header list element needs.  Find or insert
+     that header list element: the header list is in order too, so one
+     walk along it does for all of them */
+  for (curr_dim = 0; curr_dim < dimensions; curr_dim++)
+  {
+    int *dim_perm = perm + curr_dim * num_nodes;
+
+    for (k = 0; k < num_nodes; k++)
+    {
+      dim_perm[k] = k;
+    }
+    if (curr_dim > 0)
+    {
+      sp_coo_sort(dim_perm, temp, num_nodes, node_seq, dimensions, curr_dim);
+    }
+
+    hdr_list = sp_get_header_list(sp, curr_dim + 1);
+    hdr_pos = hdr_list;
+    for (k = 0; k < num_nodes; k++)
+    {
+      j = node_seq[dim_perm[k] * dimensions + curr_dim];
+      if ((k == 0) || (hdr_pos->sequence != j))
+      {
+        while ((hdr_pos->next != hdr_list) && (hdr_pos->next->sequence <= j))
+        {
+          hdr_pos = hdr_pos->next;
+        }
+        if (hdr_pos->sequence != j)
+        {
+          new_header = (SP_HDR_ELEMENT *)malloc(sizeof(SP_HDR_ELEMENT));
+          if (new_header == (SP_HDR_ELEMENT *)NULL)
+          {
+            sp->error_no = SP_MEMLOW;
+            goto cleanup;
+          }
+          new_header->previous = hdr_pos;
+          new_header->next = hdr_pos->next;
+          new_header->first = (SP_NODE *)NULL;
+          new_header->last = (SP_NODE *)NULL;
+          new_header->sequence = j;
+          new_header->detail = (SP_HEADER_DATA *)NULL;
+          hdr_pos->next->previous = new_header;
+          hdr_pos->next = new_header;
+          hdr_pos = new_header;
+        }
+      }
+      *(node[dim_perm[k]]->hdr_stack + curr_dim) = hdr_pos;
+    }
+  }
+
+  /* Put the nodes in the index, if there is one.  This is the last thing
+     that can fail, so it comes before any node is linked in */
+  if (sp->index != (SP_INDEX *)NULL)
+  {
+    for (k = 0; k < num_nodes; k++)
+    {
+      if (!sp_index_put(sp->index, node_seq + k * dimensions, node[k]))
+      {
+        while (k-- > 0)
+        {
+          sp_index_remove(sp->index, node_seq + k * dimensions);
+        }
+        sp->error_no = SP_MEMLOW;
+        goto cleanup;
+      }
+    }
+  }
+
+  /* Now link each run into a circular node list and hang it from its
+     header list element */
+  for (curr_dim = 0; curr_dim < dimensions; curr_dim++)
+  {
+    int *dim_perm = perm + curr_dim * num_nodes;
+
+    for (i = 0; i < num_nodes; i = j)
+    {
+      hdr_pos = *(node[dim_perm[i]]->hdr_stack + curr_dim);
+      for (j = i + 1;
+           (j < num_nodes) &&
+           (*(node[dim_perm[j]]->hdr_stack + curr_dim) == hdr_pos);
+           j++)
+        ;
+      for (k = i; k < j; k++)
+      {
+        new_node = node[dim_perm[k]];
+        *(new_node->dimension_stack + (2 * curr_dim)) =
+          node[dim_perm[(k + 1 < j) ? k + 1 : i]];
+        *(new_node->dimension_stack + (2 * curr_dim) + 1) =
+          node[dim_perm[(k > i) ? k - 1 : j - 1]];
+      }
+      hdr_pos->first = node[dim_perm[i]];
+      hdr_pos->last = node[dim_perm[j - 1]];
+    }
+  }
+  made = 0;
+
+cleanup:
+  /* On an error, made is the number of nodes to be freed again */
+  for (k = 0; k < made; k++)
+  {
+    free(node[k]->hdr_stack);
+    free(node[k]->dimension_stack);
+    free(node[k]);
+  }
+  free(order);
+  free(temp);
+  free(node_seq);
+  free(perm);
+  free(node);
+  return(sp);
+}
@@ -0,0 +1,137 @@
+/**************************************************************************
+**  SP_CG                                                                **
+**                                                                       **
+**    Solves A x = b by the conjugate gradient method, where A is a      **
+**  symmetric positive definite compressed sparse row matrix.            **
+**                                                                       **
+**  INPUT:                                                               **
+**    a -- The matrix, as made by sp_to_csr(sp, 1).  It must be square,  **
+**         and should be symmetric and positive definite.                **
+**    b -- The right hand side, a->major_size elements.                  **
+**    x -- On entry a first guess at the solution (all zeros will do),   **
+**         a->major_size elements.  On exit the solution.                **
+**    tolerance -- Stop when the residual b - A x is no longer than      **
+**                 tolerance times b.                                    **
+**    max_iterations -- Give up after this many iterations.              **
+**    threads -- The number of threads to use for A times a vector.      **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    int -- The number of iterations taken if the solution converged,   **
+**  -1 if it did not converge in max_iterations or broke down because A  **
+**  is not positive definite, or -2 if A is not square or memory ran     **
+**  out.                                                                 **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    x is overwritten.  If -1 is returned it holds the last estimate.   **
+**                                                                       **
+**  NOTES:                                                               **
+**    Each iteration is one sp_csr_mv and a few passes over vectors of   **
+**  length n, so the cost is about max_iterations times the number of    **
+**  values in A, against n cubed for Gaussian elimination on the dense   **
+**  matrix, and A is never stored densely.  In exact arithmetic it       **
+**  converges in at most n iterations; for well conditioned matrices     **
+**  far fewer are needed.                                                **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sparse.h"
+#include "sp_math.h"
+
+static double sp_cg_dot(double *u, double *v, int n)
+{
+  double sum = 0.0;
+  int i;
+
+  for (i = 0; i < n; i++)
+  {
+    sum += u[i] * v[i];
+  }
+  return(sum);
+}
+
+int sp_cg(SP_CSR *a, double *b, double *x, double tolerance,
+          int max_iterations, int threads)
+/* SP_CSR *a           The matrix */
+/* double *b           The right hand side */
+/* double *x           The first guess, and then the solution */
+/* double tolerance    How small the residual must get, relative to b */
+/* int max_iterations  When to give up */
+/* int threads         The number of threads to use */
+{
+  double *r, *p, *ap;
+  double rr, rr_new, pap, alpha, beta, limit;
+  int n, i, iteration, result = -1;
+
+  if ((a == (SP_CSR *)NULL) || (b == (double *)NULL) ||
+      (x == (double *)NULL) || (a->dimension != 1) ||
+      (a->major_size != a->minor_size))
+  {
+    return(-2);
+  }
+  n = a->major_size;
+
+  r = (double *)malloc(sizeof(double) * (n + 1));
+  p = (double *)malloc(sizeof(double) * (n + 1));
+  ap = (double *)malloc(sizeof(double) * (n + 1));
+  if ((r == (double *)NULL) || (p == (double *)NULL) ||
+      (ap == (double *)NULL))
+  {
+    result = -2;
+    goto cleanup;
+  }
+
+  limit = tolerance * sqrt(sp_cg_dot(b, b, n));
+
+  /* r = b - A x, and the first direction is r */
+  sp_csr_mv(a, x, ap, threads);
+  for (i = 0; i < n; i++)
+  {
+    r[i] = b[i] - ap[i];
+    p[i] = r[i];
+  }
+  rr = sp_cg_dot(r, r, n);
+
+  for (iteration = 0; iteration <= max_iterations; iteration++)
+  {
+    if (sqrt(rr) <= limit)
+    {
+      result = iteration;
+      break;
+    }
+    if (iteration == max_iterations)
+    {
+      break;
+    }
+
+    sp_csr_mv(a, p, ap, threads);
+    pap = sp_cg_dot(p, ap, n);
+    if (pap <= 0.0)
+    {
+      break;
+    }
+
+    alpha = rr / pap;
+    for (i = 0; i < n; i++)
+    {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * ap[i];
+    }
+
+    rr_new = sp_cg_dot(r, r, n);
+    beta = rr_new / rr;
+    for (i = 0; i < n; i++)
+    {
+      p[i] = r[i] + beta * p[i];
+    }
+    rr = rr_new;
+  }
+
+cleanup:
+  free(r);
+  free(p);
+  free(ap);
+  return(result);
+}
@@ -0,0 +1,123 @@
+/**************************************************************************
+**  SP_CREATE_INDEX                                                      **
+**                                                                       **
+**    Adds a hash index to a sparse matrix (see sp_index.h).             **
+**                                                                       **
+**  INPUT:                                                               **
+**    sp -- The sparse matrix to which the index is to be added.         **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    SPARSE_MATRIX * -- A pointer to the modified sparse matrix         **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    The error_no field of the sparse matrix can be set to an error if  **
+**  an error is encountered.  Whenever an error is encountered, this     **
+**  value is set and the matrix is left without an index.                **
+**                                                                       **
+**  NOTES:                                                               **
+**    Every node that is already in the matrix is put in the index, by   **
+**  walking the node list of each header element in the first            **
+**  dimension.  If the matrix already has an index, it is left alone.    **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_index.h"
+
+SPARSE_MATRIX *sp_create_index(SPARSE_MATRIX *sp)
+/* SPARSE_MATRIX *sp  The sparse matrix to which the index is added */
+{
+  SP_INDEX *index;
+  SP_HDR_ELEMENT *hdr_list, *hdr_pos;
+  SP_NODE *node_pos;
+  int curr_dim, *seq;
+  size_t size = 16;
+
+  /* If the sparse matrix is empty, then it cannot have an index */
+  if (sp == (SPARSE_MATRIX *)NULL)
+  {
+    return((SPARSE_MATRIX *)NULL);
+  }
+
+  sp->error_no = SP_NOERR;
+
+  if (sp->index != (SP_INDEX *)NULL)
+  {
+    return(sp);
+  }
+
+  /* The matrix needs at least one dimension to have any nodes */
+  if (sp->dimensions < 1)
+  {
+    sp->error_no = SP_DIM;
+    return(sp);
+  }
+
+  index = (SP_INDEX *)malloc(sizeof(SP_INDEX));
+  seq = (int *)malloc(sizeof(int) * sp->dimensions);
+  if ((index == (SP_INDEX *)NULL) || (seq == (int *)NULL))
+  {
+    free(index);
+    free(seq);
+    sp->error_no = SP_MEMLOW;
+    return(sp);
+  }
+  index->dimensions = sp->dimensions;
+  index->size = size;
+  index->count = 0;
+  index->node = (SP_NODE **)calloc(size, sizeof(SP_NODE *));
+  index->hash = (unsigned long *)malloc(size * sizeof(unsigned long));
+  index->seq = (int *)malloc(size * sizeof(int) * sp->dimensions);
+  if ((index->node == (SP_NODE **)NULL) ||
+      (index->hash == (unsigned long *)NULL) ||
+      (index->seq == (int *)NULL))
+  {
+    sp->index = index;
+    sp_del_index(sp);
+    free(seq);
+    sp->error_no = SP_MEMLOW;
+    return(sp);
+  }
+  sp->index = index;
+
+  /* Every node is in the node list of exactly one header element of the
+     first dimension */
+  hdr_list = sp_get_header_list(sp, 1);
+  if ((hdr_list == (SP_HDR_ELEMENT *)NULL) || (sp->error_no != SP_NOERR))
+  {
+    sp_del_index(sp);
+    free(seq);
+    return(sp);
+  }
+  hdr_pos = hdr_list;
+  do
+  {
+    node_pos = hdr_pos->first;
+    if (node_pos != (SP_NODE *)NULL)
+    {
+      do
+      {
+        for (curr_dim = 0; curr_dim < sp->dimensions; curr_dim++)
+        {
+          seq[curr_dim] = (*(node_pos->hdr_stack + curr_dim))->sequence;
+        }
+        if (!sp_index_put(index, seq, node_pos))
+        {
+          sp_del_index(sp);
+          free(seq);
+          sp->error_no = SP_MEMLOW;
+          return(sp);
+        }
+        node_pos = *(node_pos->dimension_stack);
+      }
+      while (node_pos != hdr_pos->first);
+    }
+    hdr_pos = hdr_pos->next;
+  }
+  while (hdr_pos != hdr_list);
+
+  free(seq);
+  return(sp);
+}
@@ -0,0 +1,215 @@
+/**************************************************************************
+**  SP_CSR_MM                                                            **
+**                                                                       **
+**    Multiplies two compressed sparse row matrices: C = A B.            **
+**                                                                       **
+**  INPUT:                                                               **
+**    a, b -- The matrices, as made by sp_to_csr(sp, 1).  The columns of **
+**            a must be the rows of b: the same minimum sequence number  **
+**            and the same size.                                         **
+**    c -- Where to put a pointer to the product, which is a new         **
+**         compressed sparse row matrix with the rows of a and the       **
+**         columns of b.  Free it with sp_del_csr.                       **
+**    threads -- The number of threads to use (see sp_math.h).           **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    int -- SP_NOERR, SP_BADDIM if a pointer is NULL or the matrices do **
+**  not fit together, SP_DIM if either is compressed by column, or       **
+**  SP_MEMLOW if memory runs out.                                        **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    *c is set to the product, or to NULL on an error.                  **
+**                                                                       **
+**  NOTES:                                                               **
+**    Row i of C is the sum, over the values a(i,k) of row i of A, of    **
+**  a(i,k) times row k of B.  The sums are kept in a dense row the width **
+**  of B, with a mark array so that only the columns touched by row i    **
+**  need to be found and cleared afterwards (Gustavson's method).  The   **
+**  rows are done twice: once to count the values of each row, so that   **
+**  C can be allocated exactly, and once to fill it in.  Each thread has **
+**  its own dense row.  The columns of each row are sorted, as sp_to_csr **
+**  gives them.  A value whose terms cancel to zero is kept.             **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_math.h"
+
+typedef struct sp_mm_part
+{
+  SP_CSR *a, *b, *c;
+  int     first, last;  /* The rows of this part */
+  int     numeric;      /* 0 to count the values, 1 to fill them in */
+  int    *sum;          /* The dense row, b->minor_size long */
+  int    *mark;         /* The last row to touch each column, or -1 */
+  int    *cols;         /* The columns touched by this row */
+} SP_MM_PART;
+
+static int sp_csr_mm_compare(const void *p1, const void *p2)
+{
+  return(*(const int *)p1 - *(const int *)p2);
+}
+
+static void *sp_csr_mm_part(void *arg)
+{
+  SP_MM_PART *part = (SP_MM_PART *)arg;
+  SP_CSR *a = part->a, *b = part->b, *c = part->c;
+  int row, ka, kb, k, col, touched, pos;
+
+  for (row = part->first; row < part->last; row++)
+  {
+    touched = 0;
+    for (ka = a->start[row]; ka < a->start[row + 1]; ka++)
+    {
+      k = a->index[ka];
+      for (kb = b->start[k]; kb < b->start[k + 1]; kb++)
+      {
+        col = b->index[kb];
+        if (part->mark[col] != row)
+        {
+          part->mark[col] = row;
+          part->cols[touched++] = col;
+          part->sum[col] = 0;
+        }
+        part->sum[col] += a->value[ka] * b->value[kb];
+      }
+    }
+
+    if (!part->numeric)
+    {
+      c->start[row + 1] = touched;
+      continue;
+    }
+
+    qsort((void *)part->cols, (size_t)touched, sizeof(int),
+          sp_csr_mm_compare);
+    pos = c->start[row];
+    for (k = 0; k < touched; k++)
+    {
+      c->index[pos] = part->cols[k];
+      c->value[pos] = part->sum[part->cols[k]];
+      pos++;
+    }
+  }
+  return(NULL);
+}
+
+int sp_csr_mm(SP_CSR *a, SP_CSR *b, SP_CSR **c, int threads)
+/* SP_CSR *a    The left matrix */
+/* SP_CSR *b    The right matrix */
+/* SP_CSR **c   Where to put the product */
+/* int threads  The number of threads to use */
+{
+  SP_MM_PART part[SP_MAX_THREADS];
+  SP_CSR *prod;
+  int count, t, i, error_no = SP_NOERR;
+
+  if (c == (SP_CSR **)NULL)
+  {
+    return(SP_BADDIM);
+  }
+  *c = (SP_CSR *)NULL;
+  if ((a == (SP_CSR *)NULL) || (b == (SP_CSR *)NULL))
+  {
+    return(SP_BADDIM);
+  }
+  if ((a->dimension != 1) || (b->dimension != 1))
+  {
+    return(SP_DIM);
+  }
+  if ((a->minor_min != b->major_min) || (a->minor_size != b->major_size))
+  {
+    return(SP_BADDIM);
+  }
+
+  prod = (SP_CSR *)malloc(sizeof(SP_CSR));
+  if (prod == (SP_CSR *)NULL)
+  {
+    return(SP_MEMLOW);
+  }
+  prod->dimension = 1;
+  prod->major_min = a->major_min;
+  prod->major_size = a->major_size;
+  prod->minor_min = b->minor_min;
+  prod->minor_size = b->minor_size;
+  prod->count = 0;
+  prod->index = (int *)NULL;
+  prod->value = (int *)NULL;
+  prod->start = (int *)calloc(prod->major_size + 1, sizeof(int));
+
+  count = sp_csr_threads(a, threads);
+  for (t = 0; t < count; t++)
+  {
+    part[t].a = a;
+    part[t].b = b;
+    part[t].c = prod;
+    part[t].first = sp_csr_split(a, t, count);
+    part[t].last = sp_csr_split(a, t + 1, count);
+    part[t].numeric = 0;
+    part[t].sum = (int *)malloc(sizeof(int) * (b->minor_size + 1));
+    part[t].mark = (int *)malloc(sizeof(int) * (b->minor_size + 1));
+    part[t].cols = (int *)malloc(sizeof(int) * (b->minor_size + 1));
+    if ((part[t].sum == (int *)NULL) || (part[t].mark == (int *)NULL) ||
+        (part[t].cols == (int *)NULL))
+    {
+      error_no = SP_MEMLOW;
+    }
+    else
+    {
+      for (i = 0; i < b->minor_size; i++)
+      {
+        part[t].mark[i] = -1;
+      }
+    }
+  }
+  if ((prod->start == (int *)NULL) || (error_no != SP_NOERR))
+  {
+    error_no = SP_MEMLOW;
+    goto cleanup;
+  }
+
+  /* Count the values of each row, then turn the counts into offsets */
+  sp_csr_run(sp_csr_mm_part, (void *)part, sizeof(SP_MM_PART), count);
+  for (i = 0; i < prod->major_size; i++)
+  {
+    prod->start[i + 1] += prod->start[i];
+  }
+  prod->count = prod->start[prod->major_size];
+
+  /* Allocate at least one of each, so that NULL only means failure */
+  prod->index = (int *)malloc(sizeof(int) * (prod->count + 1));
+  prod->value = (int *)malloc(sizeof(int) * (prod->count + 1));
+  if ((prod->index == (int *)NULL) || (prod->value == (int *)NULL))
+  {
+    error_no = SP_MEMLOW;
+    goto cleanup;
+  }
+
+  /* Clear the marks, which still hold the rows of the counting pass */
+  for (t = 0; t < count; t++)
+  {
+    part[t].numeric = 1;
+    for (i = 0; i < b->minor_size; i++)
+    {
+      part[t].mark[i] = -1;
+    }
+  }
+  sp_csr_run(sp_csr_mm_part, (void *)part, sizeof(SP_MM_PART), count);
+
+cleanup:
+  for (t = 0; t < count; t++)
+  {
+    free(part[t].sum);
+    free(part[t].mark);
+    free(part[t].cols);
+  }
+  if (error_no != SP_NOERR)
+  {
+    sp_del_csr(prod);
+    return(error_no);
+  }
+  *c = prod;
+  return(SP_NOERR);
+}
@@ -0,0 +1,128 @@
+/**************************************************************************
+**  SP_CSR_MV                                                            **
+**                                                                       **
+**    Multiplies a compressed sparse row matrix by a vector: y = A x.    **
+**                                                                       **
+**  INPUT:                                                               **
+**    a -- The matrix, as made by sp_to_csr(sp, 1).                      **
+**    x -- The vector, with a->minor_size elements.  Element j goes with **
+**         minor element j of the matrix, which is the sequence number   **
+**         a->minor_min + j.                                             **
+**    y -- Where to put the product, a->major_size elements.  It must    **
+**         not overlap x.                                                **
+**    threads -- The number of threads to use (see sp_math.h).           **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    int -- SP_NOERR, SP_BADDIM if a pointer is NULL, or SP_DIM if a is **
+**  compressed by column rather than by row.                             **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    y is overwritten.                                                  **
+**                                                                       **
+**  NOTES:                                                               **
+**    Each row is a dot product of its values with the elements of x     **
+**  that its index array picks out.  With AVX2, four of those are        **
+**  gathered at once and four running sums are kept, so the result can   **
+**  differ from the plain loop in the last bits.                         **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_math.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+typedef struct sp_mv_part
+{
+  SP_CSR *a;
+  double *x, *y;
+  int     first, last;  /* The rows of this part */
+} SP_MV_PART;
+
+static void sp_csr_mv_rows(SP_CSR *a, double *x, double *y, int first,
+                           int last)
+{
+  int row, k, end;
+  double sum;
+
+  for (row = first; row < last; row++)
+  {
+    k = a->start[row];
+    end = a->start[row + 1];
+    sum = 0.0;
+#if defined(__AVX2__)
+    if (end - k >= 4)
+    {
+      __m256d acc = _mm256_setzero_pd();
+      __m128d half;
+
+      for (; k + 4 <= end; k += 4)
+      {
+        __m128i index = _mm_loadu_si128((__m128i *)(a->index + k));
+        __m256d value = _mm256_cvtepi32_pd(
+                          _mm_loadu_si128((__m128i *)(a->value + k)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(value,
+                                   _mm256_i32gather_pd(x, index, 8)));
+      }
+      half = _mm_add_pd(_mm256_castpd256_pd128(acc),
+                        _mm256_extractf128_pd(acc, 1));
+      sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+#endif
+    for (; k < end; k++)
+    {
+      sum += a->value[k] * x[a->index[k]];
+    }
+    y[row] = sum;
+  }
+}
+
+static void *sp_csr_mv_part(void *arg)
+{
+  SP_MV_PART *part = (SP_MV_PART *)arg;
+
+  sp_csr_mv_rows(part->a, part->x, part->y, part->first, part->last);
+  return(NULL);
+}
+
+int sp_csr_mv(SP_CSR *a, double *x, double *y, int threads)
+/* SP_CSR *a    The matrix */
+/* double *x    The vector to multiply by */
+/* double *y    Where to put the product */
+/* int threads  The number of threads to use */
+{
+  SP_MV_PART part[SP_MAX_THREADS];
+  int count, t;
+
+  if ((a == (SP_CSR *)NULL) || (x == (double *)NULL) ||
+      (y == (double *)NULL))
+  {
+    return(SP_BADDIM);
+  }
+  if (a->dimension != 1)
+  {
+    return(SP_DIM);
+  }
+
+  count = sp_csr_threads(a, threads);
+  if (count == 1)
+  {
+    sp_csr_mv_rows(a, x, y, 0, a->major_size);
+    return(SP_NOERR);
+  }
+
+  for (t = 0; t < count; t++)
+  {
+    part[t].a = a;
+    part[t].x = x;
+    part[t].y = y;
+    part[t].first = sp_csr_split(a, t, count);
+    part[t].last = sp_csr_split(a, t + 1, count);
+  }
+  sp_csr_run(sp_csr_mv_part, (void *)part, sizeof(SP_MV_PART), count);
+  return(SP_NOERR);
+}
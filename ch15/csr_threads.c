@@ -0,0 +1,149 @@
+/**************************************************************************
+**  SP_CSR_THREADS, SP_CSR_SPLIT, SP_CSR_RUN                             **
+**                                                                       **
+**    Sharing out the rows of a compressed matrix among threads.         **
+**                                                                       **
+**  INPUT:                                                               **
+**    a -- The compressed matrix whose rows are to be shared out.        **
+**    threads -- For sp_csr_threads, the number of threads asked for, or **
+**               zero or less for one per online processor.              **
+**    part, parts -- For sp_csr_split, which part of how many.           **
+**    func, args, size, count -- For sp_csr_run, the function to run,    **
+**               and count argument blocks of size bytes each.           **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    sp_csr_threads: int -- The number of threads to use, at least 1.   **
+**    sp_csr_split: int -- The first row of the part.  Part parts is     **
+**  one past the last row, so part p is the rows from sp_csr_split(a, p, **
+**  parts) up to sp_csr_split(a, p + 1, parts).                          **
+**    sp_csr_run: void                                                   **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    sp_csr_run calls func once for each argument block, each in its    **
+**  own thread, and returns when they are all done.  The calling thread  **
+**  does the last one.  If a thread cannot be started, the calling       **
+**  thread does its block too, so the work always gets done.             **
+**                                                                       **
+**  NOTES:                                                               **
+**    The parts have about the same number of values rather than the     **
+**  same number of rows, since a few long rows can hold most of the      **
+**  work.                                                                **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_math.h"
+
+#ifndef THREADS_MISSING
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+int sp_csr_threads(SP_CSR *a, int threads)
+/* SP_CSR *a    The compressed matrix */
+/* int threads  The number of threads asked for */
+{
+#ifdef THREADS_MISSING
+  return(1);
+#else
+  if (threads <= 0)
+  {
+#ifdef _SC_NPROCESSORS_ONLN
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = (cpus > 0) ? (int)cpus : 1;
+#else
+    threads = 1;
+#endif
+  }
+  if (threads > SP_MAX_THREADS)
+  {
+    threads = SP_MAX_THREADS;
+  }
+
+  /* Do not make threads that will have almost nothing to do */
+  if (threads > a->count / SP_PARALLEL_CUTOFF + 1)
+  {
+    threads = a->count / SP_PARALLEL_CUTOFF + 1;
+  }
+  if (threads > a->major_size)
+  {
+    threads = (a->major_size > 0) ? a->major_size : 1;
+  }
+  return(threads);
+#endif
+}
+
+int sp_csr_split(SP_CSR *a, int part, int parts)
+/* SP_CSR *a  The compressed matrix */
+/* int part   Which part */
+/* int parts  How many parts */
+{
+  int lo = 0, hi = a->major_size, mid;
+  double target;
+
+  if (part <= 0)
+  {
+    return(0);
+  }
+  if (part >= parts)
+  {
+    return(a->major_size);
+  }
+
+  /* Find the first row that starts at or after its share of the values */
+  target = (double)a->count * part / parts;
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+    if (a->start[mid] < target)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return(lo);
+}
+
+void sp_csr_run(void *(*func)(void *), void *args, size_t size, int count)
+/* void *(*func)(void *)  The function to run */
+/* void *args             The first argument block */
+/* size_t size            The size of each argument block */
+/* int count              The number of argument blocks */
+{
+#ifdef THREADS_MISSING
+  int t;
+
+  for (t = 0; t < count; t++)
+  {
+    func((void *)((char *)args + t * size));
+  }
+#else
+  pthread_t tid[SP_MAX_THREADS];
+  int started[SP_MAX_THREADS];
+  int t;
+
+  for (t = 0; t < count - 1; t++)
+  {
+    started[t] = (pthread_create(&tid[t], NULL, func,
+                                 (void *)((char *)args + t * size)) == 0);
+  }
+  func((void *)((char *)args + (count - 1) * size));
+  for (t = 0; t < count - 1; t++)
+  {
+    if (started[t])
+    {
+      pthread_join(tid[t], NULL);
+    }
+    else
+    {
+      func((void *)((char *)args + t * size));
+    }
+  }
+#endif
+  return;
+}
@@ -0,0 +1,36 @@
+/**************************************************************************
+**  SP_DEL_CSR                                                           **
+**                                                                       **
+**    Frees a compressed matrix made by sp_to_csr.                       **
+**                                                                       **
+**  INPUT:                                                               **
+**    csr -- The compressed matrix to be freed.                          **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    void                                                               **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**                                                                       **
+**  NOTES:                                                               **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_coo.h"
+
+void sp_del_csr(SP_CSR *csr)
+/* SP_CSR *csr  The compressed matrix to be freed */
+{
+  if (csr == (SP_CSR *)NULL)
+  {
+    return;
+  }
+
+  free(csr->start);
+  free(csr->index);
+  free(csr->value);
+  free(csr);
+  return;
+}
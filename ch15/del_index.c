@@ -0,0 +1,39 @@
+/**************************************************************************
+**  SP_DEL_INDEX                                                         **
+**                                                                       **
+**    Removes the hash index from a sparse matrix (see sp_index.h).      **
+**                                                                       **
+**  INPUT:                                                               **
+**    sp -- The sparse matrix whose index is to be removed.              **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    void                                                               **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    The index field of the sparse matrix is set to NULL.               **
+**                                                                       **
+**  NOTES:                                                               **
+**    The nodes themselves belong to the matrix, and are left alone.     **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_index.h"
+
+void sp_del_index(SPARSE_MATRIX *sp)
+/* SPARSE_MATRIX *sp  The sparse matrix whose index is removed */
+{
+  if ((sp == (SPARSE_MATRIX *)NULL) || (sp->index == (SP_INDEX *)NULL))
+  {
+    return;
+  }
+
+  free(sp->index->node);
+  free(sp->index->hash);
+  free(sp->index->seq);
+  free(sp->index);
+  sp->index = (SP_INDEX *)NULL;
+  return;
+}
@@ -13,11 +13,15 @@
 **  SIDE EFFECTS:                                                        **
 **                                                                       **
 **  NOTES:                                                               **
+**    If the matrix has a hash index (see sp_index.h), the node is found **
+**  through it, and removed from it.                                     **
 **                                                                       **
 **************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "sparse.h"
+#include "sp_index.h"
 
 SP_NODE *sp_del_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple)
 /* SPARSE_MATRIX *sp  The sparse matrix in which to find the node */
@@ -66,7 +70,7 @@ SP_NODE *sp_del_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple)
 
     /* If this is the last node in the list then the first and last pointer 
        in the header should be set to NULL */
-    if ((next_node == prev_node) && (next_node = del_node))
+    if ((next_node == prev_node) && (next_node == del_node))
     {
 
       header->first = (SP_NODE *)NULL;
@@ -88,6 +92,12 @@ SP_NODE *sp_del_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple)
     }
   }
 
+  /* Take it out of the index too */
+  if (sp->index != (SP_INDEX *)NULL)
+  {
+    sp_index_remove(sp->index, tuple->seq);
+  }
+
   /* Now the node is no longer in any of the linked lists, so it can be freed */
   free(del_node->dimension_stack);
   free(del_node->hdr_stack);
@@ -0,0 +1,187 @@
+/**************************************************************************
+**  SP_INDEX_GET, SP_INDEX_PUT, SP_INDEX_REMOVE                          **
+**                                                                       **
+**    The operations on the hash index of a sparse matrix (see           **
+**  sp_index.h).                                                         **
+**                                                                       **
+**  INPUT:                                                               **
+**    index -- The index.                                                **
+**    seq -- The sequence numbers of the tuple, index->dimensions of     **
+**           them.                                                       **
+**    node -- For sp_index_put, the node to be stored for the tuple.     **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    sp_index_get: SP_NODE * -- The node stored for the tuple, or NULL  **
+**  if there is none.                                                    **
+**    sp_index_put: int -- 1 if the node was stored, 0 if there was not  **
+**  enough memory to grow the table.  If the tuple was already there,    **
+**  its node is replaced.                                                **
+**    sp_index_remove: void.  It is not an error if the tuple is not     **
+**  there.                                                               **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    sp_index_put doubles the table when it gets more than 70% full.    **
+**                                                                       **
+**  NOTES:                                                               **
+**    None of these allocate anything except when the table grows.       **
+**  Removing uses backward shift deletion, so there are no tombstones    **
+**  and a table that sees many inserts and deletes does not fill up.     **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sparse.h"
+#include "sp_index.h"
+
+/* Mix the sequence numbers of a tuple into 32 bits */
+static unsigned long sp_index_hash(int *seq, int dimensions)
+{
+  unsigned long hash = 0x811C9DC5UL;
+  int curr_dim;
+
+  for (curr_dim = 0; curr_dim < dimensions; curr_dim++)
+  {
+    hash ^= (unsigned long)(unsigned int)seq[curr_dim];
+    hash = (hash * 0x9E3779B1UL) & 0xFFFFFFFFUL;
+    hash ^= hash >> 15;
+  }
+  return(hash);
+}
+
+/* Find the slot that holds the tuple, or the empty slot where it would go */
+static size_t sp_index_slot(SP_INDEX *index, int *seq, unsigned long hash)
+{
+  size_t mask = index->size - 1, slot = hash & mask;
+  size_t seq_size = sizeof(int) * index->dimensions;
+
+  while (index->node[slot] != (SP_NODE *)NULL)
+  {
+    if ((index->hash[slot] == hash) &&
+        !memcmp((void *)(index->seq + slot * index->dimensions),
+                (void *)seq, seq_size))
+    {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return(slot);
+}
+
+/* Move every entry into a table of twice the size */
+static int sp_index_grow(SP_INDEX *index)
+{
+  SP_INDEX old_index = *index;
+  size_t size = old_index.size * 2, slot, new_slot;
+
+  index->node = (SP_NODE **)calloc(size, sizeof(SP_NODE *));
+  index->hash = (unsigned long *)malloc(size * sizeof(unsigned long));
+  index->seq = (int *)malloc(size * sizeof(int) * index->dimensions);
+  if ((index->node == (SP_NODE **)NULL) ||
+      (index->hash == (unsigned long *)NULL) ||
+      (index->seq == (int *)NULL))
+  {
+    free(index->node);
+    free(index->hash);
+    free(index->seq);
+    *index = old_index;
+    return(0);
+  }
+  index->size = size;
+
+  for (slot = 0; slot < old_index.size; slot++)
+  {
+    if (old_index.node[slot] != (SP_NODE *)NULL)
+    {
+      new_slot = old_index.hash[slot] & (size - 1);
+      while (index->node[new_slot] != (SP_NODE *)NULL)
+      {
+        new_slot = (new_slot + 1) & (size - 1);
+      }
+      index->node[new_slot] = old_index.node[slot];
+      index->hash[new_slot] = old_index.hash[slot];
+      memcpy((void *)(index->seq + new_slot * index->dimensions),
+             (void *)(old_index.seq + slot * index->dimensions),
+             sizeof(int) * index->dimensions);
+    }
+  }
+
+  free(old_index.node);
+  free(old_index.hash);
+  free(old_index.seq);
+  return(1);
+}
+
+SP_NODE *sp_index_get(SP_INDEX *index, int *seq)
+/* SP_INDEX *index  The index to search */
+/* int *seq         The tuple to look for */
+{
+  size_t slot;
+
+  slot = sp_index_slot(index, seq, sp_index_hash(seq, index->dimensions));
+  return(index->node[slot]);
+}
+
+int sp_index_put(SP_INDEX *index, int *seq, SP_NODE *node)
+/* SP_INDEX *index  The index to add to */
+/* int *seq         The tuple of the node */
+/* SP_NODE *node    The node */
+{
+  unsigned long hash = sp_index_hash(seq, index->dimensions);
+  size_t slot;
+
+  /* Keep the table no more than 70% full */
+  if (((index->count + 1) * 10 > index->size * 7) && !sp_index_grow(index))
+  {
+    return(0);
+  }
+
+  slot = sp_index_slot(index, seq, hash);
+  if (index->node[slot] == (SP_NODE *)NULL)
+  {
+    index->count++;
+    index->hash[slot] = hash;
+    memcpy((void *)(index->seq + slot * index->dimensions), (void *)seq,
+           sizeof(int) * index->dimensions);
+  }
+  index->node[slot] = node;
+  return(1);
+}
+
+void sp_index_remove(SP_INDEX *index, int *seq)
+/* SP_INDEX *index  The index to remove from */
+/* int *seq         The tuple to remove */
+{
+  size_t mask = index->size - 1, hole, slot, home;
+
+  hole = sp_index_slot(index, seq, sp_index_hash(seq, index->dimensions));
+  if (index->node[hole] == (SP_NODE *)NULL)
+  {
+    return;
+  }
+  index->count--;
+
+  /* Move later entries of the same run back into the hole, unless that
+     would put them before the slot they hash to */
+  slot = hole;
+  for (;;)
+  {
+    slot = (slot + 1) & mask;
+    if (index->node[slot] == (SP_NODE *)NULL)
+    {
+      break;
+    }
+    home = index->hash[slot] & mask;
+    if (((slot - home) & mask) >= ((slot - hole) & mask))
+    {
+      index->node[hole] = index->node[slot];
+      index->hash[hole] = index->hash[slot];
+      memcpy((void *)(index->seq + hole * index->dimensions),
+             (void *)(index->seq + slot * index->dimensions),
+             sizeof(int) * index->dimensions);
+      hole = slot;
+    }
+  }
+  index->node[hole] = (SP_NODE *)NULL;
+}
@@ -22,12 +22,16 @@
 **  insertions as well.                                                  **
 **                                                                       **
 **  NOTES:                                                               **
+**    If the matrix has a hash index (see sp_index.h), finding a node    **
+**  that already exists takes constant time, and a new node is added to  **
+**  the index as well as to the lists.                                   **
 **                                                                       **
 **************************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
 #include "sparse.h"
+#include "sp_index.h"
 
 SPARSE_MATRIX *sp_ins_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple, int node_val)
 /* SPARSE_MATRIX *sp  The sparse matrix into which the node is to be 
@@ -81,7 +85,12 @@ SPARSE_MATRIX *sp_ins_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple, int node_val)
      and if they don't, then insert them.  In the process, build up the header
      list stack needed by the node */
   new_hdr_stack = (SP_HDR_ELEMENT **)malloc(sizeof(SP_HDR_ELEMENT *) * 
-                                            (sp->dimensions - 1));
+                                            sp->dimensions);
+  if (new_hdr_stack == (SP_HDR_ELEMENT **)NULL)
+  {
+    sp->error_no = SP_MEMLOW;
+    return(sp);
+  }
   for (curr_dim = 0; curr_dim < sp->dimensions; curr_dim++)
   {
     /* Set the current sequence number to the sequence number in the tuple
@@ -124,6 +133,7 @@ SPARSE_MATRIX *sp_ins_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple, int node_val)
   {
     free(new_hdr_stack);
     free(new_node);
+    sp->error_no = SP_MEMLOW;
     return(sp);
   }
 
@@ -141,6 +151,18 @@ SPARSE_MATRIX *sp_ins_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple, int node_val)
                    (2 * curr_dim) + 1)) = new_node;
   }
 
+  /* Put the node in the index first, since that is the only step that can
+     run out of memory */
+  if ((sp->index != (SP_INDEX *)NULL) &&
+      !sp_index_put(sp->index, tuple->seq, new_node))
+  {
+    free(new_hdr_stack);
+    free(new_node);
+    free(node_stack);
+    sp->error_no = SP_MEMLOW;
+    return(sp);
+  }
+
   /* insert the node into the node lists associated with each header 
      list element */
   for (curr_dim = 0; curr_dim < sp->dimensions; curr_dim++)
@@ -210,6 +232,10 @@ SPARSE_MATRIX *sp_ins_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple, int node_val)
               node_pos = sp_next_node(sp, curr_dim+1, node_pos);
               if (sp->error_no != SP_NOERR)
               {
+                if (sp->index != (SP_INDEX *)NULL)
+                {
+                  sp_index_remove(sp->index, tuple->seq);
+                }
                 free(new_hdr_stack);
                 free(new_node);
                 free(node_stack);
@@ -238,6 +264,10 @@ SPARSE_MATRIX *sp_ins_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple, int node_val)
       prev_node = sp_previous_node(sp, curr_dim+1, node_pos);
       if ((sp->error_no != SP_NOERR) || (prev_node == (SP_NODE *)NULL))
       {
+        if (sp->index != (SP_INDEX *)NULL)
+        {
+          sp_index_remove(sp->index, tuple->seq);
+        }
         free(new_hdr_stack);
         free(new_node);
         free(node_stack);
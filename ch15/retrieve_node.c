@@ -18,6 +18,8 @@
 **  the error_no of the associated sparse matrix.                        **
 **                                                                       **
 **  NOTES:                                                               **
+**    If the matrix has a hash index (see sp_index.h), the node is found **
+**  in the index, without walking any lists or allocating anything.      **
 **                                                                       **
 **************************************************************************/
 
@@ -25,6 +27,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sparse.h"
+#include "sp_index.h"
 
 SP_NODE *sp_retrieve_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple)
 /* SPARSE_MATRIX *sp  The sparse matrix from which the node is to be 
@@ -58,6 +61,27 @@ SP_NODE *sp_retrieve_node(SPARSE_MATRIX *sp, SP_TUPLE *tuple)
     return((SP_NODE *)NULL);
   }
 
+  /* With an index, check the tuple against the ranges directly and look
+     the node up */
+  if (sp->index != (SP_INDEX *)NULL)
+  {
+    for(curr_dim = 0; curr_dim < sp->dimensions; curr_dim++)
+    {
+      curr_seq = (int *)(tuple->seq + (curr_dim));
+      if (*curr_seq < *(sp->hdr_ranges + (2 * curr_dim)))
+      {
+        sp->error_no = SP_DLOW;
+        return((SP_NODE *)NULL);
+      }
+      if (*curr_seq > *(sp->hdr_ranges + (2 * curr_dim) + 1))
+      {
+        sp->error_no = SP_DHIGH;
+        return((SP_NODE *)NULL);
+      }
+    }
+    return(sp_index_get(sp->index, tuple->seq));
+  }
+
   /* Make sure that the tuple specified is legal */
   for(curr_dim = 0; curr_dim < sp->dimensions; curr_dim++)
   {
@@ -0,0 +1,45 @@
+/**************************************************************************
+**  SP_COO.H                                                             **
+**                                                                       **
+**    Moving a sparse matrix to and from flat arrays.                    **
+**                                                                       **
+**    sp_build_coo fills an empty matrix from a coordinate (COO) list in **
+**  one sort and one linear pass, instead of one sp_ins_node per value.  **
+**  sp_to_coo is the reverse.  sp_to_csr gives a 2 dimensional matrix as **
+**  compressed sparse row (or column) arrays, for numerical code that    **
+**  wants contiguous memory rather than SP_NODE pointers.                **
+**                                                                       **
+**************************************************************************/
+
+#ifndef SP_COO_H
+#define SP_COO_H
+
+#include "sparse.h"
+
+/* A 2 dimensional matrix in compressed form.  When dimension is 1 it is
+   compressed sparse row: the major dimension is dimension 1 of the matrix,
+   and the values of major element i are value[start[i]] up to (but not
+   including) value[start[i+1]], with index[] giving the minor element of
+   each.  When dimension is 2 it is compressed sparse column, and the roles
+   are swapped.  Elements are numbered from 0, so major element i is the
+   sequence number major_min + i */
+typedef struct sp_csr
+{
+  int  dimension;   /* The dimension that is compressed, 1 or 2 */
+  int  major_min;   /* The sequence number of major element 0 */
+  int  major_size;  /* The number of major elements */
+  int  minor_min;   /* The sequence number of minor element 0 */
+  int  minor_size;  /* The number of minor elements */
+  int  count;       /* The number of values */
+  int *start;       /* major_size + 1 offsets into index and value */
+  int *index;       /* The minor element of each value, in order */
+  int *value;       /* The values */
+} SP_CSR;
+
+SPARSE_MATRIX *sp_build_coo(SPARSE_MATRIX *sp, int count, int *seq,
+                            int *value);
+int            sp_to_coo(SPARSE_MATRIX *sp, int **seq, int **value);
+SP_CSR        *sp_to_csr(SPARSE_MATRIX *sp, int dimension);
+void           sp_del_csr(SP_CSR *csr);
+
+#endif
@@ -0,0 +1,44 @@
+/**************************************************************************
+**  SP_INDEX.H                                                           **
+**                                                                       **
+**    The optional hash index of a sparse matrix.                        **
+**                                                                       **
+**    The index maps the full tuple of every node in the matrix to the   **
+**  node, so that sp_retrieve_node does not have to walk the header and  **
+**  node lists.  It is an open addressed table with linear probing, and  **
+**  keeps a copy of each tuple in one flat array so that a lookup does   **
+**  not follow the header pointers of the nodes it passes.               **
+**                                                                       **
+**    A matrix has an index when its index field is not NULL.  A matrix  **
+**  that is set up by hand must set index to NULL, and then              **
+**  sp_create_index can be called at any time to add one.  Once it is    **
+**  there, sp_ins_node and sp_del_node keep it up to date.  The linked   **
+**  lists are still kept as well, for sp_next_node and                   **
+**  sp_previous_node.                                                    **
+**                                                                       **
+**************************************************************************/
+
+#ifndef SP_INDEX_H
+#define SP_INDEX_H
+
+#include <stddef.h>
+#include "sparse.h"
+
+typedef struct sp_index
+{
+  int            dimensions; /* The number of sequence numbers in a tuple */
+  size_t         size;       /* The number of slots, a power of two */
+  size_t         count;      /* The number of slots in use */
+  SP_NODE      **node;       /* The node in each slot, or NULL if empty */
+  unsigned long *hash;       /* The hash of the tuple in each slot */
+  int           *seq;        /* The tuple in each slot, dimensions ints */
+} SP_INDEX;
+
+SPARSE_MATRIX *sp_create_index(SPARSE_MATRIX *sp);
+void           sp_del_index(SPARSE_MATRIX *sp);
+
+SP_NODE       *sp_index_get(SP_INDEX *index, int *seq);
+int            sp_index_put(SP_INDEX *index, int *seq, SP_NODE *node);
+void           sp_index_remove(SP_INDEX *index, int *seq);
+
+#endif
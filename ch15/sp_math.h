@@ -0,0 +1,45 @@
+/**************************************************************************
+**  SP_MATH.H                                                            **
+**                                                                       **
+**    Arithmetic on sparse matrices in compressed sparse row form.       **
+**                                                                       **
+**    Get an SP_CSR from a 2 dimensional SPARSE_MATRIX with              **
+**  sp_to_csr(sp, 1).  sp_csr_mv multiplies it by a vector, sp_csr_mm    **
+**  multiplies two of them, and sp_cg solves a symmetric positive        **
+**  definite system with the conjugate gradient method, which needs      **
+**  only sp_csr_mv and so never makes a dense copy of the matrix.        **
+**                                                                       **
+**    Each takes a thread count.  If it is zero or less, one thread per  **
+**  online processor is used.  The rows are split among the threads so   **
+**  that each gets about the same number of values, and small matrices   **
+**  are done in the calling thread.  The threads are POSIX threads;      **
+**  define THREADS_MISSING if you do not have them.  If the compiler is  **
+**  told it may use AVX2, sp_csr_mv loads four elements of the vector at **
+**  once with a gather instruction.                                      **
+**                                                                       **
+**************************************************************************/
+
+#ifndef SP_MATH_H
+#define SP_MATH_H
+
+#include <stddef.h>
+#include "sparse.h"
+#include "sp_coo.h"
+
+#define SP_MAX_THREADS     64
+#ifndef SP_PARALLEL_CUTOFF
+#define SP_PARALLEL_CUTOFF 32768  /* Fewer values than this per thread
+                                     are not worth starting it for */
+#endif
+
+int  sp_csr_mv(SP_CSR *a, double *x, double *y, int threads);
+int  sp_csr_mm(SP_CSR *a, SP_CSR *b, SP_CSR **c, int threads);
+int  sp_cg(SP_CSR *a, double *b, double *x, double tolerance,
+           int max_iterations, int threads);
+
+/* Used by the functions above to share out the rows */
+int  sp_csr_threads(SP_CSR *a, int threads);
+int  sp_csr_split(SP_CSR *a, int part, int parts);
+void sp_csr_run(void *(*func)(void *), void *args, size_t size, int count);
+
+#endif
@@ -1,5 +1,11 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
 #include "sparse.h"
+#include "sp_index.h"
+#include "sp_coo.h"
+#include "sp_math.h"
 
 void print_tuple(SP_TUPLE *tuple)
 {
@@ -278,6 +284,7 @@ void sparse_test()
   sp.hdr_ranges = (int *)NULL;
   sp.error_no = SP_NOERR;
   sp.hdr_stack = (SP_HDR_ELEMENT *)NULL;
+  sp.index = (SP_INDEX *)NULL;
   print_sparse(&sp);
 
   fprintf(stdout, "\n");
@@ -407,6 +414,7 @@ void sparse_test()
 
   fprintf(stdout, "\n");
   fprintf(stdout, "* Inserting a node at (1,1)\n");
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)1);
@@ -438,6 +446,7 @@ void sparse_test()
   }
   print_node(node, (int)2);
   fprintf(stdout, "* Inserting a node at (0,0)\n");
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)0);
@@ -460,6 +469,7 @@ void sparse_test()
   }
   print_node(node, (int)2);
   fprintf(stdout, "* Filling out matrix to 6x6\n");
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)0);
@@ -472,6 +482,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)0);
@@ -484,6 +495,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)0);
@@ -496,6 +508,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)0);
@@ -508,6 +521,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)0);
@@ -520,6 +534,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)1);
@@ -532,6 +547,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)1);
@@ -544,6 +560,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)1);
@@ -556,6 +573,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)1);
@@ -568,6 +586,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)1);
@@ -580,6 +599,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)2);
@@ -592,6 +612,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)2);
@@ -604,6 +625,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)2);
@@ -616,6 +638,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)2);
@@ -628,6 +651,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)2);
@@ -640,6 +664,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)2);
@@ -652,6 +677,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)3);
@@ -664,6 +690,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)3);
@@ -676,6 +703,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)3);
@@ -688,6 +716,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)3);
@@ -700,6 +729,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)3);
@@ -712,6 +742,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)3);
@@ -724,6 +755,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)4);
@@ -736,6 +768,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)4);
@@ -748,6 +781,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)4);
@@ -760,6 +794,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)4);
@@ -772,6 +807,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)4);
@@ -784,6 +820,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)4);
@@ -796,6 +833,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)5);
@@ -808,6 +846,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)5);
@@ -820,6 +859,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)5);
@@ -832,6 +872,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)5);
@@ -844,6 +885,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)5);
@@ -856,6 +898,7 @@ void sparse_test()
     print_sparse(&sp);
     return;
   }
+  my_tuple.dimensions = 0;
   my_tuple.seq = (int *)NULL;
   tuple_ptr = sp_tuple_dim(&my_tuple, (int)2);
   tuple_ptr = sp_add_tuple(&my_tuple, (int)1, (int)5);
@@ -873,10 +916,455 @@ void sparse_test()
   return;
 }
 
+void index_matrix(SPARSE_MATRIX *sp, int size)
+{
+  sp->dimensions = 0;
+  sp->hdr_ranges = (int *)NULL;
+  sp->error_no = SP_NOERR;
+  sp->hdr_stack = (SP_HDR_ELEMENT *)NULL;
+  sp->index = (SP_INDEX *)NULL;
+  sp_add_header_dimension(sp, 1, 0, size - 1);
+  sp_add_header_dimension(sp, 2, 0, size - 1);
+}
+
+void index_test()
+{
+  SPARSE_MATRIX plain, indexed;
+  SP_TUPLE tuple;
+  SP_NODE *plain_node, *indexed_node;
+  int i, size = 40, errors = 0;
+  clock_t start;
+  double plain_time, indexed_time;
+
+  fprintf(stdout, "\n");
+  fprintf(stdout, "Testing the hash index\n");
+  fprintf(stdout, "----------------------\n");
+  fprintf(stdout, "* Random inserts, updates and deletes, with and without an index\n");
+  index_matrix(&plain, size);
+  index_matrix(&indexed, size);
+  sp_create_index(&indexed);
+  if (indexed.error_no != SP_NOERR)
+  {
+    fprintf(stderr, "index_test: Unable to create the index\n");
+    return;
+  }
+  tuple.dimensions = 0;
+  tuple.seq = (int *)NULL;
+  sp_tuple_dim(&tuple, (int)2);
+
+  srand(1);
+  for (i = 0; i < 20000; i++)
+  {
+    sp_add_tuple(&tuple, (int)1, rand() % size);
+    sp_add_tuple(&tuple, (int)2, rand() % size);
+    if (rand() % 4)
+    {
+      sp_ins_node(&plain, &tuple, i);
+      sp_ins_node(&indexed, &tuple, i);
+    }
+    else
+    {
+      sp_del_node(&plain, &tuple);
+      sp_del_node(&indexed, &tuple);
+    }
+
+    sp_add_tuple(&tuple, (int)1, rand() % size);
+    sp_add_tuple(&tuple, (int)2, rand() % size);
+    plain_node = sp_retrieve_node(&plain, &tuple);
+    indexed_node = sp_retrieve_node(&indexed, &tuple);
+    if ((plain_node == (SP_NODE *)NULL) != (indexed_node == (SP_NODE *)NULL) ||
+        ((plain_node != (SP_NODE *)NULL) &&
+         (plain_node->value != indexed_node->value)))
+    {
+      errors++;
+    }
+  }
+  fprintf(stdout, "%d nodes in the index, %d mismatches\n",
+                  (int)indexed.index->count, errors);
+
+  fprintf(stdout, "* Timing 100000 retrieves\n");
+  start = clock();
+  for (i = 0; i < 100000; i++)
+  {
+    sp_add_tuple(&tuple, (int)1, rand() % size);
+    sp_add_tuple(&tuple, (int)2, rand() % size);
+    sp_retrieve_node(&plain, &tuple);
+  }
+  plain_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+  start = clock();
+  for (i = 0; i < 100000; i++)
+  {
+    sp_add_tuple(&tuple, (int)1, rand() % size);
+    sp_add_tuple(&tuple, (int)2, rand() % size);
+    sp_retrieve_node(&indexed, &tuple);
+  }
+  indexed_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+  fprintf(stdout, "lists: %.3f seconds, index: %.3f seconds\n",
+                  plain_time, indexed_time);
+
+  sp_del_index(&indexed);
+  free(tuple.seq);
+  return;
+}
+
+int same_csr(SP_CSR *a, SP_CSR *b)
+{
+  int i;
+
+  if ((a == (SP_CSR *)NULL) || (b == (SP_CSR *)NULL) ||
+      (a->major_size != b->major_size) || (a->count != b->count))
+  {
+    return(0);
+  }
+  for (i = 0; i <= a->major_size; i++)
+  {
+    if (a->start[i] != b->start[i])
+    {
+      return(0);
+    }
+  }
+  for (i = 0; i < a->count; i++)
+  {
+    if ((a->index[i] != b->index[i]) || (a->value[i] != b->value[i]))
+    {
+      return(0);
+    }
+  }
+  return(1);
+}
+
+void coo_matrix(SPARSE_MATRIX *sp)
+{
+  sp->dimensions = 0;
+  sp->hdr_ranges = (int *)NULL;
+  sp->error_no = SP_NOERR;
+  sp->hdr_stack = (SP_HDR_ELEMENT *)NULL;
+  sp->index = (SP_INDEX *)NULL;
+  sp_add_header_dimension(sp, 1, 5, 64);
+  sp_add_header_dimension(sp, 2, -10, 69);
+}
+
+void coo_test()
+{
+  SPARSE_MATRIX one_by_one, bulk, again;
+  SP_TUPLE tuple;
+  SP_CSR *csr1, *csr2;
+  int count = 3000, *seq, *value, *seq2, *value2, i, count2, dim;
+  clock_t start;
+
+  fprintf(stdout, "\n");
+  fprintf(stdout, "Testing the COO and CSR functions\n");
+  fprintf(stdout, "---------------------------------\n");
+  seq = (int *)malloc(sizeof(int) * 2 * count);
+  value = (int *)malloc(sizeof(int) * count);
+  tuple.dimensions = 0;
+  tuple.seq = (int *)NULL;
+  sp_tuple_dim(&tuple, (int)2);
+  srand(2);
+  for (i = 0; i < count; i++)
+  {
+    seq[2 * i] = 5 + rand() % 60;
+    seq[2 * i + 1] = -10 + rand() % 80;
+    value[i] = i;
+  }
+
+  fprintf(stdout, "* Inserting %d values one by one and in bulk\n", count);
+  coo_matrix(&one_by_one);
+  start = clock();
+  for (i = 0; i < count; i++)
+  {
+    sp_add_tuple(&tuple, (int)1, seq[2 * i]);
+    sp_add_tuple(&tuple, (int)2, seq[2 * i + 1]);
+    sp_ins_node(&one_by_one, &tuple, value[i]);
+  }
+  fprintf(stdout, "sp_ins_node: %.3f seconds\n",
+                  (double)(clock() - start) / CLOCKS_PER_SEC);
+  coo_matrix(&bulk);
+  sp_create_index(&bulk);
+  start = clock();
+  sp_build_coo(&bulk, count, seq, value);
+  fprintf(stdout, "sp_build_coo: %.3f seconds, error %d\n",
+                  (double)(clock() - start) / CLOCKS_PER_SEC, bulk.error_no);
+
+  fprintf(stdout, "* Comparing them as compressed rows and columns\n");
+  for (dim = 1; dim <= 2; dim++)
+  {
+    csr1 = sp_to_csr(&one_by_one, dim);
+    csr2 = sp_to_csr(&bulk, dim);
+    fprintf(stdout, "dimension %d: %d values, %s\n", dim,
+                    csr2 ? csr2->count : -1,
+                    same_csr(csr1, csr2) ? "same" : "DIFFERENT");
+    sp_del_csr(csr1);
+    sp_del_csr(csr2);
+  }
+
+  fprintf(stdout, "* Deleting every other value from both\n");
+  for (i = 0; i < count; i += 2)
+  {
+    sp_add_tuple(&tuple, (int)1, seq[2 * i]);
+    sp_add_tuple(&tuple, (int)2, seq[2 * i + 1]);
+    sp_del_node(&one_by_one, &tuple);
+    sp_del_node(&bulk, &tuple);
+  }
+  for (dim = 1; dim <= 2; dim++)
+  {
+    csr1 = sp_to_csr(&one_by_one, dim);
+    csr2 = sp_to_csr(&bulk, dim);
+    fprintf(stdout, "dimension %d: %d values, %s\n", dim,
+                    csr2 ? csr2->count : -1,
+                    same_csr(csr1, csr2) ? "same" : "DIFFERENT");
+    sp_del_csr(csr1);
+    sp_del_csr(csr2);
+  }
+
+  fprintf(stdout, "* Copying out to COO and back in\n");
+  count2 = sp_to_coo(&bulk, &seq2, &value2);
+  coo_matrix(&again);
+  sp_build_coo(&again, count2, seq2, value2);
+  csr1 = sp_to_csr(&bulk, 1);
+  csr2 = sp_to_csr(&again, 1);
+  fprintf(stdout, "%d values, %s\n", count2,
+                  same_csr(csr1, csr2) ? "same" : "DIFFERENT");
+  sp_del_csr(csr1);
+  sp_del_csr(csr2);
+
+  sp_del_index(&bulk);
+  free(seq2);
+  free(value2);
+  free(seq);
+  free(value);
+  free(tuple.seq);
+  return;
+}
+
+void math_matrix(SPARSE_MATRIX *sp, int rows, int cols)
+{
+  sp->dimensions = 0;
+  sp->hdr_ranges = (int *)NULL;
+  sp->error_no = SP_NOERR;
+  sp->hdr_stack = (SP_HDR_ELEMENT *)NULL;
+  sp->index = (SP_INDEX *)NULL;
+  sp_add_header_dimension(sp, 1, 1, rows);
+  sp_add_header_dimension(sp, 2, 1, cols);
+}
+
+/* A random rows by cols matrix with about one value in percent, kept
+   densely in dense[] as well */
+SP_CSR *math_random(int rows, int cols, int percent, int *dense)
+{
+  SPARSE_MATRIX sp;
+  SP_CSR *csr;
+  int *seq, *value, count = 0, i, j;
+
+  seq = (int *)malloc(sizeof(int) * 2 * rows * cols);
+  value = (int *)malloc(sizeof(int) * rows * cols);
+  for (i = 0; i < rows; i++)
+  {
+    for (j = 0; j < cols; j++)
+    {
+      dense[i * cols + j] = 0;
+      if (rand() % 100 < percent)
+      {
+        seq[2 * count] = i + 1;
+        seq[2 * count + 1] = j + 1;
+        value[count] = rand() % 19 - 9;
+        dense[i * cols + j] = value[count];
+        count++;
+      }
+    }
+  }
+  math_matrix(&sp, rows, cols);
+  sp_build_coo(&sp, count, seq, value);
+  csr = sp_to_csr(&sp, 1);
+  free(seq);
+  free(value);
+  return(csr);
+}
+
+/* The 5 point Laplacian on an m by m grid, which is symmetric positive
+   definite */
+SP_CSR *math_laplacian(int m)
+{
+  SPARSE_MATRIX sp;
+  SP_CSR *csr;
+  int n = m * m, *seq, *value, count = 0, i, j, row;
+
+  seq = (int *)malloc(sizeof(int) * 2 * 5 * n);
+  value = (int *)malloc(sizeof(int) * 5 * n);
+  for (i = 0; i < m; i++)
+  {
+    for (j = 0; j < m; j++)
+    {
+      row = i * m + j + 1;
+      seq[2 * count] = row;
+      seq[2 * count + 1] = row;
+      value[count++] = 4;
+      if (i > 0)
+      {
+        seq[2 * count] = row;
+        seq[2 * count + 1] = row - m;
+        value[count++] = -1;
+      }
+      if (i < m - 1)
+      {
+        seq[2 * count] = row;
+        seq[2 * count + 1] = row + m;
+        value[count++] = -1;
+      }
+      if (j > 0)
+      {
+        seq[2 * count] = row;
+        seq[2 * count + 1] = row - 1;
+        value[count++] = -1;
+      }
+      if (j < m - 1)
+      {
+        seq[2 * count] = row;
+        seq[2 * count + 1] = row + 1;
+        value[count++] = -1;
+      }
+    }
+  }
+  math_matrix(&sp, n, n);
+  sp_build_coo(&sp, count, seq, value);
+  csr = sp_to_csr(&sp, 1);
+  free(seq);
+  free(value);
+  return(csr);
+}
+
+void math_test()
+{
+  SP_CSR *a, *b, *c1, *c4;
+  int rows = 150, inner = 120, cols = 170, m = 300, n, i, j, k;
+  int *da, *db, bad, iterations;
+  double *x, *y, *rhs, sum, error;
+  clock_t start;
+
+  fprintf(stdout, "\n");
+  fprintf(stdout, "Testing sparse matrix arithmetic\n");
+  fprintf(stdout, "--------------------------------\n");
+  srand(3);
+  da = (int *)malloc(sizeof(int) * rows * inner);
+  db = (int *)malloc(sizeof(int) * inner * cols);
+  a = math_random(rows, inner, 5, da);
+  b = math_random(inner, cols, 5, db);
+
+  fprintf(stdout, "* Multiplying a %d by %d matrix by a vector\n",
+                  rows, inner);
+  x = (double *)malloc(sizeof(double) * inner);
+  y = (double *)malloc(sizeof(double) * rows);
+  for (j = 0; j < inner; j++)
+  {
+    x[j] = (double)(rand() % 1000) / 100.0;
+  }
+  sp_csr_mv(a, x, y, 0);
+  error = 0.0;
+  for (i = 0; i < rows; i++)
+  {
+    sum = 0.0;
+    for (j = 0; j < inner; j++)
+    {
+      sum += da[i * inner + j] * x[j];
+    }
+    if (fabs(sum - y[i]) > error)
+    {
+      error = fabs(sum - y[i]);
+    }
+  }
+  fprintf(stdout, "largest difference from dense: %g\n", error);
+
+  fprintf(stdout, "* Multiplying by a %d by %d matrix\n", inner, cols);
+  sp_csr_mm(a, b, &c1, 1);
+  sp_csr_mm(a, b, &c4, 4);
+  bad = 0;
+  for (i = 0; i < rows; i++)
+  {
+    for (j = 0; j < cols; j++)
+    {
+      sum = 0.0;
+      for (k = 0; k < inner; k++)
+      {
+        sum += da[i * inner + k] * db[k * cols + j];
+      }
+      for (k = c1->start[i]; k < c1->start[i + 1]; k++)
+      {
+        if (c1->index[k] == j)
+        {
+          sum -= c1->value[k];
+        }
+      }
+      if (sum != 0.0)
+      {
+        bad++;
+      }
+    }
+  }
+  fprintf(stdout, "%d values, %d wrong, 4 threads %s\n", c1->count, bad,
+                  same_csr(c1, c4) ? "same" : "DIFFERENT");
+  sp_del_csr(c1);
+  sp_del_csr(c4);
+  sp_del_csr(a);
+  sp_del_csr(b);
+  free(da);
+  free(db);
+  free(x);
+  free(y);
+
+  fprintf(stdout, "* Squaring the Laplacian on a %d by %d grid\n", m, m);
+  a = math_laplacian(m);
+  start = clock();
+  sp_csr_mm(a, a, &c1, 1);
+  fprintf(stdout, "1 thread: %.3f seconds\n",
+                  (double)(clock() - start) / CLOCKS_PER_SEC);
+  sp_csr_mm(a, a, &c4, 0);
+  fprintf(stdout, "%d values, all threads %s\n", c1->count,
+                  same_csr(c1, c4) ? "same" : "DIFFERENT");
+  sp_del_csr(c1);
+  sp_del_csr(c4);
+
+  fprintf(stdout, "* Solving with conjugate gradients, %d unknowns\n",
+                  m * m);
+  n = m * m;
+  x = (double *)malloc(sizeof(double) * n);
+  y = (double *)malloc(sizeof(double) * n);
+  rhs = (double *)malloc(sizeof(double) * n);
+  for (i = 0; i < n; i++)
+  {
+    y[i] = (double)(i % 7) - 3.0;
+  }
+  sp_csr_mv(a, y, rhs, 0);
+  for (i = 0; i < n; i++)
+  {
+    x[i] = 0.0;
+  }
+  start = clock();
+  iterations = sp_cg(a, rhs, x, 1e-10, 10 * m, 0);
+  fprintf(stdout, "%d iterations, %.3f seconds of processor time\n",
+                  iterations, (double)(clock() - start) / CLOCKS_PER_SEC);
+  error = 0.0;
+  for (i = 0; i < n; i++)
+  {
+    if (fabs(x[i] - y[i]) > error)
+    {
+      error = fabs(x[i] - y[i]);
+    }
+  }
+  fprintf(stdout, "largest error: %g\n", error);
+  sp_del_csr(a);
+  free(x);
+  free(y);
+  free(rhs);
+  return;
+}
+
 int main()
 {
   tuple_test();
   header_test();
   sparse_test();
+  index_test();
+  coo_test();
+  math_test();
   return (0);
 }
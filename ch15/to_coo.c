@@ -0,0 +1,115 @@
+/**************************************************************************
+**  SP_TO_COO                                                            **
+**                                                                       **
+**    Copies every value of a sparse matrix out into coordinate (COO)    **
+**  arrays.                                                              **
+**                                                                       **
+**  INPUT:                                                               **
+**    sp -- The sparse matrix.                                           **
+**    seq -- Where to put a pointer to the tuples, laid out as for       **
+**           sp_build_coo.                                               **
+**    value -- Where to put a pointer to the values.                     **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    int -- The number of values, or -1 on an error.                    **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    The error_no field of the sparse matrix can be set to an error if  **
+**  an error is encountered.  *seq and *value are allocated with malloc, **
+**  and the caller must free them.  If the matrix has no values, they    **
+**  are set to NULL.                                                     **
+**                                                                       **
+**  NOTES:                                                               **
+**    The values come out in order of their whole tuples, because the    **
+**  header list of the first dimension is in order and so is each node   **
+**  list.  Passing the arrays to sp_build_coo makes the same matrix.     **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_coo.h"
+
+int sp_to_coo(SPARSE_MATRIX *sp, int **seq, int **value)
+/* SPARSE_MATRIX *sp  The sparse matrix to copy */
+/* int **seq          Where to put the tuples */
+/* int **value        Where to put the values */
+{
+  SP_HDR_ELEMENT *hdr_list, *hdr_pos;
+  SP_NODE *node_pos;
+  int count, curr_dim, pass;
+
+  if (sp == (SPARSE_MATRIX *)NULL)
+  {
+    return(-1);
+  }
+
+  sp->error_no = SP_NOERR;
+
+  if ((seq == (int **)NULL) || (value == (int **)NULL))
+  {
+    sp->error_no = SP_BADDIM;
+    return(-1);
+  }
+  *seq = (int *)NULL;
+  *value = (int *)NULL;
+
+  hdr_list = sp_get_header_list(sp, 1);
+  if ((hdr_list == (SP_HDR_ELEMENT *)NULL) || (sp->error_no != SP_NOERR))
+  {
+    return(-1);
+  }
+
+  /* The first pass counts the values, the second copies them */
+  for (pass = 0; pass < 2; pass++)
+  {
+    count = 0;
+    hdr_pos = hdr_list;
+    do
+    {
+      node_pos = hdr_pos->first;
+      if (node_pos != (SP_NODE *)NULL)
+      {
+        do
+        {
+          if (pass == 1)
+          {
+            for (curr_dim = 0; curr_dim < sp->dimensions; curr_dim++)
+            {
+              (*seq)[count * sp->dimensions + curr_dim] =
+                (*(node_pos->hdr_stack + curr_dim))->sequence;
+            }
+            (*value)[count] = node_pos->value;
+          }
+          count++;
+          node_pos = *(node_pos->dimension_stack);
+        }
+        while (node_pos != hdr_pos->first);
+      }
+      hdr_pos = hdr_pos->next;
+    }
+    while (hdr_pos != hdr_list);
+
+    if ((pass == 0) && (count > 0))
+    {
+      *seq = (int *)malloc(sizeof(int) * count * sp->dimensions);
+      *value = (int *)malloc(sizeof(int) * count);
+      if ((*seq == (int *)NULL) || (*value == (int *)NULL))
+      {
+        free(*seq);
+        free(*value);
+        *seq = (int *)NULL;
+        *value = (int *)NULL;
+        sp->error_no = SP_MEMLOW;
+        return(-1);
+      }
+    }
+    if (count == 0)
+    {
+      break;
+    }
+  }
+
+  return(count);
+}
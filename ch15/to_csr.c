@@ -0,0 +1,148 @@
+/**************************************************************************
+**  SP_TO_CSR                                                            **
+**                                                                       **
+**    Copies a 2 dimensional sparse matrix out into compressed sparse    **
+**  row or column arrays (see sp_coo.h).                                 **
+**                                                                       **
+**  INPUT:                                                               **
+**    sp -- The sparse matrix.  It must have 2 dimensions.               **
+**    dimension -- 1 for compressed sparse row, so that the values of    **
+**                 each element of dimension 1 are together, or 2 for    **
+**                 compressed sparse column.                             **
+**                                                                       **
+**  OUTPUT:                                                              **
+**    SP_CSR * -- The compressed matrix, which the caller must free with **
+**  sp_del_csr, or NULL on an error.                                     **
+**                                                                       **
+**  SIDE EFFECTS:                                                        **
+**    The error_no field of the sparse matrix can be set to an error if  **
+**  an error is encountered.  Whenever an error is encountered, this     **
+**  value is set and a NULL pointer is returned.                         **
+**                                                                       **
+**  NOTES:                                                               **
+**    Each header list element of the compressed dimension has its node  **
+**  list in order of the other dimension, so each row (or column) comes  **
+**  out sorted.  The arrays are as big as the ranges of the dimensions,  **
+**  not just the elements that have header list elements.                **
+**                                                                       **
+**************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sparse.h"
+#include "sp_coo.h"
+
+SP_CSR *sp_to_csr(SPARSE_MATRIX *sp, int dimension)
+/* SPARSE_MATRIX *sp  The sparse matrix to copy */
+/* int dimension      The dimension to compress, 1 or 2 */
+{
+  SP_CSR *csr;
+  SP_HDR_ELEMENT *hdr_list, *hdr_pos;
+  SP_NODE *node_pos;
+  int major, minor, pos, i;
+
+  if (sp == (SPARSE_MATRIX *)NULL)
+  {
+    return((SP_CSR *)NULL);
+  }
+
+  sp->error_no = SP_NOERR;
+
+  if (sp->dimensions != 2)
+  {
+    sp->error_no = SP_BADDIM;
+    return((SP_CSR *)NULL);
+  }
+  if ((dimension < 1) || (dimension > 2))
+  {
+    sp->error_no = SP_DIM;
+    return((SP_CSR *)NULL);
+  }
+  major = dimension - 1;
+  minor = 1 - major;
+
+  hdr_list = sp_get_header_list(sp, dimension);
+  if ((hdr_list == (SP_HDR_ELEMENT *)NULL) || (sp->error_no != SP_NOERR))
+  {
+    return((SP_CSR *)NULL);
+  }
+
+  csr = (SP_CSR *)malloc(sizeof(SP_CSR));
+  if (csr == (SP_CSR *)NULL)
+  {
+    sp->error_no = SP_MEMLOW;
+    return((SP_CSR *)NULL);
+  }
+  csr->dimension = dimension;
+  csr->major_min = *(sp->hdr_ranges + (2 * major));
+  csr->major_size = *(sp->hdr_ranges + (2 * major) + 1) - csr->major_min + 1;
+  csr->minor_min = *(sp->hdr_ranges + (2 * minor));
+  csr->minor_size = *(sp->hdr_ranges + (2 * minor) + 1) - csr->minor_min + 1;
+  csr->index = (int *)NULL;
+  csr->value = (int *)NULL;
+  csr->start = (int *)calloc(csr->major_size + 1, sizeof(int));
+  if (csr->start == (int *)NULL)
+  {
+    sp_del_csr(csr);
+    sp->error_no = SP_MEMLOW;
+    return((SP_CSR *)NULL);
+  }
+
+  /* Count the values of each major element into the start of the next */
+  hdr_pos = hdr_list;
+  do
+  {
+    node_pos = hdr_pos->first;
+    if (node_pos != (SP_NODE *)NULL)
+    {
+      do
+      {
+        csr->start[hdr_pos->sequence - csr->major_min + 1]++;
+        node_pos = *(node_pos->dimension_stack + (2 * major));
+      }
+      while (node_pos != hdr_pos->first);
+    }
+    hdr_pos = hdr_pos->next;
+  }
+  while (hdr_pos != hdr_list);
+
+  for (i = 0; i < csr->major_size; i++)
+  {
+    csr->start[i + 1] += csr->start[i];
+  }
+  csr->count = csr->start[csr->major_size];
+
+  /* Allocate at least one of each, so that NULL only means failure */
+  csr->index = (int *)malloc(sizeof(int) * (csr->count + 1));
+  csr->value = (int *)malloc(sizeof(int) * (csr->count + 1));
+  if ((csr->index == (int *)NULL) || (csr->value == (int *)NULL))
+  {
+    sp_del_csr(csr);
+    sp->error_no = SP_MEMLOW;
+    return((SP_CSR *)NULL);
+  }
+
+  /* Copy the values */
+  hdr_pos = hdr_list;
+  do
+  {
+    node_pos = hdr_pos->first;
+    if (node_pos != (SP_NODE *)NULL)
+    {
+      pos = csr->start[hdr_pos->sequence - csr->major_min];
+      do
+      {
+        csr->index[pos] = (*(node_pos->hdr_stack + minor))->sequence -
+                          csr->minor_min;
+        csr->value[pos] = node_pos->value;
+        pos++;
+        node_pos = *(node_pos->dimension_stack + (2 * major));
+      }
+      while (node_pos != hdr_pos->first);
+    }
+    hdr_pos = hdr_pos->next;
+  }
+  while (hdr_pos != hdr_list);
+
+  return(csr);
+}
@@ -0,0 +1,219 @@
+/* adjcsr.c */
+
+#include "adjcsr.h"
+#include <stdlib.h>
+#include <string.h>
+
+int  AdjCSR_MakeGraph(struct Graph * G)
+{
+	struct Graph_CSR * C;
+
+	C=malloc(sizeof(struct Graph_CSR));
+	if (!C) return GRAPH_OUTOFMEM;
+
+	C->NumEdges=0;
+	C->Edges=NULL;
+	C->Start=malloc(sizeof(int));
+	if (!C->Start)
+	{
+		free(C);
+		return GRAPH_OUTOFMEM;
+	}
+	C->Start[0]=0;
+
+	G->CSR=C;
+	return 0;
+}
+
+void AdjCSR_FreeGraph(struct Graph * G)
+{
+	/* free everything except G and G->Vertices */
+	int i;
+
+	for (i=0;i<G->NumVertices;i++) free(G->Vertices[i]);
+
+	free(G->CSR->Start);
+	free(G->CSR->Edges);
+	free(G->CSR);
+	G->CSR=NULL;
+}
+
+int AdjCSR_AddVertex(struct Graph * G, int Index)
+{
+	/* the new vertex has no edges, so it starts where the last one ends */
+	int * start;
+
+	start=realloc(G->CSR->Start,sizeof(int)*(G->NumVertices+1));
+	if (!start) return GRAPH_OUTOFMEM;
+
+	start[G->NumVertices]=start[G->NumVertices-1];
+	G->CSR->Start=start;
+
+	return 0;
+}
+
+void AdjCSR_RemoveVertex(struct Graph * G, int Index)
+{
+	/* RemoveVertex has already checked that there are no edges to Index
+	   (DisconnectVertex fails otherwise), so only the edges from it need
+	   to go. Then all connections > Index must be adjusted. This is slow */
+	struct Graph_CSR * C=G->CSR;
+	int i, n, * start;
+
+	n=C->Start[Index+1]-C->Start[Index];
+	memmove(C->Edges+C->Start[Index],C->Edges+C->Start[Index+1],
+	        sizeof(struct Graph_CSREdge)*(C->NumEdges-C->Start[Index+1]));
+	for (i=Index;i<G->NumVertices;i++) C->Start[i]=C->Start[i+1]-n;
+	C->NumEdges-=n;
+
+	for (i=0;i<C->NumEdges;i++)
+	{
+		if (C->Edges[i].Dest>Index) C->Edges[i].Dest--;
+	}
+
+	start=realloc(C->Start,sizeof(int)*G->NumVertices);
+	if (start) C->Start=start;	/* ignore the error - we're shrinking, not growing */
+}
+
+int  AdjCSR_ConnectVertex(struct Graph * G, int Source, int Destination, int Cost)
+{
+	/* the cost of an existing edge can be changed in place, but there is
+	   no room for a new one */
+	struct Graph_CSR * C=G->CSR;
+	int i;
+
+	for (i=C->Start[Source];i<C->Start[Source+1];i++)
+	{
+		if (C->Edges[i].Dest==Destination)
+		{
+			C->Edges[i].Cost=Cost;
+			return 0;
+		}
+	}
+	return GRAPH_READONLY;
+}
+
+int  AdjCSR_DisconnectVertex(struct Graph * G, int Source, int Destination)
+{
+	struct Graph_CSR * C=G->CSR;
+	int i;
+
+	for (i=C->Start[Source];i<C->Start[Source+1];i++)
+	{
+		if (C->Edges[i].Dest==Destination) return GRAPH_READONLY;
+	}
+	return 0;
+}
+
+int  AdjCSR_EdgeScanStart(struct Graph * G, int Index, struct EdgeScan * EScan)
+{
+	EScan->Internal.Index=G->CSR->Start[Index];
+	return 0;
+}
+
+int  AdjCSR_EdgeScanEnd(struct EdgeScan * EScan)
+{
+	EScan->Internal.Index=-1;
+	return 0;
+}
+
+int  AdjCSR_EdgeScanNext(struct EdgeScan * EScan)
+{
+	struct Graph_CSR * C=EScan->G->CSR;
+	int i;
+
+	i=EScan->Internal.Index;
+	if (i>=C->Start[EScan->Source+1]) return 1;		/* >0.... denotes finished */
+
+	EScan->Dest=C->Edges[i].Dest;
+	EScan->Cost=C->Edges[i].Cost;
+	EScan->Internal.Index=i+1;
+
+	return 0;
+}
+
+int AdjCSR_Build(struct Graph * G, int NumEdges, struct Graph_Edge * Edges)
+{
+	struct Graph_CSR * C=G->CSR;
+	struct Graph_CSREdge * E, * ptr;
+	int * Start, * Seen;
+	int i, j, k, begin, V=G->NumVertices;
+
+	if (NumEdges<0 || (NumEdges && !Edges)) return GRAPH_BADPARAM;
+	for (i=0;i<NumEdges;i++)
+	{
+		if (Edges[i].Source<0 || Edges[i].Source>=V || Edges[i].Dest<0 ||
+		    Edges[i].Dest>=V || Edges[i].Cost==GRAPH_NOTCONNECTED) return GRAPH_BADPARAM;
+	}
+
+	Start=calloc(V+1,sizeof(int));
+	Seen=malloc(sizeof(int)*(V+1));
+	E=malloc(sizeof(struct Graph_CSREdge)*(NumEdges+1));
+	if (!Start || !Seen || !E)
+	{
+		free(Start);free(Seen);free(E);
+		return GRAPH_OUTOFMEM;
+	}
+
+	/* step 1, a counting sort by source. Count the edges from each
+	   vertex into the start of the next, and add up the counts */
+	for (i=0;i<NumEdges;i++) Start[Edges[i].Source+1]++;
+	for (i=0;i<V;i++) Start[i+1]+=Start[i];
+
+	/* step 2, put each edge in the next free place of its source. The
+	   edges of each vertex stay in the order they were listed */
+	for (i=0;i<V;i++) Seen[i]=Start[i];
+	for (i=0;i<NumEdges;i++)
+	{
+		k=Seen[Edges[i].Source]++;
+		E[k].Dest=Edges[i].Dest;
+		E[k].Cost=Edges[i].Cost;
+	}
+
+	/* step 3, squeeze out repeated edges. Seen[d] is where the edge to d
+	   was put, which is from the current vertex if it is >= Start[i] */
+	for (i=0;i<V;i++) Seen[i]=-1;
+	k=0;
+	for (i=0;i<V;i++)
+	{
+		begin=Start[i];
+		Start[i]=k;
+		for (j=begin;j<Start[i+1];j++)
+		{
+			if (Seen[E[j].Dest]>=Start[i])
+			{
+				E[Seen[E[j].Dest]].Cost=E[j].Cost;
+			} else
+			{
+				Seen[E[j].Dest]=k;
+				E[k++]=E[j];
+			}
+		}
+	}
+	Start[V]=k;
+	free(Seen);
+
+	ptr=realloc(E,sizeof(struct Graph_CSREdge)*(k+1));
+	if (ptr) E=ptr;		/* ignore the error - we're shrinking, not growing */
+
+	free(C->Start);
+	free(C->Edges);
+	C->Start=Start;
+	C->Edges=E;
+	C->NumEdges=k;
+
+	return 0;
+}
+
+struct Graph_Spec AdjCSR_Spec=
+{
+	AdjCSR_MakeGraph,
+	AdjCSR_FreeGraph,
+	AdjCSR_AddVertex,
+	AdjCSR_RemoveVertex,
+	AdjCSR_ConnectVertex,
+	AdjCSR_DisconnectVertex,
+	AdjCSR_EdgeScanStart,
+	AdjCSR_EdgeScanEnd,
+	AdjCSR_EdgeScanNext
+};
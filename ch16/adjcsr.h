@@ -0,0 +1,33 @@
+/* adjcsr.h */
+
+#ifndef ADJCSR_H
+#define ADJCSR_H
+
+#include "graphprv.h"
+
+/* A CSR (compressed sparse row) graph keeps every edge in one array,
+   sorted by source vertex. The edges leaving vertex i are
+   Edges[Start[i]] up to (but not including) Edges[Start[i+1]]. */
+
+struct Graph_CSR {
+	int NumEdges;
+	int * Start;						/* NumVertices+1 offsets into Edges */
+	struct Graph_CSREdge * Edges;
+};
+
+struct Graph_CSREdge {
+	int Dest;
+	int Cost;
+};
+
+extern struct Graph_Spec AdjCSR_Spec;
+
+int AdjCSR_Build(struct Graph * G, int NumEdges, struct Graph_Edge * Edges);
+	/* Replaces the edges of the CSR graph G with the NumEdges edges in
+	   Edges, which may be in any order. If an edge is listed more than
+	   once, the last cost listed is used, as if ConnectVertex had been
+	   called for each in turn.
+	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM, GRAPH_OUTOFMEM)
+	*/
+
+#endif
@@ -5,8 +5,9 @@
 #include "graphprv.h"
 #include "adjlist.h"
 #include "adjmatrix.h"
+#include "adjcsr.h"
 
-struct Graph_Spec * Specs[]={&AdjMatrix_Spec, &AdjList_Spec};
+struct Graph_Spec * Specs[]={&AdjMatrix_Spec, &AdjList_Spec, &AdjCSR_Spec};
 
 /* ---------------------------- */
 /* Creating / Destroying Graphs */
@@ -20,7 +21,7 @@ struct Graph * MakeGraph(enum GraphType T)
 {
 	struct Graph * G;
 
-	if (T!=Matrix && T!=List) return NULL;
+	if (T!=Matrix && T!=List && T!=CSR) return NULL;
 
 	G=malloc(sizeof(struct Graph));
 	if (!G) return NULL;			/* we're out of memory */
@@ -28,6 +29,7 @@ struct Graph * MakeGraph(enum GraphType T)
 	G->Private=Specs[T];
 	G->NumVertices=0;
 	G->Vertices=NULL;
+	G->CSR=NULL;
 
 	if ((*G->Private->MakeGraph)(G))
 	{
@@ -53,6 +55,131 @@ int FreeGraph(struct Graph * G)
 	return 0;
 }
 
+struct Graph * MakeGraphFromEdges(int NumVertices, int NumEdges, struct Graph_Edge * Edges)
+	/* Makes a CSR graph with NumVertices vertices (with indices 0 to NumVertices-1)
+	   and the NumEdges edges in Edges, which may be in any order. If an edge is
+	   listed more than once, the last cost listed is used. This takes time in
+	   proportion to NumVertices+NumEdges.
+	   NULL is returned on error (out of memory, or an edge with a bad index or
+	   a cost of GRAPH_NOTCONNECTED), otherwise a pointer to the graph structure
+	   is returned.
+	*/
+{
+	struct Graph * G;
+	int i;
+
+	if (NumVertices<0) return NULL;
+
+	G=MakeGraph(CSR);
+	if (!G) return NULL;
+
+	/* make all the vertices at once, rather than growing G->Vertices
+	   one at a time with AddVertex */
+	G->Vertices=malloc(sizeof(struct Graph_Vertex *) * (NumVertices+1));
+	if (!G->Vertices)
+	{
+		FreeGraph(G);
+		return NULL;
+	}
+
+	for (i=0;i<NumVertices;i++)
+	{
+		G->Vertices[i]=malloc(sizeof(struct Graph_Vertex));
+		if (!G->Vertices[i]) break;
+		G->Vertices[i]->Tag.Ptr=NULL;
+		G->NumVertices++;
+	}
+
+	if (i<NumVertices || AdjCSR_Build(G,NumEdges,Edges))
+	{
+		FreeGraph(G);				/* frees the G->NumVertices vertices made */
+		return NULL;
+	}
+
+	return G;
+}
+
+struct Graph * CopyGraph(struct Graph * G, enum GraphType T)
+	/* Makes a copy of G, of type T, with the same vertices (and tags) and edges.
+	   CopyGraph(G,CSR) 'freezes' a graph, and CopyGraph(G,List) 'thaws' it again.
+	   G is not changed.
+	   NULL is returned on error (out of memory, or G is NULL),
+	   otherwise a pointer to the new graph structure is returned.
+	*/
+{
+	struct Graph * Copy;
+	struct Graph_Edge * Edges;
+	struct EdgeScan EScan;
+	int i, NumEdges;
+
+	if (!G) return NULL;
+
+	if (T==CSR)
+	{
+		/* list all the edges, and build the copy from them in one go */
+		NumEdges=0;
+		for (i=0;i<G->NumVertices;i++)
+		{
+			EdgeScanStart(G,i,&EScan);
+			while (EdgeScanNext(&EScan)==0) NumEdges++;
+			EdgeScanEnd(&EScan);
+		}
+
+		Edges=malloc(sizeof(struct Graph_Edge) * (NumEdges+1));
+		if (!Edges) return NULL;
+
+		NumEdges=0;
+		for (i=0;i<G->NumVertices;i++)
+		{
+			EdgeScanStart(G,i,&EScan);
+			while (EdgeScanNext(&EScan)==0)
+			{
+				Edges[NumEdges].Source=i;
+				Edges[NumEdges].Dest=EScan.Dest;
+				Edges[NumEdges].Cost=EScan.Cost;
+				NumEdges++;
+			}
+			EdgeScanEnd(&EScan);
+		}
+
+		Copy=MakeGraphFromEdges(G->NumVertices,NumEdges,Edges);
+		free(Edges);
+		if (!Copy) return NULL;
+	} else
+	{
+		Copy=MakeGraph(T);
+		if (!Copy) return NULL;
+
+		for (i=0;i<G->NumVertices;i++)
+		{
+			if (AddVertex(Copy)<0)
+			{
+				FreeGraph(Copy);
+				return NULL;
+			}
+		}
+
+		for (i=0;i<G->NumVertices;i++)
+		{
+			EdgeScanStart(G,i,&EScan);
+			while (EdgeScanNext(&EScan)==0)
+			{
+				if (ConnectVertex(Copy,i,EScan.Dest,EScan.Cost))
+				{
+					EdgeScanEnd(&EScan);
+					FreeGraph(Copy);
+					return NULL;
+				}
+			}
+			EdgeScanEnd(&EScan);
+		}
+	}
+
+	for (i=0;i<G->NumVertices;i++) Copy->Vertices[i]->Tag=G->Vertices[i]->Tag;
+
+	return Copy;
+}
+
 /* ----------------- */
 /* Managing Vertices */
 /* ----------------- */
@@ -98,7 +225,8 @@ int RemoveVertex(struct Graph * G, int Index)
 	/* Removes the indicated vertex from the graph. Indices are adjusted so that all indices (if any)
 	   greater than Index are decremented by 1, so no 'holes' exist in G->Vertices. Any connections to
 	   the removed vertex are discarded.
-	   0 is returned on success, !0 indicates an error (GRAPH_BADPARAM)
+	   0 is returned on success, !0 indicates an error (GRAPH_BADPARAM, GRAPH_READONLY)
+	   A vertex of a CSR graph can only be removed if there are no edges to it.
 	*/
 {
 	int i, retval;
@@ -165,8 +293,9 @@ int FindVertex(struct Graph * G, void * Ptr, int Num)
 int ConnectVertex(struct Graph * G, int Source, int Destination, int Cost)
 	/* Make an edge from Source to Destination of specified cost.
 	   Cost must be != GRAPH_NOTCONNECTED
-	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM).
+	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM, GRAPH_OUTOFMEM, GRAPH_READONLY).
 	   If Source is already connected to Destination, then the edges cost is updated to Cost
+	   For a CSR graph, only the cost of an existing edge can be updated.
 	*/
 {
 	if (Cost==GRAPH_NOTCONNECTED || !G || Source<0 || Destination<0 || Source>=G->NumVertices || Destination>=G->NumVertices) return GRAPH_BADPARAM;
@@ -176,7 +305,7 @@ int ConnectVertex(struct Graph * G, int Source, int Destination, int Cost)
 int DisconnectVertex(struct Graph * G, int Source, int Destination) 
 	/* Disconects an edge from Source to Destination. If Source is not connected to
 	   Destination, then 0 (success) is returned.
-	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM)
+	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM, GRAPH_READONLY)
 	*/
 {
 	if (!G || Source<0 || Destination<0 || Source>=G->NumVertices || Destination>=G->NumVertices) return GRAPH_BADPARAM;
@@ -21,6 +21,15 @@
 
    For all but the most extreme circumstances, the two provided
    representations will suffice.
+
+   One such specialist representation is provided: CSR (compressed sparse
+   row) graphs keep all the edges in one array, sorted by source vertex,
+   so scanning the edges of a vertex reads a contiguous block of memory.
+   This suits very large graphs which are built once and then only
+   searched. Their edges are made all at once by MakeGraphFromEdges, or
+   by copying another graph with CopyGraph, and after that edges can not
+   be added or removed (although their costs can be changed). To change a
+   CSR graph, copy it to a List graph, change that, and copy it back.
 */
 
 #ifndef GRAPHS_H
@@ -28,7 +37,7 @@
 
 #include <limits.h>
 
-enum GraphType {Matrix, List};
+enum GraphType {Matrix, List, CSR};
 
 #define GRAPH_NOTCONNECTED			INT_MAX
 /* Since we can't store infinity, we use an arbitry large number instead.
@@ -42,12 +51,15 @@ enum GraphType {Matrix, List};
 #define GRAPH_BADGRAPH				-4
 	/* the graph is 'bad'. For instance, Dijstras algorithm implementations will return this when the graph
 	   it's working with has negative weighted edges */
+#define GRAPH_READONLY				-5
+	/* the edge can't be added or removed because the graph is a CSR graph. Copy it to a List graph first */
 
 struct Graph
 {
 	int NumVertices;
 	struct Graph_Vertex ** Vertices;
 	struct Graph_Spec * Private;				/* internal value */
+	struct Graph_CSR * CSR;						/* internal value, only used by CSR graphs */
 };
 
 struct Graph_Vertex
@@ -77,6 +89,13 @@ struct EdgeScan
 	} Internal;									/* used internally to record position */
 };
 
+struct Graph_Edge
+{
+	int Source;
+	int Dest;
+	int Cost;
+};
+
 /* ---------------------------- */
 /* Creating / Destroying Graphs */
 /* ---------------------------- */
@@ -92,6 +111,24 @@ int FreeGraph(struct Graph * G);
 	   0 is returned on success, <0 indicates an error (GRAPH_BADPARAM)
 	*/
 
+struct Graph * MakeGraphFromEdges(int NumVertices, int NumEdges, struct Graph_Edge * Edges);
+	/* Makes a CSR graph with NumVertices vertices (with indices 0 to NumVertices-1)
+	   and the NumEdges edges in Edges, which may be in any order. If an edge is
+	   listed more than once, the last cost listed is used. This takes time in
+	   proportion to NumVertices+NumEdges.
+	   NULL is returned on error (out of memory, or an edge with a bad index or
+	   a cost of GRAPH_NOTCONNECTED), otherwise a pointer to the graph structure
+	   is returned.
+	*/
+
+struct Graph * CopyGraph(struct Graph * G, enum GraphType T);
+	/* Makes a copy of G, of type T, with the same vertices (and tags) and edges.
+	   CopyGraph(G,CSR) 'freezes' a graph, and CopyGraph(G,List) 'thaws' it again.
+	   G is not changed.
+	   NULL is returned on error (out of memory, or G is NULL),
+	   otherwise a pointer to the new graph structure is returned.
+	*/
+
 /* ----------------- */
 /* Managing Vertices */
 /* ----------------- */
@@ -106,7 +143,8 @@ int RemoveVertex(struct Graph * G, int Index);
 	/* Removes the indicated vertex from the graph. Indices are adjusted so that all indices (if any)
 	   greater than Index are decremented by 1, so no 'holes' exist in G->Vertices. Any connections to
 	   the removed vertex are discarded.
-	   0 is returned on success, !0 indicates an error (GRAPH_BADPARAM)
+	   0 is returned on success, !0 indicates an error (GRAPH_BADPARAM, GRAPH_READONLY)
+	   A vertex of a CSR graph can only be removed if there are no edges to it.
 	*/
 
 int FindVertex(struct Graph * G, void * Ptr, int Num);
@@ -124,14 +162,15 @@ int FindVertex(struct Graph * G, void * Ptr, int Num);
 int ConnectVertex(struct Graph * G, int Source, int Destination, int Cost);
 	/* Make an edge from Source to Destination of specified cost.
 	   Cost must be < GRAPH_NOTCONNECTED
-	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM).
+	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM, GRAPH_OUTOFMEM, GRAPH_READONLY).
 	   If Source is already connected to Destination, then the cost is updated to Cost
+	   For a CSR graph, only the cost of an existing edge can be updated.
 	*/
 
 int DisconnectVertex(struct Graph * G, int Source, int Destination);
 	/* Disconects an edge from Source to Destination. If Source is not connected to
 	   Destination, then 0 (success) is returned.
-	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM)
+	   Returns 0 on success, or <0 on error (GRAPH_BADPARAM, GRAPH_READONLY)
 	*/
 
 int EdgeScanStart(struct Graph * G, int Index, struct EdgeScan * EScan);
@@ -2,7 +2,6 @@
 
 #include "graphs.h"
 #include "mstree.h"
-#include "dfsfuncs.h"
 #include "pqueue.h"
 #include <stdlib.h>
 
@@ -11,6 +10,18 @@
 
 #define SWAP(a,b,type) {type temp; temp=a; a=b; b=temp;}
 
+int Kruskal_Find(int * Parent, int V)
+{
+  /* returns the vertex standing for the tree V is in, and shortens the
+     path to it for next time (path halving) */
+  while (Parent[V]!=V)
+  {
+    Parent[V]=Parent[Parent[V]];
+    V=Parent[V];
+  }
+  return V;
+}
+
 int Kruskal_Undirected(struct Graph * G,struct Graph ** TreePtr)
 {
   /* The graph G is examined to produce a new graph, which is
@@ -21,15 +32,25 @@ int Kruskal_Undirected(struct Graph * G,struct Graph ** TreePtr)
 
   int i, j, numadded;
   struct Graph * Tree;
-  struct PEdgeQueue * Q;
-  struct EdgeScan EScan;
+  struct PEdgeQueue Q;
+  struct EdgeScan EScan, Edge;
+  int * Parent;
 
   if (!G || !TreePtr) return GRAPH_BADPARAM;
 
-  PEQ_Initialise(Q);
+  PEQ_Initialise(&Q);
   Tree=MakeGraph(List);
   if (!Tree) return GRAPH_OUTOFMEM;
 
+  /* Parent[] records which tree of the forest each vertex is in, so
+     that checking for a cycle does not need a search of Tree */
+  Parent=malloc(sizeof(int)*(G->NumVertices+1));
+  if (!Parent)
+  {
+    FreeGraph(Tree);
+    return GRAPH_OUTOFMEM;
+  }
+
   /* step 1 and 2: order the edges in the graph by cost
      also, duplicate the vertices in G into Tree
      (only because it's generally faster to have one
@@ -42,11 +63,13 @@ int Kruskal_Undirected(struct Graph * G,struct Graph ** TreePtr)
     if (j<0)
     {
       /* error, clean up and return */
-      PEQ_Free(Q);
+      PEQ_Free(&Q);
       FreeGraph(Tree);
+      free(Parent);
       return j;
     }
     Tree->Vertices[j]->Tag=G->Vertices[i]->Tag;
+    Parent[j]=j;
 
     EdgeScanStart(G,i,&EScan);
     while (!EdgeScanNext(&EScan))
@@ -56,14 +79,22 @@ int Kruskal_Undirected(struct Graph * G,struct Graph ** TreePtr)
          This means that we only use half the required memory,
          and we only ever traverse any edge once. The cost
          is the processing we need to do here.
+         (An edge queue which is a heap does not look for the
+         reverse edge, so it is queued twice, but the second
+         copy is dropped below as it would make a cycle)
+         The swap is done on a copy, as some kinds of graph
+         need EScan.Source to find the next edge.
       */
-      if (EScan.Source>EScan.Dest) SWAP(EScan.Source,EScan.Dest,int);
+      Edge=EScan;
+      if (Edge.Source>Edge.Dest) SWAP(Edge.Source,Edge.Dest,int);
 
-      if (PEQ_Enqueue(Q,&EScan))
+      if (PEQ_Enqueue(&Q,&Edge))
       {
         /* error - out of memory. Clean up and return */
-        PEQ_Free(Q);
+        EdgeScanEnd(&EScan);
+        PEQ_Free(&Q);
         FreeGraph(Tree);
+        free(Parent);
         return GRAPH_OUTOFMEM;
       }
     }
@@ -73,31 +104,36 @@ int Kruskal_Undirected(struct Graph * G,struct Graph ** TreePtr)
   numadded=0;
 
   /* step 3, select the next edge in the list */
-  while (numadded<G->NumVertices-1 && !PEQ_Dequeue(Q,&EScan))
+  while (numadded<G->NumVertices-1 && !PEQ_Dequeue(&Q,&EScan))
   {
 
 	/* step 4, if the current edge does not form a cycle
 	   add the current edge to the tree
     */
 
-    if (!AreVerticesConnected(Tree,EScan.Source,EScan.Dest))
+    i=Kruskal_Find(Parent,EScan.Source);
+    j=Kruskal_Find(Parent,EScan.Dest);
+    if (i!=j)
     {
-      /* if there is no path from source to dest, then the current edge will not make a cycle when added */
-      j=ConnectVertex(Tree,EScan.Source,EScan.Dest,EScan.Cost);
-      if (!j) j=ConnectVertex(Tree,EScan.Dest,EScan.Source,EScan.Cost);
-      if (j)
+      /* if source and dest are in different trees, then the current edge will not make a cycle when added */
+      Parent[i]=j;
+      i=ConnectVertex(Tree,EScan.Source,EScan.Dest,EScan.Cost);
+      if (!i) i=ConnectVertex(Tree,EScan.Dest,EScan.Source,EScan.Cost);
+      if (i)
       {
         /* an error occured, clean up and return */
-        PEQ_Free(Q);
+        PEQ_Free(&Q);
         FreeGraph(Tree);
-        return j;
+        free(Parent);
+        return i;
       }
       numadded++;
     }
   }
 
   *TreePtr=Tree;
-  PEQ_Free(Q);
+  PEQ_Free(&Q);
+  free(Parent);
 
   return 0;
 }
@@ -120,7 +156,8 @@ int Prim_Undirected(struct Graph * G,struct Graph ** TreePtr)
   struct Graph * Tree;
   struct Prim_Working * W;
   struct EdgeScan EScan;
-  int NumVisited, V, i, j, lowest;
+  struct PQueue Q;
+  int NumVisited, V, i, j, unvisited;
 
   if (!G || !TreePtr) return GRAPH_BADPARAM;
 
@@ -152,6 +189,8 @@ int Prim_Undirected(struct Graph * G,struct Graph ** TreePtr)
   }
 
   NumVisited=0;
+  unvisited=0;
+  PQ_Initialise(&Q);    /* the kind of queue is chosen by PQ_SetType */
 
   /* Tree is an empty graph,
 	 Visited is an array of integers G->NumVertices long initially zeroed */
@@ -168,16 +207,26 @@ int Prim_Undirected(struct Graph * G,struct Graph ** TreePtr)
     if (NumVisited==G->NumVertices) break;		/* we're finished */
 
     /* step 3. for every vertex adjacent to V, adjust
-       the lowest edge cost
+       the lowest edge cost, and queue it by that cost
+       (or lower its cost in the queue)
     */
 
     EdgeScanStart(G,V,&EScan);
     while (!EdgeScanNext(&EScan))
     {
-      if (EScan.Cost<W[EScan.Dest].LowestCost)
+      if (!W[EScan.Dest].Visited && EScan.Cost<W[EScan.Dest].LowestCost)
       {
         W[EScan.Dest].LowestCost=EScan.Cost;
         W[EScan.Dest].Prev=V;
+        if (PQ_Enqueue(&Q,EScan.Cost,EScan.Dest))
+        {
+          /* error occurred, tidy up and return */
+          EdgeScanEnd(&EScan);
+          PQ_Free(&Q);
+          free(W);
+          FreeGraph(Tree);
+          return GRAPH_OUTOFMEM;
+        }
       }
     }
     EdgeScanEnd(&EScan);
@@ -187,17 +236,21 @@ int Prim_Undirected(struct Graph * G,struct Graph ** TreePtr)
        to the minimum spanning tree
     */
 
-	lowest=GRAPH_NOTCONNECTED;V=-1;
-    for (i=0;i<G->NumVertices;i++)
-    {
-      if (W[i].Visited) continue;
+    V=PQ_Dequeue(&Q);
 
-      if (V==-1) V=i;                          
-      if (W[i].LowestCost<lowest)
-      {
-        lowest=W[i].LowestCost;
-        V=i;
-      }
+    if (V==-1)
+    {
+      /* The queue is empty when all the visited vertices
+         do not have any edges to any vertices which have
+         not been visited (that is, the graph is unconnected).
+         Then V is set to a vertex which has not been visited
+         and a minimum spanning forest is made instead of a
+         minimum spanning tree. unvisited only ever moves
+         forward, so finding these takes G->NumVertices steps
+         in all.
+      */
+      while (W[unvisited].Visited) unvisited++;
+      V=unvisited;
     }
 
 	if (W[V].Prev!=-1)
@@ -207,24 +260,15 @@ int Prim_Undirected(struct Graph * G,struct Graph ** TreePtr)
 		if (i)
 		{
 			/* error occurred, tidy up and return */
+            PQ_Free(&Q);
             free(W);
             FreeGraph(Tree);
             return i;
         }
     }
-
-    /* The first 'V=i' in the for loop above is used to preserve
-       the index of a vertex which has not been visited. This is
-       to neatly handle the situation where all the visited 
-       vertices do not have any edges to any vertices which have
-       not been visited (that is, the graph is unconnected). If
-       the graph is unconnected, then V is set to an unvisited
-       vertex and a minimum spanning forest is made instead of a
-       minimum spanning tree. If it is connected, then V would be
-       the index of the vertex with the lowest cost edge known.
-    */
   }
 
+  PQ_Free(&Q);
   free(W);
   *TreePtr=Tree;
 
@@ -10,11 +10,15 @@ int Kruskal_Undirected(struct Graph * G,struct Graph ** TreePtr);
 	   a minimum spanning tree and the struct Graph * denoted
 	   by TreePtr is assigned the new value.
 	   return 0 on success, <0 on error (GRAPH_BADPARAM, GRAPH_OUTOFMEM)
+	   The edges are sorted with a priority queue, of the kind chosen by
+	   PQ_SetType (see pqueue.h).
 	*/
 
 
 int Prim_Undirected(struct Graph * G,struct Graph ** TreePtr);
-  /* As above, but using Prim's algorithm instead.
+  /* As above, but using Prim's algorithm instead. The vertices not yet in
+     the tree are kept in a priority queue by the cost of the cheapest edge
+     to them, of the kind chosen by PQ_SetType.
      return 0 on success, <0 on error (GRAPH_BADPARAM, GRAPH_OUTOFMEM)
   */
 
@@ -2,12 +2,33 @@
 #include "graphs.h"
 #include <stdlib.h>
 
-void PQ_Initialise(struct PQueue * Q)
+/* Each kind of vertex queue has its own enqueue, dequeue and free
+   functions, called through a PQueue_Spec in the same way as a graph's
+   primitives are called through its Graph_Spec */
+
+struct PQueue_Spec {
+	int  (*Enqueue)(struct PQueue *, int Weight, int Index);
+	int  (*Dequeue)(struct PQueue *);
+	void (*Free)   (struct PQueue *);
+};
+
+static enum PQueueType PQ_Type=PQ_Heap;
+
+void PQ_SetType(enum PQueueType T)
 {
-	Q->Front=NULL;
+	if (T==PQ_List || T==PQ_Heap || T==PQ_Buckets) PQ_Type=T;
 }
 
-void PQ_Free(struct PQueue * Q)
+enum PQueueType PQ_GetType(void)
+{
+	return PQ_Type;
+}
+
+/* ----------------------------- */
+/* PQ_List: a sorted linked list */
+/* ----------------------------- */
+
+void PQList_Free(struct PQueue * Q)
 {
 	struct PQueue_Node * node;
 
@@ -21,7 +42,7 @@ void PQ_Free(struct PQueue * Q)
 	}
 }
 
-int PQ_Enqueue(struct PQueue * Q, int Weight, int Index)
+int PQList_Enqueue(struct PQueue * Q, int Weight, int Index)
 {
 	struct PQueue_Node ** nodeptr;
 	struct PQueue_Node *scannode, *newnode;
@@ -44,7 +65,7 @@ int PQ_Enqueue(struct PQueue * Q, int Weight, int Index)
 		newnode=malloc(sizeof(struct PQueue_Node));
 		if (!newnode) return GRAPH_OUTOFMEM;
 	}
-	
+
 	/* here, newnode is valid, uninitialised and not present in the queue regardless */
 	newnode->Weight=Weight;
 	newnode->Index=Index;
@@ -63,7 +84,7 @@ int PQ_Enqueue(struct PQueue * Q, int Weight, int Index)
 		nodeptr=&scannode->Next;
 		scannode=scannode->Next;
 	}
-	
+
 	/* if we reached the end of the list, then insert newnode after scannode */
 	newnode->Next=NULL;
 	*nodeptr=newnode;
@@ -71,7 +92,7 @@ int PQ_Enqueue(struct PQueue * Q, int Weight, int Index)
 	return 0;
 }
 
-int PQ_Dequeue(struct PQueue * Q)
+int PQList_Dequeue(struct PQueue * Q)
 {
 	/* simply, return >0 if Q->Front==NULL, otherwise the index of the first node (and remove it) */
 	int retindex;
@@ -85,18 +106,336 @@ int PQ_Dequeue(struct PQueue * Q)
 	retindex=node->Index;
 	free(node);
 
-	return retindex;	
-}	
+	return retindex;
+}
+
+/* --------------------------------------------------------- */
+/* Arrays indexed by Index, shared by PQ_Heap and PQ_Buckets */
+/* --------------------------------------------------------- */
+
+void PQArray_Free(struct PQueue * Q)
+{
+	free(Q->Weight);
+	free(Q->Where);
+	free(Q->Heap);
+	free(Q->Next);
+	free(Q->Prev);
+	free(Q->Buckets);
+	Q->Weight=Q->Where=Q->Heap=Q->Next=Q->Prev=Q->Buckets=NULL;
+	Q->NumIndices=0;
+	Q->NumBuckets=0;
+	Q->Count=0;
+}
+
+int PQArray_Make(struct PQueue * Q, int Index, int Heap)
+{
+	/* make sure the arrays are long enough for Index. Heap is true for
+	   PQ_Heap, which needs Heap[], and false for PQ_Buckets, which needs
+	   Next[] and Prev[] */
+	int size, i, * ptr;
+
+	if (Index<Q->NumIndices) return 0;
+
+	size=(Q->NumIndices? Q->NumIndices : 64);
+	while (size<=Index) size*=2;
+
+	ptr=realloc(Q->Weight,sizeof(int)*size);
+	if (!ptr) return GRAPH_OUTOFMEM;
+	Q->Weight=ptr;
+	ptr=realloc(Q->Where,sizeof(int)*size);
+	if (!ptr) return GRAPH_OUTOFMEM;
+	Q->Where=ptr;
+	if (Heap)
+	{
+		ptr=realloc(Q->Heap,sizeof(int)*size);
+		if (!ptr) return GRAPH_OUTOFMEM;
+		Q->Heap=ptr;
+	} else
+	{
+		ptr=realloc(Q->Next,sizeof(int)*size);
+		if (!ptr) return GRAPH_OUTOFMEM;
+		Q->Next=ptr;
+		ptr=realloc(Q->Prev,sizeof(int)*size);
+		if (!ptr) return GRAPH_OUTOFMEM;
+		Q->Prev=ptr;
+	}
+
+	for (i=Q->NumIndices;i<size;i++) Q->Where[i]=-1;
+	Q->NumIndices=size;
+
+	return 0;
+}
+
+/* ------------------------------------------------- */
+/* PQ_Heap: a binary heap of indices, with positions */
+/* ------------------------------------------------- */
+
+void PQHeap_Up(struct PQueue * Q, int place)
+{
+	/* move the index at place up the heap until its parent weighs no more */
+	int index=Q->Heap[place], parent;
+
+	while (place>0)
+	{
+		parent=(place-1)/2;
+		if (Q->Weight[Q->Heap[parent]]<=Q->Weight[index]) break;
+		Q->Heap[place]=Q->Heap[parent];
+		Q->Where[Q->Heap[place]]=place;
+		place=parent;
+	}
+	Q->Heap[place]=index;
+	Q->Where[index]=place;
+}
+
+void PQHeap_Down(struct PQueue * Q, int place)
+{
+	/* move the index at place down the heap until neither child weighs less */
+	int index=Q->Heap[place], child;
+
+	for (;;)
+	{
+		child=2*place+1;
+		if (child>=Q->Count) break;
+		if (child+1<Q->Count && Q->Weight[Q->Heap[child+1]]<Q->Weight[Q->Heap[child]]) child++;
+		if (Q->Weight[index]<=Q->Weight[Q->Heap[child]]) break;
+		Q->Heap[place]=Q->Heap[child];
+		Q->Where[Q->Heap[place]]=place;
+		place=child;
+	}
+	Q->Heap[place]=index;
+	Q->Where[index]=place;
+}
+
+int PQHeap_Enqueue(struct PQueue * Q, int Weight, int Index)
+{
+	int old;
+
+	if (PQArray_Make(Q,Index,1)) return GRAPH_OUTOFMEM;
+
+	if (Q->Where[Index]==-1)
+	{
+		Q->Weight[Index]=Weight;
+		Q->Heap[Q->Count]=Index;
+		Q->Count++;
+		PQHeap_Up(Q,Q->Count-1);
+		return 0;
+	}
+
+	/* already queued, so move it to suit its new weight */
+	old=Q->Weight[Index];
+	Q->Weight[Index]=Weight;
+	if (Weight<old) PQHeap_Up(Q,Q->Where[Index]);
+	else PQHeap_Down(Q,Q->Where[Index]);
+
+	return 0;
+}
+
+int PQHeap_Dequeue(struct PQueue * Q)
+{
+	int retindex;
+
+	if (!Q->Count) return -1;
+
+	retindex=Q->Heap[0];
+	Q->Where[retindex]=-1;
+	Q->Count--;
+	if (Q->Count)
+	{
+		Q->Heap[0]=Q->Heap[Q->Count];
+		PQHeap_Down(Q,0);
+	}
+
+	return retindex;
+}
+
+/* ---------------------------------------------- */
+/* PQ_Buckets: a circular array of weight buckets */
+/* ---------------------------------------------- */
+
+/* An index of weight W is kept in a doubly linked list in bucket
+   W mod NumBuckets. As long as all the weights queued are in a range
+   narrower than NumBuckets, each bucket holds only one weight, and the
+   lowest weight can be found by looking at the buckets in turn from Min */
+
+#define BUCKET(Q,W)		((int)((unsigned)(W) & (unsigned)((Q)->NumBuckets-1)))
+
+void PQBuckets_Unlink(struct PQueue * Q, int Index)
+{
+	int b=Q->Where[Index];
+
+	if (Q->Prev[Index]==-1) Q->Buckets[b]=Q->Next[Index];
+	else Q->Next[Q->Prev[Index]]=Q->Next[Index];
+	if (Q->Next[Index]!=-1) Q->Prev[Q->Next[Index]]=Q->Prev[Index];
+
+	Q->Where[Index]=-1;
+	Q->Count--;
+}
+
+void PQBuckets_Link(struct PQueue * Q, int Index)
+{
+	int b=BUCKET(Q,Q->Weight[Index]);
+
+	Q->Prev[Index]=-1;
+	Q->Next[Index]=Q->Buckets[b];
+	if (Q->Buckets[b]!=-1) Q->Prev[Q->Buckets[b]]=Index;
+	Q->Buckets[b]=Index;
+
+	Q->Where[Index]=b;
+	Q->Count++;
+}
+
+int PQBuckets_Grow(struct PQueue * Q, unsigned range)
+{
+	/* make more buckets than range, and put every queued index back in
+	   the right one. Only the old buckets say which indices are queued */
+	int * old=Q->Buckets, oldsize=Q->NumBuckets, size, i, index, next;
+
+	size=(oldsize? oldsize : 256);
+	while ((unsigned)size<=range)
+	{
+		if (size>INT_MAX/2) return GRAPH_OUTOFMEM;		/* the weights are too far apart */
+		size*=2;
+	}
+
+	Q->Buckets=malloc(sizeof(int)*size);
+	if (!Q->Buckets)
+	{
+		Q->Buckets=old;
+		return GRAPH_OUTOFMEM;
+	}
+	Q->NumBuckets=size;
+	for (i=0;i<size;i++) Q->Buckets[i]=-1;
+
+	for (i=0;i<oldsize;i++)
+	{
+		for (index=old[i];index!=-1;index=next)
+		{
+			next=Q->Next[index];
+			Q->Count--;					/* PQBuckets_Link counts it again */
+			PQBuckets_Link(Q,index);
+		}
+	}
+	free(old);
+
+	return 0;
+}
+
+int PQBuckets_Enqueue(struct PQueue * Q, int Weight, int Index)
+{
+	int min, max, others;
+
+	if (PQArray_Make(Q,Index,0)) return GRAPH_OUTOFMEM;
+
+	/* Index may be queued already. It stays queued, at its old weight,
+	   until growing the buckets can no longer fail */
+	others=Q->Count-(Q->Where[Index]!=-1);
+	if (!others)
+	{
+		min=max=Weight;
+	} else
+	{
+		min=(Weight<Q->Min? Weight : Q->Min);
+		max=(Weight>Q->Max? Weight : Q->Max);
+	}
+
+	if ((unsigned)max-(unsigned)min>=(unsigned)Q->NumBuckets)
+	{
+		if (PQBuckets_Grow(Q,(unsigned)max-(unsigned)min)) return GRAPH_OUTOFMEM;
+	}
+
+	if (Q->Where[Index]!=-1) PQBuckets_Unlink(Q,Index);
+	Q->Min=min;
+	Q->Max=max;
+	Q->Weight[Index]=Weight;
+	PQBuckets_Link(Q,Index);
+
+	return 0;
+}
+
+int PQBuckets_Dequeue(struct PQueue * Q)
+{
+	int retindex;
+
+	if (!Q->Count) return -1;
+
+	/* an empty bucket at Min means nothing weighs Min */
+	while (Q->Buckets[BUCKET(Q,Q->Min)]==-1) Q->Min++;
+
+	retindex=Q->Buckets[BUCKET(Q,Q->Min)];
+	PQBuckets_Unlink(Q,retindex);
+
+	return retindex;
+}
+
+#undef BUCKET
+
+struct PQueue_Spec PQ_Specs[]=
+{
+	{PQList_Enqueue,    PQList_Dequeue,    PQList_Free},
+	{PQHeap_Enqueue,    PQHeap_Dequeue,    PQArray_Free},
+	{PQBuckets_Enqueue, PQBuckets_Dequeue, PQArray_Free}
+};
+
+/* -------------------------------------- */
+/* The vertex queue, whichever kind it is */
+/* -------------------------------------- */
+
+void PQ_InitialiseType(struct PQueue * Q, enum PQueueType T)
+{
+	if (T!=PQ_List && T!=PQ_Heap && T!=PQ_Buckets) T=PQ_Heap;
+
+	Q->Private=&PQ_Specs[T];
+	Q->Front=NULL;
+	Q->Count=0;
+	Q->NumIndices=0;
+	Q->Weight=Q->Where=Q->Heap=Q->Next=Q->Prev=Q->Buckets=NULL;
+	Q->NumBuckets=0;
+	Q->Min=Q->Max=0;
+}
+
+void PQ_Initialise(struct PQueue * Q)
+{
+	PQ_InitialiseType(Q,PQ_Type);
+}
+
+void PQ_Free(struct PQueue * Q)
+{
+	(*Q->Private->Free)(Q);
+}
+
+int PQ_Enqueue(struct PQueue * Q, int Weight, int Index)
+{
+	if (Index<0) return GRAPH_BADPARAM;
+	return (*Q->Private->Enqueue)(Q,Weight,Index);
+}
+
+int PQ_Dequeue(struct PQueue * Q)
+{
+	return (*Q->Private->Dequeue)(Q);
+}
+
+/* ---------------------------------------------- */
+/* The edge queue, a sorted list or an array heap */
+/* ---------------------------------------------- */
 
 void PEQ_Initialise(struct PEdgeQueue * Q)
 {
+	Q->IsHeap=(PQ_Type!=PQ_List);
 	Q->Front=NULL;
+	Q->Heap=NULL;
+	Q->Count=0;
+	Q->Size=0;
 }
 
 void PEQ_Free(struct PEdgeQueue * Q)
 {
 	struct PEdgeQueue_Node * node;
 
+	free(Q->Heap);
+	Q->Heap=NULL;
+	Q->Count=0;
+	Q->Size=0;
+
 	if (!Q->Front) return;
 
 	while (Q->Front)
@@ -107,11 +446,74 @@ void PEQ_Free(struct PEdgeQueue * Q)
 	}
 }
 
+int PEQHeap_Enqueue(struct PEdgeQueue * Q, struct EdgeScan * EScan)
+{
+	struct PEdgeQueue_Item item, * ptr;
+	int place, parent;
+
+	if (Q->Count==Q->Size)
+	{
+		ptr=realloc(Q->Heap,sizeof(struct PEdgeQueue_Item)*(Q->Size? Q->Size*2 : 256));
+		if (!ptr) return GRAPH_OUTOFMEM;
+		Q->Heap=ptr;
+		Q->Size=(Q->Size? Q->Size*2 : 256);
+	}
+
+	item.Weight=EScan->Cost;
+	item.Source=EScan->Source;
+	item.Dest=EScan->Dest;
+
+	/* move the hole at the end up until its parent weighs no more */
+	place=Q->Count;
+	Q->Count++;
+	while (place>0)
+	{
+		parent=(place-1)/2;
+		if (Q->Heap[parent].Weight<=item.Weight) break;
+		Q->Heap[place]=Q->Heap[parent];
+		place=parent;
+	}
+	Q->Heap[place]=item;
+
+	return 0;
+}
+
+int PEQHeap_Dequeue(struct PEdgeQueue * Q, struct EdgeScan * EScan)
+{
+	struct PEdgeQueue_Item item;
+	int place, child;
+
+	if (!Q->Count) return -1;
+
+	EScan->Source=Q->Heap[0].Source;
+	EScan->Dest=Q->Heap[0].Dest;
+	EScan->Cost=Q->Heap[0].Weight;
+
+	/* move the last item down from the top until neither child weighs less */
+	Q->Count--;
+	item=Q->Heap[Q->Count];
+	place=0;
+	for (;;)
+	{
+		child=2*place+1;
+		if (child>=Q->Count) break;
+		if (child+1<Q->Count && Q->Heap[child+1].Weight<Q->Heap[child].Weight) child++;
+		if (item.Weight<=Q->Heap[child].Weight) break;
+		Q->Heap[place]=Q->Heap[child];
+		place=child;
+	}
+	Q->Heap[place]=item;
+
+	return 0;
+}
+
 int PEQ_Enqueue(struct PEdgeQueue * Q, struct EdgeScan * EScan)
 {
 	struct PEdgeQueue_Node ** nodeptr;
 	struct PEdgeQueue_Node *scannode, *newnode;
 
+	if (Q->IsHeap) return PEQHeap_Enqueue(Q,EScan);
+
 	/* check to see if Index is already present */
 	nodeptr=&Q->Front;
 	newnode=Q->Front;
@@ -130,7 +532,7 @@ int PEQ_Enqueue(struct PEdgeQueue * Q, struct EdgeScan * EScan)
 		newnode=malloc(sizeof(struct PEdgeQueue_Node));
 		if (!newnode) return GRAPH_OUTOFMEM;
 	}
-	
+
 	/* here, newnode is valid, uninitialised and not present in the queue regardless */
 	newnode->Weight=EScan->Cost;
 	newnode->Source=EScan->Source;
@@ -150,7 +552,7 @@ int PEQ_Enqueue(struct PEdgeQueue * Q, struct EdgeScan * EScan)
 		nodeptr=&scannode->Next;
 		scannode=scannode->Next;
 	}
-	
+
 	/* if we reached the end of the list, then insert newnode after scannode */
 	newnode->Next=NULL;
 	*nodeptr=newnode;
@@ -162,6 +564,8 @@ int PEQ_Dequeue(struct PEdgeQueue * Q, struct EdgeScan * EScan)
 {
 	struct PEdgeQueue_Node * node;
 
+	if (Q->IsHeap) return PEQHeap_Dequeue(Q,EScan);
+
 	if (!Q->Front) return -1;
 
 	node=Q->Front;
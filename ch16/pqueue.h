@@ -5,10 +5,50 @@
 
 #include "graphs.h"
 
+/* There are three kinds of queue:
+
+   PQ_List     a singly linked list kept sorted by weight. Enqueue and
+               dequeue take time in proportion to the length of the queue.
+   PQ_Heap     a binary heap of indices, with an array recording where each
+               index is in the heap, so that the weight of a queued index can
+               be changed in place (decrease-key). Enqueue and dequeue take
+               log(length) time.
+   PQ_Buckets  one bucket per weight, in a circular array which is grown to
+               be wider than the range of weights queued at once (Dial's
+               algorithm). Enqueue takes constant time, and dequeue takes time
+               in proportion to the gap to the next weight. This is fastest
+               when the weights are small integers: in Dijkstra's algorithm
+               the range of weights queued is never more than the largest
+               edge cost, and in Prim's algorithm the weights are edge costs.
+
+   PQ_SetType chooses the kind made by PQ_Initialise and PEQ_Initialise, and
+   so the kind used by the shortest path and spanning tree algorithms.
+   Edge queues are sorted lists for PQ_List, and array heaps otherwise.
+*/
+
+enum PQueueType {PQ_List, PQ_Heap, PQ_Buckets};
+
+void PQ_SetType(enum PQueueType T);
+	/* Chooses the kind of queue made from now on. PQ_Heap is the default */
+
+enum PQueueType PQ_GetType(void);
+	/* Returns the kind of queue being made */
+
 /* a prioritesed queue for vertices */
 
 struct PQueue {
-	struct PQueue_Node * Front;
+	struct PQueue_Spec * Private;		/* internal value */
+	struct PQueue_Node * Front;			/* PQ_List: the queue */
+	int Count;							/* PQ_Heap and PQ_Buckets: the number of indices queued */
+	int NumIndices;						/* the length of the arrays below, one more than the largest index seen */
+	int * Weight;						/* the weight of each index queued */
+	int * Where;						/* where each index is in Heap, or its bucket, or -1 if not queued */
+	int * Heap;							/* PQ_Heap: the heap of indices */
+	int * Next;							/* PQ_Buckets: the next and previous index in the same bucket */
+	int * Prev;
+	int * Buckets;						/* PQ_Buckets: the first index in each bucket, or -1 */
+	int NumBuckets;						/* always a power of 2 */
+	int Min, Max;						/* PQ_Buckets: no index queued has a weight outside Min..Max */
 };
 
 struct PQueue_Node {
@@ -18,14 +58,22 @@ struct PQueue_Node {
 };
 
 void PQ_Initialise(struct PQueue * Q);
+void PQ_InitialiseType(struct PQueue * Q, enum PQueueType T);
 void PQ_Free(struct PQueue * Q);
 int PQ_Enqueue(struct PQueue * Q, int Weight, int Index);
+	/* Queues Index (>=0) with the given Weight. If Index is already queued its
+	   weight is changed. Returns 0 on success, or <0 on error (GRAPH_OUTOFMEM) */
 int PQ_Dequeue(struct PQueue * Q);
+	/* Removes and returns the index with the lowest weight, or -1 if the queue is empty */
 
 /* a prioritesed queue for edges */
 
 struct PEdgeQueue {
-	struct PEdgeQueue_Node * Front;
+	int IsHeap;							/* which of the two below is used */
+	struct PEdgeQueue_Node * Front;		/* a sorted list */
+	struct PEdgeQueue_Item * Heap;		/* an array heap */
+	int Count;
+	int Size;							/* the length of Heap */
 };
 
 struct PEdgeQueue_Node {
@@ -35,9 +83,21 @@ struct PEdgeQueue_Node {
 	struct PEdgeQueue_Node * Next;
 };
 
+struct PEdgeQueue_Item {
+	int Weight;
+	int Source;
+	int Dest;
+};
+
 void PEQ_Initialise(struct PEdgeQueue * Q);
 void PEQ_Free(struct PEdgeQueue * Q);
 int PEQ_Enqueue(struct PEdgeQueue * Q, struct EdgeScan * EScan);
+	/* Queues the edge in EScan. A sorted list replaces an edge with the same
+	   Source and Dest which is already queued. An array heap does not look,
+	   so the edge may be queued twice. Returns 0 on success, or <0 on error
+	   (GRAPH_OUTOFMEM) */
 int PEQ_Dequeue(struct PEdgeQueue * Q, struct EdgeScan * EScan);
+	/* Removes the edge with the lowest weight and puts it in EScan. Returns
+	   0 on success, or -1 if the queue is empty */
 
 #endif
@@ -106,9 +106,9 @@ int Dijkstra_Sparse(struct Graph * G, int Source, struct Dijkstra_Table * Table)
   struct Dijkstra_Row * Results;
   struct EdgeScan E;    /* holds information about an edge */
 
-  PQ_Initialise(&Q);
   i=InitResults(&Results, G->NumVertices);
   if (i) return i;	/* report any errors */
+  PQ_Initialise(&Q);    /* the kind of queue is chosen by PQ_SetType */
 
   Results[Source].Total=0;       /* Step 1 */
   Results[Source].Previous=-1;	/* no previous node */
@@ -121,13 +121,20 @@ int Dijkstra_Sparse(struct Graph * G, int Source, struct Dijkstra_Table * Table)
 	while (EdgeScanNext(&E)==0)
     {
       if (Results[E.Dest].Visited) continue;
-      if (E.Cost<0) return GRAPH_BADGRAPH;
-
-      if (Results[V].Total + E.Cost < Results[E.Dest].Total )
+      if (E.Cost<0) i=GRAPH_BADGRAPH;
+      else if (Results[V].Total + E.Cost < Results[E.Dest].Total )
       {
         Results[E.Dest].Total = Results[V].Total + E.Cost;
         Results[E.Dest].Previous=V;
-		PQ_Enqueue(&Q,Results[E.Dest].Total,E.Dest);
+		i=PQ_Enqueue(&Q,Results[E.Dest].Total,E.Dest);	/* or lower its weight if queued */
+      }
+      if (i)
+      {
+        /* error, clean up and return */
+        EdgeScanEnd(&E);
+        PQ_Free(&Q);
+        free(Results);
+        return i;
       }
     }
 	EdgeScanEnd(&E);
@@ -135,6 +142,7 @@ int Dijkstra_Sparse(struct Graph * G, int Source, struct Dijkstra_Table * Table)
     V=PQ_Dequeue(&Q);           /* Step 4 */
   } while (V!=-1);
 
+  PQ_Free(&Q);
   Table->G=G;
   Table->Source=Source;
   Table->Results=Results;
@@ -150,9 +158,9 @@ int Bellman(struct Graph * G, int Source, struct Dijkstra_Table * Table)
   struct Dijkstra_Row * Results;
   struct EdgeScan E;    /* holds information about an edge */
 
-  PQ_Initialise(&Q);
   i=InitResults(&Results, G->NumVertices);
   if (i) return i;	/* report any errors */
+  PQ_Initialise(&Q);
 
   Results[Source].Total=0;       /* Step 1 */
   Results[Source].Previous=-1;	/* no previous node */
@@ -160,7 +168,12 @@ int Bellman(struct Graph * G, int Source, struct Dijkstra_Table * Table)
 	
   do {
     Results[V].Visited++;       /* Step 2 */
-	if (Results[V].Visited==G->NumVertices) return GRAPH_BADGRAPH;
+	if (Results[V].Visited==G->NumVertices)
+    {
+      PQ_Free(&Q);
+      free(Results);
+      return GRAPH_BADGRAPH;
+    }
     /* if we have visited a vertex once for each vertex, 
        then we must be in a negatively weighted cycle. Return
        an error to prevent infinite loop
@@ -173,7 +186,13 @@ int Bellman(struct Graph * G, int Source, struct Dijkstra_Table * Table)
       {
         Results[E.Dest].Total = Results[V].Total + E.Cost;
         Results[E.Dest].Previous=V;
-		PQ_Enqueue(&Q,Results[E.Dest].Total,E.Dest);
+		if (PQ_Enqueue(&Q,Results[E.Dest].Total,E.Dest))
+        {
+          EdgeScanEnd(&E);
+          PQ_Free(&Q);
+          free(Results);
+          return GRAPH_OUTOFMEM;
+        }
       }
     }
 	EdgeScanEnd(&E);
@@ -182,6 +201,7 @@ int Bellman(struct Graph * G, int Source, struct Dijkstra_Table * Table)
 
   } while (V!=-1);
 
+  PQ_Free(&Q);
   Table->G=G;
   Table->Source=Source;
   Table->Results=Results;
@@ -40,7 +40,11 @@ int Dijkstra_Simple(struct Graph * G, int Source, struct Dijkstra_Table * Table)
 	*/
 
 int Dijkstra_Sparse(struct Graph * G, int Source, struct Dijkstra_Table * Table);
-	/* Exactly the same as Dijkstra_Simple, but should be faster for sparse graphs */
+	/* Exactly the same as Dijkstra_Simple, but should be faster for sparse graphs.
+	   It keeps the vertices to visit in a priority queue, of the kind chosen by
+	   PQ_SetType (see pqueue.h). With PQ_Heap it takes E log(V) time, and with
+	   PQ_Buckets E+V*C, where C is the largest edge cost.
+	*/
 
 int Bellman(struct Graph * G, int Source, struct Dijkstra_Table * Table);
 	/* This is a drop in replacement for the above two implementations of Dijkstra's
@@ -47,7 +47,7 @@ int TopologicalSort(struct Graph * G, int ** sorted)
   if (!G || !sorted) return GRAPH_BADPARAM;
 
   queue=malloc(sizeof(int)*G->NumVertices);
-  itable=malloc(sizeof(int)*G->NumVertices);
+  itable=calloc(G->NumVertices+1,sizeof(int));	/* InitIndegreeTable counts up from 0 */
   if (!queue || !itable)
   {
     free(queue);free(itable);